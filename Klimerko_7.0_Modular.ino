@@ -23,7 +23,7 @@
  * - BME280 environmental sensor (temperature, humidity, pressure)
  * - EPA humidity correction for PM values
  * - MQTT to AllThingsTalk (configurable broker)
- * - Local Web Dashboard with Chart.js graphs
+ * - Local Web Dashboard with self-hosted charts (gzip assets on LittleFS)
  * - Prometheus metrics endpoint (/metrics)
  * - mDNS discovery (klimerko-xxxxxx.local)
  * - NTP time synchronization
@@ -38,15 +38,30 @@
  * - Unique AP password per device (ChipID-based)
  * - OTA password protection
  * - Buffer overflow protection in MQTT callback
+ * - Optional MQTT over TLS with fingerprint / CA pinning
  * - CRC32 validation for stored settings
  * 
  * MODULE STRUCTURE:
  * - config.h      - All configuration constants
  * - types.h       - Data structures and enums
+ * - assets.h      - MQTT asset names, compile-time perfect-hash lookup
  * - utils.h       - Utility functions (CRC32, calculations)
  * - sensors.h     - PMS7003 and BME280 management
  * - network.h     - WiFi, MQTT, mDNS, NTP, OTA
+ * - mqtt_tls.h    - MQTT over TLS (BearSSL, session resumption)
+ * - payload.h     - JSON / MessagePack / CBOR state encoding
+ * - deadband.h    - Change-only publishing per asset
+ * - sinks.h       - Local MQTT / InfluxDB / Sensor.Community fan-out
+ * - metrics.h     - Prometheus metric table, pull and push
  * - storage.h     - EEPROM and LittleFS persistence
+ * - settings_journal.h - Deferred, coalesced settings commits
+ * - settings_schema.h - Versioned EEPROM layout and migrations
+ * - integrity.h   - Table CRC32 and framed persistent records
+ * - stats_store.h - Crash-safe statistics (RTC memory + flash checkpoints)
+ * - timeseries.h  - Compressed long-term sample store
+ * - profiler.h    - Cycle-counted hot-path timing (/api/perf)
+ * - stall_monitor.h - Loop latency, stall and crash post-mortems
+ * - mem_telemetry.h - Heap fragmentation and stack high-water per loop task
  * - web_dashboard.h - HTTP server and Prometheus
  * - alarms.h      - Threshold monitoring and alerts
  */
@@ -60,7 +75,12 @@
 #include "src/klimerko/utils.h"
 #include "src/klimerko/sensors.h"
 #include "src/klimerko/network.h"
+#include "src/klimerko/payload.h"
+#include "src/klimerko/deadband.h"
+#include "src/klimerko/sinks.h"
+#include "src/klimerko/metrics.h"
 #include "src/klimerko/storage.h"
+#include "src/klimerko/timeseries.h"
 #include "src/klimerko/web_dashboard.h"
 #include "src/klimerko/alarms.h"
 
@@ -92,11 +112,26 @@ movingAvg presAvg(SENSOR_AVERAGE_SAMPLES);
 
 // Network objects
 WiFiClient networkClient;
+MqttTls mqttTls;
 PubSubClient mqtt(networkClient);
 WiFiManager wm;
 
 // Web server
 ESP8266WebServer webServer(WEB_SERVER_PORT);
+WiFiClient sseClients[SSE_MAX_CLIENTS];
+unsigned long sseLastKeepAlive = 0;
+
+// Long-term history
+TimeSeriesStore tsStore;
+
+// Additional data sinks
+SinkConfig sinkConfig;
+SinkPayloadPool sinkPool;
+MqttSink localMqttSink;
+InfluxSink influxSink;
+SensorCommunitySink communitySink;
+Sink* sinks[SINK_COUNT] = {&localMqttSink, &influxSink, &communitySink};
+PromPusher promPusher;
 
 // WiFi portal parameters
 WiFiManagerParameter portalDeviceID("device_id", "AllThingsTalk Device ID", "", 32);
@@ -130,12 +165,20 @@ uint16_t mqttPort = DEFAULT_MQTT_PORT;
 
 // State structures
 Settings klimerkoSettings;
+SettingsJournal settingsJournal(klimerkoSettings);
 Statistics stats = {0, 0, 0, 0, 0, 0};
+StatsStore statsStore(stats);
+StallMonitor stallMonitor;
+MemTelemetry memTelemetry;
+#if PROFILER_ENABLED
+Profiler profiler;
+#endif
 SensorData sensorData;
 Calibration calibration = {1.0f, 1.0f, 0.0f, 0.0f};
 AlarmState alarmState;
 WifiState wifiState;
 MqttState mqttState;
+MqttDnsCache mqttDns;
 ButtonState buttonState;
 
 // Sensor status
@@ -151,12 +194,14 @@ SensorStatus bmeStatus = SensorStatus::OK;
 // Fan stuck detection
 int prevPm1 = -1, prevPm25 = -1, prevPm10 = -1;
 int stuckCounter = 0, zeroCounter = 0;
-String sensorStatusText = "Init";
+const char* sensorStatusText = "Init";
 
 // Timing
 unsigned long bootTime = 0;
 unsigned long sensorReadTime = 0;
 unsigned long dataPublishTime = 0;
+unsigned long sinkPublishTime = 0;
+unsigned long diagPublishTime = 0;
 
 // Control flags
 bool ntpSynced = false;
@@ -164,11 +209,13 @@ bool alarmEnabled = true;
 bool alarmTriggered = false;
 bool deepSleepEnabled = false;
 bool shouldStartConfig = false;
-String pendingUpdateUrl = "";
+char pendingUpdateUrl[FIRMWARE_URL_SIZE] = "";
 
 // Data publishing
 uint8_t dataPublishInterval = 5;  // minutes
 bool dataPublishFailed = false;
+PayloadFormat payloadFormat = PayloadFormat::JSON;
+DeadbandFilter deadband;
 
 // LED state
 bool ledState = false;
@@ -209,14 +256,26 @@ const char* WIFI_CONFIG_ASSET = "wifi-config";
 const char* FIRMWARE_UPDATE_ASSET = "firmware-update";
 const char* RESTART_DEVICE_ASSET = "restart-device";
 const char* SENSOR_STATUS_ASSET = "sensor-status";
+const char* LAST_RESET_ASSET = "last-reset";
+const char* HEAP_FREE_ASSET = "heap-free";
+const char* HEAP_FREE_MIN_ASSET = "heap-free-min";
+const char* HEAP_MAX_BLOCK_ASSET = "heap-max-block";
+const char* HEAP_MAX_BLOCK_MIN_ASSET = "heap-max-block-min";
+const char* HEAP_FRAGMENTATION_ASSET = "heap-fragmentation";
+const char* HEAP_FRAGMENTATION_MAX_ASSET = "heap-fragmentation-max";
+const char* STACK_FREE_MIN_ASSET = "stack-free-min";
+const char* HEAP_TOP_TASK_ASSET = "heap-top-task";
 
 // ============================================================================
 // FORWARD DECLARATIONS
 // ============================================================================
 
 void mqttCallback(char* topic, byte* payload, unsigned int length);
+void mqttPublishAck(uint16_t msgId, bool delivered);
+bool publishStateDocument(const JsonDocument& doc, uint8_t qos = 0);
 void publishSensorData();
 void publishDiagnosticData();
+void publishPostMortem();
 void savePortalData();
 
 // ============================================================================
@@ -242,8 +301,22 @@ void changeInterval(int interval) {
 // DATA PUBLISHING
 // ============================================================================
 
+/**
+ * @brief Encode document in the configured payload format and publish to state
+ * @return true if published successfully
+ */
+bool publishStateDocument(const JsonDocument& doc, uint8_t qos) {
+  static uint8_t payloadBuffer[2048];
+  size_t length = serializePayload(doc, payloadBuffer, sizeof(payloadBuffer), payloadFormat);
+  if (length == 0) {
+    DEBUG_PRINTLN(F("[DATA] Payload too large"));
+    return false;
+  }
+  return publishToState(payloadBuffer, length, qos);
+}
+
 void publishSensorData() {
-  static char jsonBuffer[2048];
+  PERF_SCOPE(PUBLISH);
   StaticJsonDocument<2048> doc;
   
   if (pmsSensorOnline) {
@@ -285,10 +358,14 @@ void publishSensorData() {
   doc.createNestedObject(FIRMWARE_ASSET)["value"] = FIRMWARE_VERSION;
   doc.createNestedObject(WIFI_SIGNAL_ASSET)["value"] = getWifiSignal();
   
-  serializeJson(doc, jsonBuffer);
-  
-  if (publishToState(jsonBuffer)) {
-    recordSuccessfulPublish();
+  // Keep only assets that moved beyond their deadband (or are due a heartbeat)
+  uint32_t nowSec = getUptimeSeconds(bootTime);
+  if (deadband.filter(doc, nowSec) == 0) {
+    DEBUG_PRINTLN(F("[DATA] Nothing changed beyond deadband, skipped"));
+  } else if (publishStateDocument(doc, MQTT_STATE_QOS)) {
+    deadband.commit(doc, nowSec, MQTT_STATE_QOS ? mqtt.lastMsgId() : 0);
+    // QoS 1 publishes are counted once the broker acknowledges them (mqttPublishAck)
+    if (MQTT_STATE_QOS == 0) recordSuccessfulPublish();
     DEBUG_PRINTLN(F("[DATA] Published successfully"));
   } else {
     recordFailedPublish();
@@ -297,13 +374,13 @@ void publishSensorData() {
   
   // Log data locally
   logSensorDataToFS(sensorData, getUptimeSeconds(bootTime));
+  appendHistoryRecord(sensorData, getSampleTimestamp());
 }
 
 void publishDiagnosticData() {
   if (wifiState.connectionLost || mqttState.connectionLost) return;
   
-  char jsonBuffer[512];
-  StaticJsonDocument<512> doc;
+  StaticJsonDocument<1024> doc;
   
   doc.createNestedObject(INTERVAL_ASSET)["value"] = dataPublishInterval;
   doc.createNestedObject(FIRMWARE_ASSET)["value"] = FIRMWARE_VERSION;
@@ -313,16 +390,87 @@ void publishDiagnosticData() {
   doc.createNestedObject(ALTITUDE_SET_ASSET)["value"] = userAltitude;
   doc.createNestedObject(SENSOR_STATUS_ASSET)["value"] = getSensorStatusString();
   
-  serializeJson(doc, jsonBuffer);
-  publishToState(jsonBuffer);
+  // Memory telemetry (mem_telemetry.h)
+  doc.createNestedObject(HEAP_FREE_ASSET)["value"] = memTelemetry.heapFree();
+  doc.createNestedObject(HEAP_FREE_MIN_ASSET)["value"] = memTelemetry.heapFreeMin();
+  doc.createNestedObject(HEAP_MAX_BLOCK_ASSET)["value"] = memTelemetry.maxBlock();
+  doc.createNestedObject(HEAP_MAX_BLOCK_MIN_ASSET)["value"] = memTelemetry.maxBlockMin();
+  doc.createNestedObject(HEAP_FRAGMENTATION_ASSET)["value"] = memTelemetry.fragmentation();
+  doc.createNestedObject(HEAP_FRAGMENTATION_MAX_ASSET)["value"] = memTelemetry.fragmentationMax();
+  doc.createNestedObject(STACK_FREE_MIN_ASSET)["value"] = memTelemetry.stackFree();
+  doc.createNestedObject(HEAP_TOP_TASK_ASSET)["value"] = loopTaskToString((uint8_t)memTelemetry.topTask());
+  
+  publishStateDocument(doc);
+  diagPublishTime = millis();
   
   DEBUG_PRINTLN(F("[DATA] Diagnostics published"));
 }
 
+/**
+ * @brief Report why the previous boot ended, once (stall_monitor.h)
+ */
+void publishPostMortem() {
+  if (!stallMonitor.reportPending() || wifiState.connectionLost || mqttState.connectionLost) return;
+  
+  char text[128];
+  stallMonitor.describeReport(text, sizeof(text));
+  StaticJsonDocument<256> doc;
+  doc.createNestedObject(LAST_RESET_ASSET)["value"] = text;
+  
+  if (publishStateDocument(doc, 1)) {
+    stallMonitor.markReported();
+    DEBUG_PRINT(F("[STALL] Reported: ")); DEBUG_PRINTLN(text);
+  }
+}
+
+/**
+ * @brief Called by the core on an exception or software watchdog reset
+ */
+extern "C" void custom_crash_callback(struct rst_info* info, uint32_t stack, uint32_t stackEnd) {
+  (void)stack;
+  (void)stackEnd;
+  stallMonitor.crash(info);
+}
+
 // ============================================================================
 // MQTT CALLBACK
 // ============================================================================
 
+/**
+ * @brief Delivery result of a QoS 1 state publish
+ * @param msgId MQTT packet identifier
+ * @param delivered true on PUBACK, false if given up after retransmissions
+ */
+void mqttPublishAck(uint16_t msgId, bool delivered) {
+  if (delivered) {
+    recordSuccessfulPublish();
+  } else {
+    recordFailedPublish();
+    deadband.undelivered(msgId);
+    DEBUG_PRINTF("[MQTT] Publish %u undelivered after retransmissions\n", msgId);
+  }
+}
+
+/**
+ * @brief Text of a command value without a String copy
+ * @param value Parsed "value" member (string, number or bool)
+ * @param buffer Holds non-string values written back as JSON text
+ * @return The string in place, or buffer
+ */
+const char* commandValueText(JsonVariantConst value, char* buffer, size_t bufferSize) {
+  if (value.is<const char*>()) return value.as<const char*>();
+  buffer[0] = '\0';
+  if (!value.isNull()) serializeJson(value, buffer, bufferSize);
+  return buffer;
+}
+
+/**
+ * @brief "true" or "1" (as a string, number or bool)
+ */
+bool isCommandTrue(const char* value) {
+  return strcmp(value, "true") == 0 || strcmp(value, "1") == 0;
+}
+
 void mqttCallback(char* p_topic, byte* p_payload, unsigned int p_length) {
   DEBUG_PRINTLN(F("[MQTT] Message received"));
   
@@ -332,12 +480,15 @@ void mqttCallback(char* p_topic, byte* p_payload, unsigned int p_length) {
     return;
   }
   
-  char json[MQTT_CALLBACK_BUFFER_SIZE + 1];
-  memcpy(json, p_payload, p_length);
-  json[p_length] = '\0';
+  MqttAsset asset = assetFromTopic(p_topic);
+  DEBUG_PRINT(F("[MQTT] Asset: ")); DEBUG_PRINTLN(assetToString(asset));
+  if (asset == MqttAsset::UNKNOWN) {
+    return;
+  }
   
+  // Parsed in place: strings stay in the client buffer, which outlives the callback
   StaticJsonDocument<512> doc;
-  DeserializationError error = deserializeJson(doc, json);
+  DeserializationError error = deserializeJson(doc, p_payload, p_length);
   
   if (error) {
     DEBUG_PRINT(F("[MQTT] JSON parse error: "));
@@ -345,94 +496,125 @@ void mqttCallback(char* p_topic, byte* p_payload, unsigned int p_length) {
     return;
   }
   
-  String asset = extractAssetFromTopic(String(p_topic));
-  DEBUG_PRINT(F("[MQTT] Asset: ")); DEBUG_PRINTLN(asset);
+  char valueBuffer[24];
+  const char* v = commandValueText(doc["value"], valueBuffer, sizeof(valueBuffer));
   
   // Handle different assets
-  if (asset == INTERVAL_ASSET) {
-    changeInterval(doc["value"]);
-  }
-  else if (asset == WIFI_CONFIG_ASSET) {
-    String v = doc["value"].as<String>();
-    if (v == "true" || v == "1") {
-      shouldStartConfig = true;
-    }
-  }
-  else if (asset == TEMP_OFFSET_ASSET) {
-    String v = doc["value"].as<String>();
-    if (isValidNumber(v.c_str())) {
-      bmeTemperatureOffset = v.toFloat();
-      calibration.tempOffset = bmeTemperatureOffset;
-      snprintf(bmeTemperatureOffsetChar, sizeof(bmeTemperatureOffsetChar), "%.2f", bmeTemperatureOffset);
-      updateSetting("tempOffset", bmeTemperatureOffsetChar);
-      tempAvg.reset();
-      humAvg.reset();
-      publishDiagnosticData();
-    }
-  }
-  else if (asset == ALTITUDE_SET_ASSET) {
-    String v = doc["value"].as<String>();
-    if (isValidNumber(v.c_str())) {
-      userAltitude = v.toInt();
-      sensorData.userAltitude = userAltitude;
-      snprintf(altitudeChar, sizeof(altitudeChar), "%d", userAltitude);
-      updateSetting("altitude", altitudeChar);
-      publishDiagnosticData();
-    }
-  }
-  else if (asset == FIRMWARE_UPDATE_ASSET) {
-    String url = doc["value"].as<String>();
-    if (url.length() > 10) {
-      pendingUpdateUrl = url;
-    }
-  }
-  else if (asset == RESTART_DEVICE_ASSET) {
-    String v = doc["value"].as<String>();
-    if (v == "true" || v == "1") {
-      DEBUG_PRINTLN(F("[SYSTEM] Remote restart requested..."));
-      saveStatistics(getUptimeSeconds(bootTime));
-      delay(1000);
-      ESP.restart();
-    }
-  }
-  else if (asset == "deep-sleep") {
-    String v = doc["value"].as<String>();
-    deepSleepEnabled = (v == "true" || v == "1");
-    updateBoolSetting("deepSleep", deepSleepEnabled);
-    DEBUG_PRINT(F("[SLEEP] Deep sleep ")); 
-    DEBUG_PRINTLN(deepSleepEnabled ? F("enabled") : F("disabled"));
-  }
-  else if (asset == "alarm-enable") {
-    String v = doc["value"].as<String>();
-    alarmEnabled = (v == "true" || v == "1");
-    updateBoolSetting("alarmEnabled", alarmEnabled);
-    setAlarmEnabled(alarmEnabled);
-  }
-  else if (asset == "calibration") {
-    if (doc.containsKey("pm25")) {
-      calibration.pm25Factor = doc["pm25"].as<float>();
-    }
-    if (doc.containsKey("pm10")) {
-      calibration.pm10Factor = doc["pm10"].as<float>();
-    }
-    if (doc.containsKey("temp")) {
-      calibration.tempOffset = doc["temp"].as<float>();
-    }
-    if (doc.containsKey("hum")) {
-      calibration.humOffset = doc["hum"].as<float>();
-    }
-    updateCalibration(calibration);
-    DEBUG_PRINTLN(F("[CAL] Calibration updated"));
-  }
-  else if (asset == "mqtt-broker") {
-    if (doc.containsKey("server")) {
-      String server = doc["server"].as<String>();
-      server.toCharArray(mqttServer, sizeof(mqttServer));
-    }
-    if (doc.containsKey("port")) {
-      mqttPort = doc["port"].as<uint16_t>();
-    }
-    updateMqttBroker(mqttServer, mqttPort);
+  switch (asset) {
+    case MqttAsset::INTERVAL:
+      changeInterval(doc["value"]);
+      break;
+      
+    case MqttAsset::WIFI_CONFIG:
+      if (isCommandTrue(v)) {
+        shouldStartConfig = true;
+      }
+      break;
+    
+    case MqttAsset::TEMP_OFFSET:
+      if (isValidNumber(v)) {
+        bmeTemperatureOffset = atof(v);
+        calibration.tempOffset = bmeTemperatureOffset;
+        snprintf(bmeTemperatureOffsetChar, sizeof(bmeTemperatureOffsetChar), "%.2f", bmeTemperatureOffset);
+        updateTempOffsetSetting(bmeTemperatureOffset);
+        tempAvg.reset();
+        humAvg.reset();
+        publishDiagnosticData();
+      }
+      break;
+    
+    case MqttAsset::ALTITUDE_SET:
+      if (isValidNumber(v)) {
+        userAltitude = constrain(atoi(v), MIN_ALTITUDE, MAX_ALTITUDE);
+        sensorData.userAltitude = userAltitude;
+        snprintf(altitudeChar, sizeof(altitudeChar), "%d", userAltitude);
+        updateAltitudeSetting(userAltitude);
+        publishDiagnosticData();
+      }
+      break;
+    
+    case MqttAsset::FIRMWARE_UPDATE:
+      if (strlen(v) > 10 && strlen(v) < sizeof(pendingUpdateUrl)) {
+        strcpy(pendingUpdateUrl, v);
+      }
+      break;
+    
+    case MqttAsset::RESTART_DEVICE:
+      if (isCommandTrue(v)) {
+        DEBUG_PRINTLN(F("[SYSTEM] Remote restart requested..."));
+        saveStatistics();
+        delay(1000);
+        ESP.restart();
+      }
+      break;
+    
+    case MqttAsset::DEEP_SLEEP:
+      deepSleepEnabled = isCommandTrue(v);
+      updateBoolSetting("deepSleep", deepSleepEnabled);
+      DEBUG_PRINT(F("[SLEEP] Deep sleep ")); 
+      DEBUG_PRINTLN(deepSleepEnabled ? F("enabled") : F("disabled"));
+      break;
+    
+    case MqttAsset::ALARM_ENABLE:
+      alarmEnabled = isCommandTrue(v);
+      updateBoolSetting("alarmEnabled", alarmEnabled);
+      setAlarmEnabled(alarmEnabled);
+      break;
+    
+    case MqttAsset::CALIBRATION:
+      if (doc.containsKey("pm25")) {
+        calibration.pm25Factor = doc["pm25"].as<float>();
+      }
+      if (doc.containsKey("pm10")) {
+        calibration.pm10Factor = doc["pm10"].as<float>();
+      }
+      if (doc.containsKey("temp")) {
+        calibration.tempOffset = doc["temp"].as<float>();
+      }
+      if (doc.containsKey("hum")) {
+        calibration.humOffset = doc["hum"].as<float>();
+      }
+      updateCalibration(calibration);
+      DEBUG_PRINTLN(F("[CAL] Calibration updated"));
+      break;
+      
+    case MqttAsset::MQTT_BROKER:
+      if (doc.containsKey("server")) {
+        strncpy(mqttServer, doc["server"] | "", sizeof(mqttServer) - 1);
+        mqttServer[sizeof(mqttServer) - 1] = '\0';
+      }
+      if (doc.containsKey("port")) {
+        mqttPort = doc["port"].as<uint16_t>();
+      } else if (doc["tls"].is<bool>()) {
+        mqttPort = doc["tls"].as<bool>() ? MQTT_TLS_PORT : MQTT_DEFAULT_PORT;
+      }
+      if (mqttTls.configure(doc.as<JsonObjectConst>())) {
+        mqttTls.save();
+      }
+      updateBrokerSetting(mqttServer, mqttPort);
+      updateMqttBroker(mqttServer, mqttPort);
+      break;
+      
+    case MqttAsset::DEADBAND:
+      deadband.configure(doc.as<JsonObjectConst>());
+      break;
+      
+    case MqttAsset::SINKS:
+      if (applySinkConfig(doc.as<JsonObjectConst>())) {
+        localMqttSink.reset();
+      }
+      saveSinkConfig();
+      DEBUG_PRINTLN(F("[SINK] Configuration updated"));
+      break;
+      
+    case MqttAsset::PAYLOAD_FORMAT:
+      payloadFormat = stringToPayloadFormat(v);
+      updatePayloadFormat(payloadFormat);
+      break;
+      
+    default:
+      // Telemetry assets are published, not commanded
+      break;
   }
 }
 
@@ -507,7 +689,8 @@ void ledLoop() {
 void enterDeepSleep() {
   DEBUG_PRINTLN(F("[SLEEP] Entering deep sleep..."));
   
-  saveStatistics(getUptimeSeconds(bootTime));
+  settingsJournal.commit();
+  statsStore.suspend();  // RTC memory survives deep sleep; flash only when a checkpoint is due
   
   if (pmsSensorOnline) {
     pms.sleep();
@@ -536,11 +719,12 @@ void savePortalData() {
   strncpy(bmeTemperatureOffsetChar, portalTemperatureOffset.getValue(), sizeof(bmeTemperatureOffsetChar) - 1);
   bmeTemperatureOffset = atof(bmeTemperatureOffsetChar);
   strncpy(altitudeChar, portalAltitude.getValue(), sizeof(altitudeChar) - 1);
-  userAltitude = atoi(altitudeChar);
+  userAltitude = constrain(atoi(altitudeChar), MIN_ALTITUDE, MAX_ALTITUDE);
+  snprintf(altitudeChar, sizeof(altitudeChar), "%d", userAltitude);
   sensorData.userAltitude = userAltitude;
   calibration.tempOffset = bmeTemperatureOffset;
   
-  saveSettings(deviceId, deviceToken, bmeTemperatureOffsetChar, altitudeChar,
+  saveSettings(deviceId, deviceToken, bmeTemperatureOffset, userAltitude,
                deepSleepEnabled, alarmEnabled, mqttServer, mqttPort, calibration);
 }
 
@@ -563,7 +747,7 @@ void setupWiFiManager() {
   wm.addParameter(&portalDisplayCredits);
   
   wm.setSaveParamsCallback(savePortalData);
-  wm.setSaveConfigCallback([]() { connectMQTT(); });
+  wm.setSaveConfigCallback([]() { requestMqttReconnect(); });
   wm.setWebServerCallback(wifiConfigWebServerStarted);
   wm.setAPCallback(wifiConfigStarted);
   
@@ -587,8 +771,15 @@ void setupWiFiManager() {
 // ============================================================================
 
 void mainSensorLoop() {
+  unsigned long lastReadTime = sensorReadTime;
   sensorLoop(sensorReadTime, dataPublishInterval);
   
+  // Each new sample goes to live dashboards and the long-term store once
+  if (sensorReadTime != lastReadTime) {
+    ssePublishSample();
+    tsStore.append(makeHistoryRecord(sensorData, getSampleTimestamp()));
+  }
+  
   // Check alarms after sensor read
   checkAlarms([](const char* payload) {
     publishToState(payload);
@@ -596,6 +787,21 @@ void mainSensorLoop() {
   
   // Publish data on interval
   unsigned long now = millis();
+  
+  // Other sinks queue on their own timer; they retry independently of ATT
+  if (sensorReadTime != 0 &&
+      now - sinkPublishTime >= (unsigned long)dataPublishInterval * 60000UL) {
+    sinkPublishTime = now;
+    SinkSample sample = {&sensorData, ntpSynced ? getSampleTimestamp() : 0,
+                         pmsSensorOnline, bmeSensorOnline};
+    sinkPublishSample(sample);
+  }
+  
+  // Diagnostics otherwise only go out on a change; memory drifts on its own
+  if (now - diagPublishTime >= DIAG_PUBLISH_INTERVAL_SEC * 1000UL) {
+    publishDiagnosticData();
+  }
+  
   if (now - dataPublishTime >= (unsigned long)dataPublishInterval * 60000UL) {
     if (!wifiState.connectionLost && !mqttState.connectionLost) {
       dataPublishFailed = false;
@@ -637,6 +843,8 @@ void setup() {
   DEBUG_PRINTLN(F("╚══════════════════════════════════════════════════════════════╝"));
   
   ESP.wdtEnable(5000);
+  stallMonitor.begin();  // Before anything can stall: keeps the last boot's post-mortem
+  memTelemetry.begin();
   
   // Initialize hardware
   initPins();
@@ -647,12 +855,18 @@ void setup() {
   
   // Initialize storage
   initLittleFS();
-  loadStatistics();
+  tsStore.begin();
+  deadband.begin();
+  loadSinkConfig();
+  mqttTls.begin();
   
   // Restore settings
-  restoreSettings(deviceId, deviceToken, bmeTemperatureOffsetChar, bmeTemperatureOffset,
-                  altitudeChar, userAltitude, deepSleepEnabled, alarmEnabled,
-                  mqttServer, mqttPort, calibration);
+  if (restoreSettings(deviceId, deviceToken, bmeTemperatureOffsetChar, bmeTemperatureOffset,
+                      altitudeChar, userAltitude, deepSleepEnabled, alarmEnabled,
+                      mqttServer, mqttPort, calibration)) {
+    payloadFormat = getStoredPayloadFormat();
+  }
+  loadStatistics();  // After restore: migrating from 7.0 moves the statistics first
   
   sensorData.userAltitude = userAltitude;
   
@@ -678,7 +892,7 @@ void setup() {
     initMDNS();
     initWebServer();
     initOTA();
-    initMQTT(mqttCallback);
+    initMQTT(mqttCallback, mqttPublishAck);
   }
   
   // Initialize alarms
@@ -694,25 +908,42 @@ void setup() {
 // MAIN LOOP
 // ============================================================================
 
+/**
+ * @brief Attribute what follows to a loop task (stall and memory telemetry)
+ */
+inline void enterLoopTask(LoopTask task) {
+  stallMonitor.enter(task);
+  memTelemetry.enter(task);
+}
+
 void loop() {
   ESP.wdtFeed();
+  stallMonitor.loopStart();
+  memTelemetry.loopStart();
   
   // Network services
+  enterLoopTask(LoopTask::OTA);
   handleOTA();
+  enterLoopTask(LoopTask::MDNS);
   updateMDNS();
+  enterLoopTask(LoopTask::WEB);
   handleWebServer();
   
   // Configuration portal request
+  enterLoopTask(LoopTask::CONFIG_PORTAL);
   if (shouldStartConfig) {
     shouldStartConfig = false;
     wifiConfigStart();
   }
   
   // Pending firmware update
-  if (pendingUpdateUrl != "") {
-    String url = pendingUpdateUrl;
-    pendingUpdateUrl = "";
+  if (pendingUpdateUrl[0] != '\0') {
+    enterLoopTask(LoopTask::FW_UPDATE);
+    char url[FIRMWARE_URL_SIZE];
+    strcpy(url, pendingUpdateUrl);
+    pendingUpdateUrl[0] = '\0';
     if (pmsSensorOnline) pms.sleep();
+    settingsJournal.commit();  // Device reboots straight into the new firmware
     performHttpUpdate(url);
   }
   
@@ -720,13 +951,18 @@ void loop() {
   if (deepSleepEnabled && !isConfigPortalActive()) {
     static bool deepSleepMeasurementDone = false;
     if (!deepSleepMeasurementDone) {
+      enterLoopTask(LoopTask::DEEP_SLEEP);
       setPMSPower(true);
       delay(30000);  // Wait for PMS to stabilize
       readPMSSensor();
       readBMESensor();
       if (!wifiState.connectionLost && !mqttState.connectionLost) {
         publishSensorData();
-        delay(1000);
+        // Sleep loses the in-flight window: what is not acknowledged now never will be
+        for (uint8_t i = drainMqttInflight(MQTT_DRAIN_TIMEOUT_MS); i > 0; i--) {
+          recordFailedPublish();
+        }
+        if (MQTT_STATE_QOS == 0) delay(1000);  // Nothing to wait for; let TCP send it
       }
       deepSleepMeasurementDone = true;
       enterDeepSleep();
@@ -734,10 +970,27 @@ void loop() {
   }
   
   // Normal operation
+  enterLoopTask(LoopTask::SENSORS);
   mainSensorLoop();
+  enterLoopTask(LoopTask::WIFI);
   maintainWiFi();
+  enterLoopTask(LoopTask::MQTT);
   maintainMQTT();
+  publishPostMortem();
+  enterLoopTask(LoopTask::SINKS);
+  sinkLoop();
+  enterLoopTask(LoopTask::PROM_PUSH);
+  promPusher.loop();
+  enterLoopTask(LoopTask::SETTINGS);
+  settingsJournal.loop();
+  enterLoopTask(LoopTask::STATS);
+  statsStore.loop();
+  enterLoopTask(LoopTask::CONFIG_PORTAL);
   wifiConfigLoop();
+  enterLoopTask(LoopTask::UI);
   buttonLoop();
   ledLoop();
+  
+  stallMonitor.loopEnd();
+  memTelemetry.loopEnd();
 }
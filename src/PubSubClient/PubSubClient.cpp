@@ -160,6 +160,9 @@ PubSubClient::PubSubClient(const char* domain, uint16_t port, MQTT_CALLBACK_SIGN
 
 PubSubClient::~PubSubClient() {
   free(this->buffer);
+  for (uint8_t i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+    free(this->inflight[i].packet);
+  }
 }
 
 boolean PubSubClient::connect(const char *id) {
@@ -180,185 +183,222 @@ boolean PubSubClient::connect(const char *id, const char *user, const char *pass
 
 boolean PubSubClient::connect(const char *id, const char *user, const char *pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage, boolean cleanSession) {
     if (!connected()) {
-        int result = 0;
+        if (!beginConnect(id,user,pass,willTopic,willQos,willRetain,willMessage,cleanSession)) {
+            return false;
+        }
+        while (_state == MQTT_CONNECTING) {
+            yield();
+            pollConnack();
+        }
+        return _state == MQTT_CONNECTED;
+    }
+    return true;
+}
 
+boolean PubSubClient::beginConnect(const char *id, const char *user, const char *pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage, boolean cleanSession) {
+    int result = 0;
 
-        if(_client->connected()) {
-            result = 1;
+    if(_client->connected()) {
+        result = 1;
+    } else {
+        if (domain != NULL) {
+            result = _client->connect(this->domain, this->port);
         } else {
-            if (domain != NULL) {
-                result = _client->connect(this->domain, this->port);
-            } else {
-                result = _client->connect(this->ip, this->port);
-            }
+            result = _client->connect(this->ip, this->port);
         }
+    }
 
-        if (result == 1) {
-            nextMsgId = 1;
-            // Leave room in the buffer for header and variable length field
-            uint16_t length = MQTT_MAX_HEADER_SIZE;
-            unsigned int j;
+    if (result == 1) {
+        nextMsgId = 1;
+        // Leave room in the buffer for header and variable length field
+        uint16_t length = MQTT_MAX_HEADER_SIZE;
+        unsigned int j;
 
 #if MQTT_VERSION == MQTT_VERSION_3_1
-            uint8_t d[9] = {0x00,0x06,'M','Q','I','s','d','p', MQTT_VERSION};
+        uint8_t d[9] = {0x00,0x06,'M','Q','I','s','d','p', MQTT_VERSION};
 #define MQTT_HEADER_VERSION_LENGTH 9
 #elif MQTT_VERSION == MQTT_VERSION_3_1_1
-            uint8_t d[7] = {0x00,0x04,'M','Q','T','T',MQTT_VERSION};
+        uint8_t d[7] = {0x00,0x04,'M','Q','T','T',MQTT_VERSION};
 #define MQTT_HEADER_VERSION_LENGTH 7
 #endif
-            for (j = 0;j<MQTT_HEADER_VERSION_LENGTH;j++) {
-                this->buffer[length++] = d[j];
-            }
+        for (j = 0;j<MQTT_HEADER_VERSION_LENGTH;j++) {
+            this->buffer[length++] = d[j];
+        }
 
-            uint8_t v;
-            if (willTopic) {
-                v = 0x04|(willQos<<3)|(willRetain<<5);
-            } else {
-                v = 0x00;
-            }
-            if (cleanSession) {
-                v = v|0x02;
-            }
+        uint8_t v;
+        if (willTopic) {
+            v = 0x04|(willQos<<3)|(willRetain<<5);
+        } else {
+            v = 0x00;
+        }
+        if (cleanSession) {
+            v = v|0x02;
+        }
 
-            if(user != NULL) {
-                v = v|0x80;
+        if(user != NULL) {
+            v = v|0x80;
 
-                if(pass != NULL) {
-                    v = v|(0x80>>1);
-                }
-            }
-            this->buffer[length++] = v;
-
-            this->buffer[length++] = ((this->keepAlive) >> 8);
-            this->buffer[length++] = ((this->keepAlive) & 0xFF);
-
-            CHECK_STRING_LENGTH(length,id)
-            length = writeString(id,this->buffer,length);
-            if (willTopic) {
-                CHECK_STRING_LENGTH(length,willTopic)
-                length = writeString(willTopic,this->buffer,length);
-                CHECK_STRING_LENGTH(length,willMessage)
-                length = writeString(willMessage,this->buffer,length);
+            if(pass != NULL) {
+                v = v|(0x80>>1);
             }
+        }
+        this->buffer[length++] = v;
+
+        this->buffer[length++] = ((this->keepAlive) >> 8);
+        this->buffer[length++] = ((this->keepAlive) & 0xFF);
+
+        CHECK_STRING_LENGTH(length,id)
+        length = writeString(id,this->buffer,length);
+        if (willTopic) {
+            CHECK_STRING_LENGTH(length,willTopic)
+            length = writeString(willTopic,this->buffer,length);
+            CHECK_STRING_LENGTH(length,willMessage)
+            length = writeString(willMessage,this->buffer,length);
+        }
 
-            if(user != NULL) {
-                CHECK_STRING_LENGTH(length,user)
-                length = writeString(user,this->buffer,length);
-                if(pass != NULL) {
-                    CHECK_STRING_LENGTH(length,pass)
-                    length = writeString(pass,this->buffer,length);
-                }
+        if(user != NULL) {
+            CHECK_STRING_LENGTH(length,user)
+            length = writeString(user,this->buffer,length);
+            if(pass != NULL) {
+                CHECK_STRING_LENGTH(length,pass)
+                length = writeString(pass,this->buffer,length);
             }
+        }
 
-            write(MQTTCONNECT,this->buffer,length-MQTT_MAX_HEADER_SIZE);
-
-            lastInActivity = lastOutActivity = millis();
+        write(MQTTCONNECT,this->buffer,length-MQTT_MAX_HEADER_SIZE);
 
-            while (!_client->available()) {
-                unsigned long t = millis();
-                if (t-lastInActivity >= ((int32_t) this->socketTimeout*1000UL)) {
-                    _state = MQTT_CONNECTION_TIMEOUT;
-                    _client->stop();
-                    return false;
-                }
-            }
-            uint8_t llen;
-            uint32_t len = readPacket(&llen);
+        lastInActivity = lastOutActivity = millis();
+        _state = MQTT_CONNECTING;
+        return true;
+    }
+    _state = MQTT_CONNECT_FAILED;
+    return false;
+}
 
-            if (len == 4) {
-                if (buffer[3] == 0) {
-                    lastInActivity = millis();
-                    pingOutstanding = false;
-                    _state = MQTT_CONNECTED;
-                    return true;
-                } else {
-                    _state = buffer[3];
-                }
-            }
+// checks once for the CONNACK of a CONNECT sent by beginConnect()
+void PubSubClient::pollConnack() {
+    if (!_client->available()) {
+        unsigned long t = millis();
+        if (t-lastInActivity >= ((int32_t) this->socketTimeout*1000UL)) {
+            _state = MQTT_CONNECTION_TIMEOUT;
             _client->stop();
+        } else if (!_client->connected()) {
+            _state = MQTT_CONNECTION_LOST;
+            _client->stop();
+        }
+        return;
+    }
+    uint8_t llen;
+    uint32_t len = readPacket(&llen);
+
+    if (len == 4) {
+        if (buffer[3] == 0) {
+            lastInActivity = millis();
+            pingOutstanding = false;
+            _state = MQTT_CONNECTED;
+            resendInflight();
+            return;
         } else {
-            _state = MQTT_CONNECT_FAILED;
+            _state = buffer[3];
         }
-        return false;
+    } else {
+        _state = MQTT_CONNECT_FAILED;
     }
-    return true;
+    _client->stop();
 }
 
-// reads a byte into result
-boolean PubSubClient::readByte(uint8_t * result) {
+// reads length bytes into result, pulling whatever the client has available in
+// one call instead of polling byte by byte. Times out if no data arrives for
+// socketTimeout seconds.
+boolean PubSubClient::readBytes(uint8_t * result, uint16_t length) {
+   uint16_t received = 0;
    uint32_t previousMillis = millis();
-   while(!_client->available()) {
+   while (received < length) {
+     int available = _client->available();
+     if (available > 0) {
+       uint16_t wanted = length - received;
+       if ((uint16_t)available < wanted) {
+         wanted = available;
+       }
+       int n = _client->read(result + received, wanted);
+       if (n > 0) {
+         received += n;
+         previousMillis = millis();
+         continue;
+       }
+     }
      yield();
      uint32_t currentMillis = millis();
      if(currentMillis - previousMillis >= ((int32_t) this->socketTimeout * 1000)){
        return false;
      }
    }
-   *result = _client->read();
    return true;
 }
 
-// reads a byte into result[*index] and increments index
-boolean PubSubClient::readByte(uint8_t * result, uint16_t * index){
-  uint16_t current_index = *index;
-  uint8_t * write_address = &(result[current_index]);
-  if(readByte(write_address)){
-    *index = current_index + 1;
-    return true;
-  }
-  return false;
-}
-
 uint32_t PubSubClient::readPacket(uint8_t* lengthLength) {
-    uint16_t len = 0;
-    if(!readByte(this->buffer, &len)) return 0;
-    bool isPublish = (this->buffer[0]&0xF0) == MQTTPUBLISH;
-    uint32_t multiplier = 1;
-    uint32_t length = 0;
-    uint8_t digit = 0;
-    uint16_t skip = 0;
-    uint32_t start = 0;
-
-    do {
+    // Fixed header and the first remaining length byte
+    if(!readBytes(this->buffer, 2)) return 0;
+    uint16_t len = 2;
+    while ((this->buffer[len-1] & 128) != 0) {
         if (len == 5) {
             // Invalid remaining length encoding - kill the connection
             _state = MQTT_DISCONNECTED;
             _client->stop();
             return 0;
         }
-        if(!readByte(&digit)) return 0;
-        this->buffer[len++] = digit;
-        length += (digit & 127) * multiplier;
-        multiplier <<=7; //multiplier *= 128
-    } while ((digit & 128) != 0);
+        if(!readBytes(this->buffer+len, 1)) return 0;
+        len++;
+    }
     *lengthLength = len-1;
 
+    uint32_t multiplier = 1;
+    uint32_t length = 0;
+    for (uint16_t i = 1; i < len; i++) {
+        length += (this->buffer[i] & 127) * multiplier;
+        multiplier <<=7; //multiplier *= 128
+    }
+
+    bool isPublish = (this->buffer[0]&0xF0) == MQTTPUBLISH;
+    uint32_t idx = len;
+    uint32_t end = len + length;
+    uint32_t payloadStart = end;
+
     if (isPublish) {
-        // Read in topic length to calculate bytes to skip over for Stream writing
-        if(!readByte(this->buffer, &len)) return 0;
-        if(!readByte(this->buffer, &len)) return 0;
-        skip = (this->buffer[*lengthLength+1]<<8)+this->buffer[*lengthLength+2];
-        start = 2;
+        // Read in topic length to find where the payload starts for Stream writing
+        if(!readBytes(this->buffer+len, 2)) return 0;
+        uint32_t skip = (this->buffer[len]<<8)+this->buffer[len+1];
         if (this->buffer[0]&MQTTQOS1) {
             // skip message id
             skip += 2;
         }
+        len += 2;
+        idx += 2;
+        payloadStart = idx + skip;
     }
-    uint32_t idx = len;
-
-    for (uint32_t i = start;i<length;i++) {
-        if(!readByte(&digit)) return 0;
-        if (this->stream) {
-            if (isPublish && idx-*lengthLength-2>skip) {
-                this->stream->write(digit);
-            }
-        }
 
+    // Remainder in bulk: into the packet buffer while it fits, then through a
+    // small scratch buffer (still passed to the Stream, otherwise discarded)
+    uint8_t scratch[32];
+    while (idx < end) {
+        uint8_t* dst;
+        uint32_t n = end - idx;
         if (len < this->bufferSize) {
-            this->buffer[len] = digit;
-            len++;
+            dst = this->buffer + len;
+            if (n > (uint32_t)(this->bufferSize - len)) n = this->bufferSize - len;
+        } else {
+            dst = scratch;
+            if (n > sizeof(scratch)) n = sizeof(scratch);
+        }
+        if(!readBytes(dst, n)) return 0;
+        if (this->stream && idx + n > payloadStart) {
+            uint32_t from = idx < payloadStart ? payloadStart - idx : 0;
+            this->stream->write(dst + from, n - from);
+        }
+        if (dst != scratch) {
+            len += n;
         }
-        idx++;
+        idx += n;
     }
 
     if (!this->stream && idx > this->bufferSize) {
@@ -368,8 +408,21 @@ uint32_t PubSubClient::readPacket(uint8_t* lengthLength) {
 }
 
 boolean PubSubClient::loop() {
+    if (_state == MQTT_CONNECTING) {
+        pollConnack();
+        return _state == MQTT_CONNECTED;
+    }
     if (connected()) {
         unsigned long t = millis();
+        for (uint8_t i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+            if (this->inflight[i].msgId != 0 && t - this->inflight[i].sentAt > this->keepAlive*1000UL) {
+                // No PUBACK within a keepalive period - treat the link as dead,
+                // the message is retransmitted once we reconnect
+                this->_state = MQTT_CONNECTION_TIMEOUT;
+                _client->stop();
+                return false;
+            }
+        }
         if ((t - lastInActivity > this->keepAlive*1000UL) || (t - lastOutActivity > this->keepAlive*1000UL)) {
             if (pingOutstanding) {
                 this->_state = MQTT_CONNECTION_TIMEOUT;
@@ -416,6 +469,16 @@ boolean PubSubClient::loop() {
                             callback(topic,payload,len-llen-3-tl);
                         }
                     }
+                } else if (type == MQTTPUBACK) {
+                    if (len >= llen+3) {
+                        msgId = (this->buffer[llen+1]<<8)+this->buffer[llen+2];
+                        for (uint8_t i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+                            if (this->inflight[i].msgId == msgId) {
+                                releaseInflight(this->inflight[i], true);
+                                break;
+                            }
+                        }
+                    }
                 } else if (type == MQTTPINGREQ) {
                     this->buffer[0] = MQTTPINGRESP;
                     this->buffer[1] = 0;
@@ -471,6 +534,122 @@ boolean PubSubClient::publish(const char* topic, const uint8_t* payload, unsigne
     return false;
 }
 
+boolean PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int plength, boolean retained, uint8_t qos) {
+    if (qos == 0) {
+        return publish(topic, payload, plength, retained);
+    }
+    if (qos > 1 || !connected()) {
+        return false;
+    }
+    if (this->bufferSize < MQTT_MAX_HEADER_SIZE + 2+strnlen(topic, this->bufferSize) + 2 + plength) {
+        // Too long
+        return false;
+    }
+    Inflight* slot = NULL;
+    for (uint8_t i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+        if (this->inflight[i].msgId == 0) {
+            slot = &this->inflight[i];
+            break;
+        }
+    }
+    if (slot == NULL) {
+        // Window full
+        return false;
+    }
+
+    uint16_t length = MQTT_MAX_HEADER_SIZE;
+    length = writeString(topic,this->buffer,length);
+    uint16_t msgId = allocMsgId();
+    this->buffer[length++] = (msgId >> 8);
+    this->buffer[length++] = (msgId & 0xFF);
+    memcpy(this->buffer+length, payload, plength);
+    length += plength;
+
+    uint8_t header = MQTTPUBLISH | MQTTQOS1;
+    if (retained) {
+        header |= 1;
+    }
+    // Keep a copy of the complete packet for retransmission after a reconnect
+    uint8_t hlen = buildHeader(header, this->buffer, length-MQTT_MAX_HEADER_SIZE);
+    uint16_t packetLength = hlen+length-MQTT_MAX_HEADER_SIZE;
+    if (slot->capacity < packetLength) {
+        uint8_t* packet = (uint8_t*)realloc(slot->packet, packetLength);
+        if (packet == NULL) {
+            return false;
+        }
+        slot->packet = packet;
+        slot->capacity = packetLength;
+    }
+    memcpy(slot->packet, this->buffer+(MQTT_MAX_HEADER_SIZE-hlen), packetLength);
+    slot->msgId = msgId;
+    slot->resends = 0;
+    slot->length = packetLength;
+    slot->sentAt = millis();
+
+    // A failed write is not an error here: the connection is gone and the
+    // message goes out again on reconnect
+    write(header,this->buffer,length-MQTT_MAX_HEADER_SIZE);
+    return true;
+}
+
+uint16_t PubSubClient::allocMsgId() {
+    boolean inUse;
+    do {
+        nextMsgId++;
+        if (nextMsgId == 0) {
+            nextMsgId = 1;
+        }
+        inUse = false;
+        for (uint8_t i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+            if (this->inflight[i].msgId == nextMsgId) {
+                inUse = true;
+            }
+        }
+    } while (inUse);
+    return nextMsgId;
+}
+
+void PubSubClient::releaseInflight(Inflight& slot, boolean delivered) {
+    uint16_t msgId = slot.msgId;
+    slot.msgId = 0;  // The packet buffer stays with the slot for the next publish
+    if (pubackCallback) {
+        pubackCallback(msgId, delivered);
+    }
+}
+
+void PubSubClient::resendInflight() {
+    unsigned long t = millis();
+    for (uint8_t i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+        Inflight& slot = this->inflight[i];
+        if (slot.msgId == 0) {
+            continue;
+        }
+        if (slot.resends >= MQTT_MAX_RESEND) {
+            releaseInflight(slot, false);
+            continue;
+        }
+        slot.resends++;
+        slot.sentAt = t;
+        slot.packet[0] |= 0x08; // DUP flag
+        _client->write(slot.packet, slot.length);
+        lastOutActivity = t;
+    }
+}
+
+uint16_t PubSubClient::lastMsgId() {
+    return this->nextMsgId;
+}
+
+uint8_t PubSubClient::inflightCount() {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+        if (this->inflight[i].msgId != 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
 boolean PubSubClient::publish_P(const char* topic, const char* payload, boolean retained) {
     return publish_P(topic, (const uint8_t*)payload, payload ? strnlen(payload, this->bufferSize) : 0, retained);
 }
@@ -484,7 +663,7 @@ boolean PubSubClient::publish_P(const char* topic, const uint8_t* payload, unsig
     unsigned int i;
     uint8_t header;
     unsigned int len;
-    int expectedLength;
+    unsigned int expectedLength;
 
     if (!connected()) {
         return false;
@@ -621,12 +800,9 @@ boolean PubSubClient::subscribe(const char* topic, uint8_t qos) {
     if (connected()) {
         // Leave room in the buffer for header and variable length field
         uint16_t length = MQTT_MAX_HEADER_SIZE;
-        nextMsgId++;
-        if (nextMsgId == 0) {
-            nextMsgId = 1;
-        }
-        this->buffer[length++] = (nextMsgId >> 8);
-        this->buffer[length++] = (nextMsgId & 0xFF);
+        uint16_t msgId = allocMsgId();
+        this->buffer[length++] = (msgId >> 8);
+        this->buffer[length++] = (msgId & 0xFF);
         length = writeString((char*)topic, this->buffer,length);
         this->buffer[length++] = qos;
         return write(MQTTSUBSCRIBE|MQTTQOS1,this->buffer,length-MQTT_MAX_HEADER_SIZE);
@@ -645,12 +821,9 @@ boolean PubSubClient::unsubscribe(const char* topic) {
     }
     if (connected()) {
         uint16_t length = MQTT_MAX_HEADER_SIZE;
-        nextMsgId++;
-        if (nextMsgId == 0) {
-            nextMsgId = 1;
-        }
-        this->buffer[length++] = (nextMsgId >> 8);
-        this->buffer[length++] = (nextMsgId & 0xFF);
+        uint16_t msgId = allocMsgId();
+        this->buffer[length++] = (msgId >> 8);
+        this->buffer[length++] = (msgId & 0xFF);
         length = writeString(topic, this->buffer,length);
         return write(MQTTUNSUBSCRIBE|MQTTQOS1,this->buffer,length-MQTT_MAX_HEADER_SIZE);
     }
@@ -723,6 +896,11 @@ PubSubClient& PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE) {
     return *this;
 }
 
+PubSubClient& PubSubClient::setPublishCallback(MQTT_PUBACK_SIGNATURE) {
+    this->pubackCallback = pubackCallback;
+    return *this;
+}
+
 PubSubClient& PubSubClient::setClient(Client& client){
     this->_client = &client;
     return *this;
@@ -36,12 +36,25 @@
 #define MQTT_SOCKET_TIMEOUT 15
 #endif
 
+// MQTT_MAX_INFLIGHT : Maximum number of QoS 1 publishes awaiting PUBACK. publish()
+//  with qos 1 returns false while the window is full.
+#ifndef MQTT_MAX_INFLIGHT
+#define MQTT_MAX_INFLIGHT 4
+#endif
+
+// MQTT_MAX_RESEND : Number of reconnects an unacknowledged QoS 1 publish is
+//  retransmitted on before it is reported as undelivered.
+#ifndef MQTT_MAX_RESEND
+#define MQTT_MAX_RESEND 3
+#endif
+
 // MQTT_MAX_TRANSFER_SIZE : limit how much data is passed to the network client
 //  in each write call. Needed for the Arduino Wifi Shield. Leave undefined to
 //  pass the entire MQTT packet in each write call.
 //#define MQTT_MAX_TRANSFER_SIZE 80
 
 // Possible values for client.state()
+#define MQTT_CONNECTING             -5  // CONNECT sent by beginConnect(), awaiting CONNACK
 #define MQTT_CONNECTION_TIMEOUT     -4
 #define MQTT_CONNECTION_LOST        -3
 #define MQTT_CONNECT_FAILED         -2
@@ -79,8 +92,10 @@
 #if defined(ESP8266) || defined(ESP32)
 #include <functional>
 #define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+#define MQTT_PUBACK_SIGNATURE std::function<void(uint16_t, boolean)> pubackCallback
 #else
 #define MQTT_CALLBACK_SIGNATURE void (*callback)(char*, uint8_t*, unsigned int)
+#define MQTT_PUBACK_SIGNATURE void (*pubackCallback)(uint16_t, boolean)
 #endif
 
 #define CHECK_STRING_LENGTH(l,s) if (l+2+strnlen(s, this->bufferSize) > this->bufferSize) {_client->stop();return false;}
@@ -97,9 +112,23 @@ private:
    unsigned long lastInActivity;
    bool pingOutstanding;
    MQTT_CALLBACK_SIGNATURE;
+   // QoS 1 publishes sent but not yet acknowledged (msgId 0 = free slot)
+   struct Inflight {
+      uint16_t msgId;
+      uint8_t resends;
+      uint16_t length;
+      uint16_t capacity; // Size of packet; kept across uses so steady-state publishes don't allocate
+      unsigned long sentAt;
+      uint8_t* packet;   // Complete PUBLISH packet, kept for retransmission
+   };
+   Inflight inflight[MQTT_MAX_INFLIGHT] = {};
+   MQTT_PUBACK_SIGNATURE {};
+   uint16_t allocMsgId();
+   void releaseInflight(Inflight& slot, boolean delivered);
+   void resendInflight();
+   void pollConnack();
    uint32_t readPacket(uint8_t*);
-   boolean readByte(uint8_t * result);
-   boolean readByte(uint8_t * result, uint16_t * index);
+   boolean readBytes(uint8_t * result, uint16_t length);
    boolean write(uint8_t header, uint8_t* buf, uint16_t length);
    uint16_t writeString(const char* string, uint8_t* buf, uint16_t pos);
    // Build up the header ready to send
@@ -134,6 +163,9 @@ public:
    PubSubClient& setServer(uint8_t * ip, uint16_t port);
    PubSubClient& setServer(const char * domain, uint16_t port);
    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE);
+   // Called with the message id once a QoS 1 publish is acknowledged (true) or
+   // given up after MQTT_MAX_RESEND retransmissions (false)
+   PubSubClient& setPublishCallback(MQTT_PUBACK_SIGNATURE);
    PubSubClient& setClient(Client& client);
    PubSubClient& setStream(Stream& stream);
    PubSubClient& setKeepAlive(uint16_t keepAlive);
@@ -147,11 +179,20 @@ public:
    boolean connect(const char* id, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage);
    boolean connect(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage);
    boolean connect(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage, boolean cleanSession);
+   // Send CONNECT without waiting for the CONNACK. Uses the client's existing
+   // TCP connection if it has one. state() is MQTT_CONNECTING until loop()
+   // reads the CONNACK (MQTT_CONNECTED) or the socket timeout expires.
+   // Returns false if CONNECT could not be sent
+   boolean beginConnect(const char* id, const char* user, const char* pass, const char* willTopic = 0, uint8_t willQos = 0, boolean willRetain = 0, const char* willMessage = 0, boolean cleanSession = 1);
    void disconnect();
    boolean publish(const char* topic, const char* payload);
    boolean publish(const char* topic, const char* payload, boolean retained);
    boolean publish(const char* topic, const uint8_t * payload, unsigned int plength);
    boolean publish(const char* topic, const uint8_t * payload, unsigned int plength, boolean retained);
+   // Publish at QoS 0 or 1. A QoS 1 message is kept until its PUBACK arrives and
+   // retransmitted after a reconnect; up to MQTT_MAX_INFLIGHT may be outstanding.
+   // Returns false if the message could not be queued (window full, too long)
+   boolean publish(const char* topic, const uint8_t * payload, unsigned int plength, boolean retained, uint8_t qos);
    boolean publish_P(const char* topic, const char* payload, boolean retained);
    boolean publish_P(const char* topic, const uint8_t * payload, unsigned int plength, boolean retained);
    // Start to publish a message.
@@ -177,6 +218,10 @@ public:
    boolean loop();
    boolean connected();
    int state();
+   // Number of QoS 1 publishes awaiting PUBACK
+   uint8_t inflightCount();
+   // Message id of the latest QoS 1 publish (as later passed to the PUBACK callback)
+   uint16_t lastMsgId();
 
 };
 
@@ -111,26 +111,29 @@ inline bool checkAlarms(PublishFunc publishCallback) {
   }
   
   bool shouldAlarm = false;
-  String alarmReason = "";
+  char alarmReason[ALARM_REASON_SIZE];
+  size_t reasonLength = 0;
+  alarmReason[0] = '\0';
   
   // Check PM2.5
   if (sensorData.pm25 > alarmState.pm25Threshold) {
     shouldAlarm = true;
-    alarmReason = "PM2.5 HIGH: " + String(sensorData.pm25) + " µg/m³";
+    reasonLength = snprintf(alarmReason, sizeof(alarmReason), "PM2.5 HIGH: %d µg/m³", sensorData.pm25);
     DEBUG_PRINT(F("[ALARM] ")); DEBUG_PRINTLN(alarmReason);
   }
   
   // Check PM10
   if (sensorData.pm10 > alarmState.pm10Threshold) {
-    if (shouldAlarm) {
-      alarmReason += ", ";
-    }
+    reasonLength = min(reasonLength, sizeof(alarmReason) - 1);
+    snprintf(alarmReason + reasonLength, sizeof(alarmReason) - reasonLength, "%sPM10 HIGH: %d µg/m³",
+             shouldAlarm ? ", " : "", sensorData.pm10);
     shouldAlarm = true;
-    alarmReason += "PM10 HIGH: " + String(sensorData.pm10) + " µg/m³";
     DEBUG_PRINT(F("[ALARM] PM10 HIGH: ")); DEBUG_PRINTLN(sensorData.pm10);
   }
   
   if (shouldAlarm) {
+    strncpy(alarmState.reason, alarmReason, sizeof(alarmState.reason) - 1);
+    alarmState.reason[sizeof(alarmState.reason) - 1] = '\0';
     alarmState.triggered = true;
     alarmState.lastTriggerTime = now;
     alarmTriggered = true;
@@ -140,7 +143,7 @@ inline bool checkAlarms(PublishFunc publishCallback) {
     
     // Publish alarm via MQTT
     StaticJsonDocument<256> doc;
-    doc.createNestedObject("alarm")["value"] = alarmReason;
+    doc.createNestedObject("alarm")["value"] = (const char*)alarmReason;
     
     char jsonBuffer[256];
     serializeJson(doc, jsonBuffer);
@@ -213,21 +216,23 @@ inline bool isAlarmTriggered() {
  * @brief Get alarm state description
  * @return Human readable alarm status
  */
-inline String getAlarmStatus() {
+inline const char* getAlarmStatus() {
   if (!alarmEnabled) {
-    return F("Disabled");
+    return "Disabled";
   }
   if (alarmTriggered) {
-    return F("TRIGGERED");
+    return "TRIGGERED";
   }
-  return F("OK");
+  return "OK";
 }
 
 /**
  * @brief Get alarm configuration as JSON
- * @return JSON string with alarm settings
+ * @param buffer Output buffer
+ * @param bufferSize Size of buffer
+ * @return Number of bytes written (excluding null terminator)
  */
-inline String getAlarmConfigJson() {
+inline size_t getAlarmConfigJson(char* buffer, size_t bufferSize) {
   StaticJsonDocument<192> doc;
   doc["enabled"] = alarmEnabled;
   doc["triggered"] = alarmTriggered;
@@ -235,9 +240,7 @@ inline String getAlarmConfigJson() {
   doc["pm10Threshold"] = alarmState.pm10Threshold;
   doc["cooldownSec"] = alarmState.cooldownMs / 1000;
   
-  String output;
-  serializeJson(doc, output);
-  return output;
+  return serializeJson(doc, buffer, bufferSize);
 }
 
 /**
@@ -266,12 +269,12 @@ inline void initAlarms() {
  * @param quality Current air quality level
  * @return Warning message or empty string
  */
-inline String getAirQualityWarning(AirQuality quality) {
+inline const char* getAirQualityWarning(AirQuality quality) {
   switch (quality) {
     case AirQuality::POLLUTED:
-      return F("⚠️ Air quality is poor. Consider staying indoors.");
+      return "⚠️ Air quality is poor. Consider staying indoors.";
     case AirQuality::VERY_POLLUTED:
-      return F("🚨 Air quality is very poor! Avoid outdoor activities.");
+      return "🚨 Air quality is very poor! Avoid outdoor activities.";
     default:
       return "";
   }
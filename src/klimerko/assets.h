@@ -0,0 +1,175 @@
+/**
+ * @file assets.h
+ * @brief Klimerko MQTT asset names - perfect-hash lookup built at compile time
+ * @version 7.0 Ultimate
+ *
+ * ASSET_NAMES is the single list of asset names, indexed by MqttAsset.
+ * From it the compiler builds an open table of ASSET_TABLE_SIZE slots and
+ * searches for a hash seed under which no two names share a slot, so a
+ * lookup is one hash, one slot read and one string compare. Adding a name
+ * that breaks the perfect hash fails the build (static_assert below).
+ *
+ * Only <Arduino.h> is needed, so the table can be tested on the host.
+ */
+
+#ifndef KLIMERKO_ASSETS_H
+#define KLIMERKO_ASSETS_H
+
+#include <Arduino.h>
+
+/**
+ * @brief MQTT Asset identifiers
+ */
+enum class MqttAsset : uint8_t {
+  // Particle measurements
+  PM1,
+  PM2_5,
+  PM10,
+  PM1_CORRECTED,
+  PM2_5_CORRECTED,
+  PM10_CORRECTED,
+
+  // Particle counts
+  COUNT_0_3,
+  COUNT_0_5,
+  COUNT_1_0,
+  COUNT_2_5,
+  COUNT_5_0,
+  COUNT_10_0,
+
+  // Environmental
+  TEMPERATURE,
+  HUMIDITY,
+  PRESSURE,
+  DEWPOINT,
+  HUMIDITY_ABS,
+  PRESSURE_SEA,
+  HEAT_INDEX,
+  ALTITUDE,
+
+  // Device status
+  AIR_QUALITY,
+  SENSOR_STATUS,
+  WIFI_SIGNAL,
+  FIRMWARE,
+  INTERVAL,
+
+  // Configuration
+  TEMP_OFFSET,
+  ALTITUDE_SET,
+  WIFI_CONFIG,
+  RESTART_DEVICE,
+  FIRMWARE_UPDATE,
+  DEEP_SLEEP,
+  ALARM_ENABLE,
+  CALIBRATION,
+  MQTT_BROKER,
+  PAYLOAD_FORMAT,
+  DEADBAND,
+  SINKS,
+
+  UNKNOWN
+};
+
+#define ASSET_COUNT       ((uint8_t)MqttAsset::UNKNOWN)
+#define ASSET_TABLE_SIZE  128  // Power of two; sparse enough for a seed search to succeed quickly
+
+/**
+ * @brief Asset names in MqttAsset order
+ */
+constexpr const char* ASSET_NAMES[ASSET_COUNT] = {
+  "pm1", "pm2-5", "pm10", "pm1-c", "pm2-5-c", "pm10-c",
+  "count-0-3", "count-0-5", "count-1-0", "count-2-5", "count-5-0", "count-10-0",
+  "temperature", "humidity", "pressure", "dewpoint", "humidityAbs", "pressureSea",
+  "HeatIndex", "altitude",
+  "air-quality", "sensor-status", "wifi-signal", "firmware", "interval",
+  "temperature-offset", "altitude-set", "wifi-config", "restart-device",
+  "firmware-update", "deep-sleep", "alarm-enable", "calibration", "mqtt-broker",
+  "payload-format", "deadband", "sinks"
+};
+
+/**
+ * @brief FNV-1a over len bytes, mixed with a seed
+ */
+constexpr uint32_t assetHash(const char* name, size_t len, uint32_t seed) {
+  uint32_t h = 2166136261UL ^ seed;
+  for (size_t i = 0; i < len; i++) {
+    h = (h ^ (uint8_t)name[i]) * 16777619UL;
+  }
+  return h ^ (h >> 15);
+}
+
+constexpr size_t assetNameLength(const char* name) {
+  size_t len = 0;
+  while (name[len]) len++;
+  return len;
+}
+
+/**
+ * @brief Slot table: asset index per slot, UNKNOWN when empty
+ */
+struct AssetTable {
+  uint32_t seed;
+  uint8_t slots[ASSET_TABLE_SIZE];
+};
+
+/**
+ * @brief Try seeds until every name lands in its own slot
+ * @return Table with seed 0xFFFFFFFF if no seed below that works
+ */
+constexpr AssetTable buildAssetTable() {
+  AssetTable table = {};
+  for (uint32_t seed = 0; seed < 0xFFFFFFFFUL; seed++) {
+    for (uint8_t s = 0; s < ASSET_TABLE_SIZE; s++) {
+      table.slots[s] = (uint8_t)MqttAsset::UNKNOWN;
+    }
+    bool collision = false;
+    for (uint8_t a = 0; a < ASSET_COUNT && !collision; a++) {
+      uint8_t slot = assetHash(ASSET_NAMES[a], assetNameLength(ASSET_NAMES[a]), seed) & (ASSET_TABLE_SIZE - 1);
+      collision = table.slots[slot] != (uint8_t)MqttAsset::UNKNOWN;
+      table.slots[slot] = a;
+    }
+    if (!collision) {
+      table.seed = seed;
+      return table;
+    }
+  }
+  table.seed = 0xFFFFFFFFUL;
+  return table;
+}
+
+constexpr AssetTable ASSET_TABLE = buildAssetTable();
+static_assert(ASSET_TABLE.seed != 0xFFFFFFFFUL, "No perfect hash for ASSET_NAMES, grow ASSET_TABLE_SIZE");
+
+/**
+ * @brief Get MQTT asset name string
+ */
+inline const char* assetToString(MqttAsset asset) {
+  return asset < MqttAsset::UNKNOWN ? ASSET_NAMES[(uint8_t)asset] : "unknown";
+}
+
+/**
+ * @brief Look up an asset by name (not necessarily NUL-terminated)
+ */
+inline MqttAsset assetFromName(const char* name, size_t len) {
+  uint8_t a = ASSET_TABLE.slots[assetHash(name, len, ASSET_TABLE.seed) & (ASSET_TABLE_SIZE - 1)];
+  if (a == (uint8_t)MqttAsset::UNKNOWN) return MqttAsset::UNKNOWN;
+  const char* candidate = ASSET_NAMES[a];
+  return strncmp(candidate, name, len) == 0 && candidate[len] == '\0' ? (MqttAsset)a : MqttAsset::UNKNOWN;
+}
+
+/**
+ * @brief Find the asset of a command topic without copying it
+ * @param topic device/{deviceId}/asset/{assetName}/command
+ * @return Asset, or UNKNOWN for other topics and names
+ */
+inline MqttAsset assetFromTopic(const char* topic) {
+  const char* start = strstr(topic, "/asset/");
+  if (!start) return MqttAsset::UNKNOWN;
+  start += 7;
+  const char* end = strchr(start, '/');
+  if (!end || end == start || strcmp(end, "/command") != 0) return MqttAsset::UNKNOWN;
+  return assetFromName(start, end - start);
+}
+
+#endif // KLIMERKO_ASSETS_H
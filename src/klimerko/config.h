@@ -35,6 +35,14 @@
   #define DEBUG_PRINTF(...)
 #endif
 
+// 64-bit statistics counters in JSON (must precede every ArduinoJson include)
+#define ARDUINOJSON_USE_LONG_LONG 1
+
+// Hot-path profiler (profiler.h, /api/perf) - about 1.5 KB RAM when enabled
+#define PROFILER_ENABLED        1
+#define PERF_HIST_BUCKETS       16      // log2 duration buckets per probe
+#define PERF_HIST_FIRST_LOG2    5       // First bucket: up to 2^5 = 32 us
+
 // ============================================================================
 // PIN DEFINITIONS
 // ============================================================================
@@ -69,7 +77,11 @@
 #define WIFI_CONFIG_TIMEOUT_MS      1800000UL   // 30 minutes portal timeout
 
 // MQTT
-#define MQTT_RECONNECT_INTERVAL_MS  30000UL     // 30 seconds
+#define MQTT_RECONNECT_BASE_MS      5000UL      // First retry after a failure (jittered)
+#define MQTT_RECONNECT_MAX_MS       300000UL    // 5 minutes max backoff
+#define MQTT_TCP_TIMEOUT_MS         3000        // TCP connect/write timeout
+#define MQTT_DNS_TIMEOUT_MS         10000UL     // Give up on a broker lookup
+#define MQTT_DNS_CACHE_MS           300000UL    // Re-resolve the broker after 5 minutes
 
 // Button
 #define BUTTON_SHORT_PRESS_MS       50UL
@@ -101,6 +113,39 @@
 #define MQTT_MAX_MESSAGE_SIZE   4096
 #define MQTT_CALLBACK_BUFFER    1023    // Leave room for null terminator
 #define MQTT_KEEPALIVE_SEC      30
+#define MQTT_STATE_QOS          1       // Sensor data: counted as delivered on PUBACK
+#define MQTT_DRAIN_TIMEOUT_MS   5000    // Wait for PUBACKs before deep sleep
+
+// MQTT over TLS (BearSSL)
+#define MQTT_TLS_PORT           8883
+#define MQTT_TLS_FILE_PATH      "/mqtt_tls.json"
+#define MQTT_TLS_CA_PATH        "/mqtt_ca.pem"  // Optional pinned CA / server certificate
+#define MQTT_TLS_MFLN           1024    // Receive buffer if the broker supports MFLN
+#define MQTT_TLS_TX_BUFFER      512     // Outgoing record size
+
+// Deadband publishing (send only assets that changed)
+#define DEADBAND_DEFAULT_ENABLED        1
+#define DEADBAND_FILE_PATH              "/deadband.json"
+#define DEADBAND_MAX_ASSETS             32
+#define DEADBAND_ASSET_NAME_SIZE        20
+#define DEADBAND_HEARTBEAT_SEC          3600UL   // Resend unchanged values hourly
+#define DEADBAND_STATIC_HEARTBEAT_SEC   86400UL  // Firmware, altitude: daily
+
+// Additional data sinks (local MQTT, InfluxDB, Sensor.Community)
+#define SINKS_FILE_PATH         "/sinks.json"
+#define SINK_POOL_SIZE          12      // Shared encoded payloads in flight
+#define SINK_PAYLOAD_SIZE       384     // Max encoded sample per wire format
+#define SINK_QUEUE_DEPTH        8       // Per-sink backlog (oldest dropped)
+#define SINK_TIMEOUT_MS         2000    // Connect/response timeout per attempt
+#define SINK_BACKOFF_MIN_MS     5000UL  // First retry delay after a failure
+#define SINK_BACKOFF_MAX_MS     300000UL // Retry delay cap (5 min)
+#define INFLUX_BATCH_SAMPLES    6       // POST once this many lines are queued...
+#define INFLUX_BATCH_MAX_SEC    900     // ...or the oldest line is this old
+#define INFLUX_BATCH_BUFFER     1536    // Batch body (and gzip output) size
+#define SINK_MQTT_TOPIC_PREFIX  "klimerko/"
+#define SENSOR_COMMUNITY_URL    "http://api.sensor.community/v1/push-sensor-data/"
+#define SENSOR_COMMUNITY_PIN_PM  "1"    // X-Pin for particulate sensors
+#define SENSOR_COMMUNITY_PIN_ENV "11"   // X-Pin for BME280
 
 // ============================================================================
 // WEB SERVER CONFIGURATION
@@ -108,6 +153,66 @@
 #define WEB_SERVER_PORT         80
 #define MAX_LOG_ENTRIES         100     // LittleFS log size limit
 #define LOG_FILE_PATH           "/sensor_log.json"
+#define HISTORY_FILE_PATH       "/history.bin"  // Fixed-width binary ring log
+#define HISTORY_MAX_RECORDS     2016    // 7 days at 5-minute interval (~32 KB)
+#define TS_FILE_PATH            "/ts.bin"       // Compressed time-series chunk ring
+#define TS_CHUNK_SIZE           512     // Bytes per chunk slot (header + bitstream)
+#define TS_MAX_CHUNKS           512     // 256 KB ring, ~6 weeks of per-minute samples
+#define TS_SAMPLE_INTERVAL_SEC  60      // Minimum spacing of stored samples
+#define TS_FLUSH_SAMPLES        15      // Persist open chunk every N samples
+#define TS_HOURLY_PATH          "/ts_hourly.bin" // Per-hour pre-aggregates
+#define TS_HOURLY_SLOTS         1440    // 60 days of hours (128 B each, ~184 KB)
+#define QUERY_DEFAULT_LIMIT     500     // Max result points per /api/query
+#define QUERY_TIME_BUDGET_MS    1000UL  // Stop scanning after this (truncated)
+#define QUERY_EXACT_VALUES      128     // Raw values kept per point for exact percentiles
+#define WEB_ASSET_DIR           "/www"  // Pre-gzipped dashboard assets (LittleFS)
+#define WEB_CACHE_MAX_AGE_SEC   604800UL // 7 days for versioned static assets
+
+// Server-Sent Events (/api/events live stream)
+#define SSE_MAX_CLIENTS         4       // Concurrent dashboard subscribers
+#define SSE_KEEPALIVE_MS        15000UL // Comment ping interval (detects dead clients)
+#define SSE_RETRY_MS            5000    // Browser reconnect delay hint
+
+// Prometheus push (remote-write / Pushgateway, for devices behind NAT)
+#define PROM_PUSH_INTERVAL_SEC  60      // Snapshot / Pushgateway push interval
+#define PROM_PUSH_BATCH         3       // Snapshots per remote-write request
+#define PROM_PUSH_BUFFER        6144    // Max Pushgateway text body (heap, freed after push)
+#define PROM_WRITE_BUFFER_MAX   8192    // Cap on the remote-write body, sized from the series count
+#define PROM_PUSH_PACKED        2048    // Max snappy-compressed request
+#define PROM_SERIES_MAX         56      // Series kept per snapshot (static_assert in metrics.h)
+#define PROM_LABEL_VALUE_MAX    16      // Longest label value (sink name) counted in the buffer bound
+
+// ============================================================================
+// SETTINGS PERSISTENCE
+// ============================================================================
+// EEPROM map - fixed offsets, so a larger Settings never moves the statistics
+#define SETTINGS_EEPROM_RESERVED      256     // Settings at 0, any schema version
+#define STATS_EEPROM_OFFSET           256     // Statistics
+#define STATS_EEPROM_RESERVED         64
+#define EEPROM_USED_SIZE              (STATS_EEPROM_OFFSET + STATS_EEPROM_RESERVED)
+#define SETTINGS_JOURNAL_PATH         "/settings.jnl" // Field updates since the EEPROM base
+#define SETTINGS_JOURNAL_MAX_BYTES    2048    // Fold into EEPROM (one sector erase) beyond this
+#define SETTINGS_COMMIT_QUIET_MS      5000UL  // Commit once changes pause this long...
+#define SETTINGS_COMMIT_MAX_DELAY_MS  60000UL // ...or this long after the first change
+
+// Statistics: live copy in RTC memory, checkpoints appended to LittleFS
+#define STATS_RTC_BLOCK               32      // RTC user memory block (0-31 used by OTA)
+#define STATS_LOG_PATH                "/stats.log"
+#define STATS_LOG_MAX_BYTES           4096    // Rewrite with the newest record beyond this
+#define STATS_CHECKPOINT_SEC          900     // Awake time between flash checkpoints
+
+// ============================================================================
+// STALL MONITOR
+// ============================================================================
+#define STALL_WARN_MS           2000    // loop() iteration this long is a stall (soft WDT ~3.2 s)
+#define LOOP_TRACE_MIN_MS       20      // Tasks at least this long go to the trace
+#define LOOP_WINDOW_SEC         60      // Window of the loop latency percentiles
+#define POSTMORTEM_TRACE_EVENTS 8       // Trace events kept in the post-mortem
+#define POSTMORTEM_RTC_BLOCK    56      // Current task, then the post-mortem (after the stats)
+
+// Memory telemetry (mem_telemetry.h)
+#define MEM_SAMPLE_MS           1000UL  // Fragmentation and per-task stack scan interval
+#define DIAG_PUBLISH_INTERVAL_SEC 3600UL // MQTT diagnostics (incl. memory) republish interval
 
 // ============================================================================
 // NTP CONFIGURATION
@@ -136,6 +241,8 @@
 #define DEFAULT_PM_CAL_FACTOR   1.0f    // No correction by default
 #define MIN_CAL_FACTOR          0.1f    // Minimum valid calibration factor
 #define MAX_CAL_FACTOR          10.0f   // Maximum valid calibration factor
+#define MIN_ALTITUDE            -500    // Meters; the range fits altitudeChar[6]
+#define MAX_ALTITUDE            9000
 
 // ============================================================================
 // BUFFER SIZES
@@ -147,6 +254,10 @@
 #define JSON_BUFFER_SMALL       256
 #define JSON_BUFFER_MEDIUM      512
 #define JSON_BUFFER_LARGE       2048
+#define UPTIME_TEXT_SIZE        24      // "12345d 12:34:56"
+#define TIME_TEXT_SIZE          24      // ISO timestamp or HH:MM:SS
+#define ALARM_REASON_SIZE       64
+#define FIRMWARE_URL_SIZE       256
 
 // ============================================================================
 // COMPATIBILITY ALIASES (for modular code consistency)
@@ -168,7 +279,6 @@
 #define WIFI_RECONNECT_BASE_INTERVAL    WIFI_RECONNECT_BASE_MS
 #define WIFI_RECONNECT_MAX_INTERVAL     WIFI_RECONNECT_MAX_MS
 #define WIFI_CONFIG_TIMEOUT             WIFI_CONFIG_TIMEOUT_MS
-#define MQTT_RECONNECT_INTERVAL         MQTT_RECONNECT_INTERVAL_MS
 #define LED_BLINK_INTERVAL              LED_BLINK_INTERVAL_MS
 #define DEEP_SLEEP_DURATION_US          DEEP_SLEEP_DEFAULT_US
 #define ALARM_COOLDOWN                  ALARM_COOLDOWN_MS
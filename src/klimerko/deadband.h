@@ -0,0 +1,314 @@
+/**
+ * @file deadband.h
+ * @brief Klimerko Deadband Publishing - send only assets that changed
+ * @version 7.0 Ultimate
+ *
+ * Each asset in a state publish has a rule:
+ * - abs:    include when |value - last published| >= band
+ * - rel:    include when |value - last| >= band * |last|
+ * - change: include on any change (strings always use this)
+ * - always: include every publish (no deadband)
+ * plus a heartbeat: an asset silent for longer than its heartbeat is
+ * sent anyway so the platform never goes stale.
+ *
+ * Defaults live in DEADBAND_DEFAULTS; overrides arrive over MQTT
+ * ("deadband" asset) and are kept in DEADBAND_FILE_PATH on LittleFS.
+ */
+
+#ifndef KLIMERKO_DEADBAND_H
+#define KLIMERKO_DEADBAND_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "config.h"
+#include "types.h"
+#include "utils.h"
+#include "../ArduinoJson-v6.18.5.h"
+
+enum class DeadbandMode : uint8_t {
+  ABSOLUTE = 0,
+  RELATIVE = 1,
+  CHANGE = 2,
+  ALWAYS = 3
+};
+
+/**
+ * @brief Default rule for one asset
+ */
+struct DeadbandDefault {
+  const char* asset;
+  DeadbandMode mode;
+  float band;
+  uint32_t heartbeatSec;
+};
+
+static const DeadbandDefault DEADBAND_DEFAULTS[] = {
+  {"pm1",         DeadbandMode::ABSOLUTE, 1.0f,  DEADBAND_HEARTBEAT_SEC},
+  {"pm2-5",       DeadbandMode::ABSOLUTE, 1.0f,  DEADBAND_HEARTBEAT_SEC},
+  {"pm10",        DeadbandMode::ABSOLUTE, 1.0f,  DEADBAND_HEARTBEAT_SEC},
+  {"pm1-c",       DeadbandMode::ABSOLUTE, 1.0f,  DEADBAND_HEARTBEAT_SEC},
+  {"pm2-5-c",     DeadbandMode::ABSOLUTE, 1.0f,  DEADBAND_HEARTBEAT_SEC},
+  {"pm10-c",      DeadbandMode::ABSOLUTE, 1.0f,  DEADBAND_HEARTBEAT_SEC},
+  {"count-0-3",   DeadbandMode::RELATIVE, 0.1f,  DEADBAND_HEARTBEAT_SEC},
+  {"count-0-5",   DeadbandMode::RELATIVE, 0.1f,  DEADBAND_HEARTBEAT_SEC},
+  {"count-1-0",   DeadbandMode::RELATIVE, 0.1f,  DEADBAND_HEARTBEAT_SEC},
+  {"count-2-5",   DeadbandMode::RELATIVE, 0.1f,  DEADBAND_HEARTBEAT_SEC},
+  {"count-5-0",   DeadbandMode::RELATIVE, 0.1f,  DEADBAND_HEARTBEAT_SEC},
+  {"count-10-0",  DeadbandMode::RELATIVE, 0.1f,  DEADBAND_HEARTBEAT_SEC},
+  {"temperature", DeadbandMode::ABSOLUTE, 0.2f,  DEADBAND_HEARTBEAT_SEC},
+  {"humidity",    DeadbandMode::ABSOLUTE, 1.0f,  DEADBAND_HEARTBEAT_SEC},
+  {"pressure",    DeadbandMode::ABSOLUTE, 0.3f,  DEADBAND_HEARTBEAT_SEC},
+  {"pressureSea", DeadbandMode::ABSOLUTE, 0.3f,  DEADBAND_HEARTBEAT_SEC},
+  {"dewpoint",    DeadbandMode::ABSOLUTE, 0.2f,  DEADBAND_HEARTBEAT_SEC},
+  {"humidityAbs", DeadbandMode::ABSOLUTE, 0.2f,  DEADBAND_HEARTBEAT_SEC},
+  {"HeatIndex",   DeadbandMode::ABSOLUTE, 0.3f,  DEADBAND_HEARTBEAT_SEC},
+  {"wifi-signal", DeadbandMode::ABSOLUTE, 3.0f,  DEADBAND_HEARTBEAT_SEC},
+  {"altitude",    DeadbandMode::CHANGE,   0.0f,  DEADBAND_STATIC_HEARTBEAT_SEC},
+  {"firmware",    DeadbandMode::CHANGE,   0.0f,  DEADBAND_STATIC_HEARTBEAT_SEC},
+};
+
+#define DEADBAND_DEFAULT_COUNT (sizeof(DEADBAND_DEFAULTS) / sizeof(DEADBAND_DEFAULTS[0]))
+
+/**
+ * @brief Rule and last published value of one asset
+ */
+struct DeadbandEntry {
+  char asset[DEADBAND_ASSET_NAME_SIZE];
+  DeadbandMode mode;
+  bool custom;              // Set over MQTT (persisted)
+  bool published;           // lastValue/lastPublishSec are valid
+  float band;
+  uint32_t heartbeatSec;
+  float lastValue;          // Numeric value, or hash of a string value
+  uint32_t lastPublishSec;
+  uint16_t msgId;           // QoS 1 publish that carried lastValue (0 = QoS 0)
+};
+
+/**
+ * @brief Per-asset change filter for state publishes
+ */
+class DeadbandFilter {
+private:
+  DeadbandEntry _entries[DEADBAND_MAX_ASSETS];
+  uint8_t _count;
+  bool _enabled;
+
+  /**
+   * @brief Find entry for asset, creating it from defaults if needed
+   */
+  DeadbandEntry* entry(const char* asset) {
+    for (uint8_t i = 0; i < _count; i++) {
+      if (strcmp(_entries[i].asset, asset) == 0) return &_entries[i];
+    }
+    if (_count >= DEADBAND_MAX_ASSETS) return nullptr;
+
+    DeadbandEntry& e = _entries[_count++];
+    memset(&e, 0, sizeof(e));
+    safeStrCopy(e.asset, asset, sizeof(e.asset));
+    e.mode = DeadbandMode::CHANGE;   // Unknown assets: send on change
+    e.heartbeatSec = DEADBAND_HEARTBEAT_SEC;
+    for (size_t i = 0; i < DEADBAND_DEFAULT_COUNT; i++) {
+      if (strcmp(DEADBAND_DEFAULTS[i].asset, asset) == 0) {
+        e.mode = DEADBAND_DEFAULTS[i].mode;
+        e.band = DEADBAND_DEFAULTS[i].band;
+        e.heartbeatSec = DEADBAND_DEFAULTS[i].heartbeatSec;
+        break;
+      }
+    }
+    return &e;
+  }
+
+  /**
+   * @brief Comparable form of an asset value
+   */
+  static float valueOf(JsonVariantConst value, bool& isString) {
+    isString = value.is<const char*>();
+    if (isString) {
+      // 24-bit hash stays exact in a float
+      const char* s = value.as<const char*>();
+      return (float)(calculateCRC32((const uint8_t*)s, strlen(s)) & 0xFFFFFF);
+    }
+    if (value.is<bool>()) return value.as<bool>() ? 1.0f : 0.0f;
+    return value.as<float>();
+  }
+
+  /**
+   * @brief Decide whether an asset goes into this publish
+   */
+  static bool shouldSend(const DeadbandEntry& e, float value, bool isString, uint32_t nowSec) {
+    if (!e.published || e.mode == DeadbandMode::ALWAYS) return true;
+    if (nowSec - e.lastPublishSec >= e.heartbeatSec) return true;
+
+    float diff = fabsf(value - e.lastValue);
+    if (isString || e.mode == DeadbandMode::CHANGE) return diff != 0.0f;
+    if (e.mode == DeadbandMode::RELATIVE) return diff >= e.band * fabsf(e.lastValue) && diff > 0.0f;
+    return diff >= e.band;
+  }
+
+  void save() {
+    DynamicJsonDocument doc(JSON_BUFFER_LARGE);
+    doc["enabled"] = _enabled;
+    JsonObject rules = doc.createNestedObject("rules");
+    for (uint8_t i = 0; i < _count; i++) {
+      const DeadbandEntry& e = _entries[i];
+      if (!e.custom) continue;
+      JsonObject r = rules.createNestedObject(e.asset);
+      ruleToJson(e, r);
+    }
+
+    File f = LittleFS.open(DEADBAND_FILE_PATH, "w");
+    if (!f) {
+      DEBUG_PRINTLN(F("[DEADBAND] Cannot save rules"));
+      return;
+    }
+    serializeJson(doc, f);
+    f.close();
+  }
+
+  static void ruleToJson(const DeadbandEntry& e, JsonObject r) {
+    switch (e.mode) {
+      case DeadbandMode::ABSOLUTE: r["abs"] = e.band; break;
+      case DeadbandMode::RELATIVE: r["rel"] = e.band; break;
+      case DeadbandMode::CHANGE:   r["change"] = true; break;
+      case DeadbandMode::ALWAYS:   r["always"] = true; break;
+    }
+    r["hb"] = e.heartbeatSec;
+  }
+
+  /**
+   * @brief Apply one rule object ({"abs":0.2,"hb":3600}, {"rel":0.1}, ...)
+   */
+  void applyRule(const char* asset, JsonObjectConst r) {
+    DeadbandEntry* e = entry(asset);
+    if (!e) return;
+    if (r.containsKey("abs")) {
+      e->mode = DeadbandMode::ABSOLUTE;
+      e->band = fabsf(r["abs"].as<float>());
+    } else if (r.containsKey("rel")) {
+      e->mode = DeadbandMode::RELATIVE;
+      e->band = fabsf(r["rel"].as<float>());
+    } else if (r["change"] | false) {
+      e->mode = DeadbandMode::CHANGE;
+    } else if (r["always"] | false) {
+      e->mode = DeadbandMode::ALWAYS;
+    }
+    if (r.containsKey("hb")) {
+      e->heartbeatSec = max(r["hb"].as<uint32_t>(), (uint32_t)60);
+    }
+    e->custom = true;
+  }
+
+public:
+  DeadbandFilter() : _count(0), _enabled(DEADBAND_DEFAULT_ENABLED) {}
+
+  /**
+   * @brief Load persisted overrides (call after LittleFS is mounted)
+   */
+  void begin() {
+    File f = LittleFS.open(DEADBAND_FILE_PATH, "r");
+    if (!f) return;
+
+    DynamicJsonDocument doc(JSON_BUFFER_LARGE);
+    DeserializationError err = deserializeJson(doc, f);
+    f.close();
+    if (err) {
+      DEBUG_PRINTLN(F("[DEADBAND] Invalid rules file, using defaults"));
+      return;
+    }
+    _enabled = doc["enabled"] | (bool)DEADBAND_DEFAULT_ENABLED;
+    for (JsonPairConst kv : doc["rules"].as<JsonObjectConst>()) {
+      applyRule(kv.key().c_str(), kv.value().as<JsonObjectConst>());
+    }
+    DEBUG_PRINTF("[DEADBAND] %s, %u custom rules\n", _enabled ? "enabled" : "disabled", _count);
+  }
+
+  /**
+   * @brief Apply configuration received over MQTT
+   * @param config {"enabled":bool, "reset":true, "<asset>":{rule}, ...}
+   */
+  void configure(JsonObjectConst config) {
+    if (config["reset"] | false) {
+      _count = 0;
+      _enabled = DEADBAND_DEFAULT_ENABLED;
+    }
+    if (config.containsKey("enabled")) {
+      _enabled = config["enabled"].as<bool>();
+    }
+    for (JsonPairConst kv : config) {
+      if (kv.value().is<JsonObjectConst>()) {
+        applyRule(kv.key().c_str(), kv.value().as<JsonObjectConst>());
+      }
+    }
+    save();
+    DEBUG_PRINTF("[DEADBAND] Rules updated (%s)\n", _enabled ? "enabled" : "disabled");
+  }
+
+  /**
+   * @brief Drop assets that stayed inside their deadband
+   * @param doc State document {"asset":{"value":...}, ...}
+   * @param nowSec Monotonic seconds (uptime)
+   * @return Number of assets left in the document
+   */
+  size_t filter(JsonDocument& doc, uint32_t nowSec) {
+    JsonObject root = doc.as<JsonObject>();
+    if (!_enabled) return root.size();
+
+    const char* drop[DEADBAND_MAX_ASSETS];
+    uint8_t dropCount = 0;
+    for (JsonPair kv : root) {
+      DeadbandEntry* e = entry(kv.key().c_str());
+      if (!e) continue;
+      bool isString;
+      float value = valueOf(kv.value()["value"], isString);
+      if (!shouldSend(*e, value, isString, nowSec) && dropCount < DEADBAND_MAX_ASSETS) {
+        drop[dropCount++] = kv.key().c_str();
+      }
+    }
+    for (uint8_t i = 0; i < dropCount; i++) {
+      root.remove(drop[i]);
+    }
+    return root.size();
+  }
+
+  /**
+   * @brief Remember values of a successful publish
+   * @param doc Document as published (after filter())
+   * @param nowSec Monotonic seconds (uptime)
+   * @param msgId MQTT message id of a QoS 1 publish, 0 for QoS 0
+   */
+  void commit(const JsonDocument& doc, uint32_t nowSec, uint16_t msgId = 0) {
+    for (JsonPairConst kv : doc.as<JsonObjectConst>()) {
+      DeadbandEntry* e = entry(kv.key().c_str());
+      if (!e) continue;
+      bool isString;
+      e->lastValue = valueOf(kv.value()["value"], isString);
+      e->lastPublishSec = nowSec;
+      e->published = true;
+      e->msgId = msgId;
+    }
+  }
+
+  /**
+   * @brief Forget values the broker never acknowledged
+   *
+   * Assets last carried by the undelivered publish go out with the next
+   * one instead of waiting for their heartbeat. Assets committed again
+   * by a later publish keep that one.
+   * @param msgId MQTT message id given up after retransmissions
+   */
+  void undelivered(uint16_t msgId) {
+    if (msgId == 0) return;
+    for (uint8_t i = 0; i < _count; i++) {
+      if (_entries[i].msgId == msgId) {
+        _entries[i].published = false;
+        _entries[i].msgId = 0;
+      }
+    }
+  }
+
+  bool enabled() const { return _enabled; }
+};
+
+extern DeadbandFilter deadband;
+
+#endif // KLIMERKO_DEADBAND_H
@@ -0,0 +1,182 @@
+/**
+ * @file gzip.h
+ * @brief Klimerko Gzip Compression - small single-pass deflate encoder
+ * @version 7.0 Ultimate
+ *
+ * Compresses an in-memory buffer into a gzip member (RFC 1951/1952) using
+ * one fixed-Huffman block and greedy LZ77 matching over a single-entry
+ * hash table. That is far from zlib's ratio on arbitrary data, but batched
+ * line protocol and JSON repeat the same keys and tags on every line, which
+ * is exactly what back-references catch. Needs no heap and ~1 KB of RAM.
+ */
+
+#ifndef KLIMERKO_GZIP_H
+#define KLIMERKO_GZIP_H
+
+#include <Arduino.h>
+#include "utils.h"
+
+#define GZIP_HASH_BITS      9
+#define GZIP_MIN_MATCH      3
+#define GZIP_MAX_MATCH      258
+#define GZIP_MAX_DISTANCE   32768
+#define GZIP_MAX_INPUT      65535   // Positions are kept as uint16_t
+
+static const uint16_t DEFLATE_LEN_BASE[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t DEFLATE_LEN_EXTRA[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t DEFLATE_DIST_BASE[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t DEFLATE_DIST_EXTRA[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/**
+ * @brief LSB-first bit writer into a caller buffer
+ */
+struct DeflateWriter {
+  uint8_t* buf;
+  size_t capacity;
+  size_t len;
+  uint32_t bits;
+  uint8_t bitCount;
+  bool overflow;
+
+  DeflateWriter(uint8_t* buffer, size_t size)
+    : buf(buffer), capacity(size), len(0), bits(0), bitCount(0), overflow(false) {}
+
+  void putByte(uint8_t b) {
+    if (len < capacity) buf[len++] = b;
+    else overflow = true;
+  }
+
+  void putLE32(uint32_t v) {
+    putByte(v); putByte(v >> 8); putByte(v >> 16); putByte(v >> 24);
+  }
+
+  void putBits(uint32_t value, uint8_t count) {
+    bits |= value << bitCount;
+    bitCount += count;
+    while (bitCount >= 8) {
+      putByte(bits & 0xFF);
+      bits >>= 8;
+      bitCount -= 8;
+    }
+  }
+
+  /**
+   * @brief Write a Huffman code (stored MSB-first in the stream)
+   */
+  void putCode(uint16_t code, uint8_t length) {
+    uint16_t reversed = 0;
+    for (uint8_t i = 0; i < length; i++) {
+      reversed = (reversed << 1) | (code & 1);
+      code >>= 1;
+    }
+    putBits(reversed, length);
+  }
+
+  void flushBits() {
+    if (bitCount) putByte(bits & 0xFF);
+    bits = 0;
+    bitCount = 0;
+  }
+
+  /**
+   * @brief Literal/length symbol with the fixed Huffman code
+   */
+  void putSymbol(uint16_t sym) {
+    if (sym < 144)      putCode(0x30 + sym, 8);
+    else if (sym < 256) putCode(0x190 + sym - 144, 9);
+    else if (sym < 280) putCode(sym - 256, 7);
+    else                putCode(0xC0 + sym - 280, 8);
+  }
+
+  void putMatch(uint16_t length, uint16_t distance) {
+    uint8_t i = 28;
+    while (DEFLATE_LEN_BASE[i] > length) i--;
+    putSymbol(257 + i);
+    putBits(length - DEFLATE_LEN_BASE[i], DEFLATE_LEN_EXTRA[i]);
+
+    uint8_t d = 29;
+    while (DEFLATE_DIST_BASE[d] > distance) d--;
+    putCode(d, 5);
+    putBits(distance - DEFLATE_DIST_BASE[d], DEFLATE_DIST_EXTRA[d]);
+  }
+};
+
+inline uint16_t gzipHash(const uint8_t* p) {
+  uint32_t v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+  return (uint16_t)((uint32_t)(v * 2654435761U) >> (32 - GZIP_HASH_BITS));
+}
+
+/**
+ * @brief Compress a buffer into a complete gzip member
+ * @param input Data to compress (at most GZIP_MAX_INPUT bytes)
+ * @param length Input length
+ * @param output Output buffer
+ * @param outputSize Output buffer size
+ * @return Compressed length, 0 if it did not fit (send uncompressed instead)
+ */
+inline size_t gzipCompress(const uint8_t* input, size_t length, uint8_t* output, size_t outputSize) {
+  static uint16_t head[1 << GZIP_HASH_BITS];
+  if (length > GZIP_MAX_INPUT) return 0;
+
+  DeflateWriter w(output, outputSize);
+  static const uint8_t GZIP_HEADER[10] = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF};
+  for (uint8_t i = 0; i < sizeof(GZIP_HEADER); i++) w.putByte(GZIP_HEADER[i]);
+
+  // Single final block, fixed Huffman codes
+  w.putBits(1, 1);
+  w.putBits(1, 2);
+
+  memset(head, 0xFF, sizeof(head));
+  size_t pos = 0;
+  while (pos < length && !w.overflow) {
+    uint16_t bestLen = 0;
+    uint16_t bestDist = 0;
+
+    if (pos + GZIP_MIN_MATCH <= length) {
+      uint16_t h = gzipHash(input + pos);
+      uint16_t candidate = head[h];
+      head[h] = pos;
+      if (candidate != 0xFFFF && pos - candidate <= GZIP_MAX_DISTANCE) {
+        size_t limit = min(length - pos, (size_t)GZIP_MAX_MATCH);
+        size_t n = 0;
+        while (n < limit && input[candidate + n] == input[pos + n]) n++;
+        if (n >= GZIP_MIN_MATCH) {
+          bestLen = n;
+          bestDist = pos - candidate;
+        }
+      }
+    }
+
+    if (bestLen) {
+      w.putMatch(bestLen, bestDist);
+      // Index the positions covered by the match for later references
+      for (size_t j = pos + 1; j < pos + bestLen && j + GZIP_MIN_MATCH <= length; j++) {
+        head[gzipHash(input + j)] = j;
+      }
+      pos += bestLen;
+    } else {
+      w.putSymbol(input[pos]);
+      pos++;
+    }
+  }
+  w.putSymbol(256);
+  w.flushBits();
+
+  w.putLE32(calculateCRC32(input, length));
+  w.putLE32(length);
+  return w.overflow ? 0 : w.len;
+}
+
+#endif // KLIMERKO_GZIP_H
@@ -0,0 +1,220 @@
+/**
+ * @file integrity.h
+ * @brief Klimerko Integrity - table CRC32 and framed persistent records
+ * @version 7.0 Ultimate
+ *
+ * CRC32 (IEEE 802.3, same values as the former bitwise loop) is computed
+ * slicing-by-4: four 256-entry tables in flash, one 32-bit word per step.
+ * Crc32 gives a streaming interface for data that is not contiguous.
+ *
+ * Every fixed-size record that is persisted (EEPROM settings and
+ * statistics, history ring header, RTC snapshots) is a frame:
+ *
+ *   magic (4 B) | version (2 B) | length (2 B) | payload | crc32 (4 B)
+ *
+ * length counts the whole frame and the CRC covers everything before it,
+ * so a frame can be checked without knowing its payload type.
+ *
+ * Only <Arduino.h> is needed, so this can be tested on the host.
+ */
+
+#ifndef KLIMERKO_INTEGRITY_H
+#define KLIMERKO_INTEGRITY_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// CRC32
+// ============================================================================
+
+/**
+ * @brief Slicing-by-4 tables; t[0] is the classic byte table
+ */
+struct Crc32Tables {
+  uint32_t t[4][256];
+};
+
+constexpr Crc32Tables buildCrc32Tables() {
+  Crc32Tables tables = {};
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t c = i;
+    for (uint8_t k = 0; k < 8; k++) {
+      c = (c & 1) ? (c >> 1) ^ 0xEDB88320UL : c >> 1;
+    }
+    tables.t[0][i] = c;
+  }
+  for (uint32_t i = 0; i < 256; i++) {
+    for (uint8_t s = 1; s < 4; s++) {
+      uint32_t prev = tables.t[s - 1][i];
+      tables.t[s][i] = (prev >> 8) ^ tables.t[0][prev & 0xFF];
+    }
+  }
+  return tables;
+}
+
+static const Crc32Tables CRC32_TABLES PROGMEM = buildCrc32Tables();
+
+#define CRC32_T(s, i) pgm_read_dword(&CRC32_TABLES.t[s][i])
+
+/**
+ * @brief Advance a raw CRC state (start with 0xFFFFFFFF, finish with ~)
+ */
+inline uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length) {
+  // Bytes up to a word boundary, then whole words, then the tail
+  while (length && ((uintptr_t)data & 3)) {
+    crc = (crc >> 8) ^ CRC32_T(0, (crc ^ *data++) & 0xFF);
+    length--;
+  }
+  while (length >= 4) {
+    uint32_t word;
+    memcpy(&word, data, 4);  // Little-endian on ESP8266 and x86
+    crc ^= word;
+    crc = CRC32_T(3, crc & 0xFF) ^ CRC32_T(2, (crc >> 8) & 0xFF) ^
+          CRC32_T(1, (crc >> 16) & 0xFF) ^ CRC32_T(0, crc >> 24);
+    data += 4;
+    length -= 4;
+  }
+  while (length--) {
+    crc = (crc >> 8) ^ CRC32_T(0, (crc ^ *data++) & 0xFF);
+  }
+  return crc;
+}
+
+/**
+ * @brief Streaming CRC32
+ */
+class Crc32 {
+private:
+  uint32_t _state;
+
+public:
+  Crc32() : _state(0xFFFFFFFFUL) {}
+
+  Crc32& update(const void* data, size_t length) {
+    _state = crc32Update(_state, (const uint8_t*)data, length);
+    return *this;
+  }
+
+  uint32_t value() const { return ~_state; }
+  void reset() { _state = 0xFFFFFFFFUL; }
+};
+
+/**
+ * @brief CRC32 of one buffer
+ */
+inline uint32_t crc32(const void* data, size_t length) {
+  return ~crc32Update(0xFFFFFFFFUL, (const uint8_t*)data, length);
+}
+
+// ============================================================================
+// FRAMES
+// ============================================================================
+
+/**
+ * @brief Leading part of every frame
+ */
+struct FrameHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t length;    // Whole frame, header and CRC included
+};
+
+#define FRAME_OVERHEAD   (sizeof(FrameHeader) + sizeof(uint32_t))
+#define FRAME_MAX_SIZE   0xFFFF
+
+enum class FrameStatus : uint8_t {
+  OK,
+  SHORT,      // Fewer bytes than a frame (or than its length field)
+  MAGIC,      // Not this record type
+  VERSION,    // Known type, other layout
+  LENGTH,     // Length field impossible for this record
+  CRC         // Damaged (torn write, bit rot)
+};
+
+inline const char* frameStatusToString(FrameStatus status) {
+  switch (status) {
+    case FrameStatus::OK:      return "ok";
+    case FrameStatus::SHORT:   return "short";
+    case FrameStatus::MAGIC:   return "magic";
+    case FrameStatus::VERSION: return "version";
+    case FrameStatus::LENGTH:  return "length";
+    case FrameStatus::CRC:     return "crc";
+    default:                   return "unknown";
+  }
+}
+
+/**
+ * @brief Decoded frame, pointing into the checked buffer
+ */
+struct FrameView {
+  uint16_t version;
+  const uint8_t* payload;
+  uint16_t payloadLength;
+};
+
+/**
+ * @brief Write payload as a frame
+ * @return Frame length, 0 if it does not fit
+ */
+inline size_t frameEncode(uint8_t* out, size_t capacity, uint32_t magic, uint16_t version,
+                          const void* payload, size_t payloadLength) {
+  size_t total = payloadLength + FRAME_OVERHEAD;
+  if (total > capacity || total > FRAME_MAX_SIZE) return 0;
+  FrameHeader header = {magic, version, (uint16_t)total};
+  memcpy(out, &header, sizeof(header));
+  memmove(out + sizeof(header), payload, payloadLength);
+  uint32_t crc = crc32(out, total - sizeof(uint32_t));
+  memcpy(out + total - sizeof(uint32_t), &crc, sizeof(crc));
+  return total;
+}
+
+/**
+ * @brief Check the frame at the start of a buffer
+ * @param in Untrusted bytes
+ * @param available Bytes readable at in
+ * @param magic Expected record type
+ * @param view Set on OK (and on VERSION, so callers can migrate)
+ *
+ * Never reads past available, whatever the length field says.
+ */
+inline FrameStatus frameDecode(const uint8_t* in, size_t available, uint32_t magic, FrameView& view) {
+  FrameHeader header;
+  if (available < FRAME_OVERHEAD) return FrameStatus::SHORT;
+  memcpy(&header, in, sizeof(header));
+  if (header.magic != magic) return FrameStatus::MAGIC;
+  if (header.length < FRAME_OVERHEAD) return FrameStatus::LENGTH;
+  if (header.length > available) return FrameStatus::SHORT;
+
+  uint32_t stored;
+  memcpy(&stored, in + header.length - sizeof(uint32_t), sizeof(stored));
+  if (crc32(in, header.length - sizeof(uint32_t)) != stored) return FrameStatus::CRC;
+
+  view.version = header.version;
+  view.payload = in + sizeof(header);
+  view.payloadLength = header.length - FRAME_OVERHEAD;
+  return FrameStatus::OK;
+}
+
+/**
+ * @brief Seal a struct that starts with a FrameHeader and ends with its CRC
+ */
+inline void frameSeal(void* record, size_t size, uint32_t magic, uint16_t version) {
+  FrameHeader header = {magic, version, (uint16_t)size};
+  memcpy(record, &header, sizeof(header));
+  uint32_t crc = crc32(record, size - sizeof(uint32_t));
+  memcpy((uint8_t*)record + size - sizeof(uint32_t), &crc, sizeof(crc));
+}
+
+/**
+ * @brief Check a struct sealed with frameSeal()
+ */
+inline FrameStatus frameCheck(const void* record, size_t size, uint32_t magic, uint16_t version) {
+  FrameView view;
+  FrameStatus status = frameDecode((const uint8_t*)record, size, magic, view);
+  if (status != FrameStatus::OK) return status;
+  if (view.version != version) return FrameStatus::VERSION;
+  if (view.payloadLength != size - FRAME_OVERHEAD) return FrameStatus::LENGTH;
+  return FrameStatus::OK;
+}
+
+#endif // KLIMERKO_INTEGRITY_H
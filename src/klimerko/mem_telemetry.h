@@ -0,0 +1,193 @@
+/**
+ * @file mem_telemetry.h
+ * @brief Klimerko Memory Telemetry - heap fragmentation and stack high-water
+ * @version 7.0 Ultimate
+ *
+ * Free heap alone hides the usual ESP8266 failure: after days of String
+ * churn the largest free block collapses while plenty of heap is free.
+ * Tracked here, with minimums (fragmentation: maximum) since boot:
+ * - free heap, exact at every loop task boundary;
+ * - largest free block, re-measured at a task boundary when the free heap
+ *   changed, and at every boundary of one iteration per MEM_SAMPLE_MS.
+ *   Same-size free-then-allocate churn leaves the free heap unchanged, so
+ *   the shrink it causes is seen at the next sampled iteration, possibly
+ *   under a later task;
+ * - fragmentation percent, every MEM_SAMPLE_MS;
+ * - continuation stack high-water (ESP.getFreeContStack()).
+ *
+ * Attribution: around each loop task (stall_monitor.h) the heap delta is
+ * added to that task. The stack scan is slower, so it runs around every
+ * task of one loop() iteration per MEM_SAMPLE_MS; growth seen outside
+ * those iterations is counted under "none".
+ */
+
+#ifndef KLIMERKO_MEM_TELEMETRY_H
+#define KLIMERKO_MEM_TELEMETRY_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "stall_monitor.h"
+
+/**
+ * @brief Memory attributed to one loop task since boot
+ */
+struct MemTaskStats {
+  int32_t heapRetained;     // Net bytes allocated and kept (negative: freed)
+  uint32_t heapPeak;        // Largest net allocation of a single run
+  uint32_t blockDrop;       // Largest shrink of the largest free block in a single run
+  uint32_t stackGrowth;     // Stack high-water growth seen during its runs
+};
+
+/**
+ * @brief Heap and stack telemetry
+ */
+class MemTelemetry {
+private:
+  MemTaskStats _tasks[(uint8_t)LoopTask::COUNT];
+  LoopTask _task;
+  uint32_t _heapBefore;     // At the start of the running task
+  uint32_t _blockBefore;
+  uint32_t _stackBefore;
+  bool _sampling;           // Stack and largest block measured around every task of this iteration
+  unsigned long _lastSample;
+
+  uint32_t _heapFreeMin;
+  uint32_t _maxBlock;
+  uint32_t _maxBlockMin;
+  uint8_t _fragmentation;
+  uint8_t _fragmentationMax;
+  uint32_t _stackFree;
+
+  void finishTask() {
+    MemTaskStats& s = _tasks[(uint8_t)_task];
+    uint32_t heap = ESP.getFreeHeap();
+    bool heapChanged = heap != _heapBefore;
+    if (heapChanged) {
+      int32_t allocated = (int32_t)(_heapBefore - heap);
+      s.heapRetained += allocated;
+      if (allocated > 0) s.heapPeak = max(s.heapPeak, (uint32_t)allocated);
+      _heapFreeMin = min(_heapFreeMin, heap);
+      _heapBefore = heap;
+    }
+    // Freeing and reallocating the same size leaves the free heap as it was
+    // but can still split the largest block: sampled iterations always measure
+    if (heapChanged || _sampling) {
+      _maxBlock = ESP.getMaxFreeBlockSize();
+      if (_maxBlock < _blockBefore) s.blockDrop = max(s.blockDrop, _blockBefore - _maxBlock);
+      _maxBlockMin = min(_maxBlockMin, _maxBlock);
+      _blockBefore = _maxBlock;
+    }
+    if (_sampling) scanStack(s);
+  }
+
+  void scanStack(MemTaskStats& into) {
+    uint32_t free = ESP.getFreeContStack();
+    if (free < _stackBefore) into.stackGrowth += _stackBefore - free;
+    _stackBefore = free;
+    _stackFree = free;
+  }
+
+public:
+  MemTelemetry()
+    : _task(LoopTask::NONE), _heapBefore(0), _blockBefore(0), _stackBefore(0), _sampling(false),
+      _lastSample(0), _heapFreeMin(0), _maxBlock(0), _maxBlockMin(0), _fragmentation(0),
+      _fragmentationMax(0), _stackFree(0) {
+    memset(_tasks, 0, sizeof(_tasks));
+  }
+
+  /**
+   * @brief First sample (setup)
+   */
+  void begin() {
+    ESP.getHeapStats(&_heapBefore, &_maxBlock, &_fragmentation);
+    _heapFreeMin = _heapBefore;
+    _blockBefore = _maxBlockMin = _maxBlock;
+    _fragmentationMax = _fragmentation;
+    _stackBefore = _stackFree = ESP.getFreeContStack();
+    _lastSample = millis();
+  }
+
+  /**
+   * @brief Start of a loop() iteration
+   */
+  void loopStart() {
+    finishTask();  // Between iterations: "none"
+    _sampling = millis() - _lastSample >= MEM_SAMPLE_MS;
+    if (_sampling) {
+      _lastSample = millis();
+      scanStack(_tasks[(uint8_t)LoopTask::NONE]);
+    }
+    _task = LoopTask::NONE;
+  }
+
+  /**
+   * @brief Attribute the last task, start measuring the next
+   */
+  void enter(LoopTask task) {
+    finishTask();
+    _task = task;
+  }
+
+  /**
+   * @brief End of a loop() iteration (fragmentation on sampled ones)
+   */
+  void loopEnd() {
+    enter(LoopTask::NONE);
+    if (_sampling) {
+      uint32_t heap;
+      ESP.getHeapStats(&heap, &_maxBlock, &_fragmentation);
+      _fragmentationMax = max(_fragmentationMax, _fragmentation);
+    }
+  }
+
+  uint32_t heapFree() const { return ESP.getFreeHeap(); }
+  uint32_t heapFreeMin() const { return _heapFreeMin; }
+  uint32_t maxBlock() const { return _maxBlock; }
+  uint32_t maxBlockMin() const { return _maxBlockMin; }
+  uint8_t fragmentation() const { return _fragmentation; }
+  uint8_t fragmentationMax() const { return _fragmentationMax; }
+  uint32_t stackFree() const { return _stackFree; }  // High-water: already the minimum since boot
+  const MemTaskStats& task(uint8_t index) const { return _tasks[index]; }
+
+  /**
+   * @brief Task holding the most heap since boot
+   */
+  LoopTask topTask() const {
+    uint8_t top = 0;
+    for (uint8_t i = 1; i < (uint8_t)LoopTask::COUNT; i++) {
+      if (_tasks[i].heapRetained > _tasks[top].heapRetained) top = i;
+    }
+    return (LoopTask)top;
+  }
+
+  /**
+   * @brief Per-task attribution in Prometheus text format (pull only)
+   */
+  template <typename Out>
+  void writeExposition(Out& out, const char* device) const {
+    static const struct {
+      const char* name;
+      const char* help;
+    } SERIES[] = {
+      {"klimerko_task_heap_retained_bytes", "Heap allocated and kept per loop task since boot"},
+      {"klimerko_task_heap_peak_bytes", "Largest net allocation of one loop task run"},
+      {"klimerko_task_max_block_drop_bytes", "Largest shrink of the largest free block in one run"},
+      {"klimerko_task_stack_growth_bytes", "Stack high-water growth per loop task"},
+    };
+    for (uint8_t k = 0; k < 4; k++) {
+      out.printf("# HELP %s %s\n", SERIES[k].name, SERIES[k].help);
+      out.printf("# TYPE %s gauge\n", SERIES[k].name);
+      for (uint8_t i = 0; i < (uint8_t)LoopTask::COUNT; i++) {
+        const MemTaskStats& s = _tasks[i];
+        long value = k == 0 ? s.heapRetained : k == 1 ? (long)s.heapPeak
+                   : k == 2 ? (long)s.blockDrop : (long)s.stackGrowth;
+        out.printf("%s{device=\"%s\",task=\"%s\"} %ld\n", SERIES[k].name, device,
+                   loopTaskToString(i), value);
+      }
+    }
+  }
+};
+
+extern MemTelemetry memTelemetry;
+
+#endif // KLIMERKO_MEM_TELEMETRY_H
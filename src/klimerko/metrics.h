@@ -0,0 +1,592 @@
+/**
+ * @file metrics.h
+ * @brief Klimerko Prometheus Metrics - shared definitions, pull and push
+ * @version 7.0 Ultimate
+ *
+ * PROM_METRICS is the single list of exported metrics. It feeds:
+ * - /metrics pull scrapes (text exposition, streamed in chunks)
+ * - Pushgateway push (same text, PUT every PROM_PUSH_INTERVAL_SEC)
+ * - remote-write push: snapshots are buffered and sent PROM_PUSH_BATCH at
+ *   a time as a snappy-compressed protobuf WriteRequest
+ *
+ * Push mode is for devices behind NAT that Prometheus cannot scrape.
+ * It is configured with the "prometheus" object of the "sinks" command.
+ */
+
+#ifndef KLIMERKO_METRICS_H
+#define KLIMERKO_METRICS_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <ESP8266HTTPClient.h>
+#include "config.h"
+#include "types.h"
+#include "utils.h"
+#include "sinks.h"
+#include "settings_journal.h"
+#include "stats_store.h"
+#include "stall_monitor.h"
+#include "mem_telemetry.h"
+#include "snappy.h"
+
+extern SensorData sensorData;
+extern Statistics stats;
+extern char klimerkoID[32];
+extern bool ntpSynced;
+extern bool alarmTriggered;
+extern unsigned long bootTime;
+
+inline uint8_t sseClientCount();  // web_dashboard.h
+
+// ============================================================================
+// METRIC DEFINITIONS
+// ============================================================================
+
+enum class PromType : uint8_t {
+  GAUGE = 0,
+  COUNTER = 1
+};
+
+/**
+ * @brief One exported metric (one series, or one per label value)
+ */
+struct PromMetric {
+  const char* name;
+  const char* help;
+  PromType type;
+  uint8_t decimals;
+  double (*value)(uint8_t index);
+  uint8_t series;                            // Series count (1 = unlabelled)
+  const char* label;                         // Extra label name, or nullptr
+  const char* (*labelValue)(uint8_t index);
+};
+
+inline const char* promSinkName(uint8_t i) { return sinks[i]->name(); }
+inline const char* promHandshakeType(uint8_t i) { return i == 0 ? "full" : "resumed"; }
+
+static constexpr PromMetric PROM_METRICS[] PROGMEM = {
+  // Sensor metrics
+  {"klimerko_pm1", "PM1.0 concentration in µg/m³", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return sensorData.pm1; }, 1, nullptr, nullptr},
+  {"klimerko_pm25", "PM2.5 concentration in µg/m³", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return sensorData.pm25; }, 1, nullptr, nullptr},
+  {"klimerko_pm10", "PM10 concentration in µg/m³", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return sensorData.pm10; }, 1, nullptr, nullptr},
+  {"klimerko_pm25_corrected", "Humidity-corrected PM2.5 in µg/m³", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return sensorData.pm25_corrected; }, 1, nullptr, nullptr},
+  {"klimerko_pm10_corrected", "Humidity-corrected PM10 in µg/m³", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return sensorData.pm10_corrected; }, 1, nullptr, nullptr},
+  {"klimerko_temperature", "Temperature in Celsius", PromType::GAUGE, 2,
+   [](uint8_t) -> double { return sensorData.temperature; }, 1, nullptr, nullptr},
+  {"klimerko_humidity", "Relative humidity in percent", PromType::GAUGE, 2,
+   [](uint8_t) -> double { return sensorData.humidity; }, 1, nullptr, nullptr},
+  {"klimerko_pressure", "Atmospheric pressure in hPa", PromType::GAUGE, 2,
+   [](uint8_t) -> double { return sensorData.pressure; }, 1, nullptr, nullptr},
+  {"klimerko_heat_index", "Heat index in Celsius", PromType::GAUGE, 2,
+   [](uint8_t) -> double { return sensorData.heatIndex; }, 1, nullptr, nullptr},
+  {"klimerko_dewpoint", "Dewpoint temperature in Celsius", PromType::GAUGE, 2,
+   [](uint8_t) -> double { return sensorData.dewpoint; }, 1, nullptr, nullptr},
+
+  // System metrics
+  {"klimerko_wifi_rssi", "WiFi signal strength in dBm", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return WiFi.isConnected() ? WiFi.RSSI() : 0; }, 1, nullptr, nullptr},
+  {"klimerko_uptime_seconds", "Device uptime in seconds", PromType::COUNTER, 0,
+   [](uint8_t) -> double { return getUptimeSeconds(bootTime); }, 1, nullptr, nullptr},
+  {"klimerko_boot_count", "Number of device boots", PromType::COUNTER, 0,
+   [](uint8_t) -> double { return stats.bootCount; }, 1, nullptr, nullptr},
+  {"klimerko_heap_free", "Free heap memory in bytes", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return ESP.getFreeHeap(); }, 1, nullptr, nullptr},
+  {"klimerko_heap_free_min_bytes", "Lowest free heap since boot", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return memTelemetry.heapFreeMin(); }, 1, nullptr, nullptr},
+  {"klimerko_heap_max_block_bytes", "Largest free heap block", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return memTelemetry.maxBlock(); }, 1, nullptr, nullptr},
+  {"klimerko_heap_max_block_min_bytes", "Smallest largest free block since boot", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return memTelemetry.maxBlockMin(); }, 1, nullptr, nullptr},
+  {"klimerko_heap_fragmentation_percent", "Heap fragmentation", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return memTelemetry.fragmentation(); }, 1, nullptr, nullptr},
+  {"klimerko_heap_fragmentation_max_percent", "Highest heap fragmentation since boot", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return memTelemetry.fragmentationMax(); }, 1, nullptr, nullptr},
+  {"klimerko_stack_free_min_bytes", "Loop stack never used since boot (high-water)", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return memTelemetry.stackFree(); }, 1, nullptr, nullptr},
+  {"klimerko_publishes_total", "Total successful MQTT publishes", PromType::COUNTER, 0,
+   [](uint8_t) -> double { return stats.successfulPublishes; }, 1, nullptr, nullptr},
+  {"klimerko_publishes_failed", "Total failed MQTT publishes", PromType::COUNTER, 0,
+   [](uint8_t) -> double { return stats.failedPublishes; }, 1, nullptr, nullptr},
+
+  // Per-sink delivery counters
+  {"klimerko_sink_sent_total", "Samples delivered per sink", PromType::COUNTER, 0,
+   [](uint8_t i) -> double { return sinks[i]->sent(); }, SINK_COUNT, "sink", promSinkName},
+  {"klimerko_sink_failed_total", "Failed delivery attempts per sink", PromType::COUNTER, 0,
+   [](uint8_t i) -> double { return sinks[i]->failed(); }, SINK_COUNT, "sink", promSinkName},
+  {"klimerko_sink_dropped_total", "Samples dropped from a full sink queue", PromType::COUNTER, 0,
+   [](uint8_t i) -> double { return sinks[i]->dropped(); }, SINK_COUNT, "sink", promSinkName},
+  {"klimerko_sink_queued", "Samples waiting per sink", PromType::GAUGE, 0,
+   [](uint8_t i) -> double { return sinks[i]->queued(); }, SINK_COUNT, "sink", promSinkName},
+
+  {"klimerko_wifi_reconnects", "Total WiFi reconnection attempts", PromType::COUNTER, 0,
+   [](uint8_t) -> double { return stats.wifiReconnects; }, 1, nullptr, nullptr},
+  {"klimerko_mqtt_reconnects", "Total MQTT reconnection attempts", PromType::COUNTER, 0,
+   [](uint8_t) -> double { return stats.mqttReconnects; }, 1, nullptr, nullptr},
+  {"klimerko_mqtt_inflight", "QoS 1 publishes awaiting PUBACK", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return mqtt.inflightCount(); }, 1, nullptr, nullptr},
+  {"klimerko_mqtt_tls_handshakes_total", "MQTT TLS handshakes by type", PromType::COUNTER, 0,
+   [](uint8_t i) -> double { return i == 0 ? mqttTls.fullHandshakes() : mqttTls.resumedHandshakes(); },
+   2, "type", promHandshakeType},
+  {"klimerko_mqtt_tls_handshake_ms", "Duration of the last MQTT TLS handshake", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return mqttTls.handshakeMs(); }, 1, nullptr, nullptr},
+  {"klimerko_mqtt_tls_heap_bytes", "Heap taken by the MQTT TLS connection", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return mqttTls.heapUsed(); }, 1, nullptr, nullptr},
+  {"klimerko_alarm_triggered", "Alarm currently triggered (1=yes, 0=no)", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return alarmTriggered ? 1 : 0; }, 1, nullptr, nullptr},
+  {"klimerko_sse_clients", "Connected dashboard event streams", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return sseClientCount(); }, 1, nullptr, nullptr},
+  {"klimerko_ntp_synced", "NTP time synchronized (1=yes, 0=no)", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return ntpSynced ? 1 : 0; }, 1, nullptr, nullptr},
+
+  // Settings persistence
+  {"klimerko_flash_erases_total", "EEPROM sector erases since boot", PromType::COUNTER, 0,
+   [](uint8_t) -> double { return settingsJournal.eepromErases(); }, 1, nullptr, nullptr},
+  {"klimerko_settings_journal_appends_total", "Settings commits appended to the journal", PromType::COUNTER, 0,
+   [](uint8_t) -> double { return settingsJournal.appends(); }, 1, nullptr, nullptr},
+  {"klimerko_settings_coalesced_total", "Setting updates merged into a pending commit", PromType::COUNTER, 0,
+   [](uint8_t) -> double { return settingsJournal.coalesced(); }, 1, nullptr, nullptr},
+  {"klimerko_settings_journal_bytes", "Settings journal size", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return settingsJournal.journalBytes(); }, 1, nullptr, nullptr},
+  {"klimerko_stats_checkpoints_total", "Statistics checkpoints written to flash", PromType::COUNTER, 0,
+   [](uint8_t) -> double { return statsStore.checkpoints(); }, 1, nullptr, nullptr},
+
+  // Main loop (latency quantiles are pull only, stall_monitor.h)
+  {"klimerko_loop_max_seconds", "Longest loop() iteration since boot", PromType::GAUGE, 6,
+   [](uint8_t) -> double { return stallMonitor.loopMaxUs() / 1e6; }, 1, nullptr, nullptr},
+  {"klimerko_loop_stalls_total", "loop() iterations longer than STALL_WARN_MS", PromType::COUNTER, 0,
+   [](uint8_t) -> double { return stallMonitor.stalls(); }, 1, nullptr, nullptr},
+
+  // Particle counts
+  {"klimerko_particle_count_0_3", "Particle count >0.3µm per 0.1L", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return sensorData.count_0_3; }, 1, nullptr, nullptr},
+  {"klimerko_particle_count_2_5", "Particle count >2.5µm per 0.1L", PromType::GAUGE, 0,
+   [](uint8_t) -> double { return sensorData.count_2_5; }, 1, nullptr, nullptr},
+};
+
+#define PROM_METRIC_COUNT (sizeof(PROM_METRICS) / sizeof(PROM_METRICS[0]))
+
+/**
+ * @brief Total series over all metrics (one per label value)
+ */
+constexpr size_t promSeriesCount() {
+  size_t count = 0;
+  for (size_t m = 0; m < PROM_METRIC_COUNT; m++) count += PROM_METRICS[m].series;
+  return count;
+}
+
+static_assert(promSeriesCount() <= PROM_SERIES_MAX, "PROM_METRICS has more series than PROM_SERIES_MAX");
+
+/**
+ * @brief Copy of one metric definition out of flash
+ */
+inline PromMetric promMetric(size_t m) {
+  PromMetric metric;
+  memcpy_P(&metric, &PROM_METRICS[m], sizeof(metric));
+  return metric;
+}
+
+// ============================================================================
+// TEXT EXPOSITION
+// ============================================================================
+
+/**
+ * @brief Write all metrics in Prometheus text format
+ * @param out Any writer with printf() (chunked HTTP response, push buffer)
+ * @param withHelp Include # HELP lines (omitted for push to save space)
+ */
+template <typename Out>
+void writePromExposition(Out& out, bool withHelp) {
+  for (size_t m = 0; m < PROM_METRIC_COUNT; m++) {
+    const PromMetric metric = promMetric(m);
+    if (withHelp) out.printf("# HELP %s %s\n", metric.name, metric.help);
+    out.printf("# TYPE %s %s\n", metric.name, metric.type == PromType::COUNTER ? "counter" : "gauge");
+    for (uint8_t i = 0; i < metric.series; i++) {
+      if (metric.label) {
+        out.printf("%s{device=\"%s\",%s=\"%s\"} %.*f\n", metric.name, klimerkoID,
+                   metric.label, metric.labelValue(i), metric.decimals, metric.value(i));
+      } else {
+        out.printf("%s{device=\"%s\"} %.*f\n", metric.name, klimerkoID,
+                   metric.decimals, metric.value(i));
+      }
+    }
+  }
+}
+
+/**
+ * @brief printf() target over a fixed buffer (sets overflow when full)
+ */
+struct PromTextBuffer {
+  char* buf;
+  size_t capacity;
+  size_t len;
+  bool overflow;
+
+  PromTextBuffer(char* buffer, size_t size) : buf(buffer), capacity(size), len(0), overflow(false) {}
+
+  void printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    if (overflow) return;
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf + len, capacity - len, fmt, args);
+    va_end(args);
+    if (n < 0 || (size_t)n >= capacity - len) {
+      overflow = true;
+      return;
+    }
+    len += n;
+  }
+};
+
+// ============================================================================
+// REMOTE-WRITE ENCODING (prometheus.WriteRequest)
+// ============================================================================
+
+/**
+ * @brief One snapshot value in 4 bytes
+ *
+ * Counters are whole uint32 values and stay exact (a float would round
+ * them above 2^24, e.g. uptime past ~194 days); gauges fit a float.
+ */
+union PromValue {
+  float gauge;
+  uint32_t counter;
+};
+
+/**
+ * @brief Snapshots of every series, oldest first
+ */
+struct PromSnapshots {
+  uint32_t timestamp[PROM_PUSH_BATCH];      // Unix seconds
+  PromValue values[PROM_PUSH_BATCH][PROM_SERIES_MAX];
+  uint8_t head;
+  uint8_t count;
+  uint8_t series;
+
+  uint8_t slot(uint8_t i) const { return (head + i) % PROM_PUSH_BATCH; }
+
+  void take(uint32_t ts) {
+    if (count == PROM_PUSH_BATCH) {
+      head = (head + 1) % PROM_PUSH_BATCH;  // Overwrite the oldest
+      count--;
+    }
+    uint8_t s = slot(count);
+    timestamp[s] = ts;
+    series = 0;
+    for (size_t m = 0; m < PROM_METRIC_COUNT; m++) {
+      const PromMetric metric = promMetric(m);
+      for (uint8_t i = 0; i < metric.series; i++) {
+        PromValue& v = values[s][series++];
+        if (metric.type == PromType::COUNTER) v.counter = (uint32_t)metric.value(i);
+        else v.gauge = metric.value(i);
+      }
+    }
+    count++;
+  }
+
+  void drop(uint8_t n) {
+    n = min(n, count);
+    head = (head + n) % PROM_PUSH_BATCH;
+    count -= n;
+  }
+};
+
+constexpr size_t pbVarintSize(uint64_t v) {
+  size_t n = 1;
+  while (v >= 0x80) {
+    v >>= 7;
+    n++;
+  }
+  return n;
+}
+
+constexpr size_t pbFieldSize(size_t payload) {
+  return 1 + pbVarintSize(payload) + payload;
+}
+
+/**
+ * @brief Bounded protobuf writer
+ */
+struct PbWriter {
+  uint8_t* buf;
+  size_t capacity;
+  size_t len;
+
+  PbWriter(uint8_t* buffer, size_t size) : buf(buffer), capacity(size), len(0) {}
+
+  void put(uint8_t b) {
+    if (len < capacity) buf[len++] = b;
+  }
+
+  void putVarint(uint64_t v) {
+    while (v >= 0x80) {
+      put(v | 0x80);
+      v >>= 7;
+    }
+    put(v);
+  }
+
+  void putHeader(uint8_t field, size_t length) {
+    put((field << 3) | 2);
+    putVarint(length);
+  }
+
+  void putString(uint8_t field, const char* s) {
+    size_t n = strlen(s);
+    putHeader(field, n);
+    for (size_t i = 0; i < n; i++) put(s[i]);
+  }
+
+  void putDouble(uint8_t field, double v) {
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    put((field << 3) | 1);
+    for (uint8_t i = 0; i < 8; i++) put(bits >> (8 * i));
+  }
+};
+
+constexpr size_t promLabelSize(size_t nameLength, size_t valueLength) {
+  return pbFieldSize(nameLength) + pbFieldSize(valueLength);
+}
+
+inline size_t promLabelSize(const char* name, const char* value) {
+  return promLabelSize(strlen(name), strlen(value));
+}
+
+constexpr size_t promSampleSize(uint64_t timestampMs) {
+  return 9 + 1 + pbVarintSize(timestampMs);
+}
+
+constexpr size_t promLength(const char* s) {
+  size_t n = 0;
+  while (s[n]) n++;
+  return n;
+}
+
+/**
+ * @brief Largest WriteRequest n snapshots can encode to
+ *
+ * Worst case per series: a 31-character device ID, label values of
+ * PROM_LABEL_VALUE_MAX characters and millisecond timestamps up to
+ * 2^42 (year 2109).
+ */
+constexpr size_t promWriteRequestBound(uint8_t n) {
+  size_t total = 0;
+  for (size_t m = 0; m < PROM_METRIC_COUNT; m++) {
+    const PromMetric& metric = PROM_METRICS[m];
+    size_t series = pbFieldSize(promLabelSize(8, promLength(metric.name))) +
+                    pbFieldSize(promLabelSize(6, sizeof(klimerkoID) - 1)) +
+                    n * pbFieldSize(promSampleSize((1ULL << 42) - 1));
+    if (metric.label) series += pbFieldSize(promLabelSize(promLength(metric.label), PROM_LABEL_VALUE_MAX));
+    total += metric.series * pbFieldSize(series);
+  }
+  return total;
+}
+
+static constexpr size_t PROM_WRITE_REQUEST_MAX = promWriteRequestBound(PROM_PUSH_BATCH);
+static_assert(PROM_WRITE_REQUEST_MAX <= PROM_WRITE_BUFFER_MAX,
+              "PROM_PUSH_BATCH snapshots exceed PROM_WRITE_BUFFER_MAX: lower the batch or raise the cap");
+
+/**
+ * @brief Size of one TimeSeries message with n samples
+ */
+inline size_t promSeriesSize(const PromMetric& metric, uint8_t index,
+                             const PromSnapshots& snaps, uint8_t n) {
+  size_t size = pbFieldSize(promLabelSize("__name__", metric.name)) +
+                pbFieldSize(promLabelSize("device", klimerkoID));
+  if (metric.label) size += pbFieldSize(promLabelSize(metric.label, metric.labelValue(index)));
+  for (uint8_t k = 0; k < n; k++) {
+    size += pbFieldSize(promSampleSize((uint64_t)snaps.timestamp[snaps.slot(k)] * 1000));
+  }
+  return size;
+}
+
+/**
+ * @brief Encode the oldest n snapshots as a WriteRequest
+ * @return Encoded length, 0 if it does not fit
+ */
+inline size_t encodePromWriteRequest(const PromSnapshots& snaps, uint8_t n,
+                                     uint8_t* buffer, size_t size) {
+  size_t total = 0;
+  for (size_t m = 0; m < PROM_METRIC_COUNT; m++) {
+    const PromMetric metric = promMetric(m);
+    for (uint8_t i = 0; i < metric.series; i++) {
+      total += pbFieldSize(promSeriesSize(metric, i, snaps, n));
+    }
+  }
+  if (total > size) return 0;
+
+  PbWriter w(buffer, size);
+  uint8_t column = 0;
+  for (size_t m = 0; m < PROM_METRIC_COUNT; m++) {
+    const PromMetric metric = promMetric(m);
+    for (uint8_t i = 0; i < metric.series; i++, column++) {
+      w.putHeader(1, promSeriesSize(metric, i, snaps, n));
+
+      // Labels sorted by name: __name__ < device < metric label (sink, type)
+      w.putHeader(1, promLabelSize("__name__", metric.name));
+      w.putString(1, "__name__");
+      w.putString(2, metric.name);
+      w.putHeader(1, promLabelSize("device", klimerkoID));
+      w.putString(1, "device");
+      w.putString(2, klimerkoID);
+      if (metric.label) {
+        w.putHeader(1, promLabelSize(metric.label, metric.labelValue(i)));
+        w.putString(1, metric.label);
+        w.putString(2, metric.labelValue(i));
+      }
+
+      for (uint8_t k = 0; k < n; k++) {
+        uint8_t s = snaps.slot(k);
+        uint64_t ms = (uint64_t)snaps.timestamp[s] * 1000;
+        w.putHeader(2, promSampleSize(ms));
+        const PromValue& v = snaps.values[s][column];
+        w.putDouble(1, metric.type == PromType::COUNTER ? (double)v.counter : (double)v.gauge);
+        w.put(2 << 3);
+        w.putVarint(ms);
+      }
+    }
+  }
+  return w.len;
+}
+
+// ============================================================================
+// PUSH LOOP
+// ============================================================================
+
+/**
+ * @brief Periodic snapshots and pushes to a remote-write receiver or Pushgateway
+ */
+class PromPusher {
+private:
+  PromSnapshots _snaps;
+  WiFiClient _net;
+  HTTPClient _http;
+  unsigned long _lastSnapshot;
+  unsigned long _lastFailure;
+  unsigned long _retryDelay;
+  uint32_t _pushed;
+  uint32_t _failed;
+
+  PromPushMode mode() const { return sinkConfig.promMode; }
+
+  bool post(const char* url, const char* contentType, const uint8_t* body, size_t len,
+            bool snappy) {
+    _http.setTimeout(SINK_TIMEOUT_MS);
+    if (!_http.begin(_net, url)) return false;
+    _http.addHeader(F("Content-Type"), contentType);
+    if (snappy) {
+      _http.addHeader(F("Content-Encoding"), F("snappy"));
+      _http.addHeader(F("X-Prometheus-Remote-Write-Version"), F("0.1.0"));
+    }
+    int code = snappy ? _http.POST(body, len) : _http.PUT(body, len);
+    _http.end();
+    if (code < 200 || code >= 300) {
+      DEBUG_PRINTF("[PROM] Push HTTP %d\n", code);
+      return false;
+    }
+    return true;
+  }
+
+  bool pushRemoteWrite() {
+    uint8_t* buffer = (uint8_t*)malloc(PROM_WRITE_REQUEST_MAX + PROM_PUSH_PACKED);
+    if (!buffer) return false;
+    uint8_t* packed = buffer + PROM_WRITE_REQUEST_MAX;
+
+    // Send as many snapshots as fit both buffers; the rest go next time
+    uint8_t n = _snaps.count;
+    size_t length = 0;
+    size_t packedLength = 0;
+    for (; n > 0; n--) {
+      length = encodePromWriteRequest(_snaps, n, buffer, PROM_WRITE_REQUEST_MAX);
+      if (length) packedLength = snappyCompress(buffer, length, packed, PROM_PUSH_PACKED);
+      if (packedLength) break;
+    }
+    if (n == 0 && _snaps.count) {
+      // Not even one snapshot fits (label values too long, incompressible): never will
+      DEBUG_PRINTF("[PROM] Snapshot does not fit (%u bytes), dropped\n", (unsigned)length);
+      _snaps.drop(1);
+      free(buffer);
+      return false;
+    }
+
+    bool ok = packedLength > 0 &&
+              post(sinkConfig.promUrl, "application/x-protobuf", packed, packedLength, true);
+    free(buffer);
+    if (ok) {
+      DEBUG_PRINTF("[PROM] Pushed %u snapshots, %u -> %u bytes\n", n, (unsigned)length, (unsigned)packedLength);
+      _snaps.drop(n);
+    }
+    return ok;
+  }
+
+  bool pushGateway() {
+    char* buffer = (char*)malloc(PROM_PUSH_BUFFER);
+    if (!buffer) return false;
+    PromTextBuffer text(buffer, PROM_PUSH_BUFFER);
+    writePromExposition(text, false);
+
+    char url[sizeof(sinkConfig.promUrl) + 64];
+    snprintf(url, sizeof(url), "%s/metrics/job/klimerko/instance/%s", sinkConfig.promUrl, klimerkoID);
+    bool ok = !text.overflow &&
+              post(url, "text/plain; version=0.0.4", (const uint8_t*)buffer, text.len, false);
+    free(buffer);
+    return ok;
+  }
+
+public:
+  PromPusher() : _lastSnapshot(0), _lastFailure(0), _retryDelay(0), _pushed(0), _failed(0) {
+    _snaps.head = 0;
+    _snaps.count = 0;
+    _snaps.series = 0;
+    _http.setReuse(true);
+  }
+
+  /**
+   * @brief Take snapshots and push when due (call in loop)
+   */
+  void loop() {
+    if (mode() == PromPushMode::OFF || sinkConfig.promUrl[0] == '\0') return;
+
+    unsigned long now = millis();
+    bool due = now - _lastSnapshot >= sinkConfig.promIntervalSec * 1000UL;
+    if (due) {
+      _lastSnapshot = now;
+      // Remote-write needs real sample times; wait for NTP
+      if (mode() == PromPushMode::REMOTE_WRITE && ntpSynced) _snaps.take(time(nullptr));
+    }
+
+    if (WiFi.status() != WL_CONNECTED) return;
+    if (_retryDelay && now - _lastFailure < _retryDelay) return;
+
+    bool ok;
+    if (mode() == PromPushMode::REMOTE_WRITE) {
+      if (_snaps.count < min(sinkConfig.promBatch, (uint8_t)PROM_PUSH_BATCH) &&
+          !(_retryDelay && _snaps.count)) return;
+      ok = pushRemoteWrite();
+    } else {
+      if (!due && !_retryDelay) return;
+      ok = pushGateway();
+    }
+
+    if (ok) {
+      _pushed++;
+      _retryDelay = 0;
+    } else {
+      _failed++;
+      _lastFailure = millis();
+      _retryDelay = _retryDelay ? min(_retryDelay * 2, SINK_BACKOFF_MAX_MS) : SINK_BACKOFF_MIN_MS;
+    }
+  }
+
+  uint32_t pushed() const { return _pushed; }
+  uint32_t failed() const { return _failed; }
+};
+
+extern PromPusher promPusher;
+
+#endif // KLIMERKO_METRICS_H
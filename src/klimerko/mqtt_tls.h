@@ -0,0 +1,244 @@
+/**
+ * @file mqtt_tls.h
+ * @brief Klimerko MQTT over TLS - BearSSL client with session resumption
+ * @version 7.0 Ultimate
+ *
+ * Optional TLS transport for the main MQTT connection (device token is the
+ * MQTT username, so plain TCP sends it in clear text):
+ * - Server authentication by pinned SHA-1 certificate fingerprint, or by a
+ *   CA / server certificate stored as PEM in MQTT_TLS_CA_PATH. With neither
+ *   the link is encrypted but not authenticated (logged at connect).
+ * - The BearSSL session is kept across reconnects, so only the first
+ *   connect pays for the full (public-key) handshake; later ones resume.
+ * - Max Fragment Length support is probed once per broker. When the broker
+ *   honours it, the receive buffer shrinks from 16 KB to MQTT_TLS_MFLN.
+ * - The connection goes to the address network.h already resolved (async
+ *   lookup, DNS cache, last known address), never through another blocking
+ *   lookup. BearSSL only learns the broker name from connect(name), so
+ *   connecting by address sends no SNI: a broker that picks its
+ *   certificate by SNI has to serve the right one by default. With a CA
+ *   pinned the name is always checked; the last known address alone is
+ *   not enough for that, so such an attempt fails and backs off.
+ *
+ * Settings are kept in MQTT_TLS_FILE_PATH and set with the "mqtt-broker"
+ * command ({"tls": true, "fingerprint": "AB:CD:..."}).
+ */
+
+#ifndef KLIMERKO_MQTT_TLS_H
+#define KLIMERKO_MQTT_TLS_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <WiFiClientSecure.h>
+#include <LittleFS.h>
+#include <lwip/dns.h>
+#include "config.h"
+#include "../ArduinoJson-v6.18.5.h"
+
+#define MQTT_TLS_FINGERPRINT_SIZE  60   // 40 hex digits plus separators
+
+/**
+ * @brief TLS transport, pinning and handshake statistics for the MQTT link
+ */
+class MqttTls {
+private:
+  BearSSL::WiFiClientSecure _client;
+  BearSSL::Session _session;
+  BearSSL::X509List* _trustAnchors;
+  bool _enabled;
+  char _fingerprint[MQTT_TLS_FINGERPRINT_SIZE];
+  bool _probed;
+  bool _mfln;
+  uint16_t _handshakeMs;
+  uint32_t _heapUsed;
+  bool _resumed;
+  uint32_t _fullHandshakes;
+  uint32_t _resumedHandshakes;
+
+  static bool sessionEmpty(const BearSSL::Session& session) {
+    const uint8_t* p = (const uint8_t*)&session;
+    for (size_t i = 0; i < sizeof(session); i++) {
+      if (p[i]) return false;
+    }
+    return true;
+  }
+
+  void loadTrustAnchors() {
+    delete _trustAnchors;
+    _trustAnchors = nullptr;
+    File f = LittleFS.open(MQTT_TLS_CA_PATH, "r");
+    if (!f) return;
+    size_t size = f.size();
+    char* pem = (char*)malloc(size + 1);
+    if (pem) {
+      size_t n = f.readBytes(pem, size);
+      pem[n] = '\0';
+      _trustAnchors = new BearSSL::X509List(pem);
+      free(pem);
+      DEBUG_PRINTF("[TLS] Trust anchor loaded (%u B PEM)\n", (unsigned)size);
+    }
+    f.close();
+  }
+
+  void configureTrust() {
+    if (_fingerprint[0]) {
+      _client.setFingerprint(_fingerprint);
+    } else if (_trustAnchors) {
+      _client.setTrustAnchors(_trustAnchors);
+    } else {
+      _client.setInsecure();
+      DEBUG_PRINTLN(F("[TLS] Warning: no fingerprint or CA, server not verified"));
+    }
+  }
+
+public:
+  MqttTls() : _trustAnchors(nullptr), _enabled(false), _probed(false), _mfln(false),
+              _handshakeMs(0), _heapUsed(0), _resumed(false),
+              _fullHandshakes(0), _resumedHandshakes(0) {
+    _fingerprint[0] = '\0';
+  }
+
+  bool enabled() const { return _enabled; }
+  Client& client() { return _client; }
+  bool mflnSupported() const { return _mfln; }
+  uint16_t handshakeMs() const { return _handshakeMs; }
+  uint32_t heapUsed() const { return _heapUsed; }
+  bool resumed() const { return _resumed; }
+  uint32_t fullHandshakes() const { return _fullHandshakes; }
+  uint32_t resumedHandshakes() const { return _resumedHandshakes; }
+
+  /**
+   * @brief Forget the session and MFLN probe (broker changed)
+   */
+  void reset() {
+    _session = BearSSL::Session();
+    _probed = false;
+    _mfln = false;
+  }
+
+  /**
+   * @brief Apply settings from the mqtt-broker command
+   * @return true if anything TLS related changed
+   */
+  bool configure(JsonObjectConst cfg) {
+    bool changed = false;
+    if (cfg.containsKey("tls")) {
+      bool enabled = cfg["tls"].as<bool>();
+      changed |= enabled != _enabled;
+      _enabled = enabled;
+    }
+    if (cfg.containsKey("fingerprint")) {
+      const char* fp = cfg["fingerprint"] | "";
+      changed |= strcmp(fp, _fingerprint) != 0;
+      strncpy(_fingerprint, fp, sizeof(_fingerprint) - 1);
+      _fingerprint[sizeof(_fingerprint) - 1] = '\0';
+    }
+    if (changed) reset();
+    return changed;
+  }
+
+  void save() {
+    StaticJsonDocument<128> doc;
+    doc["tls"] = _enabled;
+    doc["fingerprint"] = _fingerprint;
+    File f = LittleFS.open(MQTT_TLS_FILE_PATH, "w");
+    if (!f) {
+      DEBUG_PRINTLN(F("[TLS] Cannot save config"));
+      return;
+    }
+    serializeJson(doc, f);
+    f.close();
+  }
+
+  /**
+   * @brief Load settings and trust anchor (after LittleFS is mounted)
+   */
+  void begin() {
+    loadTrustAnchors();
+    File f = LittleFS.open(MQTT_TLS_FILE_PATH, "r");
+    if (!f) return;
+    StaticJsonDocument<128> doc;
+    DeserializationError err = deserializeJson(doc, f);
+    f.close();
+    if (err) {
+      DEBUG_PRINTLN(F("[TLS] Invalid config file, TLS disabled"));
+      return;
+    }
+    configure(doc.as<JsonObjectConst>());
+    DEBUG_PRINTF("[TLS] %s, %s\n", _enabled ? "enabled" : "disabled",
+                 _fingerprint[0] ? "fingerprint pinned" : (_trustAnchors ? "CA pinned" : "not pinned"));
+  }
+
+  static void dnsIgnored(const char*, const ip_addr_t*, void*) {}
+
+  /**
+   * @brief Whether the broker name is available to BearSSL without waiting on DNS
+   *
+   * BearSSL takes the name solely through connect(name), which looks it up
+   * again with WiFi.hostByName(); that returns at once for an address
+   * literal or when lwIP's table holds the answer (the usual case right
+   * after mqttDnsStart()), but not after a failed lookup, when network.h
+   * falls back to the last known address.
+   */
+  static bool nameResolved(const char* host) {
+    IPAddress literal;
+    if (literal.fromString(host)) return true;
+    ip_addr_t addr;
+    return dns_gethostbyname(host, &addr, dnsIgnored, nullptr) == ERR_OK;
+  }
+
+  /**
+   * @brief Open the TCP connection and run the TLS handshake
+   * @param host Broker name (checked against a CA-verified certificate;
+   *             with a CA pinned, fails unless the name resolves at once)
+   * @param ip Already resolved broker address
+   * @param port Broker TLS port
+   * @return true if the TLS session is up
+   */
+  bool connect(const char* host, IPAddress ip, uint16_t port) {
+    // CA verification only means something with the name checked: by address,
+    // any certificate from that CA would pass. Fail and let a fresh lookup retry.
+    bool checkName = _trustAnchors && !_fingerprint[0];
+    if (checkName && !nameResolved(host)) {
+      DEBUG_PRINTLN(F("[TLS] Broker name not resolved, cannot check the certificate"));
+      return false;
+    }
+    if (!_probed) {
+      _mfln = BearSSL::WiFiClientSecure::probeMaxFragmentLength(ip, port, MQTT_TLS_MFLN);
+      _probed = true;
+      DEBUG_PRINTF("[TLS] Max fragment length %u %s\n", MQTT_TLS_MFLN,
+                   _mfln ? "supported" : "not supported, using 16 KB buffer");
+    }
+    _client.setBufferSizes(_mfln ? MQTT_TLS_MFLN : 16384, MQTT_TLS_TX_BUFFER);
+    configureTrust();
+    _client.setSession(&_session);
+    _client.setTimeout(MQTT_TCP_TIMEOUT_MS);
+
+    // A resumed session keeps its id and master secret; a full handshake replaces them
+    BearSSL::Session previous = _session;
+    uint32_t heapBefore = ESP.getFreeHeap();
+    unsigned long start = millis();
+    bool ok = checkName ? _client.connect(host, port) : _client.connect(ip, port);
+    _handshakeMs = millis() - start;
+
+    if (!ok) {
+      char error[64];
+      int code = _client.getLastSSLError(error, sizeof(error));
+      DEBUG_PRINTF("[TLS] Handshake failed (%d): %s\n", code, error);
+      _session = BearSSL::Session();  // Do not offer a session the server refused
+      return false;
+    }
+
+    _heapUsed = heapBefore > ESP.getFreeHeap() ? heapBefore - ESP.getFreeHeap() : 0;
+    _resumed = !sessionEmpty(previous) && memcmp(&previous, &_session, sizeof(_session)) == 0;
+    if (_resumed) _resumedHandshakes++;
+    else _fullHandshakes++;
+    DEBUG_PRINTF("[TLS] %s handshake %u ms, %u B heap\n",
+                 _resumed ? "Resumed" : "Full", _handshakeMs, (unsigned)_heapUsed);
+    return true;
+  }
+};
+
+extern MqttTls mqttTls;
+
+#endif // KLIMERKO_MQTT_TLS_H
@@ -15,9 +15,16 @@
 #include <ESP8266mDNS.h>
 #include <WiFiUdp.h>
 #include <ArduinoOTA.h>
+#include <ESP8266httpUpdate.h>
+#include <WiFiClientSecure.h>
+#include <lwip/dns.h>
 #include <time.h>
 #include "config.h"
 #include "types.h"
+#include "utils.h"
+#include "mqtt_tls.h"
+#include "profiler.h"
+#include "settings_journal.h"
 #include "../WiFiManager/WiFiManager.h"
 #include "../PubSubClient/PubSubClient.h"
 
@@ -43,6 +50,7 @@ extern WiFiManagerParameter portalDisplayCredits;
 
 extern WifiState wifiState;
 extern MqttState mqttState;
+extern MqttDnsCache mqttDns;
 extern char klimerkoID[32];
 extern char apPassword[16];
 extern char otaPassword[16];
@@ -225,6 +233,7 @@ inline bool isConfigPortalActive() {
 
 // Forward declaration for callback
 typedef void (*MqttCallbackFunc)(char*, byte*, unsigned int);
+typedef void (*MqttPublishAckFunc)(uint16_t, bool);
 
 /**
  * @brief Build MQTT topic string
@@ -247,25 +256,193 @@ inline void mqttSubscribeTopics() {
 }
 
 /**
- * @brief Connect to MQTT broker
+ * @brief Reconnect delay after consecutive failures
+ *
+ * Exponential like the WiFi path, with equal jitter (half fixed, half random)
+ * so a fleet does not reconnect in lockstep after a broker restart.
+ * @param failures Consecutive failed attempts
+ * @return Delay in milliseconds
+ */
+inline unsigned long mqttBackoffInterval(uint8_t failures) {
+  unsigned long interval = min(MQTT_RECONNECT_MAX_MS,
+                               MQTT_RECONNECT_BASE_MS * (1UL << min(failures, (uint8_t)6)));
+  return interval / 2 + random(interval / 2 + 1);
+}
+
+/**
+ * @brief lwIP DNS callback (runs in the network stack context)
+ */
+inline void mqttDnsFound(const char* name, const ip_addr_t* addr, void* arg) {
+  (void)name;
+  if ((uint8_t)(uintptr_t)arg != mqttDns.lookupId) return;  // Stale lookup
+  mqttDns.lookupIp = addr ? ip_addr_get_ip4_u32(addr) : 0;
+  mqttDns.lookupDone = true;
+}
+
+/**
+ * @brief Check if the cached broker address is usable without a lookup
+ */
+inline bool mqttDnsFresh() {
+  return mqttDns.ip != 0 && strcmp(mqttDns.host, mqttServer) == 0 &&
+         millis() - mqttDns.resolvedAt < MQTT_DNS_CACHE_MS;
+}
+
+/**
+ * @brief Start resolving mqttServer unless the cache already holds it
+ *
+ * lwIP answers from its own TTL-honouring table when it can (ERR_OK);
+ * otherwise the query runs in the background and mqttDnsFound() reports.
+ */
+inline void mqttDnsStart() {
+  IPAddress literal;
+  safeStrCopy(mqttDns.lookupHost, mqttServer, sizeof(mqttDns.lookupHost));
+  mqttDns.lookupDone = true;
+  if (literal.fromString(mqttServer)) {
+    mqttDns.lookupIp = (uint32_t)literal;
+    return;
+  }
+  if (mqttDnsFresh()) {
+    mqttDns.lookupIp = mqttDns.ip;
+    return;
+  }
+
+  ip_addr_t addr;
+  mqttDns.lookupId++;
+  mqttDns.lookupDone = false;
+  err_t err = dns_gethostbyname(mqttServer, &addr, mqttDnsFound, (void*)(uintptr_t)mqttDns.lookupId);
+  if (err == ERR_OK) {
+    mqttDns.lookupIp = ip_addr_get_ip4_u32(&addr);
+    mqttDns.lookupDone = true;
+  } else if (err != ERR_INPROGRESS) {
+    mqttDns.lookupIp = 0;
+    mqttDns.lookupDone = true;
+  }
+}
+
+/**
+ * @brief Begin an asynchronous connect attempt (resolve, TCP, CONNECT/CONNACK)
+ */
+inline void mqttStartConnect() {
+  DEBUG_PRINTF("[MQTT] Connecting to %s:%d\n", mqttServer, mqttPort);
+  mqttState.connectionLost = true;
+  mqttState.lastReconnectAttempt = millis();
+  mqttState.phaseStarted = millis();
+  mqttState.phase = MqttConnectPhase::RESOLVING;
+  if (mqttTls.enabled()) mqtt.setClient(mqttTls.client());
+  else mqtt.setClient(networkClient);
+  mqttDnsStart();
+}
+
+/**
+ * @brief Record a failed attempt and schedule the next one
+ * @param reason Short description for the log
+ */
+inline void mqttConnectFailed(const char* reason) {
+  mqttState.phase = MqttConnectPhase::IDLE;
+  mqttState.connectionLost = true;
+  mqttState.reconnectCount++;
+  if (mqttState.reconnectFailCount < 255) mqttState.reconnectFailCount++;
+  mqttState.reconnectInterval = mqttBackoffInterval(mqttState.reconnectFailCount);
+  mqttState.lastReconnectAttempt = millis();
+  DEBUG_PRINTF("[MQTT] Connection failed (%s, state %d), retry in %lus\n",
+               reason, mqtt.state(), mqttState.reconnectInterval / 1000);
+}
+
+/**
+ * @brief Advance the connect attempt in progress; never waits on the network
+ *
+ * The only blocking call is the TCP handshake inside WiFiClient::connect(),
+ * bounded by MQTT_TCP_TIMEOUT_MS, plus the TLS handshake when enabled (short
+ * once the session can be resumed).
+ */
+inline void mqttConnectStep() {
+  if (mqttState.phase == MqttConnectPhase::RESOLVING) {
+    if (!mqttDns.lookupDone) {
+      if (millis() - mqttState.phaseStarted < MQTT_DNS_TIMEOUT_MS) return;
+      mqttDns.lookupId++;  // Ignore the late answer
+      mqttDns.lookupIp = 0;
+    }
+    // Cache the answer under the name that was looked up, not the current mqttServer
+    if (mqttDns.lookupIp != 0) {
+      bool fresh = mqttDns.ip == mqttDns.lookupIp && mqttDnsFresh() &&
+                   strcmp(mqttDns.host, mqttDns.lookupHost) == 0;
+      safeStrCopy(mqttDns.host, mqttDns.lookupHost, sizeof(mqttDns.host));
+      if (!fresh) mqttDns.resolvedAt = millis();
+      mqttDns.ip = mqttDns.lookupIp;
+    } else if (mqttDns.ip != 0 && strcmp(mqttDns.host, mqttDns.lookupHost) == 0) {
+      DEBUG_PRINTLN(F("[MQTT] DNS lookup failed, using last known address"));
+    } else {
+      mqttConnectFailed("DNS");
+      return;
+    }
+
+    bool linked = mqttTls.enabled() ? mqttTls.connect(mqttDns.host, IPAddress(mqttDns.ip), mqttPort)
+                                    : networkClient.connect(IPAddress(mqttDns.ip), mqttPort);
+    if (!linked) {
+      mqttDns.resolvedAt = millis() - MQTT_DNS_CACHE_MS;  // Re-resolve next time
+      mqttConnectFailed(mqttTls.enabled() ? "TLS" : "TCP");
+      return;
+    }
+    if (!mqtt.beginConnect(klimerkoID, deviceToken, MQTT_PASSWORD)) {
+      mqttConnectFailed("CONNECT");
+      return;
+    }
+    mqttState.phase = MqttConnectPhase::HANDSHAKE;
+    mqttState.phaseStarted = millis();
+    return;
+  }
+
+  if (mqttState.phase == MqttConnectPhase::HANDSHAKE) {
+    // mqtt.loop() reads the CONNACK
+    if (mqtt.connected()) {
+      mqttState.phase = MqttConnectPhase::IDLE;
+      mqttState.connectionLost = false;
+      mqttState.reconnectFailCount = 0;
+      mqttSubscribeTopics();
+      DEBUG_PRINTLN(F("[MQTT] Connected!"));
+    } else if (mqtt.state() != MQTT_CONNECTING) {
+      mqttConnectFailed("CONNACK");
+    }
+  }
+}
+
+/**
+ * @brief Connect to MQTT broker, waiting for the outcome
+ *
+ * Used at boot only; the main loop reconnects through maintainMQTT().
  * @return true if connected
  */
 inline bool connectMQTT() {
   if (wifiState.connectionLost) return false;
   
-  DEBUG_PRINTF("[MQTT] Connecting to %s:%d\n", mqttServer, mqttPort);
-  
-  if (mqtt.connect(klimerkoID, deviceToken, MQTT_PASSWORD)) {
-    mqttState.connectionLost = false;
-    mqttSubscribeTopics();
-    DEBUG_PRINTLN(F("[MQTT] Connected!"));
-    return true;
+  mqttStartConnect();
+  while (mqttState.phase != MqttConnectPhase::IDLE) {
+    delay(10);
+    mqtt.loop();
+    mqttConnectStep();
   }
-  
+  return mqtt.connected();
+}
+
+/**
+ * @brief Start a reconnect now instead of waiting out the backoff
+ *
+ * An attempt already in progress may be for the previous broker, so it is
+ * abandoned (late DNS answer ignored, half-open session closed) rather
+ * than left to fail and count against the backoff.
+ */
+inline void requestMqttReconnect() {
+  mqttState.reconnectFailCount = 0;
+  mqttState.reconnectInterval = 0;
   mqttState.connectionLost = true;
-  mqttState.reconnectCount++;
-  DEBUG_PRINTLN(F("[MQTT] Connection failed"));
-  return false;
+  if (mqttState.phase != MqttConnectPhase::IDLE) {
+    if (mqttState.phase == MqttConnectPhase::HANDSHAKE) mqtt.disconnect();
+    mqttDns.lookupId++;
+    mqttState.phase = MqttConnectPhase::IDLE;
+  }
+  if (!wifiState.connectionLost && !mqtt.connected()) {
+    mqttStartConnect();
+  }
 }
 
 /**
@@ -273,26 +450,32 @@ inline bool connectMQTT() {
  * @return true if connected
  */
 inline bool maintainMQTT() {
-  mqtt.loop();
+  {
+    PERF_SCOPE(MQTT_LOOP);
+    mqtt.loop();
+  }
+  
+  if (mqttState.phase != MqttConnectPhase::IDLE) {
+    mqttConnectStep();
+    return mqtt.connected();
+  }
   
   if (mqtt.connected()) {
-    if (mqttState.connectionLost) {
-      mqttState.connectionLost = false;
-    }
     return true;
   }
   
-  // Connection lost
+  // Connection lost - first retry after a short jittered delay
   if (!mqttState.connectionLost) {
     mqttState.connectionLost = true;
+    mqttState.lastReconnectAttempt = millis();
+    mqttState.reconnectInterval = mqttBackoffInterval(0);
     DEBUG_PRINTLN(F("[MQTT] Connection lost"));
   }
   
   // Try to reconnect
   if (!wifiState.connectionLost && 
-      millis() - mqttState.lastReconnectAttempt >= MQTT_RECONNECT_INTERVAL) {
-    connectMQTT();
-    mqttState.lastReconnectAttempt = millis();
+      millis() - mqttState.lastReconnectAttempt >= mqttState.reconnectInterval) {
+    mqttStartConnect();
   }
   
   return false;
@@ -328,6 +511,48 @@ inline bool mqttPublish(const char* topic, const char* payload, bool retained =
   return result;
 }
 
+/**
+ * @brief Publish binary data to MQTT
+ * @param topic Topic to publish to
+ * @param payload Payload bytes (may contain zeros)
+ * @param length Payload length
+ * @param retained Retain message flag
+ * @param qos 0 = fire and forget, 1 = delivery confirmed by PUBACK
+ * @return true if published (QoS 1: queued in the in-flight window)
+ */
+inline bool mqttPublish(const char* topic, const uint8_t* payload, size_t length, bool retained = false, uint8_t qos = 0) {
+  if (!mqtt.connected()) {
+    DEBUG_PRINTLN(F("[MQTT] Cannot publish - not connected"));
+    return false;
+  }
+  
+  bool result = mqtt.publish(topic, payload, length, retained, qos);
+  if (result) {
+    DEBUG_PRINTF("[MQTT] Published %u bytes to %s (QoS %u, %u in flight)\n",
+                 (unsigned)length, topic, qos, mqtt.inflightCount());
+  } else {
+    DEBUG_PRINTLN(F("[MQTT] Publish failed!"));
+  }
+  return result;
+}
+
+/**
+ * @brief Service the connection until every QoS 1 publish is acknowledged
+ *
+ * The in-flight window lives in RAM and is lost in deep sleep, so the
+ * PUBACKs have to arrive (and fire the ack callback) before sleeping.
+ * @param timeoutMs Give up after this long
+ * @return Publishes still unacknowledged (0 = all delivered)
+ */
+inline uint8_t drainMqttInflight(unsigned long timeoutMs) {
+  unsigned long start = millis();
+  while (mqtt.connected() && mqtt.inflightCount() > 0 && millis() - start < timeoutMs) {
+    mqtt.loop();
+    delay(10);
+  }
+  return mqtt.inflightCount();
+}
+
 /**
  * @brief Publish to device state topic
  * @param payload JSON payload string
@@ -339,15 +564,31 @@ inline bool publishToState(const char* payload) {
   return mqttPublish(topic, payload);
 }
 
+/**
+ * @brief Publish encoded payload to device state topic
+ * @param payload Payload bytes (JSON, MessagePack or CBOR)
+ * @param length Payload length
+ * @param qos MQTT QoS level (0 or 1)
+ * @return true if published successfully
+ */
+inline bool publishToState(const uint8_t* payload, size_t length, uint8_t qos = 0) {
+  char topic[128];
+  buildMqttTopicStr(topic, sizeof(topic), "state");
+  return mqttPublish(topic, payload, length, false, qos);
+}
+
 /**
  * @brief Initialize MQTT client
  * @param callback MQTT message callback function
+ * @param ackCallback Called when a QoS 1 publish is acknowledged or given up
  */
-inline void initMQTT(MqttCallbackFunc callback) {
+inline void initMQTT(MqttCallbackFunc callback, MqttPublishAckFunc ackCallback = nullptr) {
   mqtt.setBufferSize(MQTT_MAX_MESSAGE_SIZE);
   mqtt.setServer(mqttServer, mqttPort);
   mqtt.setKeepAlive(30);
   mqtt.setCallback(callback);
+  mqtt.setPublishCallback(ackCallback);
+  networkClient.setTimeout(MQTT_TCP_TIMEOUT_MS);
   DEBUG_PRINTF("[MQTT] Configured for %s:%d\n", mqttServer, mqttPort);
   connectMQTT();
 }
@@ -358,13 +599,16 @@ inline void initMQTT(MqttCallbackFunc callback) {
  * @param port New broker port
  */
 inline void updateMqttBroker(const char* server, uint16_t port) {
-  strncpy(mqttServer, server, sizeof(mqttServer) - 1);
-  mqttServer[sizeof(mqttServer) - 1] = '\0';
+  if (server != mqttServer) {
+    strncpy(mqttServer, server, sizeof(mqttServer) - 1);
+    mqttServer[sizeof(mqttServer) - 1] = '\0';
+  }
   mqttPort = port;
   
   mqtt.disconnect();
   mqtt.setServer(mqttServer, mqttPort);
-  connectMQTT();
+  mqttTls.reset();
+  requestMqttReconnect();
   
   DEBUG_PRINTF("[MQTT] Broker updated: %s:%d\n", mqttServer, mqttPort);
 }
@@ -436,35 +680,51 @@ inline bool initNTP(long gmtOffsetSec = GMT_OFFSET_SEC,
 
 /**
  * @brief Get current time as ISO timestamp
- * @return ISO format timestamp or uptime string
+ * @param buffer Output buffer (TIME_TEXT_SIZE)
+ * @param bufferSize Size of buffer
+ * @return buffer: ISO format timestamp, or uptime seconds without NTP
  */
-inline String getISOTimestamp() {
+inline char* getISOTimestamp(char* buffer, size_t bufferSize) {
   if (!ntpSynced) {
-    return String(millis() / 1000);
+    snprintf(buffer, bufferSize, "%lu", millis() / 1000);
+    return buffer;
   }
   time_t now = time(nullptr);
-  struct tm* timeinfo = localtime(&now);
-  char buffer[32];
-  snprintf(buffer, sizeof(buffer), "%04d-%02d-%02dT%02d:%02d:%02d",
-           timeinfo->tm_year + 1900, timeinfo->tm_mon + 1, timeinfo->tm_mday,
-           timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec);
-  return String(buffer);
+  struct tm timeinfo;
+  localtime_r(&now, &timeinfo);
+  snprintf(buffer, bufferSize, "%04d-%02d-%02dT%02d:%02d:%02d",
+           timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
+           timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
+  return buffer;
+}
+
+/**
+ * @brief Get timestamp for stored samples
+ * @return Unix time if NTP synced, otherwise uptime seconds
+ */
+inline uint32_t getSampleTimestamp() {
+  if (!ntpSynced) {
+    return millis() / 1000;
+  }
+  return (uint32_t)time(nullptr);
 }
 
 /**
  * @brief Get current time formatted as HH:MM:SS
- * @return Time string
+ * @param buffer Output buffer (TIME_TEXT_SIZE)
+ * @param bufferSize Size of buffer
+ * @return buffer: time of day, or uptime without NTP
  */
-inline String getFormattedTime() {
+inline char* getFormattedTime(char* buffer, size_t bufferSize) {
   if (!ntpSynced) {
-    return formatUptime(millis() / 1000);
+    return formatUptime(buffer, bufferSize, millis() / 1000);
   }
   time_t now = time(nullptr);
-  struct tm* timeinfo = localtime(&now);
-  char buffer[16];
-  snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d",
-           timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec);
-  return String(buffer);
+  struct tm timeinfo;
+  localtime_r(&now, &timeinfo);
+  snprintf(buffer, bufferSize, "%02d:%02d:%02d",
+           timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
+  return buffer;
 }
 
 /**
@@ -488,6 +748,7 @@ inline void initOTA() {
   
   ArduinoOTA.onStart([]() {
     DEBUG_PRINTLN(F("[OTA] Starting update..."));
+    settingsJournal.commit();
   });
   
   ArduinoOTA.onEnd([]() {
@@ -529,7 +790,7 @@ inline void handleOTA() {
  * @param url Firmware binary URL
  * @return true if update started (device will reboot)
  */
-inline bool performHttpUpdate(const String& url) {
+inline bool performHttpUpdate(const char* url) {
   DEBUG_PRINTLN(F("[UPDATE] Starting HTTP firmware update..."));
   DEBUG_PRINT(F("[UPDATE] URL: ")); DEBUG_PRINTLN(url);
   
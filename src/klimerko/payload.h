@@ -0,0 +1,165 @@
+/**
+ * @file payload.h
+ * @brief Klimerko Payload Encoding - JSON, MessagePack and CBOR
+ * @version 7.0 Ultimate
+ *
+ * State publishes are built once as an ArduinoJson document and encoded
+ * in the configured PayloadFormat. MessagePack uses ArduinoJson's own
+ * serializer; CBOR (RFC 8949) is written by the small encoder below,
+ * which covers the subset a document can hold: maps, arrays, strings,
+ * integers, floats, booleans and null.
+ */
+
+#ifndef KLIMERKO_PAYLOAD_H
+#define KLIMERKO_PAYLOAD_H
+
+#include <Arduino.h>
+#include <cmath>
+#include "config.h"
+#include "types.h"
+#include "../ArduinoJson-v6.18.5.h"
+
+// ============================================================================
+// CBOR ENCODER
+// ============================================================================
+
+#define CBOR_UNSIGNED   0
+#define CBOR_NEGATIVE   1
+#define CBOR_TEXT       3
+#define CBOR_ARRAY      4
+#define CBOR_MAP        5
+#define CBOR_SIMPLE     7
+
+/**
+ * @brief Bounded CBOR writer into a caller buffer
+ */
+struct CborWriter {
+  uint8_t* buf;
+  size_t capacity;
+  size_t len;
+  bool overflow;
+
+  CborWriter(uint8_t* buffer, size_t size) : buf(buffer), capacity(size), len(0), overflow(false) {}
+
+  void put(uint8_t b) {
+    if (len < capacity) buf[len++] = b;
+    else overflow = true;
+  }
+
+  void putBytes(const uint8_t* data, size_t n) {
+    if (len + n > capacity) {
+      overflow = true;
+      return;
+    }
+    memcpy(buf + len, data, n);
+    len += n;
+  }
+
+  /**
+   * @brief Write initial byte with the shortest argument encoding
+   */
+  void putHead(uint8_t major, uint32_t value) {
+    major <<= 5;
+    if (value < 24) {
+      put(major | value);
+    } else if (value <= 0xFF) {
+      put(major | 24); put(value);
+    } else if (value <= 0xFFFF) {
+      put(major | 25); put(value >> 8); put(value);
+    } else {
+      put(major | 26); put(value >> 24); put(value >> 16); put(value >> 8); put(value);
+    }
+  }
+
+  void putInt(int32_t v) {
+    if (v >= 0) putHead(CBOR_UNSIGNED, (uint32_t)v);
+    else putHead(CBOR_NEGATIVE, (uint32_t)(-1 - v));
+  }
+
+  void putFloat(float f) {
+    // Whole numbers (e.g. altitude, offsets) are shorter as integers. Range
+    // first: converting NaN, inf or anything beyond int32 is undefined
+    if (std::isfinite(f) && fabsf(f) < 2147483520.0f && f == (float)(int32_t)f) {
+      putInt((int32_t)f);
+      return;
+    }
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    put((CBOR_SIMPLE << 5) | 26);
+    put(bits >> 24); put(bits >> 16); put(bits >> 8); put(bits);
+  }
+
+  void putText(const char* s) {
+    size_t n = strlen(s);
+    putHead(CBOR_TEXT, n);
+    putBytes((const uint8_t*)s, n);
+  }
+
+  /**
+   * @brief Encode a document value recursively
+   */
+  void putVariant(JsonVariantConst v) {
+    if (v.isNull()) {
+      put((CBOR_SIMPLE << 5) | 22);
+    } else if (v.is<bool>()) {
+      put((CBOR_SIMPLE << 5) | (v.as<bool>() ? 21 : 20));
+    } else if (v.is<long>()) {
+      putInt(v.as<long>());
+    } else if (v.is<unsigned long>()) {
+      putHead(CBOR_UNSIGNED, v.as<unsigned long>());
+    } else if (v.is<float>()) {
+      putFloat(v.as<float>());
+    } else if (v.is<const char*>()) {
+      putText(v.as<const char*>());
+    } else if (v.is<JsonArrayConst>()) {
+      JsonArrayConst arr = v.as<JsonArrayConst>();
+      putHead(CBOR_ARRAY, arr.size());
+      for (JsonVariantConst item : arr) putVariant(item);
+    } else if (v.is<JsonObjectConst>()) {
+      JsonObjectConst obj = v.as<JsonObjectConst>();
+      putHead(CBOR_MAP, obj.size());
+      for (JsonPairConst kv : obj) {
+        putText(kv.key().c_str());
+        putVariant(kv.value());
+      }
+    }
+  }
+};
+
+/**
+ * @brief Serialize document as CBOR
+ * @return Encoded length, 0 if the buffer was too small
+ */
+inline size_t serializeCbor(const JsonDocument& doc, uint8_t* buffer, size_t size) {
+  CborWriter writer(buffer, size);
+  writer.putVariant(doc.as<JsonVariantConst>());
+  return writer.overflow ? 0 : writer.len;
+}
+
+// ============================================================================
+// FORMAT SELECTION
+// ============================================================================
+
+/**
+ * @brief Serialize document in the selected format
+ * @param doc Document to encode
+ * @param buffer Output buffer
+ * @param size Buffer size
+ * @param format Payload format
+ * @return Encoded length, 0 if it does not fit
+ */
+inline size_t serializePayload(const JsonDocument& doc, uint8_t* buffer, size_t size,
+                               PayloadFormat format) {
+  switch (format) {
+    case PayloadFormat::MSGPACK:
+      if (measureMsgPack(doc) > size) return 0;
+      return serializeMsgPack(doc, buffer, size);
+    case PayloadFormat::CBOR:
+      return serializeCbor(doc, buffer, size);
+    default:
+      if (measureJson(doc) >= size) return 0;
+      return serializeJson(doc, (char*)buffer, size);
+  }
+}
+
+#endif // KLIMERKO_PAYLOAD_H
@@ -0,0 +1,223 @@
+/**
+ * @file profiler.h
+ * @brief Klimerko Profiler - cycle-counted timing of hot paths
+ * @version 7.0 Ultimate
+ *
+ * PERF_SCOPE(probe) at the top of a block times it with the CPU cycle
+ * counter (ESP.getCycleCount(), 12.5 ns at 80 MHz) until the block ends.
+ * Each probe keeps count, min, max, total and a log2 histogram of the
+ * duration in microseconds (PERF_HIST_BUCKETS buckets, the first one
+ * up to 2^PERF_HIST_FIRST_LOG2 µs, the last one unbounded).
+ *
+ * Results: /api/perf (JSON, ?reset=1 clears them) and the
+ * klimerko_perf_duration_seconds histogram on /metrics.
+ *
+ * With PROFILER_ENABLED 0 probes compile to nothing and no RAM is used.
+ */
+
+#ifndef KLIMERKO_PROFILER_H
+#define KLIMERKO_PROFILER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+/**
+ * @brief Timed code paths
+ */
+enum class PerfProbe : uint8_t {
+  PMS_READ,
+  BME_READ,
+  PUBLISH,
+  LOG_FS,
+  MQTT_LOOP,
+  WEB_CLIENT,       // webServer.handleClient(), handlers included
+  WEB_ROOT,
+  WEB_CHART_JS,
+  WEB_API_DATA,
+  WEB_API_EVENTS,
+  WEB_API_STATS,
+  WEB_API_LOG,
+  WEB_API_HISTORY,
+  WEB_API_QUERY,
+  WEB_API_PERF,
+  WEB_METRICS,
+  WEB_NOT_FOUND,
+
+  COUNT
+};
+
+#define PERF_PROBE_COUNT ((uint8_t)PerfProbe::COUNT)
+
+static const char* const PERF_PROBE_NAMES[PERF_PROBE_COUNT] = {
+  "pms_read", "bme_read", "publish", "log_fs", "mqtt_loop", "web_client",
+  "web_root", "web_chart_js", "web_api_data", "web_api_events", "web_api_stats",
+  "web_api_log", "web_api_history", "web_api_query", "web_api_perf", "web_metrics",
+  "web_not_found"
+};
+
+/**
+ * @brief Upper bound of histogram bucket i in µs (0 = unbounded)
+ */
+inline uint32_t perfBucketBoundUs(uint8_t i) {
+  return i + 1 < PERF_HIST_BUCKETS ? 1UL << (i + PERF_HIST_FIRST_LOG2) : 0;
+}
+
+/**
+ * @brief Histogram bucket of a duration in µs
+ *
+ * Bucket i holds durations up to 2^(i + PERF_HIST_FIRST_LOG2) µs
+ * (Prometheus "le"), the last one everything longer.
+ */
+inline uint8_t perfBucketIndex(uint32_t us) {
+  uint8_t bits = us > 1 ? 32 - __builtin_clz(us - 1) : 0;
+  uint8_t bucket = bits > PERF_HIST_FIRST_LOG2 ? bits - PERF_HIST_FIRST_LOG2 : 0;
+  return min(bucket, (uint8_t)(PERF_HIST_BUCKETS - 1));
+}
+
+#if PROFILER_ENABLED
+
+/**
+ * @brief Timings of one probe
+ */
+struct PerfProbeStats {
+  uint32_t count;
+  uint32_t minCycles;
+  uint32_t maxCycles;
+  uint64_t totalCycles;
+  uint32_t buckets[PERF_HIST_BUCKETS];
+};
+
+/**
+ * @brief Per-probe timing table
+ */
+class Profiler {
+private:
+  PerfProbeStats _stats[PERF_PROBE_COUNT];
+  unsigned long _since;
+
+public:
+  Profiler() { reset(); }
+
+  void reset() {
+    memset(_stats, 0, sizeof(_stats));
+    _since = millis();
+  }
+
+  void record(PerfProbe probe, uint32_t cycles) {
+    PerfProbeStats& s = _stats[(uint8_t)probe];
+    if (s.count == 0 || cycles < s.minCycles) s.minCycles = cycles;
+    if (cycles > s.maxCycles) s.maxCycles = cycles;
+    s.count++;
+    s.totalCycles += cycles;
+    s.buckets[perfBucketIndex(cycles / ESP.getCpuFreqMHz())]++;
+  }
+
+  const PerfProbeStats& stats(uint8_t probe) const { return _stats[probe]; }
+  unsigned long since() const { return _since; }
+};
+
+extern Profiler profiler;
+
+/**
+ * @brief Times its own lifetime
+ */
+class PerfScope {
+private:
+  PerfProbe _probe;
+  uint32_t _start;
+
+public:
+  explicit PerfScope(PerfProbe probe) : _probe(probe), _start(ESP.getCycleCount()) {}
+  ~PerfScope() { profiler.record(_probe, ESP.getCycleCount() - _start); }
+};
+
+#define PERF_CONCAT_(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_(a, b)
+#define PERF_SCOPE(probe) PerfScope PERF_CONCAT(_perfScope, __LINE__)(PerfProbe::probe)
+
+/**
+ * @brief Write the probes as a Prometheus histogram
+ * @param out Any writer with printf() (chunked HTTP response)
+ * @param device Value of the device label
+ *
+ * Only probes that have run are written, to keep /metrics short.
+ */
+template <typename Out>
+void writePerfExposition(Out& out, const char* device) {
+  out.printf("# HELP klimerko_perf_duration_seconds Duration of profiled code paths\n");
+  out.printf("# TYPE klimerko_perf_duration_seconds histogram\n");
+  float cyclesPerSecond = ESP.getCpuFreqMHz() * 1e6f;
+  for (uint8_t p = 0; p < PERF_PROBE_COUNT; p++) {
+    const PerfProbeStats& s = profiler.stats(p);
+    if (s.count == 0) continue;
+    uint32_t cumulative = 0;
+    for (uint8_t i = 0; i < PERF_HIST_BUCKETS; i++) {
+      cumulative += s.buckets[i];
+      uint32_t bound = perfBucketBoundUs(i);
+      if (bound) {
+        out.printf("klimerko_perf_duration_seconds_bucket{device=\"%s\",probe=\"%s\",le=\"%g\"} %u\n",
+                   device, PERF_PROBE_NAMES[p], bound / 1e6, cumulative);
+      } else {
+        out.printf("klimerko_perf_duration_seconds_bucket{device=\"%s\",probe=\"%s\",le=\"+Inf\"} %u\n",
+                   device, PERF_PROBE_NAMES[p], cumulative);
+      }
+    }
+    out.printf("klimerko_perf_duration_seconds_sum{device=\"%s\",probe=\"%s\"} %.6f\n",
+               device, PERF_PROBE_NAMES[p], s.totalCycles / cyclesPerSecond);
+    out.printf("klimerko_perf_duration_seconds_count{device=\"%s\",probe=\"%s\"} %u\n",
+               device, PERF_PROBE_NAMES[p], s.count);
+  }
+}
+
+/**
+ * @brief Write the probes as JSON (/api/perf)
+ */
+template <typename Out>
+void writePerfJson(Out& out) {
+  uint8_t mhz = ESP.getCpuFreqMHz();
+  out.printf("{\"enabled\":true,\"cpuMHz\":%u,\"windowSec\":%lu,\"bucketLeUs\":[",
+             mhz, (millis() - profiler.since()) / 1000);
+  for (uint8_t i = 0; i + 1 < PERF_HIST_BUCKETS; i++) {
+    out.printf("%s%u", i ? "," : "", perfBucketBoundUs(i));
+  }
+  out.printf("],\"probes\":[");
+  for (uint8_t p = 0; p < PERF_PROBE_COUNT; p++) {
+    const PerfProbeStats& s = profiler.stats(p);
+    out.printf("%s{\"name\":\"%s\",\"count\":%u,\"minUs\":%u,\"maxUs\":%u,\"meanUs\":%u,\"totalMs\":%u,\"hist\":[",
+               p ? "," : "", PERF_PROBE_NAMES[p], s.count, s.minCycles / mhz, s.maxCycles / mhz,
+               s.count ? (uint32_t)(s.totalCycles / s.count / mhz) : 0,
+               (uint32_t)(s.totalCycles / mhz / 1000));
+    for (uint8_t i = 0; i < PERF_HIST_BUCKETS; i++) {
+      out.printf("%s%u", i ? "," : "", s.buckets[i]);
+    }
+    out.printf("]}");
+  }
+  out.printf("]}");
+}
+
+#else
+
+#define PERF_SCOPE(probe)
+
+template <typename Out>
+void writePerfExposition(Out&, const char*) {}
+
+template <typename Out>
+void writePerfJson(Out& out) {
+  out.printf("{\"enabled\":false}");
+}
+
+#endif // PROFILER_ENABLED
+
+/**
+ * @brief Route handler wrapped in a probe (webServer.on("/x", perfHandler<...>))
+ */
+template <PerfProbe probe, void (*handler)()>
+void perfHandler() {
+#if PROFILER_ENABLED
+  PerfScope scope(probe);
+#endif
+  handler();
+}
+
+#endif // KLIMERKO_PROFILER_H
@@ -16,6 +16,7 @@
 #include "config.h"
 #include "types.h"
 #include "utils.h"
+#include "profiler.h"
 #include "../pmsLibrary/PMS.h"
 #include "../AdafruitBME280/Adafruit_BME280.h"
 #include "../movingAvg/movingAvg.h"
@@ -56,7 +57,7 @@ extern bool pmsWoken;
 // Fan stuck detection
 extern int prevPm1, prevPm25, prevPm10;
 extern int stuckCounter, zeroCounter;
-extern String sensorStatusText;
+extern const char* sensorStatusText;
 
 // ============================================================================
 // SENSOR INITIALIZATION
@@ -154,6 +155,8 @@ inline void setPMSPower(bool state) {
  * Handles offline detection and recovery.
  */
 inline void readPMSSensor() {
+  PERF_SCOPE(PMS_READ);
+  
   // Clear serial buffer
   while (pmsSerial.available()) {
     pmsSerial.read();
@@ -223,6 +226,7 @@ inline void readPMSSensor() {
  * Calculates derived values: dewpoint, absolute humidity, heat index.
  */
 inline void readBMESensor() {
+  PERF_SCOPE(BME_READ);
   float temperatureRaw = bme.readTemperature();
   float temperature = temperatureRaw + calibration.tempOffset;
   float humidityRaw = bme.readHumidity();
@@ -337,16 +341,16 @@ inline SensorStatus checkFanStatus() {
   
   // Determine status
   if (stuckCounter >= FAN_STUCK_THRESHOLD) {
-    sensorStatusText = F("Fan Stuck / Error");
+    sensorStatusText = "Fan Stuck / Error";
     pmsStatus = SensorStatus::FAN_STUCK;
     return SensorStatus::FAN_STUCK;
   } else if (zeroCounter >= ZERO_DATA_THRESHOLD) {
-    sensorStatusText = F("Zero Data Error");
+    sensorStatusText = "Zero Data Error";
     pmsStatus = SensorStatus::ZERO_DATA;
     return SensorStatus::ZERO_DATA;
   }
   
-  sensorStatusText = F("OK");
+  sensorStatusText = "OK";
   pmsStatus = SensorStatus::OK;
   return SensorStatus::OK;
 }
@@ -422,19 +426,19 @@ inline bool allSensorsOnline() {
  * @brief Get combined sensor status string
  * @return Human readable status
  */
-inline String getSensorStatusString() {
+inline const char* getSensorStatusString() {
   if (!pmsSensorOnline && !bmeSensorOnline) {
-    return F("All Sensors Offline");
+    return "All Sensors Offline";
   } else if (!pmsSensorOnline) {
-    return F("PMS Offline");
+    return "PMS Offline";
   } else if (!bmeSensorOnline) {
-    return F("BME Offline");
+    return "BME Offline";
   } else if (pmsStatus == SensorStatus::FAN_STUCK) {
-    return F("Fan Stuck");
+    return "Fan Stuck";
   } else if (pmsStatus == SensorStatus::ZERO_DATA) {
-    return F("Zero Data");
+    return "Zero Data";
   }
-  return F("OK");
+  return "OK";
 }
 
 #endif // KLIMERKO_SENSORS_H
@@ -0,0 +1,286 @@
+/**
+ * @file settings_journal.h
+ * @brief Klimerko Settings Journal - deferred, coalesced settings commits
+ * @version 7.0 Ultimate
+ *
+ * The Settings struct in EEPROM is the base snapshot. Writing it erases a
+ * whole 4 KB flash sector and stalls the CPU, so single-field updates
+ * (MQTT commands) no longer write it:
+ * - An update changes klimerkoSettings in RAM and marks the field dirty.
+ * - After SETTINGS_COMMIT_QUIET_MS without further changes (or at most
+ *   SETTINGS_COMMIT_MAX_DELAY_MS after the first one), the dirty fields
+ *   are appended as key/value records to a LittleFS journal in one write.
+ *   LittleFS spreads those writes over its blocks.
+ * - When the journal passes SETTINGS_JOURNAL_MAX_BYTES it is folded into
+ *   a new EEPROM base and removed (compaction, one sector erase).
+ * - At boot the journal is replayed over the EEPROM base. It carries the
+ *   CRC of the base it was written against, so a journal left behind by an
+ *   interrupted compaction is never applied to a newer base.
+ *
+ * Journal record: key (1 B), length (1 B), value, CRC32 (4 B).
+ */
+
+#ifndef KLIMERKO_SETTINGS_JOURNAL_H
+#define KLIMERKO_SETTINGS_JOURNAL_H
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <LittleFS.h>
+#include <stddef.h>
+#include "config.h"
+#include "types.h"
+#include "utils.h"
+
+#define SETTINGS_JOURNAL_MAGIC  0x4A534B4CUL  // "LKSJ"
+
+/**
+ * @brief Journal file header
+ */
+struct SettingsJournalHeader {
+  uint32_t magic;
+  uint32_t baseCrc;   // crc32 of the EEPROM base the records apply to
+};
+
+/**
+ * @brief Location of a journaled field inside Settings
+ */
+struct SettingsField {
+  SettingKey key;
+  uint16_t offset;
+  uint8_t size;
+};
+
+static const SettingsField SETTINGS_FIELDS[] = {
+  {SettingKey::DEVICE_ID,      offsetof(Settings, deviceId),         sizeof(Settings::deviceId)},
+  {SettingKey::DEVICE_TOKEN,   offsetof(Settings, deviceToken),      sizeof(Settings::deviceToken)},
+  {SettingKey::TEMP_OFFSET,    offsetof(Settings, tempOffset),       sizeof(Settings::tempOffset)},
+  {SettingKey::ALTITUDE,       offsetof(Settings, altitude),         sizeof(Settings::altitude)},
+  {SettingKey::DEEP_SLEEP,     offsetof(Settings, deepSleepEnabled), sizeof(Settings::deepSleepEnabled)},
+  {SettingKey::MQTT_BROKER,    offsetof(Settings, mqttBroker),       sizeof(Settings::mqttBroker)},
+  {SettingKey::PAYLOAD_FORMAT, offsetof(Settings, payloadFormat),    sizeof(Settings::payloadFormat)},
+  {SettingKey::MQTT_PORT,      offsetof(Settings, mqttBrokerPort),   sizeof(Settings::mqttBrokerPort)},
+  {SettingKey::ALARM_ENABLED,  offsetof(Settings, alarmEnabled),     sizeof(Settings::alarmEnabled)},
+  {SettingKey::GMT_OFFSET,     offsetof(Settings, gmtOffset),        sizeof(Settings::gmtOffset)},
+  {SettingKey::PM25_CAL,       offsetof(Settings, pm25CalFactor),    sizeof(Settings::pm25CalFactor)},
+  {SettingKey::PM10_CAL,       offsetof(Settings, pm10CalFactor),    sizeof(Settings::pm10CalFactor)},
+};
+
+#define SETTINGS_FIELD_COUNT (sizeof(SETTINGS_FIELDS) / sizeof(SETTINGS_FIELDS[0]))
+
+/**
+ * @brief Dirty-set and journal for klimerkoSettings
+ */
+class SettingsJournal {
+private:
+  Settings* const _settings;
+  uint32_t _dirty;            // Bit per SettingKey
+  unsigned long _dirtySince;
+  unsigned long _lastChange;
+  uint32_t _baseCrc;
+  uint32_t _journalBytes;
+  uint32_t _eepromErases;
+  uint32_t _appends;
+  uint32_t _compactions;
+  uint32_t _coalesced;
+
+  static const SettingsField* findField(const SettingsField* fields, uint8_t count, uint8_t key) {
+    for (uint8_t i = 0; i < count; i++) {
+      if ((uint8_t)fields[i].key == key) return &fields[i];
+    }
+    return nullptr;
+  }
+
+  static uint32_t recordCrc(const uint8_t* record, size_t length) {
+    return calculateCRC32(record, length);
+  }
+
+public:
+  explicit SettingsJournal(Settings& settings)
+    : _settings(&settings), _dirty(0), _dirtySince(0), _lastChange(0),
+      _baseCrc(0), _journalBytes(0), _eepromErases(0), _appends(0),
+      _compactions(0), _coalesced(0) {}
+
+  bool pending() const { return _dirty != 0; }
+  uint32_t journalBytes() const { return _journalBytes; }
+  uint32_t eepromErases() const { return _eepromErases; }
+  uint32_t appends() const { return _appends; }
+  uint32_t compactions() const { return _compactions; }
+  uint32_t coalesced() const { return _coalesced; }
+
+  /**
+   * @brief Count an EEPROM commit made elsewhere (statistics, factory reset)
+   */
+  void countEepromErase() { _eepromErases++; }
+
+  /**
+   * @brief Apply journal records to a base of any schema version
+   * @param base Struct the records were written against
+   * @param baseCrc CRC the journal must carry; otherwise it is stale and removed
+   * @param fields Field table of that struct's layout
+   * @param count Entries in fields
+   * @param torn Set if reading stopped at a damaged record
+   * @return Number of records applied
+   */
+  uint16_t apply(void* base, uint32_t baseCrc, const SettingsField* fields, uint8_t count, bool& torn) {
+    torn = false;
+    File f = LittleFS.open(SETTINGS_JOURNAL_PATH, "r");
+    if (!f) return 0;
+
+    SettingsJournalHeader header;
+    if (f.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+        header.magic != SETTINGS_JOURNAL_MAGIC || header.baseCrc != baseCrc) {
+      f.close();
+      DEBUG_PRINTLN(F("[EEPROM] Stale settings journal discarded"));
+      LittleFS.remove(SETTINGS_JOURNAL_PATH);
+      return 0;
+    }
+
+    uint16_t applied = 0;
+    uint8_t record[2 + 255 + 4];
+    while (f.available()) {
+      if (f.read(record, 2) != 2) { torn = true; break; }
+      uint8_t len = record[1];
+      if (f.read(record + 2, len + 4) != len + 4) { torn = true; break; }
+      uint32_t crc;
+      memcpy(&crc, record + 2 + len, sizeof(crc));
+      const SettingsField* field = findField(fields, count, record[0]);
+      if (crc != recordCrc(record, 2 + len) || !field || field->size != len) { torn = true; break; }
+      memcpy((uint8_t*)base + field->offset, record + 2, len);
+      applied++;
+    }
+    _journalBytes = f.size();
+    f.close();
+    return applied;
+  }
+
+  /**
+   * @brief Apply the journal to the settings just loaded from EEPROM
+   * @return Number of records applied
+   * @note Call only after the base passed its CRC check
+   */
+  uint16_t replay() {
+    Settings& settings = *_settings;
+    _baseCrc = settings.crc32;
+    _journalBytes = 0;
+
+    bool torn;
+    uint16_t applied = apply(&settings, _baseCrc, SETTINGS_FIELDS, SETTINGS_FIELD_COUNT, torn);
+    settings.crc32 = calculateSettingsCRC(settings);
+    if (torn) {
+      // Power lost mid-append: keep what was read, start a clean journal
+      DEBUG_PRINTLN(F("[EEPROM] Settings journal tail damaged, compacting"));
+      compact();
+    }
+    if (applied) {
+      DEBUG_PRINTF("[EEPROM] %u journaled setting(s) applied\n", applied);
+    }
+    return applied;
+  }
+
+  /**
+   * @brief Drop the journal (no valid EEPROM base to apply it to)
+   */
+  void discard() {
+    _baseCrc = _settings->crc32;
+    _journalBytes = 0;
+    if (LittleFS.exists(SETTINGS_JOURNAL_PATH)) LittleFS.remove(SETTINGS_JOURNAL_PATH);
+  }
+
+  /**
+   * @brief Record that a field of klimerkoSettings changed
+   */
+  void markDirty(SettingKey key) {
+    uint32_t bit = 1UL << (uint8_t)key;
+    if (_dirty & bit) _coalesced++;
+    if (!_dirty) _dirtySince = millis();
+    _dirty |= bit;
+    _lastChange = millis();
+  }
+
+  /**
+   * @brief Write the whole struct as the new EEPROM base and drop the journal
+   * @return true if the EEPROM commit succeeded
+   */
+  bool compact() {
+    _settings->crc32 = calculateSettingsCRC(*_settings);
+    EEPROM.begin(EEPROM_USED_SIZE);
+    EEPROM.put(0, *_settings);
+    bool ok = EEPROM.commit();
+    EEPROM.end();
+    _eepromErases++;
+    if (!ok) {
+      DEBUG_PRINTLN(F("[EEPROM] Save failed!"));
+      _dirtySince = _lastChange = millis();  // Retry after the next quiet period
+      return false;
+    }
+    _baseCrc = _settings->crc32;
+    if (LittleFS.exists(SETTINGS_JOURNAL_PATH)) LittleFS.remove(SETTINGS_JOURNAL_PATH);
+    _journalBytes = 0;
+    _dirty = 0;
+    _compactions++;
+    return true;
+  }
+
+  /**
+   * @brief Persist dirty fields now (shutdown, OTA, or from loop())
+   * @return true if nothing is left pending
+   */
+  bool commit() {
+    if (!_dirty) return true;
+
+    uint8_t buffer[256];
+    size_t used = 0;
+    if (_journalBytes == 0) {
+      SettingsJournalHeader header = {SETTINGS_JOURNAL_MAGIC, _baseCrc};
+      memcpy(buffer, &header, sizeof(header));
+      used = sizeof(header);
+    }
+    for (uint8_t i = 0; i < SETTINGS_FIELD_COUNT; i++) {
+      const SettingsField& field = SETTINGS_FIELDS[i];
+      if (!(_dirty & (1UL << (uint8_t)field.key))) continue;
+      if (used + 2 + field.size + 4 > sizeof(buffer)) return compact();
+      uint8_t* record = buffer + used;
+      record[0] = (uint8_t)field.key;
+      record[1] = field.size;
+      memcpy(record + 2, (const uint8_t*)_settings + field.offset, field.size);
+      uint32_t crc = recordCrc(record, 2 + field.size);
+      memcpy(record + 2 + field.size, &crc, sizeof(crc));
+      used += 2 + field.size + 4;
+    }
+
+    if (_journalBytes + used > SETTINGS_JOURNAL_MAX_BYTES) {
+      DEBUG_PRINTLN(F("[EEPROM] Settings journal full, compacting"));
+      return compact();
+    }
+
+    File f = LittleFS.open(SETTINGS_JOURNAL_PATH, "a");
+    if (!f || f.write(buffer, used) != used) {
+      if (f) f.close();
+      DEBUG_PRINTLN(F("[EEPROM] Journal append failed, compacting"));
+      return compact();
+    }
+    f.close();
+    _journalBytes += used;
+    _dirty = 0;
+    _appends++;
+    DEBUG_PRINTF("[EEPROM] Settings journaled (%u B, journal %u B)\n",
+                 (unsigned)used, (unsigned)_journalBytes);
+    return true;
+  }
+
+  /**
+   * @brief Commit once changes have settled (call in loop)
+   */
+  void loop() {
+    if (!_dirty) return;
+    unsigned long now = millis();
+    if (now - _lastChange >= SETTINGS_COMMIT_QUIET_MS ||
+        now - _dirtySince >= SETTINGS_COMMIT_MAX_DELAY_MS) {
+      commit();
+    }
+  }
+};
+
+extern SettingsJournal settingsJournal;
+
+#endif // KLIMERKO_SETTINGS_JOURNAL_H
@@ -0,0 +1,294 @@
+/**
+ * @file settings_schema.h
+ * @brief Klimerko Settings Schema - EEPROM layout versions and migrations
+ * @version 7.0 Ultimate
+ *
+ * EEPROM map (fixed, see config.h):
+ *   0                    Settings, any version, at most SETTINGS_EEPROM_RESERVED
+ *   STATS_EEPROM_OFFSET  StatisticsRecord (32-bit counters; read once and
+ *                        imported by stats_store.h, which keeps them since)
+ *
+ * Both are frames (integrity.h): magic, version, length, ..., CRC32.
+ *
+ * Schema versions:
+ *   0  Klimerko 6.7  - "KLI" header, id/token/offset/altitude strings, no CRC
+ *   1  Klimerko 7.0  - "KLI" header, numbers as strings, CRC32; statistics
+ *                      directly after it (offset 196)
+ *   2  Current       - magic/version/length header, typed fields, CRC32
+ *
+ * Older layouts are migrated one step at a time up to the current version
+ * and written back once, so upgrades keep the device configured.
+ */
+
+#ifndef KLIMERKO_SETTINGS_SCHEMA_H
+#define KLIMERKO_SETTINGS_SCHEMA_H
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <stddef.h>
+#include "config.h"
+#include "types.h"
+#include "utils.h"
+#include "settings_journal.h"
+
+#define SETTINGS_MAGIC    0x53494C4BUL  // "KLIS"
+#define SETTINGS_VERSION  2
+#define STATS_MAGIC       0x3154534BUL  // "KST1"
+#define STATS_VERSION     1
+
+/**
+ * @brief Statistics as kept in EEPROM up to 7.0 (32-bit counters)
+ */
+struct StatisticsV1 {
+  uint32_t bootCount;
+  uint32_t wifiReconnects;
+  uint32_t mqttReconnects;
+  uint32_t successfulPublishes;
+  uint32_t failedPublishes;
+  uint32_t uptimeSeconds;
+};
+
+/**
+ * @brief Statistics as stored in EEPROM
+ */
+struct StatisticsRecord {
+  FrameHeader frame;      // STATS_MAGIC, STATS_VERSION
+  StatisticsV1 stats;
+  uint32_t crc32;
+};
+
+static_assert(sizeof(Settings) <= SETTINGS_EEPROM_RESERVED, "Settings outgrew its EEPROM area");
+static_assert(sizeof(StatisticsRecord) <= STATS_EEPROM_RESERVED, "Statistics outgrew its EEPROM area");
+static_assert(offsetof(Settings, length) == offsetof(FrameHeader, length) &&
+              offsetof(Settings, crc32) == sizeof(Settings) - sizeof(uint32_t),
+              "Settings must keep the frame layout");
+
+/**
+ * @brief Stage statistics for the next EEPROM.commit() (after EEPROM.begin)
+ */
+inline void putStatisticsRecord(const StatisticsV1& stats) {
+  StatisticsRecord record;
+  record.stats = stats;
+  frameSeal(&record, sizeof(record), STATS_MAGIC, STATS_VERSION);
+  EEPROM.put(STATS_EEPROM_OFFSET, record);
+}
+
+/**
+ * @brief Read statistics (after EEPROM.begin)
+ * @return OK if the record is intact; stats is left untouched otherwise
+ */
+inline FrameStatus getStatisticsRecord(StatisticsV1& stats) {
+  StatisticsRecord record;
+  EEPROM.get(STATS_EEPROM_OFFSET, record);
+  FrameStatus status = frameCheck(&record, sizeof(record), STATS_MAGIC, STATS_VERSION);
+  if (status == FrameStatus::OK) stats = record.stats;
+  return status;
+}
+
+// ============================================================================
+// LEGACY LAYOUTS
+// ============================================================================
+
+/**
+ * @brief Klimerko 6.7 settings (version 0)
+ */
+struct SettingsV0 {
+  char header[4];
+  char deviceId[32];
+  char deviceToken[64];
+  char tempOffset[8];
+  char altitude[6];
+};
+
+/**
+ * @brief Klimerko 7.0 settings (version 1)
+ */
+struct SettingsV1 {
+  char header[4];
+  char deviceId[32];
+  char deviceToken[64];
+  char tempOffset[8];
+  char altitude[6];
+  bool deepSleepEnabled;
+  char mqttBroker[64];
+  uint8_t payloadFormat;      // Former padding, 0xFF on early 7.0 devices
+  uint16_t mqttBrokerPort;
+  bool alarmEnabled;
+  int8_t gmtOffset;
+  float pm25CalFactor;
+  float pm10CalFactor;
+  uint32_t crc32;
+};
+
+static_assert(sizeof(SettingsV0) == 114, "6.7 layout changed");
+static_assert(sizeof(SettingsV1) == 196, "7.0 layout changed");
+
+#define STATS_V1_EEPROM_OFFSET  sizeof(SettingsV1)
+
+// Journal written by 7.0 builds (before typed fields)
+static const SettingsField SETTINGS_V1_FIELDS[] = {
+  {SettingKey::DEVICE_ID,      offsetof(SettingsV1, deviceId),         sizeof(SettingsV1::deviceId)},
+  {SettingKey::DEVICE_TOKEN,   offsetof(SettingsV1, deviceToken),      sizeof(SettingsV1::deviceToken)},
+  {SettingKey::TEMP_OFFSET,    offsetof(SettingsV1, tempOffset),       sizeof(SettingsV1::tempOffset)},
+  {SettingKey::ALTITUDE,       offsetof(SettingsV1, altitude),         sizeof(SettingsV1::altitude)},
+  {SettingKey::DEEP_SLEEP,     offsetof(SettingsV1, deepSleepEnabled), sizeof(SettingsV1::deepSleepEnabled)},
+  {SettingKey::MQTT_BROKER,    offsetof(SettingsV1, mqttBroker),       sizeof(SettingsV1::mqttBroker)},
+  {SettingKey::PAYLOAD_FORMAT, offsetof(SettingsV1, payloadFormat),    sizeof(SettingsV1::payloadFormat)},
+  {SettingKey::MQTT_PORT,      offsetof(SettingsV1, mqttBrokerPort),   sizeof(SettingsV1::mqttBrokerPort)},
+  {SettingKey::ALARM_ENABLED,  offsetof(SettingsV1, alarmEnabled),     sizeof(SettingsV1::alarmEnabled)},
+  {SettingKey::GMT_OFFSET,     offsetof(SettingsV1, gmtOffset),        sizeof(SettingsV1::gmtOffset)},
+  {SettingKey::PM25_CAL,       offsetof(SettingsV1, pm25CalFactor),    sizeof(SettingsV1::pm25CalFactor)},
+  {SettingKey::PM10_CAL,       offsetof(SettingsV1, pm10CalFactor),    sizeof(SettingsV1::pm10CalFactor)},
+};
+
+// ============================================================================
+// MIGRATIONS
+// ============================================================================
+
+/**
+ * @brief Result of reading the EEPROM settings area
+ */
+enum class SettingsLoad : uint8_t {
+  NONE,       // Nothing usable - defaults
+  CURRENT,    // Current version, CRC valid
+  MIGRATED    // Converted from an older version, not yet written back
+};
+
+inline bool isTerminated(const char* s, size_t size) {
+  return memchr(s, '\0', size) != nullptr;
+}
+
+/**
+ * @brief Current-version settings with default values
+ */
+inline void defaultSettings(Settings& s) {
+  memset(&s, 0, sizeof(s));
+  s.magic = SETTINGS_MAGIC;
+  s.version = SETTINGS_VERSION;
+  s.length = sizeof(Settings);
+  s.tempOffset = DEFAULT_TEMP_OFFSET;
+  s.pm25CalFactor = DEFAULT_PM_CAL_FACTOR;
+  s.pm10CalFactor = DEFAULT_PM_CAL_FACTOR;
+  s.payloadFormat = (uint8_t)PayloadFormat::JSON;
+  s.alarmEnabled = true;
+  s.crc32 = calculateSettingsCRC(s);
+}
+
+/**
+ * @brief Version 0 -> 1: 6.7 strings, 7.0 defaults for everything else
+ */
+inline void migrateV0toV1(const SettingsV0& in, SettingsV1& out) {
+  memset(&out, 0, sizeof(out));
+  memcpy(out.header, in.header, sizeof(out.header));
+  memcpy(out.deviceId, in.deviceId, sizeof(out.deviceId));
+  memcpy(out.deviceToken, in.deviceToken, sizeof(out.deviceToken));
+  memcpy(out.tempOffset, in.tempOffset, sizeof(out.tempOffset));
+  memcpy(out.altitude, in.altitude, sizeof(out.altitude));
+  out.alarmEnabled = true;
+  out.pm25CalFactor = DEFAULT_PM_CAL_FACTOR;
+  out.pm10CalFactor = DEFAULT_PM_CAL_FACTOR;
+  out.crc32 = crc32(&out, sizeof(out) - sizeof(uint32_t));
+}
+
+/**
+ * @brief Version 1 -> 2: numbers parsed once, out-of-range values defaulted
+ */
+inline void migrateV1toV2(const SettingsV1& in, Settings& out) {
+  defaultSettings(out);
+  safeStrCopy(out.deviceId, in.deviceId, sizeof(out.deviceId));
+  safeStrCopy(out.deviceToken, in.deviceToken, sizeof(out.deviceToken));
+  safeStrCopy(out.mqttBroker, in.mqttBroker, sizeof(out.mqttBroker));
+
+  char number[9];
+  safeStrCopy(number, in.tempOffset, sizeof(in.tempOffset));
+  if (isValidNumber(number)) out.tempOffset = atof(number);
+  safeStrCopy(number, in.altitude, sizeof(in.altitude));
+  if (isValidNumber(number)) out.altitude = (int16_t)constrain(atol(number), (long)MIN_ALTITUDE, (long)MAX_ALTITUDE);
+
+  out.deepSleepEnabled = in.deepSleepEnabled;
+  out.alarmEnabled = in.alarmEnabled;
+  out.mqttBrokerPort = in.mqttBrokerPort;
+  out.gmtOffset = in.gmtOffset;
+  if (in.payloadFormat <= (uint8_t)PayloadFormat::CBOR) out.payloadFormat = in.payloadFormat;
+  if (isValidCalibrationFactor(in.pm25CalFactor)) out.pm25CalFactor = in.pm25CalFactor;
+  if (isValidCalibrationFactor(in.pm10CalFactor)) out.pm10CalFactor = in.pm10CalFactor;
+  out.crc32 = calculateSettingsCRC(out);
+}
+
+/**
+ * @brief Move 7.0 statistics (right after SettingsV1) to their fixed offset
+ */
+inline void migrateStatisticsV1() {
+  StatisticsV1 old;
+  EEPROM.begin(EEPROM_USED_SIZE);
+  EEPROM.get(STATS_V1_EEPROM_OFFSET, old);
+  // 7.0 had no CRC on statistics, only this sanity check
+  if (old.bootCount <= 100000 && old.successfulPublishes <= 10000000) {
+    putStatisticsRecord(old);
+    EEPROM.commit();
+    settingsJournal.countEepromErase();
+    DEBUG_PRINTF("[EEPROM] Statistics moved (boot #%u)\n", old.bootCount);
+  }
+  EEPROM.end();
+}
+
+/**
+ * @brief Read the settings area and bring it to the current version
+ * @param out Current-version settings (valid unless NONE is returned)
+ * @return How the settings were obtained
+ *
+ * A version 1 base first gets its journal (7.0 field sizes) applied, so
+ * updates not yet compacted survive the upgrade.
+ */
+inline SettingsLoad loadSettingsBase(Settings& out) {
+  union {
+    Settings current;
+    SettingsV1 v1;
+    SettingsV0 v0;
+  } raw;
+  EEPROM.begin(EEPROM_USED_SIZE);
+  EEPROM.get(0, raw);
+  EEPROM.end();
+
+  FrameStatus status = frameCheck(&raw.current, sizeof(Settings), SETTINGS_MAGIC, SETTINGS_VERSION);
+  if (status != FrameStatus::MAGIC) {
+    if (status != FrameStatus::OK) {
+      DEBUG_PRINTF("[EEPROM] Settings invalid (%s) - using defaults\n", frameStatusToString(status));
+      return SettingsLoad::NONE;
+    }
+    out = raw.current;
+    return SettingsLoad::CURRENT;
+  }
+
+  if (memcmp(raw.v0.header, "KLI", 4) != 0) {
+    DEBUG_PRINTLN(F("[EEPROM] No valid header - using defaults"));
+    return SettingsLoad::NONE;
+  }
+
+  uint8_t from = 1;
+  SettingsV1 v1 = raw.v1;
+  if (crc32(&v1, sizeof(v1) - sizeof(uint32_t)) != v1.crc32) {
+    // No valid 7.0 CRC: a 6.7 record if its strings are intact
+    if (!isTerminated(raw.v0.deviceId, sizeof(raw.v0.deviceId)) ||
+        !isTerminated(raw.v0.deviceToken, sizeof(raw.v0.deviceToken)) ||
+        !isTerminated(raw.v0.tempOffset, sizeof(raw.v0.tempOffset)) ||
+        !isTerminated(raw.v0.altitude, sizeof(raw.v0.altitude))) {
+      DEBUG_PRINTLN(F("[EEPROM] CRC mismatch - using defaults"));
+      return SettingsLoad::NONE;
+    }
+    from = 0;
+    SettingsV0 v0 = raw.v0;
+    migrateV0toV1(v0, v1);
+  } else {
+    bool torn;
+    settingsJournal.apply(&v1, v1.crc32, SETTINGS_V1_FIELDS,
+                          sizeof(SETTINGS_V1_FIELDS) / sizeof(SETTINGS_V1_FIELDS[0]), torn);
+    migrateStatisticsV1();
+  }
+
+  migrateV1toV2(v1, out);
+  DEBUG_PRINTF("[EEPROM] Settings migrated v%u -> v%u\n", from, SETTINGS_VERSION);
+  return SettingsLoad::MIGRATED;
+}
+
+#endif // KLIMERKO_SETTINGS_SCHEMA_H
@@ -0,0 +1,806 @@
+/**
+ * @file sinks.h
+ * @brief Klimerko Data Sinks - encode once, fan out to several backends
+ * @version 7.0 Ultimate
+ *
+ * Besides the AllThingsTalk state publish, a sample can go to:
+ * - a local MQTT broker (e.g. Mosquitto), flat JSON on klimerko/<id>/sample
+ * - an InfluxDB HTTP write endpoint, line protocol, batched and gzipped
+ * - Sensor.Community (luftdaten) push API, one JSON document per sensor pin
+ *
+ * Each sample is encoded once per wire format into a reference-counted
+ * SinkPayload from a fixed pool; every sink that speaks that format queues
+ * a reference to the same bytes. The pool and the InfluxDB batch buffers
+ * are allocated while at least one sink that uses them is enabled, so a
+ * device with every sink off (the default) keeps that RAM. Sinks keep their own queue and their own
+ * retry backoff, so an unreachable InfluxDB never delays Sensor.Community.
+ * sinkLoop() services at most one sink per call to bound loop() latency.
+ *
+ * Configuration is kept in SINKS_FILE_PATH and set over MQTT ("sinks" asset),
+ * together with the Prometheus push settings used by metrics.h.
+ */
+
+#ifndef KLIMERKO_SINKS_H
+#define KLIMERKO_SINKS_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <ESP8266HTTPClient.h>
+#include <LittleFS.h>
+#include "config.h"
+#include "types.h"
+#include "utils.h"
+#include "gzip.h"
+#include "../PubSubClient/PubSubClient.h"
+#include "../ArduinoJson-v6.18.5.h"
+
+extern char klimerkoID[32];
+
+// ============================================================================
+// WIRE FORMATS AND SHARED PAYLOADS
+// ============================================================================
+
+enum class SinkFormat : uint8_t {
+  SAMPLE_JSON = 0,       // Flat JSON object
+  INFLUX_LINE = 1,       // InfluxDB line protocol
+  SENSOR_COMMUNITY = 2,  // "<pin> <json>\n" per sensor
+  COUNT = 3
+};
+
+/**
+ * @brief One encoded sample, shared by every sink queue that holds it
+ */
+struct SinkPayload {
+  uint8_t refs;          // 0 = free
+  uint16_t len;
+  char data[SINK_PAYLOAD_SIZE];
+};
+
+/**
+ * @brief Sample fields handed to the encoders
+ */
+struct SinkSample {
+  const SensorData* data;
+  uint32_t timestamp;    // Unix seconds (0 = not synced)
+  bool pmValid;
+  bool envValid;
+};
+
+/**
+ * @brief Paces retries of a failed buffer allocation
+ *
+ * sinkUpdateStorage() runs every loop; without this a malloc that fails on
+ * a fragmented heap would be retried (and logged) on every iteration.
+ * Same backoff range as a failed delivery.
+ */
+class SinkAllocBackoff {
+private:
+  unsigned long _failedAt;
+  unsigned long _delay;            // 0 = no failure pending
+
+public:
+  SinkAllocBackoff() : _failedAt(0), _delay(0) {}
+
+  bool due() const { return _delay == 0 || millis() - _failedAt >= _delay; }
+
+  /**
+   * @brief Record a failed allocation
+   * @return true for the first failure in a row (the one worth logging)
+   */
+  bool failed() {
+    bool first = _delay == 0;
+    _delay = first ? SINK_BACKOFF_MIN_MS : min(_delay * 2, SINK_BACKOFF_MAX_MS);
+    _failedAt = millis();
+    return first;
+  }
+
+  void reset() { _delay = 0; }
+};
+
+/**
+ * @brief Fixed pool of shared payloads, allocated while a sink is enabled
+ */
+class SinkPayloadPool {
+private:
+  SinkPayload* _slots;
+  SinkAllocBackoff _allocRetry;
+
+public:
+  SinkPayloadPool() : _slots(nullptr) {}
+
+  /**
+   * @brief Allocate the slots (on) or free them once none is referenced (off)
+   * @return true if the slots are available
+   */
+  bool reserve(bool on) {
+    if (on && !_slots) {
+      if (!_allocRetry.due()) return false;
+      _slots = (SinkPayload*)malloc(sizeof(SinkPayload) * SINK_POOL_SIZE);
+      if (!_slots) {
+        if (_allocRetry.failed()) DEBUG_PRINTLN(F("[SINK] No memory for the payload pool"));
+        return false;
+      }
+      _allocRetry.reset();
+      for (uint8_t i = 0; i < SINK_POOL_SIZE; i++) _slots[i].refs = 0;
+    } else if (!on) {
+      _allocRetry.reset();
+      if (_slots && inUse() == 0) {
+        free(_slots);
+        _slots = nullptr;
+      }
+    }
+    return _slots != nullptr;
+  }
+
+  bool reserved() const { return _slots != nullptr; }
+
+  SinkPayload* alloc() {
+    if (!_slots) return nullptr;
+    for (uint8_t i = 0; i < SINK_POOL_SIZE; i++) {
+      if (_slots[i].refs == 0) {
+        _slots[i].refs = 1;
+        _slots[i].len = 0;
+        return &_slots[i];
+      }
+    }
+    return nullptr;
+  }
+
+  static void retain(SinkPayload* p) { p->refs++; }
+
+  static void release(SinkPayload* p) {
+    if (p && p->refs > 0) p->refs--;
+  }
+
+  uint8_t inUse() const {
+    uint8_t n = 0;
+    if (!_slots) return 0;
+    for (uint8_t i = 0; i < SINK_POOL_SIZE; i++) {
+      if (_slots[i].refs) n++;
+    }
+    return n;
+  }
+};
+
+// ============================================================================
+// ENCODERS
+// ============================================================================
+
+/**
+ * @brief Append formatted text to a payload (marks the payload full on overflow)
+ */
+inline bool sinkAppend(SinkPayload* p, const char* fmt, ...) {
+  if (p->len >= SINK_PAYLOAD_SIZE) return false;
+  va_list args;
+  va_start(args, fmt);
+  size_t room = SINK_PAYLOAD_SIZE - p->len;
+  int n = vsnprintf(p->data + p->len, room, fmt, args);
+  va_end(args);
+  if (n < 0 || (size_t)n >= room) {
+    p->len = SINK_PAYLOAD_SIZE;
+    return false;
+  }
+  p->len += n;
+  return true;
+}
+
+inline void encodeSampleJson(const SinkSample& s, SinkPayload* p) {
+  const SensorData& d = *s.data;
+  sinkAppend(p, "{\"id\":\"%s\",\"ts\":%lu", klimerkoID, (unsigned long)s.timestamp);
+  if (s.pmValid) {
+    sinkAppend(p, ",\"pm1\":%d,\"pm25\":%d,\"pm10\":%d,\"aq\":\"%s\"",
+               d.pm1, d.pm25, d.pm10, airQualityToString(d.airQuality));
+  }
+  if (s.envValid) {
+    sinkAppend(p, ",\"temp\":%.2f,\"hum\":%.2f,\"pres\":%.2f",
+               d.temperature, d.humidity, d.pressure);
+  }
+  sinkAppend(p, "}");
+}
+
+inline void encodeInfluxLine(const SinkSample& s, SinkPayload* p) {
+  const SensorData& d = *s.data;
+  char sep = ' ';
+  sinkAppend(p, "klimerko,device=%s", klimerkoID);
+  if (s.pmValid) {
+    sinkAppend(p, "%cpm1=%di,pm25=%di,pm10=%di", sep, d.pm1, d.pm25, d.pm10);
+    sep = ',';
+  }
+  if (s.envValid) {
+    sinkAppend(p, "%ctemperature=%.2f,humidity=%.2f,pressure=%.2f",
+               sep, d.temperature, d.humidity, d.pressure);
+    sep = ',';
+  }
+  if (sep == ' ') {
+    p->len = 0;  // No fields: nothing to write
+    return;
+  }
+  // Without NTP the server assigns its own receive time
+  if (s.timestamp) sinkAppend(p, " %lu", (unsigned long)s.timestamp);
+  sinkAppend(p, "\n");
+}
+
+inline void encodeSensorCommunity(const SinkSample& s, SinkPayload* p) {
+  const SensorData& d = *s.data;
+  if (s.pmValid) {
+    sinkAppend(p, SENSOR_COMMUNITY_PIN_PM " {\"software_version\":\"Klimerko-" FIRMWARE_VERSION
+               "\",\"sensordatavalues\":[{\"value_type\":\"P1\",\"value\":\"%d\"},"
+               "{\"value_type\":\"P2\",\"value\":\"%d\"}]}\n", d.pm10, d.pm25);
+  }
+  if (s.envValid) {
+    sinkAppend(p, SENSOR_COMMUNITY_PIN_ENV " {\"software_version\":\"Klimerko-" FIRMWARE_VERSION
+               "\",\"sensordatavalues\":[{\"value_type\":\"temperature\",\"value\":\"%.2f\"},"
+               "{\"value_type\":\"humidity\",\"value\":\"%.2f\"},"
+               "{\"value_type\":\"pressure\",\"value\":\"%.0f\"}]}\n",
+               d.temperature, d.humidity, d.pressure * 100.0f);
+  }
+}
+
+/**
+ * @brief Encode a sample in one wire format
+ * @return false if the result is empty or did not fit
+ */
+inline bool encodeSinkPayload(SinkFormat format, const SinkSample& s, SinkPayload* p) {
+  p->len = 0;
+  switch (format) {
+    case SinkFormat::SAMPLE_JSON:      encodeSampleJson(s, p); break;
+    case SinkFormat::INFLUX_LINE:      encodeInfluxLine(s, p); break;
+    case SinkFormat::SENSOR_COMMUNITY: encodeSensorCommunity(s, p); break;
+    default: break;
+  }
+  return p->len > 0 && p->len < SINK_PAYLOAD_SIZE;
+}
+
+// ============================================================================
+// SINK CONFIGURATION
+// ============================================================================
+
+struct SinkConfig {
+  char mqttHost[64];
+  uint16_t mqttPort;
+  char mqttTopic[64];
+  char influxUrl[160];    // Full write URL incl. db/bucket and precision=s
+  char influxToken[96];   // "Token ..." for v2, empty for open v1
+  uint8_t influxBatch;    // Lines per POST
+  uint16_t influxFlushSec; // Max age of a queued line
+  bool communityEnabled;
+  char promUrl[160];      // Remote-write endpoint or Pushgateway base URL
+  PromPushMode promMode;
+  uint8_t promBatch;      // Snapshots per remote-write request
+  uint16_t promIntervalSec;
+};
+
+extern SinkConfig sinkConfig;
+
+// ============================================================================
+// SINK BASE CLASS
+// ============================================================================
+
+/**
+ * @brief Backend with its own queue and retry backoff
+ */
+class Sink {
+private:
+  SinkPayload* _queue[SINK_QUEUE_DEPTH];
+  unsigned long _queuedAt[SINK_QUEUE_DEPTH];
+  uint8_t _head;
+  uint8_t _count;
+  unsigned long _lastFailure;
+  unsigned long _retryDelay;       // 0 = healthy
+  uint32_t _sent;
+  uint32_t _failed;
+  uint32_t _dropped;
+
+  void popFront(uint8_t n) {
+    while (n-- && _count) {
+      SinkPayloadPool::release(_queue[_head]);
+      _head = (_head + 1) % SINK_QUEUE_DEPTH;
+      _count--;
+    }
+  }
+
+public:
+  Sink() : _head(0), _count(0), _lastFailure(0), _retryDelay(0),
+           _sent(0), _failed(0), _dropped(0) {}
+  virtual ~Sink() {}
+
+  virtual const char* name() const = 0;
+  virtual SinkFormat format() const = 0;
+  virtual bool enabled() const = 0;
+
+  /**
+   * @brief Deliver queued payloads (oldest first)
+   * @return Number of payloads delivered, 0 on failure
+   */
+  virtual uint8_t send(SinkPayload* const* items, uint8_t count) = 0;
+
+  /**
+   * @brief Keep connections alive (called every loop)
+   */
+  virtual void poll() {}
+
+  /**
+   * @brief Allocate working buffers while enabled (on), free them when disabled
+   */
+  virtual void reserve(bool on) { (void)on; }
+
+  /**
+   * @brief Whether the backlog should be sent now (batching sinks wait)
+   * @param queued Payloads in the queue
+   * @param oldestAgeMs Time since the oldest payload was queued
+   */
+  virtual bool ready(uint8_t queued, unsigned long oldestAgeMs) const {
+    (void)queued; (void)oldestAgeMs;
+    return true;
+  }
+
+  /**
+   * @brief Queue a shared payload, dropping the oldest when full
+   */
+  void enqueue(SinkPayload* p) {
+    if (_count == SINK_QUEUE_DEPTH) {
+      popFront(1);
+      _dropped++;
+    }
+    SinkPayloadPool::retain(p);
+    _queue[(_head + _count) % SINK_QUEUE_DEPTH] = p;
+    _queuedAt[(_head + _count) % SINK_QUEUE_DEPTH] = millis();
+    _count++;
+  }
+
+  /**
+   * @brief Drop the whole backlog (sink disabled)
+   */
+  void clear() {
+    _dropped += _count;
+    popFront(_count);
+  }
+
+  /**
+   * @brief Drop the oldest queued payload to free pool space
+   */
+  bool dropOldest() {
+    if (_count == 0) return false;
+    popFront(1);
+    _dropped++;
+    return true;
+  }
+
+  /**
+   * @brief Attempt delivery if something is queued and backoff has elapsed
+   * @return true if an attempt was made
+   */
+  bool service(unsigned long now) {
+    if (_count == 0) return false;
+    if (!enabled()) {
+      clear();
+      return false;
+    }
+    if (_retryDelay && now - _lastFailure < _retryDelay) return false;
+    if (!ready(_count, now - _queuedAt[_head])) return false;
+
+    SinkPayload* batch[SINK_QUEUE_DEPTH];
+    for (uint8_t i = 0; i < _count; i++) {
+      batch[i] = _queue[(_head + i) % SINK_QUEUE_DEPTH];
+    }
+    uint8_t delivered = send(batch, _count);
+    if (delivered > 0) {
+      popFront(delivered);
+      _sent += delivered;
+      _retryDelay = 0;
+    } else {
+      _failed++;
+      _lastFailure = millis();
+      // Exponential backoff with jitter so sinks don't retry in lockstep
+      _retryDelay = _retryDelay ? min(_retryDelay * 2, SINK_BACKOFF_MAX_MS) : SINK_BACKOFF_MIN_MS;
+      _retryDelay += random(_retryDelay / 4);
+      DEBUG_PRINTF("[SINK] %s failed, retry in %lus\n", name(), _retryDelay / 1000);
+    }
+    return true;
+  }
+
+  uint8_t queued() const { return _count; }
+  uint32_t sent() const { return _sent; }
+  uint32_t failed() const { return _failed; }
+  uint32_t dropped() const { return _dropped; }
+  bool backingOff() const { return _retryDelay != 0; }
+};
+
+// ============================================================================
+// BACKENDS
+// ============================================================================
+
+/**
+ * @brief Local MQTT broker, one message per sample
+ */
+class MqttSink : public Sink {
+private:
+  WiFiClient _net;
+  PubSubClient _client;
+  char _topic[96];
+
+public:
+  MqttSink() : _client(_net) { _topic[0] = '\0'; }
+
+  const char* name() const override { return "mqtt"; }
+  SinkFormat format() const override { return SinkFormat::SAMPLE_JSON; }
+  bool enabled() const override { return sinkConfig.mqttHost[0] != '\0'; }
+
+  void poll() override {
+    if (_client.connected()) _client.loop();
+  }
+
+  /**
+   * @brief Forget the current connection (broker settings changed)
+   */
+  void reset() {
+    _client.disconnect();
+    _topic[0] = '\0';
+  }
+
+  uint8_t send(SinkPayload* const* items, uint8_t count) override {
+    if (!_client.connected()) {
+      _net.setTimeout(SINK_TIMEOUT_MS);
+      _client.setServer(sinkConfig.mqttHost, sinkConfig.mqttPort);
+      _client.setSocketTimeout(SINK_TIMEOUT_MS / 1000);
+      _client.setBufferSize(SINK_PAYLOAD_SIZE + sizeof(_topic) + 8);
+      if (!_client.connect(klimerkoID)) return 0;
+    }
+    if (_topic[0] == '\0') {
+      if (sinkConfig.mqttTopic[0]) safeStrCopy(_topic, sinkConfig.mqttTopic, sizeof(_topic));
+      else snprintf(_topic, sizeof(_topic), SINK_MQTT_TOPIC_PREFIX "%s/sample", klimerkoID);
+    }
+    uint8_t done = 0;
+    while (done < count &&
+           _client.publish(_topic, (const uint8_t*)items[done]->data, items[done]->len, false)) {
+      done++;
+    }
+    return done;
+  }
+};
+
+/**
+ * @brief InfluxDB HTTP write API (v1 /write or v2 /api/v2/write)
+ *
+ * Lines are batched until influxBatch are queued or the oldest is
+ * influxFlushSec old, then sent as one gzip-encoded POST over a kept-alive
+ * connection. VictoriaMetrics accepts the same requests on /write.
+ */
+class InfluxSink : public Sink {
+private:
+  WiFiClient _net;
+  HTTPClient _http;
+  char* _body;            // INFLUX_BATCH_BUFFER, allocated while enabled
+  uint8_t* _compressed;   // Second half of the same allocation
+  SinkAllocBackoff _allocRetry;
+
+public:
+  InfluxSink() : _body(nullptr), _compressed(nullptr) { _http.setReuse(true); }
+
+  const char* name() const override { return "influx"; }
+  SinkFormat format() const override { return SinkFormat::INFLUX_LINE; }
+  bool enabled() const override { return sinkConfig.influxUrl[0] != '\0'; }
+
+  bool ready(uint8_t queued, unsigned long oldestAgeMs) const override {
+    return queued >= min(sinkConfig.influxBatch, (uint8_t)SINK_QUEUE_DEPTH) ||
+           oldestAgeMs >= sinkConfig.influxFlushSec * 1000UL;
+  }
+
+  void reserve(bool on) override {
+    if (on && !_body) {
+      if (!_allocRetry.due()) return;
+      _body = (char*)malloc(2 * INFLUX_BATCH_BUFFER);
+      if (_body) {
+        _compressed = (uint8_t*)_body + INFLUX_BATCH_BUFFER;
+        _allocRetry.reset();
+      } else if (_allocRetry.failed()) {
+        DEBUG_PRINTLN(F("[SINK] No memory for the influx batch"));
+      }
+    } else if (!on) {
+      _allocRetry.reset();
+      free(_body);
+      _body = nullptr;
+      _compressed = nullptr;
+    }
+  }
+
+  uint8_t send(SinkPayload* const* items, uint8_t count) override {
+    if (!_body) return 0;
+
+    // Concatenate as many whole lines as fit
+    size_t length = 0;
+    uint8_t lines = 0;
+    while (lines < count && length + items[lines]->len <= INFLUX_BATCH_BUFFER) {
+      memcpy(_body + length, items[lines]->data, items[lines]->len);
+      length += items[lines]->len;
+      lines++;
+    }
+    if (lines == 0) return 0;
+
+    _http.setTimeout(SINK_TIMEOUT_MS);
+    if (!_http.begin(_net, sinkConfig.influxUrl)) return 0;
+    _http.addHeader(F("Content-Type"), F("text/plain; charset=utf-8"));
+    if (sinkConfig.influxToken[0]) {
+      _http.addHeader(F("Authorization"), String(F("Token ")) + sinkConfig.influxToken);
+    }
+
+    size_t packed = gzipCompress((const uint8_t*)_body, length, _compressed, INFLUX_BATCH_BUFFER);
+    int code;
+    if (packed > 0 && packed < length) {
+      _http.addHeader(F("Content-Encoding"), F("gzip"));
+      code = _http.POST(_compressed, packed);
+    } else {
+      code = _http.POST((const uint8_t*)_body, length);
+    }
+    _http.end();  // Keeps the connection open for the next batch
+
+    if (code < 200 || code >= 300) {
+      DEBUG_PRINTF("[SINK] influx HTTP %d\n", code);
+      return 0;
+    }
+    DEBUG_PRINTF("[SINK] influx: %u lines, %u -> %u bytes\n", lines, (unsigned)length,
+                 (unsigned)(packed && packed < length ? packed : length));
+    return lines;
+  }
+};
+
+/**
+ * @brief Sensor.Community push API, one request per sensor pin
+ *
+ * A sample is only complete once every pin has been accepted. Pins already
+ * posted are remembered for the payload at the head of the queue, so a retry
+ * after a failed BME280 POST does not post the PM reading a second time.
+ */
+class SensorCommunitySink : public Sink {
+private:
+  WiFiClient _net;
+  SinkPayload* _partial;  // Head payload with some pins posted (referenced)
+  uint8_t _postedPins;    // Bit per line of _partial already accepted
+
+  void forgetPartial() {
+    SinkPayloadPool::release(_partial);
+    _partial = nullptr;
+    _postedPins = 0;
+  }
+
+  bool post(const char* pin, const char* body, size_t len) {
+    HTTPClient http;
+    http.setTimeout(SINK_TIMEOUT_MS);
+    if (!http.begin(_net, SENSOR_COMMUNITY_URL)) return false;
+    http.addHeader(F("Content-Type"), F("application/json"));
+    http.addHeader(F("X-Pin"), pin);
+    http.addHeader(F("X-Sensor"), String(F("esp8266-")) + String(ESP.getChipId()));
+    int code = http.POST((const uint8_t*)body, len);
+    http.end();
+    return code >= 200 && code < 300;
+  }
+
+public:
+  SensorCommunitySink() : _partial(nullptr), _postedPins(0) {}
+
+  const char* name() const override { return "sensor-community"; }
+  SinkFormat format() const override { return SinkFormat::SENSOR_COMMUNITY; }
+  bool enabled() const override { return sinkConfig.communityEnabled; }
+
+  void reserve(bool on) override {
+    if (!on) forgetPartial();
+  }
+
+  uint8_t send(SinkPayload* const* items, uint8_t count) override {
+    (void)count;
+    // The reference held on _partial keeps its slot from being reused, so
+    // a different head payload is always a different sample
+    if (items[0] != _partial) {
+      forgetPartial();
+      _partial = items[0];
+      SinkPayloadPool::retain(_partial);
+    }
+
+    // Payload holds "<pin> <json>\n" lines; each is its own request
+    const char* p = items[0]->data;
+    const char* end = p + items[0]->len;
+    for (uint8_t line = 0; p < end; line++) {
+      const char* space = (const char*)memchr(p, ' ', end - p);
+      const char* eol = (const char*)memchr(p, '\n', end - p);
+      if (!space || !eol || space > eol || line >= 8) {
+        forgetPartial();
+        return 0;
+      }
+      if (!(_postedPins & (1 << line))) {
+        char pin[4];
+        safeStrCopy(pin, p, min((size_t)(space - p + 1), sizeof(pin)));
+        if (!post(pin, space + 1, eol - space - 1)) return 0;
+        _postedPins |= 1 << line;
+      }
+      p = eol + 1;
+    }
+    forgetPartial();
+    return 1;
+  }
+};
+
+// ============================================================================
+// FAN-OUT
+// ============================================================================
+
+#define SINK_COUNT 3
+
+extern SinkPayloadPool sinkPool;
+extern Sink* sinks[SINK_COUNT];
+
+/**
+ * @brief Allocate sink buffers for the enabled sinks and free the rest
+ *
+ * Called every loop, so a sink turned on or off over MQTT gets or returns
+ * its RAM without a restart. A disabled sink's backlog is dropped here,
+ * which lets the pool go once the last sink is off.
+ */
+inline void sinkUpdateStorage() {
+  bool any = false;
+  for (uint8_t i = 0; i < SINK_COUNT; i++) {
+    bool on = sinks[i]->enabled();
+    if (!on && sinks[i]->queued()) sinks[i]->clear();
+    sinks[i]->reserve(on);
+    any = any || on;
+  }
+  sinkPool.reserve(any);
+}
+
+/**
+ * @brief Get a payload, reclaiming the oldest backlog if the pool is empty
+ */
+inline SinkPayload* sinkAllocPayload() {
+  SinkPayload* p = sinkPool.alloc();
+  while (!p) {
+    Sink* longest = nullptr;
+    for (uint8_t i = 0; i < SINK_COUNT; i++) {
+      if (sinks[i]->queued() && (!longest || sinks[i]->queued() > longest->queued())) {
+        longest = sinks[i];
+      }
+    }
+    if (!longest || !longest->dropOldest()) return nullptr;
+    p = sinkPool.alloc();
+  }
+  return p;
+}
+
+/**
+ * @brief Encode a sample once per needed format and queue it on every sink
+ */
+inline void sinkPublishSample(const SinkSample& sample) {
+  SinkPayload* encoded[(uint8_t)SinkFormat::COUNT] = {nullptr};
+  bool failed[(uint8_t)SinkFormat::COUNT] = {false};
+
+  for (uint8_t i = 0; i < SINK_COUNT; i++) {
+    Sink* sink = sinks[i];
+    if (!sink->enabled()) continue;
+    uint8_t f = (uint8_t)sink->format();
+    if (!encoded[f] && !failed[f]) {
+      encoded[f] = sinkAllocPayload();
+      if (!encoded[f] || !encodeSinkPayload(sink->format(), sample, encoded[f])) {
+        SinkPayloadPool::release(encoded[f]);
+        encoded[f] = nullptr;
+        failed[f] = true;
+      }
+    }
+    if (encoded[f]) sink->enqueue(encoded[f]);
+  }
+
+  // Drop the encoder's own reference; queues keep theirs
+  for (uint8_t f = 0; f < (uint8_t)SinkFormat::COUNT; f++) {
+    SinkPayloadPool::release(encoded[f]);
+  }
+}
+
+/**
+ * @brief Service sinks (round-robin, at most one delivery attempt per call)
+ */
+inline void sinkLoop() {
+  static uint8_t next = 0;
+  sinkUpdateStorage();
+  if (WiFi.status() != WL_CONNECTED) return;
+
+  unsigned long now = millis();
+  for (uint8_t i = 0; i < SINK_COUNT; i++) sinks[i]->poll();
+  for (uint8_t i = 0; i < SINK_COUNT; i++) {
+    uint8_t idx = (next + i) % SINK_COUNT;
+    if (sinks[idx]->service(now)) {
+      next = (idx + 1) % SINK_COUNT;
+      break;
+    }
+  }
+}
+
+// ============================================================================
+// PERSISTENCE
+// ============================================================================
+
+inline void saveSinkConfig() {
+  StaticJsonDocument<768> doc;
+  JsonObject mqttCfg = doc.createNestedObject("mqtt");
+  mqttCfg["host"] = sinkConfig.mqttHost;
+  mqttCfg["port"] = sinkConfig.mqttPort;
+  mqttCfg["topic"] = sinkConfig.mqttTopic;
+  JsonObject influx = doc.createNestedObject("influx");
+  influx["url"] = sinkConfig.influxUrl;
+  influx["token"] = sinkConfig.influxToken;
+  influx["batch"] = sinkConfig.influxBatch;
+  influx["flush"] = sinkConfig.influxFlushSec;
+  doc["sensor-community"] = sinkConfig.communityEnabled;
+  JsonObject prom = doc.createNestedObject("prometheus");
+  prom["url"] = sinkConfig.promUrl;
+  prom["mode"] = promPushModeToString(sinkConfig.promMode);
+  prom["interval"] = sinkConfig.promIntervalSec;
+  prom["batch"] = sinkConfig.promBatch;
+
+  File f = LittleFS.open(SINKS_FILE_PATH, "w");
+  if (!f) {
+    DEBUG_PRINTLN(F("[SINK] Cannot save config"));
+    return;
+  }
+  serializeJson(doc, f);
+  f.close();
+}
+
+/**
+ * @brief Apply sink settings ({"mqtt":{...},"influx":{...},"sensor-community":bool})
+ * @return true if the local MQTT settings changed
+ */
+inline bool applySinkConfig(JsonObjectConst config) {
+  bool mqttChanged = false;
+  JsonObjectConst mqttCfg = config["mqtt"];
+  if (!mqttCfg.isNull()) {
+    safeStrCopy(sinkConfig.mqttHost, mqttCfg["host"] | "", sizeof(sinkConfig.mqttHost));
+    sinkConfig.mqttPort = mqttCfg["port"] | MQTT_DEFAULT_PORT;
+    safeStrCopy(sinkConfig.mqttTopic, mqttCfg["topic"] | "", sizeof(sinkConfig.mqttTopic));
+    mqttChanged = true;
+  }
+  JsonObjectConst influx = config["influx"];
+  if (!influx.isNull()) {
+    safeStrCopy(sinkConfig.influxUrl, influx["url"] | "", sizeof(sinkConfig.influxUrl));
+    safeStrCopy(sinkConfig.influxToken, influx["token"] | "", sizeof(sinkConfig.influxToken));
+    sinkConfig.influxBatch = constrain(influx["batch"] | INFLUX_BATCH_SAMPLES, 1, SINK_QUEUE_DEPTH);
+    sinkConfig.influxFlushSec = constrain(influx["flush"] | INFLUX_BATCH_MAX_SEC, 10, 3600);
+  }
+  if (config.containsKey("sensor-community")) {
+    sinkConfig.communityEnabled = config["sensor-community"].as<bool>();
+  }
+  JsonObjectConst prom = config["prometheus"];
+  if (!prom.isNull()) {
+    safeStrCopy(sinkConfig.promUrl, prom["url"] | "", sizeof(sinkConfig.promUrl));
+    sinkConfig.promMode = stringToPromPushMode(prom["mode"] | "off");
+    sinkConfig.promIntervalSec = constrain(prom["interval"] | PROM_PUSH_INTERVAL_SEC, 10, 3600);
+    sinkConfig.promBatch = constrain(prom["batch"] | PROM_PUSH_BATCH, 1, PROM_PUSH_BATCH);
+  }
+  return mqttChanged;
+}
+
+/**
+ * @brief Load sink settings (call after LittleFS is mounted)
+ */
+inline void loadSinkConfig() {
+  memset(&sinkConfig, 0, sizeof(sinkConfig));
+  sinkConfig.mqttPort = MQTT_DEFAULT_PORT;
+  sinkConfig.influxBatch = INFLUX_BATCH_SAMPLES;
+  sinkConfig.influxFlushSec = INFLUX_BATCH_MAX_SEC;
+  sinkConfig.promIntervalSec = PROM_PUSH_INTERVAL_SEC;
+  sinkConfig.promBatch = PROM_PUSH_BATCH;
+
+  File f = LittleFS.open(SINKS_FILE_PATH, "r");
+  if (!f) return;
+  StaticJsonDocument<768> doc;
+  DeserializationError err = deserializeJson(doc, f);
+  f.close();
+  if (err) {
+    DEBUG_PRINTLN(F("[SINK] Invalid config file, sinks disabled"));
+    return;
+  }
+  applySinkConfig(doc.as<JsonObjectConst>());
+  sinkUpdateStorage();  // Early, while the heap is still in one piece
+  DEBUG_PRINTF("[SINK] mqtt:%s influx:%s sensor-community:%s\n",
+               sinkConfig.mqttHost[0] ? sinkConfig.mqttHost : "off",
+               sinkConfig.influxUrl[0] ? "on" : "off",
+               sinkConfig.communityEnabled ? "on" : "off");
+}
+
+#endif // KLIMERKO_SINKS_H
@@ -0,0 +1,112 @@
+/**
+ * @file snappy.h
+ * @brief Klimerko Snappy Compression - block format encoder
+ * @version 7.0 Ultimate
+ *
+ * Encodes the raw Snappy block format required by Prometheus remote-write.
+ * Greedy matching over a single-entry hash table, literals and 2-byte
+ * offset copies only; any Snappy decoder accepts the output.
+ */
+
+#ifndef KLIMERKO_SNAPPY_H
+#define KLIMERKO_SNAPPY_H
+
+#include <Arduino.h>
+
+#define SNAPPY_HASH_BITS    9
+#define SNAPPY_MIN_MATCH    4
+#define SNAPPY_MAX_COPY     64
+#define SNAPPY_MAX_INPUT    65535   // One block, uint16_t positions
+
+/**
+ * @brief Bounded byte writer for the Snappy encoder
+ */
+struct SnappyWriter {
+  uint8_t* buf;
+  size_t capacity;
+  size_t len;
+  bool overflow;
+
+  SnappyWriter(uint8_t* buffer, size_t size) : buf(buffer), capacity(size), len(0), overflow(false) {}
+
+  void put(uint8_t b) {
+    if (len < capacity) buf[len++] = b;
+    else overflow = true;
+  }
+
+  void putVarint(uint32_t v) {
+    while (v >= 0x80) {
+      put(v | 0x80);
+      v >>= 7;
+    }
+    put(v);
+  }
+
+  void putLiteral(const uint8_t* data, size_t n) {
+    if (n == 0) return;
+    size_t m = n - 1;
+    if (m < 60) {
+      put(m << 2);
+    } else if (m < 256) {
+      put(60 << 2); put(m);
+    } else {
+      put(61 << 2); put(m); put(m >> 8);
+    }
+    if (len + n > capacity) {
+      overflow = true;
+      return;
+    }
+    memcpy(buf + len, data, n);
+    len += n;
+  }
+
+  void putCopy(uint16_t offset, size_t n) {
+    while (n > 0) {
+      uint8_t chunk = min(n, (size_t)SNAPPY_MAX_COPY);
+      put(((chunk - 1) << 2) | 2);
+      put(offset); put(offset >> 8);
+      n -= chunk;
+    }
+  }
+};
+
+inline uint16_t snappyHash(const uint8_t* p) {
+  uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+  return (uint16_t)((uint32_t)(v * 0x1E35A7BDU) >> (32 - SNAPPY_HASH_BITS));
+}
+
+/**
+ * @brief Compress a buffer into one Snappy block
+ * @return Compressed length, 0 if it did not fit
+ */
+inline size_t snappyCompress(const uint8_t* input, size_t length, uint8_t* output, size_t outputSize) {
+  static uint16_t head[1 << SNAPPY_HASH_BITS];
+  if (length > SNAPPY_MAX_INPUT) return 0;
+
+  SnappyWriter w(output, outputSize);
+  w.putVarint(length);
+
+  memset(head, 0xFF, sizeof(head));
+  size_t literalStart = 0;
+  size_t pos = 0;
+  while (pos + SNAPPY_MIN_MATCH <= length && !w.overflow) {
+    uint16_t h = snappyHash(input + pos);
+    uint16_t candidate = head[h];
+    head[h] = pos;
+    if (candidate == 0xFFFF || memcmp(input + candidate, input + pos, SNAPPY_MIN_MATCH) != 0) {
+      pos++;
+      continue;
+    }
+    size_t n = SNAPPY_MIN_MATCH;
+    while (pos + n < length && input[candidate + n] == input[pos + n]) n++;
+
+    w.putLiteral(input + literalStart, pos - literalStart);
+    w.putCopy(pos - candidate, n);
+    pos += n;
+    literalStart = pos;
+  }
+  w.putLiteral(input + literalStart, length - literalStart);
+  return w.overflow ? 0 : w.len;
+}
+
+#endif // KLIMERKO_SNAPPY_H
@@ -0,0 +1,455 @@
+/**
+ * @file stall_monitor.h
+ * @brief Klimerko Stall Monitor - loop latency and post-mortem capture
+ * @version 7.0 Ultimate
+ *
+ * The hardware watchdog resets a stuck device but says nothing about
+ * what was stuck. loop() is split into tasks (stallMonitor.enter()):
+ * - The running task is mirrored to one RTC memory word, so it is known
+ *   even after a hardware watchdog reset (no callback runs then).
+ * - Tasks of LOOP_TRACE_MIN_MS or more are kept in a small trace.
+ * - A loop() iteration of STALL_WARN_MS or more (near the ~3.2 s software
+ *   watchdog), an exception or a software watchdog reset writes a
+ *   post-mortem to RTC memory: task, time, heap and the trace.
+ * - On the next boot the post-mortem gets the reset info of that boot
+ *   (ESP.getResetInfoPtr()) and is reported once over MQTT (last-reset)
+ *   and kept on /api/stats until the following reset.
+ *
+ * Loop latency percentiles over the last LOOP_WINDOW_SEC are on /metrics.
+ */
+
+#ifndef KLIMERKO_STALL_MONITOR_H
+#define KLIMERKO_STALL_MONITOR_H
+
+#include <Arduino.h>
+#include <time.h>
+#include "config.h"
+#include "types.h"
+#include "integrity.h"
+#include "profiler.h"
+#include "stats_store.h"
+#include "../ArduinoJson-v6.18.5.h"
+
+extern Statistics stats;
+extern bool ntpSynced;
+
+/**
+ * @brief Parts of loop() (and setup) a stall is attributed to
+ */
+enum class LoopTask : uint8_t {
+  NONE,             // Between loop() iterations
+  SETUP,
+  OTA,
+  MDNS,
+  WEB,
+  CONFIG_PORTAL,
+  FW_UPDATE,
+  DEEP_SLEEP,
+  SENSORS,
+  WIFI,
+  MQTT,
+  SINKS,
+  PROM_PUSH,
+  SETTINGS,
+  STATS,
+  UI,               // Button and LED
+
+  COUNT
+};
+
+static const char* const LOOP_TASK_NAMES[(uint8_t)LoopTask::COUNT] = {
+  "none", "setup", "ota", "mdns", "web", "config-portal", "firmware-update", "deep-sleep",
+  "sensors", "wifi", "mqtt", "sinks", "prom-push", "settings", "stats", "ui"
+};
+
+inline const char* loopTaskToString(uint8_t task) {
+  return task < (uint8_t)LoopTask::COUNT ? LOOP_TASK_NAMES[task] : "unknown";
+}
+
+/**
+ * @brief Tasks that block by design (never reported as stalls)
+ */
+inline bool loopTaskMayBlock(LoopTask task) {
+  return task == LoopTask::SETUP || task == LoopTask::FW_UPDATE || task == LoopTask::DEEP_SLEEP;
+}
+
+enum class PostMortemCause : uint8_t {
+  NONE = 0,
+  STALL = 1,        // Slow iteration, the device kept running
+  EXCEPTION = 2,
+  SOFT_WDT = 3,
+  HARD_WDT = 4
+};
+
+inline const char* postMortemCauseToString(PostMortemCause cause) {
+  switch (cause) {
+    case PostMortemCause::STALL: return "stall";
+    case PostMortemCause::EXCEPTION: return "exception";
+    case PostMortemCause::SOFT_WDT: return "soft-wdt";
+    case PostMortemCause::HARD_WDT: return "hw-wdt";
+    default: return "none";
+  }
+}
+
+inline const char* resetReasonToString(uint32_t reason) {
+  switch (reason) {
+    case REASON_DEFAULT_RST: return "power-on";
+    case REASON_WDT_RST: return "hw-wdt";
+    case REASON_EXCEPTION_RST: return "exception";
+    case REASON_SOFT_WDT_RST: return "soft-wdt";
+    case REASON_SOFT_RESTART: return "restart";
+    case REASON_DEEP_SLEEP_AWAKE: return "deep-sleep-wake";
+    case REASON_EXT_SYS_RST: return "external";
+    default: return "unknown";
+  }
+}
+
+/**
+ * @brief One slow task
+ */
+struct TraceEvent {
+  uint32_t ms;              // millis() at the task start
+  uint16_t durationMs;      // Saturates at 65535
+  uint8_t task;             // LoopTask
+  uint8_t running;          // 1 = still running when captured
+};
+
+/**
+ * @brief What was going on before a stall or reset (kept in RTC memory)
+ */
+struct PostMortem {
+  uint8_t cause;            // PostMortemCause
+  uint8_t task;             // LoopTask running at the time
+  uint8_t traceCount;
+  uint8_t reserved;
+  uint32_t boot;            // Boot number it happened in
+  uint32_t uptimeMs;
+  uint32_t epoch;           // Unix time, 0 without NTP
+  uint32_t taskMs;          // How long the task had been running
+  uint32_t loopMaxUs;       // Longest loop() iteration of that boot
+  uint32_t freeHeap;
+  uint32_t maxFreeBlock;    // 0 when captured in the crash callback
+  rst_info reset;           // Reset that ended that boot (filled on the next boot)
+  TraceEvent trace[POSTMORTEM_TRACE_EVENTS];  // Oldest first
+};
+
+#define POSTMORTEM_MAGIC       0x4D50534BUL  // "KSPM"
+#define POSTMORTEM_VERSION     1
+#define POSTMORTEM_TASK_MAGIC  0x4B535400UL  // Low byte = LoopTask
+#define POSTMORTEM_RTC_WORDS   ((sizeof(PostMortem) + FRAME_OVERHEAD + 3) / 4)
+
+static_assert(POSTMORTEM_RTC_BLOCK >= STATS_RTC_BLOCK + STATS_RTC_WORDS,
+              "Post-mortem overlaps the stats snapshot");
+static_assert(POSTMORTEM_RTC_BLOCK + 1 + POSTMORTEM_RTC_WORDS <= 128,
+              "Post-mortem exceeds RTC user memory");
+
+/**
+ * @brief Loop latency, current task and post-mortems
+ */
+class StallMonitor {
+private:
+  LoopTask _task;
+  uint32_t _taskStartMs;
+  LoopTask _slowestTask;          // Of the current iteration
+  uint32_t _slowestMs;
+
+  uint32_t _loopStartUs;
+  uint32_t _loopCount;
+  uint64_t _loopTotalUs;
+  uint32_t _loopMaxUs;
+  uint32_t _stalls;
+
+  // Latency histograms (profiler.h buckets): current and last full window
+  uint32_t _window[PERF_HIST_BUCKETS];
+  uint32_t _windowMaxUs;
+  unsigned long _windowStart;
+  uint32_t _last[PERF_HIST_BUCKETS];
+  uint32_t _lastMaxUs;
+  bool _haveLast;
+
+  TraceEvent _trace[POSTMORTEM_TRACE_EVENTS];
+  uint8_t _traceHead;
+  uint8_t _traceCount;
+
+  PostMortem _report;
+  bool _hasReport;
+  bool _reportPending;
+
+  void writeTask() {
+    uint32_t word = POSTMORTEM_TASK_MAGIC | (uint8_t)_task;
+    ESP.rtcUserMemoryWrite(POSTMORTEM_RTC_BLOCK, &word, sizeof(word));
+  }
+
+  void pushTrace(LoopTask task, uint32_t startMs, uint32_t durationMs, bool running) {
+    TraceEvent& e = _trace[(_traceHead + _traceCount) % POSTMORTEM_TRACE_EVENTS];
+    e = {startMs, (uint16_t)min(durationMs, (uint32_t)UINT16_MAX), (uint8_t)task, running};
+    if (_traceCount < POSTMORTEM_TRACE_EVENTS) {
+      _traceCount++;
+    } else {
+      _traceHead = (_traceHead + 1) % POSTMORTEM_TRACE_EVENTS;
+    }
+  }
+
+  void finishTask() {
+    uint32_t ms = millis() - _taskStartMs;
+    if (ms >= LOOP_TRACE_MIN_MS) pushTrace(_task, _taskStartMs, ms, false);
+    if (ms > _slowestMs) {
+      _slowestMs = ms;
+      _slowestTask = _task;
+    }
+  }
+
+  /**
+   * @brief Write a post-mortem to RTC memory
+   * @param inCrash Called from the crash callback (heap may be corrupt)
+   */
+  void capture(PostMortemCause cause, LoopTask task, uint32_t taskMs, bool inCrash) {
+    PostMortem pm;
+    memset(&pm, 0, sizeof(pm));
+    pm.cause = (uint8_t)cause;
+    pm.task = (uint8_t)task;
+    pm.boot = (uint32_t)stats.bootCount;
+    pm.uptimeMs = millis();
+    pm.epoch = ntpSynced ? (uint32_t)time(nullptr) : 0;
+    pm.taskMs = taskMs;
+    pm.loopMaxUs = _loopMaxUs;
+    pm.freeHeap = ESP.getFreeHeap();
+    pm.maxFreeBlock = inCrash ? 0 : ESP.getMaxFreeBlockSize();
+
+    // The task still running goes last, after the newest finished ones
+    uint8_t finished = min(_traceCount, (uint8_t)(inCrash ? POSTMORTEM_TRACE_EVENTS - 1 : POSTMORTEM_TRACE_EVENTS));
+    for (uint8_t i = 0; i < finished; i++) {
+      pm.trace[pm.traceCount++] = _trace[(_traceHead + _traceCount - finished + i) % POSTMORTEM_TRACE_EVENTS];
+    }
+    if (inCrash) {
+      pm.trace[pm.traceCount++] = {_taskStartMs, (uint16_t)min(taskMs, (uint32_t)UINT16_MAX), (uint8_t)_task, 1};
+    }
+
+    uint32_t words[POSTMORTEM_RTC_WORDS];
+    frameEncode((uint8_t*)words, sizeof(words), POSTMORTEM_MAGIC, POSTMORTEM_VERSION, &pm, sizeof(pm));
+    ESP.rtcUserMemoryWrite(POSTMORTEM_RTC_BLOCK + 1, words, sizeof(words));
+  }
+
+  bool readCapture(PostMortem& out) {
+    uint32_t words[POSTMORTEM_RTC_WORDS];
+    if (!ESP.rtcUserMemoryRead(POSTMORTEM_RTC_BLOCK + 1, words, sizeof(words))) return false;
+    FrameView view;
+    if (frameDecode((const uint8_t*)words, sizeof(words), POSTMORTEM_MAGIC, view) != FrameStatus::OK ||
+        view.version != POSTMORTEM_VERSION || view.payloadLength != sizeof(out)) {
+      return false;
+    }
+    memcpy(&out, view.payload, sizeof(out));
+    return true;
+  }
+
+  static uint32_t bucketCount(const uint32_t* hist) {
+    uint32_t n = 0;
+    for (uint8_t i = 0; i < PERF_HIST_BUCKETS; i++) n += hist[i];
+    return n;
+  }
+
+public:
+  StallMonitor()
+    : _task(LoopTask::NONE), _taskStartMs(0), _slowestTask(LoopTask::NONE), _slowestMs(0),
+      _loopStartUs(0), _loopCount(0), _loopTotalUs(0), _loopMaxUs(0), _stalls(0),
+      _windowMaxUs(0), _windowStart(0), _lastMaxUs(0), _haveLast(false),
+      _traceHead(0), _traceCount(0), _hasReport(false), _reportPending(false) {
+    memset(_window, 0, sizeof(_window));
+    memset(_last, 0, sizeof(_last));
+    memset(&_report, 0, sizeof(_report));
+  }
+
+  /**
+   * @brief Pick up the previous boot's post-mortem (first thing in setup)
+   */
+  void begin() {
+    uint32_t taskWord = 0;
+    ESP.rtcUserMemoryRead(POSTMORTEM_RTC_BLOCK, &taskWord, sizeof(taskWord));
+    const rst_info* reset = ESP.getResetInfoPtr();
+
+    _hasReport = readCapture(_report);
+    if (reset->reason == REASON_WDT_RST &&
+        (!_hasReport || _report.cause == (uint8_t)PostMortemCause::STALL)) {
+      // No callback runs on a hardware watchdog reset, only the task word tells
+      if (!_hasReport) memset(&_report, 0, sizeof(_report));
+      _report.cause = (uint8_t)PostMortemCause::HARD_WDT;
+      _report.task = (taskWord & 0xFFFFFF00UL) == POSTMORTEM_TASK_MAGIC ? taskWord & 0xFF
+                                                                       : (uint8_t)LoopTask::NONE;
+      _report.taskMs = 0;  // Unknown
+      _hasReport = true;
+    }
+    if (_hasReport) {
+      _report.reset = *reset;
+      _reportPending = true;
+      DEBUG_PRINTF("[STALL] Last boot: %s in %s, reset: %s\n",
+                   postMortemCauseToString((PostMortemCause)_report.cause),
+                   loopTaskToString(_report.task), resetReasonToString(reset->reason));
+    }
+
+    uint32_t none = 0;  // Report once: break the frame magic
+    ESP.rtcUserMemoryWrite(POSTMORTEM_RTC_BLOCK + 1, &none, sizeof(none));
+
+    _task = LoopTask::SETUP;
+    _taskStartMs = millis();
+    _windowStart = millis();
+    writeTask();
+  }
+
+  /**
+   * @brief Start of a loop() iteration
+   */
+  void loopStart() {
+    _loopStartUs = micros();
+    _slowestMs = 0;
+    _slowestTask = LoopTask::NONE;
+  }
+
+  /**
+   * @brief Mark the next part of loop() as running
+   */
+  void enter(LoopTask task) {
+    finishTask();
+    _task = task;
+    _taskStartMs = millis();
+    writeTask();
+  }
+
+  /**
+   * @brief End of a loop() iteration: latency, stall check
+   */
+  void loopEnd() {
+    enter(LoopTask::NONE);
+    uint32_t us = micros() - _loopStartUs;
+    _loopCount++;
+    _loopTotalUs += us;
+    _loopMaxUs = max(_loopMaxUs, us);
+    _window[perfBucketIndex(us)]++;
+    _windowMaxUs = max(_windowMaxUs, us);
+
+    if (us >= STALL_WARN_MS * 1000UL && !loopTaskMayBlock(_slowestTask)) {
+      _stalls++;
+      DEBUG_PRINTF("[STALL] loop() took %lu ms, %lu ms in %s\n", (unsigned long)(us / 1000),
+                   (unsigned long)_slowestMs, loopTaskToString((uint8_t)_slowestTask));
+      capture(PostMortemCause::STALL, _slowestTask, _slowestMs, false);
+    }
+
+    if (millis() - _windowStart >= LOOP_WINDOW_SEC * 1000UL) {
+      memcpy(_last, _window, sizeof(_last));
+      _lastMaxUs = _windowMaxUs;
+      _haveLast = true;
+      memset(_window, 0, sizeof(_window));
+      _windowMaxUs = 0;
+      _windowStart = millis();
+    }
+  }
+
+  /**
+   * @brief Exception or software watchdog (custom_crash_callback)
+   */
+  void crash(const rst_info* info) {
+    PostMortemCause cause = info->reason == REASON_SOFT_WDT_RST ? PostMortemCause::SOFT_WDT
+                                                                : PostMortemCause::EXCEPTION;
+    capture(cause, _task, millis() - _taskStartMs, true);
+  }
+
+  /**
+   * @brief Loop latency percentile (last full window, else the current one)
+   * @param q Quantile 0..1
+   * @return Microseconds, interpolated within the log2 bucket
+   */
+  uint32_t loopQuantileUs(float q) const {
+    const uint32_t* hist = _haveLast ? _last : _window;
+    uint32_t maxUs = _haveLast ? _lastMaxUs : _windowMaxUs;
+    uint32_t total = bucketCount(hist);
+    if (total == 0) return 0;
+
+    float rank = q * total;
+    uint32_t cumulative = 0;
+    for (uint8_t i = 0; i < PERF_HIST_BUCKETS; i++) {
+      if (hist[i] > 0 && cumulative + hist[i] >= rank) {
+        uint32_t lo = i ? perfBucketBoundUs(i - 1) : 0;
+        uint32_t hi = perfBucketBoundUs(i) ? min(perfBucketBoundUs(i), maxUs) : maxUs;
+        float fraction = (rank - cumulative) / hist[i];
+        return lo + (uint32_t)(fraction * (hi > lo ? hi - lo : 0));
+      }
+      cumulative += hist[i];
+    }
+    return maxUs;
+  }
+
+  uint32_t loopMaxUs() const { return _loopMaxUs; }
+  uint32_t loopCount() const { return _loopCount; }
+  uint32_t stalls() const { return _stalls; }
+
+  bool hasReport() const { return _hasReport; }
+  bool reportPending() const { return _reportPending; }
+  void markReported() { _reportPending = false; }
+  const PostMortem& report() const { return _report; }
+
+  /**
+   * @brief One-line summary of the post-mortem (MQTT last-reset asset)
+   */
+  void describeReport(char* out, size_t size) const {
+    int n = snprintf(out, size, "%s in %s", postMortemCauseToString((PostMortemCause)_report.cause),
+                     loopTaskToString(_report.task));
+    if (n < 0 || (size_t)n >= size) return;
+    if (_report.taskMs) n += snprintf(out + n, size - n, " after %lu ms", (unsigned long)_report.taskMs);
+    if ((size_t)n >= size) return;
+    snprintf(out + n, size - n, " (boot %lu, reset %s, heap %lu)", (unsigned long)_report.boot,
+             resetReasonToString(_report.reset.reason), (unsigned long)_report.freeHeap);
+  }
+
+  /**
+   * @brief Post-mortem as JSON (/api/stats)
+   */
+  void reportToJson(JsonObject out) const {
+    char hex[11];
+    out["cause"] = postMortemCauseToString((PostMortemCause)_report.cause);
+    out["task"] = loopTaskToString(_report.task);
+    out["taskMs"] = _report.taskMs;
+    out["boot"] = _report.boot;
+    out["uptimeMs"] = _report.uptimeMs;
+    out["time"] = _report.epoch;
+    out["loopMaxUs"] = _report.loopMaxUs;
+    out["freeHeap"] = _report.freeHeap;
+    out["maxFreeBlock"] = _report.maxFreeBlock;
+    out["resetReason"] = resetReasonToString(_report.reset.reason);
+    out["exccause"] = _report.reset.exccause;
+    snprintf(hex, sizeof(hex), "0x%08lx", (unsigned long)_report.reset.epc1);
+    out["epc1"] = hex;
+    snprintf(hex, sizeof(hex), "0x%08lx", (unsigned long)_report.reset.excvaddr);
+    out["excvaddr"] = hex;
+
+    JsonArray trace = out.createNestedArray("trace");
+    for (uint8_t i = 0; i < _report.traceCount && i < POSTMORTEM_TRACE_EVENTS; i++) {
+      const TraceEvent& e = _report.trace[i];
+      JsonObject event = trace.createNestedObject();
+      event["ms"] = e.ms;
+      event["task"] = loopTaskToString(e.task);
+      event["durationMs"] = e.durationMs;
+      if (e.running) event["running"] = true;
+    }
+  }
+
+  /**
+   * @brief Loop latency summary in Prometheus text format (pull only)
+   */
+  template <typename Out>
+  void writeExposition(Out& out, const char* device) const {
+    static const float QUANTILES[] = {0.5f, 0.9f, 0.99f};
+    out.printf("# HELP klimerko_loop_latency_seconds loop() iteration time, quantiles over the last %u s\n",
+               LOOP_WINDOW_SEC);
+    out.printf("# TYPE klimerko_loop_latency_seconds summary\n");
+    for (float q : QUANTILES) {
+      out.printf("klimerko_loop_latency_seconds{device=\"%s\",quantile=\"%g\"} %.6f\n",
+                 device, q, loopQuantileUs(q) / 1e6);
+    }
+    out.printf("klimerko_loop_latency_seconds_sum{device=\"%s\"} %.6f\n", device, _loopTotalUs / 1e6);
+    out.printf("klimerko_loop_latency_seconds_count{device=\"%s\"} %lu\n", device,
+               (unsigned long)_loopCount);
+  }
+};
+
+extern StallMonitor stallMonitor;
+
+#endif // KLIMERKO_STALL_MONITOR_H
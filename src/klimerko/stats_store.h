@@ -0,0 +1,251 @@
+/**
+ * @file stats_store.h
+ * @brief Klimerko Statistics Store - crash-safe counters
+ * @version 7.0 Ultimate
+ *
+ * Counters used to reach flash only on a clean restart or deep sleep, so
+ * a watchdog reset or power loss dropped everything since boot.
+ * - Every change is mirrored to RTC user memory (a frame, integrity.h).
+ *   RTC memory survives resets and deep sleep, not power loss.
+ * - Every STATS_CHECKPOINT_SEC of awake time the counters are appended as
+ *   a frame to STATS_LOG_PATH. Appends go to LittleFS (no EEPROM sector
+ *   erase); beyond STATS_LOG_MAX_BYTES the log is rewritten with just the
+ *   newest record.
+ * - At boot every counter is restored as max(RTC, flash): a reset keeps
+ *   the RTC values, a power loss falls back to the last checkpoint.
+ */
+
+#ifndef KLIMERKO_STATS_STORE_H
+#define KLIMERKO_STATS_STORE_H
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <LittleFS.h>
+#include "config.h"
+#include "types.h"
+#include "integrity.h"
+#include "settings_schema.h"
+
+#define STATS_LOG_MAGIC     0x4C54534BUL  // "KSTL"
+#define STATS_RTC_MAGIC     0x5254534BUL  // "KSTR"
+#define STATS_LOG_VERSION   1
+#define STATS_RTC_VERSION   1
+#define STATS_LOG_TMP_PATH  STATS_LOG_PATH ".tmp"
+
+/**
+ * @brief Live copy kept in RTC memory
+ */
+struct StatsRtcSnapshot {
+  Statistics stats;
+  uint64_t checkpointUptime;    // stats.uptimeSeconds at the last flash checkpoint
+};
+
+#define STATS_LOG_RECORD_SIZE  (sizeof(Statistics) + FRAME_OVERHEAD)
+#define STATS_RTC_WORDS        ((sizeof(StatsRtcSnapshot) + FRAME_OVERHEAD + 3) / 4)
+
+static_assert(STATS_RTC_BLOCK + STATS_RTC_WORDS <= 128, "Stats snapshot exceeds RTC user memory");
+
+/**
+ * @brief Owner of the global Statistics
+ */
+class StatsStore {
+private:
+  Statistics& _stats;
+  uint64_t _uptime;             // Total uptime, whole seconds
+  uint64_t _checkpointUptime;
+  uint32_t _sessionMs;
+  unsigned long _lastTick;
+  uint32_t _checkpoints;
+
+  static void takeMax(Statistics& into, const Statistics& other) {
+    into.bootCount = max(into.bootCount, other.bootCount);
+    into.wifiReconnects = max(into.wifiReconnects, other.wifiReconnects);
+    into.mqttReconnects = max(into.mqttReconnects, other.mqttReconnects);
+    into.successfulPublishes = max(into.successfulPublishes, other.successfulPublishes);
+    into.failedPublishes = max(into.failedPublishes, other.failedPublishes);
+    into.uptimeSeconds = max(into.uptimeSeconds, other.uptimeSeconds);
+  }
+
+  void tick() {
+    unsigned long now = millis();
+    _sessionMs += now - _lastTick;
+    _lastTick = now;
+    if (_sessionMs >= 1000) {
+      _uptime += _sessionMs / 1000;
+      _sessionMs %= 1000;
+    }
+    _stats.uptimeSeconds = _uptime;
+  }
+
+  bool readRtc(StatsRtcSnapshot& out) {
+    uint32_t words[STATS_RTC_WORDS];
+    if (!ESP.rtcUserMemoryRead(STATS_RTC_BLOCK, words, sizeof(words))) return false;
+    FrameView view;
+    if (frameDecode((const uint8_t*)words, sizeof(words), STATS_RTC_MAGIC, view) != FrameStatus::OK ||
+        view.version != STATS_RTC_VERSION || view.payloadLength != sizeof(out)) {
+      return false;
+    }
+    memcpy(&out, view.payload, sizeof(out));
+    return true;
+  }
+
+  void writeRtc() {
+    StatsRtcSnapshot snapshot = {_stats, _checkpointUptime};
+    uint32_t words[STATS_RTC_WORDS];
+    frameEncode((uint8_t*)words, sizeof(words), STATS_RTC_MAGIC, STATS_RTC_VERSION,
+                &snapshot, sizeof(snapshot));
+    ESP.rtcUserMemoryWrite(STATS_RTC_BLOCK, words, sizeof(words));
+  }
+
+  /**
+   * @brief Newest intact record of a checkpoint log (a torn tail is skipped)
+   */
+  static bool readLog(const char* path, Statistics& out) {
+    File f = LittleFS.open(path, "r");
+    if (!f) return false;
+    uint8_t record[STATS_LOG_RECORD_SIZE];
+    bool found = false;
+    for (size_t n = f.size() / sizeof(record); n > 0 && !found; n--) {
+      FrameView view;
+      f.seek((n - 1) * sizeof(record), SeekSet);
+      found = f.read(record, sizeof(record)) == sizeof(record) &&
+              frameDecode(record, sizeof(record), STATS_LOG_MAGIC, view) == FrameStatus::OK &&
+              view.version == STATS_LOG_VERSION && view.payloadLength == sizeof(out);
+      if (found) memcpy(&out, view.payload, sizeof(out));
+    }
+    f.close();
+    return found;
+  }
+
+  /**
+   * @brief 7.0 statistics from EEPROM, used once when there is no log yet
+   */
+  static bool readLegacy(Statistics& out) {
+    StatisticsV1 old;
+    EEPROM.begin(EEPROM_USED_SIZE);
+    FrameStatus status = getStatisticsRecord(old);
+    EEPROM.end();
+    if (status != FrameStatus::OK) return false;
+    out.bootCount = old.bootCount;
+    out.wifiReconnects = old.wifiReconnects;
+    out.mqttReconnects = old.mqttReconnects;
+    out.successfulPublishes = old.successfulPublishes;
+    out.failedPublishes = old.failedPublishes;
+    out.uptimeSeconds = old.uptimeSeconds;
+    return true;
+  }
+
+public:
+  explicit StatsStore(Statistics& stats)
+    : _stats(stats), _uptime(0), _checkpointUptime(0), _sessionMs(0),
+      _lastTick(0), _checkpoints(0) {}
+
+  uint32_t checkpoints() const { return _checkpoints; }
+
+  /**
+   * @brief Restore counters and count this boot (after LittleFS is mounted)
+   */
+  void begin() {
+    memset(&_stats, 0, sizeof(_stats));
+    Statistics flash = {};
+    StatsRtcSnapshot rtc;
+    bool haveFlash = readLog(STATS_LOG_PATH, flash) || readLog(STATS_LOG_TMP_PATH, flash);
+    bool haveRtc = readRtc(rtc);
+
+    if (!haveFlash && readLegacy(flash)) {
+      DEBUG_PRINTLN(F("[STATS] Imported from EEPROM"));
+      haveFlash = true;
+    }
+    if (haveFlash) takeMax(_stats, flash);
+    if (haveRtc) {
+      takeMax(_stats, rtc.stats);
+      _checkpointUptime = rtc.checkpointUptime;
+    } else {
+      _checkpointUptime = _stats.uptimeSeconds;
+    }
+    DEBUG_PRINTF("[STATS] Restored from %s%s%s\n", haveRtc ? "RTC" : "",
+                 haveRtc && haveFlash ? " + " : "", haveFlash ? "flash" : (haveRtc ? "" : "nothing"));
+
+    _uptime = _stats.uptimeSeconds;
+    _lastTick = millis();
+    _stats.bootCount++;
+    writeRtc();
+    DEBUG_PRINTF("[STATS] Boot #%lu\n", (unsigned long)_stats.bootCount);
+  }
+
+  /**
+   * @brief Mirror a counter change to RTC memory (cheap, no flash write)
+   */
+  void changed() {
+    tick();
+    writeRtc();
+  }
+
+  /**
+   * @brief Append the counters to the flash log now
+   * @return true if written
+   */
+  bool checkpoint() {
+    tick();
+    uint8_t record[STATS_LOG_RECORD_SIZE];
+    frameEncode(record, sizeof(record), STATS_LOG_MAGIC, STATS_LOG_VERSION, &_stats, sizeof(_stats));
+
+    File f = LittleFS.open(STATS_LOG_PATH, "a");
+    bool full = f && f.size() + sizeof(record) > STATS_LOG_MAX_BYTES;
+    bool ok = f && !full && f.write(record, sizeof(record)) == sizeof(record);
+    if (f) f.close();
+
+    if (full) {
+      // Newest record into a new file, then swap, so a valid log always exists
+      f = LittleFS.open(STATS_LOG_TMP_PATH, "w");
+      ok = f && f.write(record, sizeof(record)) == sizeof(record);
+      if (f) f.close();
+      ok = ok && LittleFS.rename(STATS_LOG_TMP_PATH, STATS_LOG_PATH);
+    }
+    if (!ok) {
+      DEBUG_PRINTLN(F("[STATS] Checkpoint failed"));
+      return false;
+    }
+    _checkpointUptime = _stats.uptimeSeconds;
+    _checkpoints++;
+    writeRtc();
+    DEBUG_PRINTLN(F("[STATS] Checkpoint saved"));
+    return true;
+  }
+
+  /**
+   * @brief Checkpoint when STATS_CHECKPOINT_SEC of awake time has passed
+   *
+   * Awake time survives deep sleep in RTC memory, so sleep cycles reach
+   * a checkpoint too without writing flash on every wake.
+   */
+  void loop() {
+    tick();
+    if (_stats.uptimeSeconds - _checkpointUptime >= STATS_CHECKPOINT_SEC) checkpoint();
+  }
+
+  /**
+   * @brief Before deep sleep: current uptime to RTC, checkpoint if due
+   */
+  void suspend() {
+    changed();
+    loop();
+  }
+
+  /**
+   * @brief Forget all counters (factory reset)
+   */
+  void clear() {
+    memset(&_stats, 0, sizeof(_stats));
+    _uptime = 0;
+    _checkpointUptime = 0;
+    uint32_t words[STATS_RTC_WORDS] = {};
+    ESP.rtcUserMemoryWrite(STATS_RTC_BLOCK, words, sizeof(words));
+    if (LittleFS.exists(STATS_LOG_PATH)) LittleFS.remove(STATS_LOG_PATH);
+    if (LittleFS.exists(STATS_LOG_TMP_PATH)) LittleFS.remove(STATS_LOG_TMP_PATH);
+  }
+};
+
+extern StatsStore statsStore;
+
+#endif // KLIMERKO_STATS_STORE_H
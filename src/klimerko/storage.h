@@ -4,9 +4,10 @@
  * @version 7.0 Ultimate
  * 
  * Handles persistent storage operations including:
- * - EEPROM settings with CRC32 validation
- * - LittleFS data logging
- * - Statistics persistence
+ * - EEPROM settings with CRC32 validation, updates journaled (settings_journal.h),
+ *   older layouts migrated (settings_schema.h)
+ * - LittleFS data logging (JSON log + binary history ring)
+ * - Statistics persistence (RTC memory + flash checkpoints, stats_store.h)
  */
 
 #ifndef KLIMERKO_STORAGE_H
@@ -18,6 +19,10 @@
 #include "config.h"
 #include "types.h"
 #include "utils.h"
+#include "profiler.h"
+#include "settings_journal.h"
+#include "settings_schema.h"
+#include "stats_store.h"
 #include "../ArduinoJson-v6.18.5.h"
 
 // ============================================================================
@@ -78,6 +83,8 @@ inline void getFilesystemInfo(size_t& totalBytes, size_t& usedBytes) {
  * @param uptimeSeconds Current uptime
  */
 inline void logSensorDataToFS(const SensorData& data, unsigned long uptimeSeconds) {
+  PERF_SCOPE(LOG_FS);
+  
   // Create file if doesn't exist
   if (!LittleFS.exists(LOG_FILE_PATH)) {
     File f = LittleFS.open(LOG_FILE_PATH, "w");
@@ -121,9 +128,13 @@ inline void logSensorDataToFS(const SensorData& data, unsigned long uptimeSecond
   entry["pm1"] = data.pm1;
   entry["pm25"] = data.pm25;
   entry["pm10"] = data.pm10;
-  entry["temp"] = serialized(String(data.temperature, 1));
-  entry["hum"] = serialized(String(data.humidity, 1));
-  entry["pres"] = serialized(String(data.pressure, 1));
+  char temp[16], hum[16], pres[16];  // One decimal, written as raw JSON numbers
+  snprintf(temp, sizeof(temp), "%.1f", data.temperature);
+  snprintf(hum, sizeof(hum), "%.1f", data.humidity);
+  snprintf(pres, sizeof(pres), "%.1f", data.pressure);
+  entry["temp"] = serialized((const char*)temp);
+  entry["hum"] = serialized((const char*)hum);
+  entry["pres"] = serialized((const char*)pres);
   
   // Write back
   logFile = LittleFS.open(LOG_FILE_PATH, "w");
@@ -180,6 +191,172 @@ inline size_t getLogFileSize() {
   return size;
 }
 
+// ============================================================================
+// BINARY HISTORY LOG (LittleFS ring buffer)
+// ============================================================================
+
+/**
+ * @brief Open history file and read its header
+ * @param header Output header
+ * @param mode "r" for reading, "r+" for appending
+ * @return Open file, or closed File if missing or incompatible
+ */
+inline File openHistoryFile(HistoryHeader& header, const char* mode = "r") {
+  File f = LittleFS.open(HISTORY_FILE_PATH, mode);
+  if (!f) return f;
+  
+  if (f.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+      frameCheck(&header, sizeof(header), HISTORY_MAGIC, HISTORY_VERSION) != FrameStatus::OK ||
+      header.recordSize != sizeof(HistoryRecord) ||
+      header.capacity == 0 || header.count > header.capacity ||
+      header.head >= header.capacity) {
+    f.close();
+    return File();
+  }
+  return f;
+}
+
+/**
+ * @brief Convert sensor data to a history record
+ * @param data Current sensor data
+ * @param timestamp Record timestamp (seconds)
+ * @return Packed record
+ */
+inline HistoryRecord makeHistoryRecord(const SensorData& data, uint32_t timestamp) {
+  HistoryRecord rec;
+  rec.timestamp = timestamp;
+  rec.pm1 = (uint16_t)clamp(data.pm1, 0, 65535);
+  rec.pm25 = (uint16_t)clamp(data.pm25, 0, 65535);
+  rec.pm10 = (uint16_t)clamp(data.pm10, 0, 65535);
+  rec.temperature = (int16_t)lroundf(data.temperature * 10.0f);
+  rec.humidity = (uint16_t)lroundf(clamp(data.humidity, 0.0f, 100.0f) * 10.0f);
+  rec.pressure = (uint16_t)lroundf(clamp(data.pressure, 0.0f, 6553.5f) * 10.0f);
+  return rec;
+}
+
+// Field order used when a record is handled as a value vector
+#define HISTORY_FIELD_COUNT 7
+
+static const char* const HISTORY_FIELD_NAMES[HISTORY_FIELD_COUNT] = {
+  "ts", "pm1", "pm25", "pm10", "temp", "hum", "pres"
+};
+static const uint8_t HISTORY_FIELD_DECIMALS[HISTORY_FIELD_COUNT] = {
+  0, 0, 0, 0, 1, 1, 1
+};
+
+/**
+ * @brief Unpack history record into signed field values
+ * 
+ * Shared field order for the binary endpoint, the time-series store
+ * and queries.
+ * @param rec Stored record
+ * @param out Output values in HISTORY_FIELD_NAMES order
+ */
+inline void historyRecordFields(const HistoryRecord& rec, int32_t out[HISTORY_FIELD_COUNT]) {
+  out[0] = (int32_t)rec.timestamp;
+  out[1] = rec.pm1;
+  out[2] = rec.pm25;
+  out[3] = rec.pm10;
+  out[4] = rec.temperature;
+  out[5] = rec.humidity;
+  out[6] = rec.pressure;
+}
+
+/**
+ * @brief Pack signed field values back into a history record
+ * @param in Values in HISTORY_FIELD_NAMES order
+ * @return Record
+ */
+inline HistoryRecord historyRecordFromFields(const int32_t in[HISTORY_FIELD_COUNT]) {
+  HistoryRecord rec;
+  rec.timestamp = (uint32_t)in[0];
+  rec.pm1 = (uint16_t)in[1];
+  rec.pm25 = (uint16_t)in[2];
+  rec.pm10 = (uint16_t)in[3];
+  rec.temperature = (int16_t)in[4];
+  rec.humidity = (uint16_t)in[5];
+  rec.pressure = (uint16_t)in[6];
+  return rec;
+}
+
+/**
+ * @brief Append a sample to the binary history ring
+ * @param data Sensor data to store
+ * @param timestamp Unix time (or uptime seconds before NTP sync)
+ * 
+ * Writes one 16-byte slot plus the header instead of rewriting the
+ * whole log. The oldest record is overwritten when the ring is full.
+ */
+inline void appendHistoryRecord(const SensorData& data, uint32_t timestamp) {
+  HistoryHeader header;
+  File f = openHistoryFile(header, "r+");
+  
+  if (!f) {
+    // Missing, damaged or from an incompatible build - start a fresh ring
+    f = LittleFS.open(HISTORY_FILE_PATH, "w+");
+    if (!f) {
+      DEBUG_PRINTLN(F("[FS] Cannot create history file"));
+      return;
+    }
+    header.recordSize = sizeof(HistoryRecord);
+    header.capacity = HISTORY_MAX_RECORDS;
+    header.head = 0;
+    header.count = 0;
+  }
+  
+  HistoryRecord rec = makeHistoryRecord(data, timestamp);
+  f.seek(sizeof(HistoryHeader) + header.head * sizeof(HistoryRecord), SeekSet);
+  f.write((const uint8_t*)&rec, sizeof(rec));
+  
+  header.head = (header.head + 1) % header.capacity;
+  if (header.count < header.capacity) header.count++;
+  frameSeal(&header, sizeof(header), HISTORY_MAGIC, HISTORY_VERSION);
+  f.seek(0, SeekSet);
+  f.write((const uint8_t*)&header, sizeof(header));
+  f.close();
+}
+
+/**
+ * @brief Visit history records in chronological order
+ * @param f History file opened with openHistoryFile()
+ * @param header Its header
+ * @param first Index of first record to visit (0 = oldest)
+ * @param count Number of records to visit
+ * @param visit Callback taking (const HistoryRecord&)
+ * 
+ * Reads in small batches rather than one record at a time.
+ */
+template<typename Visitor>
+inline void forEachHistoryRecord(File& f, const HistoryHeader& header,
+                                 uint32_t first, uint32_t count, Visitor visit) {
+  HistoryRecord batch[16];
+  uint32_t oldest = (header.head + header.capacity - header.count) % header.capacity;
+  uint32_t slot = (oldest + first) % header.capacity;
+  
+  while (count > 0) {
+    uint32_t contiguous = min(count, header.capacity - slot);
+    uint32_t n = min(contiguous, (uint32_t)(sizeof(batch) / sizeof(batch[0])));
+    f.seek(sizeof(HistoryHeader) + slot * sizeof(HistoryRecord), SeekSet);
+    if (f.read((uint8_t*)batch, n * sizeof(HistoryRecord)) != (int)(n * sizeof(HistoryRecord))) {
+      return;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+      visit(batch[i]);
+    }
+    count -= n;
+    slot = (slot + n) % header.capacity;
+  }
+}
+
+/**
+ * @brief Delete the binary history log
+ */
+inline void clearHistoryFile() {
+  if (LittleFS.exists(HISTORY_FILE_PATH)) {
+    LittleFS.remove(HISTORY_FILE_PATH);
+  }
+}
+
 // ============================================================================
 // EEPROM SETTINGS
 // ============================================================================
@@ -202,6 +379,9 @@ inline void loadDefaultSettings(char* devId, char* devToken,
 /**
  * @brief Restore settings from EEPROM with CRC32 validation
  * @return true if valid settings restored
+ * 
+ * Settings from an older firmware are migrated (settings_schema.h) and
+ * written back once in the current layout.
  */
 inline bool restoreSettings(char* devId, char* devToken,
                            char* tempOffsetChar, float& tempOffset,
@@ -209,34 +389,28 @@ inline bool restoreSettings(char* devId, char* devToken,
                            bool& deepSleepEnabled, bool& alarmEnabled,
                            char* mqttBroker, uint16_t& mqttBrokerPort,
                            Calibration& cal) {
-  EEPROM.begin(sizeof(Settings));
-  EEPROM.get(0, klimerkoSettings);
-  EEPROM.end();
-  
-  // Verify header
-  if (String(klimerkoSettings.header) != "KLI") {
-    DEBUG_PRINTLN(F("[EEPROM] No valid header - using defaults"));
+  SettingsLoad load = loadSettingsBase(klimerkoSettings);
+  if (load == SettingsLoad::NONE) {
+    defaultSettings(klimerkoSettings);
+    settingsJournal.discard();
     loadDefaultSettings(devId, devToken, tempOffsetChar, tempOffset, 
                         altitudeChar, userAltitude);
     return false;
   }
   
-  // Verify CRC32
-  uint32_t calculatedCrc = calculateSettingsCRC(klimerkoSettings);
-  if (calculatedCrc != klimerkoSettings.crc32) {
-    DEBUG_PRINTLN(F("[EEPROM] CRC mismatch - using defaults"));
-    loadDefaultSettings(devId, devToken, tempOffsetChar, tempOffset, 
-                        altitudeChar, userAltitude);
-    return false;
+  if (load == SettingsLoad::MIGRATED) {
+    settingsJournal.compact();            // New layout, old journal dropped
+  } else {
+    settingsJournal.replay();             // Field updates made since the base was written
   }
   
   // Restore values
   safeStrCopy(devId, klimerkoSettings.deviceId, 32);
   safeStrCopy(devToken, klimerkoSettings.deviceToken, 64);
-  safeStrCopy(tempOffsetChar, klimerkoSettings.tempOffset, 8);
-  tempOffset = atof(tempOffsetChar);
-  safeStrCopy(altitudeChar, klimerkoSettings.altitude, 6);
-  userAltitude = atoi(altitudeChar);
+  tempOffset = klimerkoSettings.tempOffset;
+  snprintf(tempOffsetChar, 8, "%.2f", tempOffset);
+  userAltitude = constrain((int)klimerkoSettings.altitude, MIN_ALTITUDE, MAX_ALTITUDE);
+  snprintf(altitudeChar, 6, "%d", userAltitude);
   
   deepSleepEnabled = klimerkoSettings.deepSleepEnabled;
   alarmEnabled = klimerkoSettings.alarmEnabled;
@@ -271,18 +445,20 @@ inline bool restoreSettings(char* devId, char* devToken,
  * @return true if saved successfully
  */
 inline bool saveSettings(const char* devId, const char* devToken,
-                        const char* tempOffsetChar, const char* altitudeChar,
+                        float tempOffset, int altitude,
                         bool deepSleepEnabled, bool alarmEnabled,
                         const char* mqttBroker, uint16_t mqttBrokerPort,
                         const Calibration& cal) {
   DEBUG_PRINTLN(F("[EEPROM] Saving settings..."));
   
   // Prepare settings struct
-  strcpy(klimerkoSettings.header, "KLI");
+  klimerkoSettings.magic = SETTINGS_MAGIC;
+  klimerkoSettings.version = SETTINGS_VERSION;
+  klimerkoSettings.length = sizeof(Settings);
   safeStrCopy(klimerkoSettings.deviceId, devId, sizeof(klimerkoSettings.deviceId));
   safeStrCopy(klimerkoSettings.deviceToken, devToken, sizeof(klimerkoSettings.deviceToken));
-  safeStrCopy(klimerkoSettings.tempOffset, tempOffsetChar, sizeof(klimerkoSettings.tempOffset));
-  safeStrCopy(klimerkoSettings.altitude, altitudeChar, sizeof(klimerkoSettings.altitude));
+  klimerkoSettings.tempOffset = tempOffset;
+  klimerkoSettings.altitude = (int16_t)altitude;
   klimerkoSettings.deepSleepEnabled = deepSleepEnabled;
   klimerkoSettings.alarmEnabled = alarmEnabled;
   safeStrCopy(klimerkoSettings.mqttBroker, mqttBroker, sizeof(klimerkoSettings.mqttBroker));
@@ -290,51 +466,33 @@ inline bool saveSettings(const char* devId, const char* devToken,
   klimerkoSettings.pm25CalFactor = cal.pm25Factor;
   klimerkoSettings.pm10CalFactor = cal.pm10Factor;
   
-  // Calculate CRC
-  klimerkoSettings.crc32 = calculateSettingsCRC(klimerkoSettings);
-  
-  // Write to EEPROM
-  EEPROM.begin(sizeof(Settings));
-  EEPROM.put(0, klimerkoSettings);
-  bool success = EEPROM.commit();
-  EEPROM.end();
-  
+  // Full save: new EEPROM base (with CRC), journal dropped
+  bool success = settingsJournal.compact();
   if (success) {
     DEBUG_PRINTLN(F("[EEPROM] Settings saved with CRC"));
-  } else {
-    DEBUG_PRINTLN(F("[EEPROM] Save failed!"));
   }
   
   return success;
 }
 
 /**
- * @brief Update single setting field and save
- * @param field Setting field name
- * @param value New value
+ * @brief Update temperature offset (committed later by settingsJournal)
+ * @param offset New offset in Celsius
  */
-inline void updateSetting(const char* field, const char* value) {
-  bool changed = false;
-  
-  if (strcmp(field, "tempOffset") == 0) {
-    safeStrCopy(klimerkoSettings.tempOffset, value, sizeof(klimerkoSettings.tempOffset));
-    changed = true;
-  } else if (strcmp(field, "altitude") == 0) {
-    safeStrCopy(klimerkoSettings.altitude, value, sizeof(klimerkoSettings.altitude));
-    changed = true;
-  } else if (strcmp(field, "mqttBroker") == 0) {
-    safeStrCopy(klimerkoSettings.mqttBroker, value, sizeof(klimerkoSettings.mqttBroker));
-    changed = true;
-  }
-  
-  if (changed) {
-    klimerkoSettings.crc32 = calculateSettingsCRC(klimerkoSettings);
-    EEPROM.begin(sizeof(Settings));
-    EEPROM.put(0, klimerkoSettings);
-    EEPROM.commit();
-    EEPROM.end();
-    DEBUG_PRINT(F("[EEPROM] Updated ")); DEBUG_PRINTLN(field);
-  }
+inline void updateTempOffsetSetting(float offset) {
+  klimerkoSettings.tempOffset = offset;
+  settingsJournal.markDirty(SettingKey::TEMP_OFFSET);
+  DEBUG_PRINTF("[EEPROM] Updated tempOffset: %.2f\n", offset);
+}
+
+/**
+ * @brief Update altitude (committed later by settingsJournal)
+ * @param altitude New altitude in meters (MIN_ALTITUDE..MAX_ALTITUDE)
+ */
+inline void updateAltitudeSetting(int altitude) {
+  klimerkoSettings.altitude = (int16_t)altitude;
+  settingsJournal.markDirty(SettingKey::ALTITUDE);
+  DEBUG_PRINTF("[EEPROM] Updated altitude: %d\n", altitude);
 }
 
 /**
@@ -343,25 +501,30 @@ inline void updateSetting(const char* field, const char* value) {
  * @param value New value
  */
 inline void updateBoolSetting(const char* field, bool value) {
-  bool changed = false;
-  
   if (strcmp(field, "deepSleep") == 0) {
     klimerkoSettings.deepSleepEnabled = value;
-    changed = true;
+    settingsJournal.markDirty(SettingKey::DEEP_SLEEP);
   } else if (strcmp(field, "alarmEnabled") == 0) {
     klimerkoSettings.alarmEnabled = value;
-    changed = true;
-  }
-  
-  if (changed) {
-    klimerkoSettings.crc32 = calculateSettingsCRC(klimerkoSettings);
-    EEPROM.begin(sizeof(Settings));
-    EEPROM.put(0, klimerkoSettings);
-    EEPROM.commit();
-    EEPROM.end();
-    DEBUG_PRINT(F("[EEPROM] Updated ")); DEBUG_PRINT(field);
-    DEBUG_PRINT(F(": ")); DEBUG_PRINTLN(value ? "true" : "false");
+    settingsJournal.markDirty(SettingKey::ALARM_ENABLED);
+  } else {
+    return;
   }
+  DEBUG_PRINT(F("[EEPROM] Updated ")); DEBUG_PRINT(field);
+  DEBUG_PRINT(F(": ")); DEBUG_PRINTLN(value ? "true" : "false");
+}
+
+/**
+ * @brief Update custom MQTT broker
+ * @param server Broker host name or address
+ * @param port Broker port
+ */
+inline void updateBrokerSetting(const char* server, uint16_t port) {
+  safeStrCopy(klimerkoSettings.mqttBroker, server, sizeof(klimerkoSettings.mqttBroker));
+  klimerkoSettings.mqttBrokerPort = port;
+  settingsJournal.markDirty(SettingKey::MQTT_BROKER);
+  settingsJournal.markDirty(SettingKey::MQTT_PORT);
+  DEBUG_PRINTF("[EEPROM] Updated mqttBroker: %s:%u\n", server, port);
 }
 
 /**
@@ -371,54 +534,54 @@ inline void updateBoolSetting(const char* field, bool value) {
 inline void updateCalibration(const Calibration& cal) {
   klimerkoSettings.pm25CalFactor = cal.pm25Factor;
   klimerkoSettings.pm10CalFactor = cal.pm10Factor;
-  klimerkoSettings.crc32 = calculateSettingsCRC(klimerkoSettings);
-  
-  EEPROM.begin(sizeof(Settings));
-  EEPROM.put(0, klimerkoSettings);
-  EEPROM.commit();
-  EEPROM.end();
+  settingsJournal.markDirty(SettingKey::PM25_CAL);
+  settingsJournal.markDirty(SettingKey::PM10_CAL);
   
   DEBUG_PRINTF("[EEPROM] Calibration updated - PM2.5: %.2f, PM10: %.2f\n",
                cal.pm25Factor, cal.pm10Factor);
 }
 
+/**
+ * @brief Update state payload format
+ * @param format New format
+ */
+inline void updatePayloadFormat(PayloadFormat format) {
+  klimerkoSettings.payloadFormat = (uint8_t)format;
+  settingsJournal.markDirty(SettingKey::PAYLOAD_FORMAT);
+  
+  DEBUG_PRINT(F("[EEPROM] Payload format: ")); DEBUG_PRINTLN(payloadFormatToString(format));
+}
+
+/**
+ * @brief Get stored payload format
+ * @return Format, JSON if the stored byte is not a known format
+ */
+inline PayloadFormat getStoredPayloadFormat() {
+  if (klimerkoSettings.payloadFormat > (uint8_t)PayloadFormat::CBOR) {
+    return PayloadFormat::JSON;
+  }
+  return (PayloadFormat)klimerkoSettings.payloadFormat;
+}
+
 // ============================================================================
 // STATISTICS PERSISTENCE
 // ============================================================================
 
 /**
- * @brief Load statistics from EEPROM
+ * @brief Restore statistics (RTC memory and flash checkpoints)
  */
 inline void loadStatistics() {
-  size_t statsOffset = sizeof(Settings);
-  EEPROM.begin(statsOffset + sizeof(Statistics));
-  EEPROM.get(statsOffset, stats);
-  EEPROM.end();
-  
-  // Validate (sanity check for garbage data)
-  if (stats.bootCount > 100000 || stats.successfulPublishes > 10000000) {
-    DEBUG_PRINTLN(F("[STATS] Invalid data, resetting"));
-    memset(&stats, 0, sizeof(Statistics));
-  }
-  
-  stats.bootCount++;
-  DEBUG_PRINT(F("[STATS] Boot #")); DEBUG_PRINTLN(stats.bootCount);
+  statsStore.begin();
 }
 
 /**
- * @brief Save statistics to EEPROM
- * @param uptimeSeconds Current uptime
+ * @brief Checkpoint statistics to flash (before restart)
+ * 
+ * Also commits settings changes still waiting for their quiet period.
  */
-inline void saveStatistics(unsigned long uptimeSeconds) {
-  size_t statsOffset = sizeof(Settings);
-  stats.uptimeSeconds = uptimeSeconds;
-  
-  EEPROM.begin(statsOffset + sizeof(Statistics));
-  EEPROM.put(statsOffset, stats);
-  EEPROM.commit();
-  EEPROM.end();
-  
-  DEBUG_PRINTLN(F("[STATS] Saved"));
+inline void saveStatistics() {
+  settingsJournal.commit();
+  statsStore.checkpoint();
 }
 
 /**
@@ -426,6 +589,7 @@ inline void saveStatistics(unsigned long uptimeSeconds) {
  */
 inline void incrementWifiReconnects() {
   stats.wifiReconnects++;
+  statsStore.changed();
 }
 
 /**
@@ -433,6 +597,7 @@ inline void incrementWifiReconnects() {
  */
 inline void incrementMqttReconnects() {
   stats.mqttReconnects++;
+  statsStore.changed();
 }
 
 /**
@@ -440,6 +605,7 @@ inline void incrementMqttReconnects() {
  */
 inline void recordSuccessfulPublish() {
   stats.successfulPublishes++;
+  statsStore.changed();
 }
 
 /**
@@ -447,6 +613,7 @@ inline void recordSuccessfulPublish() {
  */
 inline void recordFailedPublish() {
   stats.failedPublishes++;
+  statsStore.changed();
 }
 
 /**
@@ -482,18 +649,37 @@ inline void factoryReset(WifiMgr& wm) {
   ESP.eraseConfig();
   
   // Clear EEPROM
-  size_t totalSize = sizeof(Settings) + sizeof(Statistics);
-  EEPROM.begin(totalSize);
-  for (size_t i = 0; i < totalSize; i++) {
+  EEPROM.begin(EEPROM_USED_SIZE);
+  for (size_t i = 0; i < EEPROM_USED_SIZE; i++) {
     EEPROM.write(i, 0);
   }
   EEPROM.commit();
   EEPROM.end();
+  statsStore.clear();
   
-  // Clear LittleFS log
+  // Clear LittleFS logs
+  if (LittleFS.exists(SETTINGS_JOURNAL_PATH)) {
+    LittleFS.remove(SETTINGS_JOURNAL_PATH);
+  }
   if (LittleFS.exists(LOG_FILE_PATH)) {
     LittleFS.remove(LOG_FILE_PATH);
   }
+  clearHistoryFile();
+  if (LittleFS.exists(TS_FILE_PATH)) {
+    LittleFS.remove(TS_FILE_PATH);
+  }
+  if (LittleFS.exists(DEADBAND_FILE_PATH)) {
+    LittleFS.remove(DEADBAND_FILE_PATH);
+  }
+  if (LittleFS.exists(SINKS_FILE_PATH)) {
+    LittleFS.remove(SINKS_FILE_PATH);
+  }
+  if (LittleFS.exists(MQTT_TLS_FILE_PATH)) {
+    LittleFS.remove(MQTT_TLS_FILE_PATH);
+  }
+  if (LittleFS.exists(MQTT_TLS_CA_PATH)) {
+    LittleFS.remove(MQTT_TLS_CA_PATH);
+  }
   
   DEBUG_PRINTLN(F("[SYSTEM] Reset complete, rebooting..."));
   delay(500);
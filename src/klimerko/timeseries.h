@@ -0,0 +1,605 @@
+/**
+ * @file timeseries.h
+ * @brief Klimerko Compressed Time-Series Store (LittleFS)
+ * @version 7.0 Ultimate
+ *
+ * Long-term sample history in the spirit of Gorilla (Facebook TSDB):
+ * - Timestamps as delta-of-delta (regular interval costs 1 bit)
+ * - Values as zigzag deltas against the previous sample
+ * - Both use the same prefix code: 0 | 10+4 | 110+8 | 1110+12 | 1111+32 bits
+ *
+ * Samples are packed into fixed-size chunks kept in RAM. A full chunk is
+ * sealed with a CRC32 and written to the next slot of a ring file; the
+ * open chunk is also persisted every TS_FLUSH_SAMPLES samples so a power
+ * cut loses at most that many minutes.
+ *
+ * Chunk slot layout (TS_CHUNK_SIZE bytes):
+ *   TsChunkHeader | bitstream (MSB first) | zero padding
+ *
+ * Each stored sample also updates a per-hour aggregate (sum/min/max and a
+ * coarse histogram per metric) kept in a second file indexed directly by
+ * hour, so long-range queries read one record per hour instead of
+ * decoding every sample.
+ */
+
+#ifndef KLIMERKO_TIMESERIES_H
+#define KLIMERKO_TIMESERIES_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <algorithm>
+#include "config.h"
+#include "types.h"
+#include "utils.h"
+#include "storage.h"
+
+#define TS_CHUNK_MAGIC 0x3143534B  // "KSC1"
+
+/**
+ * @brief Header at the start of every chunk slot
+ */
+struct TsChunkHeader {
+  uint32_t magic;         // TS_CHUNK_MAGIC
+  uint32_t crc32;         // CRC of the rest of the header + bitstream
+  uint32_t seq;           // Monotonic chunk number (ring order)
+  uint32_t startTs;       // First sample timestamp
+  uint32_t endTs;         // Last sample timestamp
+  uint16_t count;         // Samples in chunk
+  uint16_t bitLen;        // Used bits of the bitstream
+};
+
+#define TS_PAYLOAD_BYTES (TS_CHUNK_SIZE - sizeof(TsChunkHeader))
+#define TS_MAX_SAMPLE_BITS (HISTORY_FIELD_COUNT * 36)  // Worst case per sample
+
+// ============================================================================
+// CHUNK DECODING
+// ============================================================================
+
+/**
+ * @brief Check chunk header and CRC
+ * @param chunk Full chunk slot
+ * @return true if chunk holds valid sealed or flushed data
+ */
+inline bool tsChunkValid(const uint8_t* chunk) {
+  const TsChunkHeader* h = (const TsChunkHeader*)chunk;
+  if (h->magic != TS_CHUNK_MAGIC || h->count == 0 ||
+      h->bitLen > TS_PAYLOAD_BYTES * 8) {
+    return false;
+  }
+  size_t len = sizeof(TsChunkHeader) - 8 + (h->bitLen + 7) / 8;
+  return calculateCRC32(chunk + 8, len) == h->crc32;
+}
+
+/**
+ * @brief Decode samples of one chunk
+ * @param chunk Full chunk slot (header + bitstream)
+ * @param fromTs Skip samples older than this
+ * @param toTs Skip samples newer than this
+ * @param visit Callback (const HistoryRecord&) returning false to stop
+ * @return false if the visitor stopped early
+ */
+template<typename Visitor>
+inline bool tsDecodeChunk(const uint8_t* chunk, uint32_t fromTs, uint32_t toTs, Visitor visit) {
+  const TsChunkHeader* h = (const TsChunkHeader*)chunk;
+  const uint8_t* bits = chunk + sizeof(TsChunkHeader);
+  uint16_t pos = 0;
+
+  auto getBits = [&](uint8_t n) -> uint32_t {
+    uint32_t v = 0;
+    while (n--) {
+      v = (v << 1) | ((bits[pos >> 3] >> (7 - (pos & 7))) & 1);
+      pos++;
+    }
+    return v;
+  };
+  auto getValue = [&]() -> int32_t {
+    uint32_t z;
+    if (!getBits(1)) return 0;
+    if (!getBits(1)) z = getBits(4);
+    else if (!getBits(1)) z = getBits(8);
+    else if (!getBits(1)) z = getBits(12);
+    else z = getBits(32);
+    return (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+  };
+
+  int32_t cur[HISTORY_FIELD_COUNT] = {0};
+  int32_t delta = 0;
+  cur[0] = (int32_t)h->startTs;
+
+  for (uint16_t n = 0; n < h->count && pos < h->bitLen; n++) {
+    delta += getValue();
+    cur[0] += delta;
+    for (uint8_t i = 1; i < HISTORY_FIELD_COUNT; i++) {
+      cur[i] += getValue();
+    }
+    uint32_t ts = (uint32_t)cur[0];
+    if (ts >= fromTs && ts <= toTs && !visit(historyRecordFromFields(cur))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// ============================================================================
+// HOURLY PRE-AGGREGATES
+// ============================================================================
+
+#define TS_AGG_METRICS (HISTORY_FIELD_COUNT - 1)  // All fields except ts
+#define TS_HIST_BUCKETS 12
+#define TS_MIN_EPOCH 1600000000UL  // Older timestamps are uptime, not wall time
+
+// Upper edges of histogram buckets per metric (scaled units, last bucket open)
+static const int16_t TS_HIST_EDGES[TS_AGG_METRICS][TS_HIST_BUCKETS - 1] = {
+  {5, 10, 15, 20, 25, 35, 50, 75, 100, 150, 250},                         // pm1
+  {5, 10, 15, 20, 25, 35, 50, 75, 100, 150, 250},                         // pm25
+  {5, 10, 15, 20, 25, 35, 50, 75, 100, 150, 250},                         // pm10
+  {-100, 0, 50, 100, 150, 200, 250, 300, 350, 400, 450},                  // temp
+  {200, 300, 400, 450, 500, 550, 600, 650, 700, 800, 900},                // hum
+  {9000, 9300, 9500, 9700, 9800, 9900, 10000, 10100, 10200, 10300, 10500} // pres
+};
+
+/**
+ * @brief Aggregate of one metric over one hour
+ */
+struct TsMetricAgg {
+  int32_t sum;
+  int16_t min;
+  int16_t max;
+  uint8_t hist[TS_HIST_BUCKETS];  // Saturating sample counts
+};
+
+/**
+ * @brief One hour of pre-aggregated samples (128 bytes)
+ */
+struct TsHourAgg {
+  uint32_t hourTs;                // Start of hour (Unix time)
+  uint16_t count;                 // Samples in hour
+  uint16_t reserved;
+  TsMetricAgg m[TS_AGG_METRICS];  // HISTORY_FIELD_NAMES[1..] order
+};
+
+/**
+ * @brief Histogram bucket for a metric value
+ */
+inline uint8_t tsHistBucket(uint8_t metric, int32_t v) {
+  uint8_t b = 0;
+  while (b < TS_HIST_BUCKETS - 1 && v > TS_HIST_EDGES[metric][b]) b++;
+  return b;
+}
+
+/**
+ * @brief Direct-indexed ring of hourly aggregates
+ *
+ * Slot = hour number % TS_HOURLY_SLOTS; each record carries its hour so
+ * stale slots from an earlier lap are recognised. Only wall-clock
+ * (NTP) timestamps are aggregated.
+ */
+class TsHourlyStore {
+private:
+  TsHourAgg _cur;
+
+  static uint32_t slotOffset(uint32_t hourTs) {
+    return ((hourTs / 3600) % TS_HOURLY_SLOTS) * sizeof(TsHourAgg);
+  }
+
+  void write() {
+    File f = LittleFS.open(TS_HOURLY_PATH, LittleFS.exists(TS_HOURLY_PATH) ? "r+" : "w+");
+    if (!f) return;
+    f.seek(slotOffset(_cur.hourTs), SeekSet);
+    f.write((const uint8_t*)&_cur, sizeof(_cur));
+    f.close();
+  }
+
+public:
+  TsHourlyStore() { memset(&_cur, 0, sizeof(_cur)); }
+
+  /**
+   * @brief Read the aggregate for one hour
+   * @param hourTs Start of hour
+   * @param out Output record
+   * @return true if the hour has data
+   */
+  bool read(uint32_t hourTs, TsHourAgg& out) {
+    if (_cur.count > 0 && _cur.hourTs == hourTs) {
+      out = _cur;
+      return true;
+    }
+    File f = LittleFS.open(TS_HOURLY_PATH, "r");
+    if (!f) return false;
+    bool ok = f.seek(slotOffset(hourTs), SeekSet) &&
+              f.read((uint8_t*)&out, sizeof(out)) == sizeof(out) &&
+              out.hourTs == hourTs && out.count > 0;
+    f.close();
+    return ok;
+  }
+
+  /**
+   * @brief Visit hours in a range, reading the file once
+   * @param fromTs First hour start (aligned to 3600)
+   * @param toTs Last timestamp to include
+   * @param visit Callback (uint32_t hourTs, const TsHourAgg* agg) returning
+   *              false to stop; agg is nullptr for hours without data
+   * @return false if the visitor stopped early
+   */
+  template<typename Visitor>
+  bool forEachHour(uint32_t fromTs, uint32_t toTs, Visitor visit) {
+    File f = LittleFS.open(TS_HOURLY_PATH, "r");
+    TsHourAgg agg;
+    for (uint32_t h = fromTs; h <= toTs && h >= fromTs; h += 3600) {
+      bool found = false;
+      if (_cur.count > 0 && _cur.hourTs == h) {
+        agg = _cur;
+        found = true;
+      } else if (f && f.seek(slotOffset(h), SeekSet) &&
+                 f.read((uint8_t*)&agg, sizeof(agg)) == sizeof(agg)) {
+        found = agg.hourTs == h && agg.count > 0;
+      }
+      if (!visit(h, found ? &agg : nullptr)) {
+        if (f) f.close();
+        return false;
+      }
+    }
+    if (f) f.close();
+    return true;
+  }
+
+  /**
+   * @brief Fold a sample into its hour
+   * @param fields Sample values in HISTORY_FIELD_NAMES order
+   */
+  void add(const int32_t fields[HISTORY_FIELD_COUNT]) {
+    uint32_t ts = (uint32_t)fields[0];
+    if (ts < TS_MIN_EPOCH) return;
+    uint32_t hourTs = ts - ts % 3600;
+
+    if (_cur.count > 0 && _cur.hourTs != hourTs) {
+      write();
+      _cur.count = 0;
+    }
+    if (_cur.count == 0 && !read(hourTs, _cur)) {
+      // New hour (or resume one persisted before a reboot)
+      memset(&_cur, 0, sizeof(_cur));
+      _cur.hourTs = hourTs;
+      for (uint8_t i = 0; i < TS_AGG_METRICS; i++) {
+        _cur.m[i].min = INT16_MAX;
+        _cur.m[i].max = INT16_MIN;
+      }
+    }
+
+    for (uint8_t i = 0; i < TS_AGG_METRICS; i++) {
+      int16_t v = (int16_t)clamp(fields[i + 1], (int32_t)INT16_MIN, (int32_t)INT16_MAX);
+      TsMetricAgg& m = _cur.m[i];
+      m.sum += v;
+      if (v < m.min) m.min = v;
+      if (v > m.max) m.max = v;
+      uint8_t& bucket = m.hist[tsHistBucket(i, v)];
+      if (bucket < 255) bucket++;
+    }
+    _cur.count++;
+    if (_cur.count % TS_FLUSH_SAMPLES == 0) {
+      write();
+    }
+  }
+};
+
+// ============================================================================
+// TIME-SERIES STORE
+// ============================================================================
+
+/**
+ * @brief Append-only compressed sample store backed by a LittleFS ring
+ *
+ * Uses one TS_CHUNK_SIZE buffer for the open chunk; reads stream one
+ * chunk at a time through a stack buffer.
+ */
+class TimeSeriesStore {
+private:
+  uint8_t _chunk[TS_CHUNK_SIZE];
+  uint16_t _slot;
+  uint32_t _seq;
+  uint16_t _storedChunks;
+  int32_t _prev[HISTORY_FIELD_COUNT];
+  int32_t _prevDelta;
+  TsHourlyStore _hourly;
+
+  TsChunkHeader& header() { return *(TsChunkHeader*)_chunk; }
+
+  void resetChunk() {
+    memset(_chunk, 0, sizeof(_chunk));
+    header().magic = TS_CHUNK_MAGIC;
+    header().seq = _seq;
+  }
+
+  void putBits(uint32_t value, uint8_t n) {
+    uint8_t* bits = _chunk + sizeof(TsChunkHeader);
+    uint16_t& pos = header().bitLen;
+    while (n--) {
+      if ((value >> n) & 1) bits[pos >> 3] |= 0x80 >> (pos & 7);
+      pos++;
+    }
+  }
+
+  void putValue(int32_t v) {
+    uint32_t z = ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);  // zigzag
+    if (z == 0) {
+      putBits(0, 1);
+    } else if (z < 16) {
+      putBits(0x2, 2); putBits(z, 4);
+    } else if (z < 256) {
+      putBits(0x6, 3); putBits(z, 8);
+    } else if (z < 4096) {
+      putBits(0xE, 4); putBits(z, 12);
+    } else {
+      putBits(0xF, 4); putBits(z, 32);
+    }
+  }
+
+  bool writeSlot() {
+    TsChunkHeader& h = header();
+    h.crc32 = calculateCRC32(_chunk + 8, sizeof(TsChunkHeader) - 8 + (h.bitLen + 7) / 8);
+
+    File f = LittleFS.open(TS_FILE_PATH, LittleFS.exists(TS_FILE_PATH) ? "r+" : "w+");
+    if (!f) {
+      DEBUG_PRINTLN(F("[TS] Cannot open store file"));
+      return false;
+    }
+    f.seek((uint32_t)_slot * TS_CHUNK_SIZE, SeekSet);
+    bool ok = f.write(_chunk, TS_CHUNK_SIZE) == TS_CHUNK_SIZE;
+    f.close();
+    return ok;
+  }
+
+public:
+  TimeSeriesStore() : _slot(0), _seq(1), _storedChunks(0), _prevDelta(0) {
+    memset(_prev, 0, sizeof(_prev));
+    resetChunk();
+  }
+
+  /**
+   * @brief Find the newest chunk in the ring and continue after it
+   *
+   * Call after LittleFS is mounted.
+   */
+  void begin() {
+    _storedChunks = 0;
+    uint32_t maxSeq = 0;
+    uint16_t maxSlot = TS_MAX_CHUNKS - 1;
+
+    File f = LittleFS.open(TS_FILE_PATH, "r");
+    if (f) {
+      for (uint16_t i = 0; i < TS_MAX_CHUNKS; i++) {
+        TsChunkHeader h;
+        if (!f.seek((uint32_t)i * TS_CHUNK_SIZE, SeekSet) ||
+            f.read((uint8_t*)&h, sizeof(h)) != sizeof(h)) {
+          break;
+        }
+        if (h.magic != TS_CHUNK_MAGIC || h.count == 0) continue;
+        _storedChunks++;
+        if (h.seq > maxSeq) {
+          maxSeq = h.seq;
+          maxSlot = i;
+        }
+      }
+      f.close();
+    }
+
+    _slot = (maxSlot + 1) % TS_MAX_CHUNKS;
+    _seq = maxSeq + 1;
+    resetChunk();
+    DEBUG_PRINTF("[TS] %u chunks stored, next slot %u\n", _storedChunks, _slot);
+  }
+
+  /**
+   * @brief Add a sample
+   * @param rec Sample (timestamp in seconds)
+   * @return true if stored, false if too close to the previous sample
+   */
+  bool append(const HistoryRecord& rec) {
+    TsChunkHeader& h = header();
+
+    if (h.count > 0) {
+      // Clock stepped back (reboot before NTP) - start a fresh chunk
+      if (rec.timestamp < h.endTs) {
+        seal();
+      } else if (rec.timestamp - h.endTs < TS_SAMPLE_INTERVAL_SEC - 1) {
+        return false;
+      }
+    }
+    if ((size_t)h.bitLen + TS_MAX_SAMPLE_BITS > TS_PAYLOAD_BYTES * 8) {
+      seal();
+    }
+
+    int32_t cur[HISTORY_FIELD_COUNT];
+    historyRecordFields(rec, cur);
+
+    if (h.count == 0) {
+      h.startTs = rec.timestamp;
+      memset(_prev, 0, sizeof(_prev));
+      _prev[0] = cur[0];
+      _prevDelta = 0;
+    }
+
+    int32_t delta = cur[0] - _prev[0];
+    putValue(delta - _prevDelta);
+    _prevDelta = delta;
+    for (uint8_t i = 1; i < HISTORY_FIELD_COUNT; i++) {
+      putValue(cur[i] - _prev[i]);
+    }
+    memcpy(_prev, cur, sizeof(_prev));
+
+    h.count++;
+    h.endTs = rec.timestamp;
+    if (h.count % TS_FLUSH_SAMPLES == 0) {
+      writeSlot();
+    }
+    _hourly.add(cur);
+    return true;
+  }
+
+  /**
+   * @brief Write the open chunk and move to the next slot
+   */
+  void seal() {
+    TsChunkHeader& h = header();
+    if (h.count == 0) return;
+
+    if (writeSlot()) {
+      DEBUG_PRINTF("[TS] Sealed chunk %lu: %u samples, %u bytes\n",
+                   (unsigned long)h.seq, h.count, (h.bitLen + 7) / 8);
+      if (_storedChunks < TS_MAX_CHUNKS) _storedChunks++;
+    }
+    _slot = (_slot + 1) % TS_MAX_CHUNKS;
+    _seq++;
+    resetChunk();
+  }
+
+  /**
+   * @brief Visit stored samples in chronological order
+   * @param fromTs Oldest timestamp to include
+   * @param toTs Newest timestamp to include
+   * @param visit Callback (const HistoryRecord&) returning false to stop
+   * @return false if the visitor stopped early
+   *
+   * Chunks outside the range are skipped by header; chunks failing
+   * their CRC are ignored.
+   */
+  template<typename Visitor>
+  bool forEach(uint32_t fromTs, uint32_t toTs, Visitor visit) {
+    File f = LittleFS.open(TS_FILE_PATH, "r");
+    if (f) {
+      uint8_t buf[TS_CHUNK_SIZE];
+      const TsChunkHeader* h = (const TsChunkHeader*)buf;
+
+      // Oldest chunk sits at the open slot (previous lap) or just after it
+      for (uint16_t i = 0; i < TS_MAX_CHUNKS; i++) {
+        uint16_t slot = (_slot + i) % TS_MAX_CHUNKS;
+        if (!f.seek((uint32_t)slot * TS_CHUNK_SIZE, SeekSet) ||
+            f.read((uint8_t*)h, sizeof(TsChunkHeader)) != sizeof(TsChunkHeader)) {
+          continue;
+        }
+        if (h->magic != TS_CHUNK_MAGIC || h->seq >= _seq ||
+            h->endTs < fromTs || h->startTs > toTs) {
+          continue;
+        }
+        if (f.read(buf + sizeof(TsChunkHeader), TS_PAYLOAD_BYTES) != (int)TS_PAYLOAD_BYTES ||
+            !tsChunkValid(buf)) {
+          continue;
+        }
+        if (!tsDecodeChunk(buf, fromTs, toTs, visit)) {
+          f.close();
+          return false;
+        }
+        yield();
+      }
+      f.close();
+    }
+
+    if (header().count == 0) return true;
+    return tsDecodeChunk(_chunk, fromTs, toTs, visit);
+  }
+
+  /**
+   * @brief Hourly pre-aggregates
+   */
+  TsHourlyStore& hourly() { return _hourly; }
+
+  /**
+   * @brief Number of chunks on flash
+   */
+  uint16_t storedChunks() const { return _storedChunks; }
+
+  /**
+   * @brief Samples in the open (RAM) chunk
+   */
+  uint16_t openSamples() const { return ((const TsChunkHeader*)_chunk)->count; }
+};
+
+// ============================================================================
+// QUERY AGGREGATION
+// ============================================================================
+
+/**
+ * @brief Running aggregate for one query result point
+ *
+ * Keeps up to QUERY_EXACT_VALUES raw values for exact percentiles;
+ * beyond that, or when hourly aggregates are merged in, percentiles
+ * are interpolated from the histogram.
+ */
+struct TsQueryAcc {
+  uint32_t count;
+  int64_t sum;
+  int32_t vmin;
+  int32_t vmax;
+  uint16_t hist[TS_HIST_BUCKETS];
+  int16_t exact[QUERY_EXACT_VALUES];
+  uint16_t exactCount;
+  bool exactOverflow;
+
+  void reset() {
+    count = 0;
+    sum = 0;
+    vmin = INT32_MAX;
+    vmax = INT32_MIN;
+    memset(hist, 0, sizeof(hist));
+    exactCount = 0;
+    exactOverflow = false;
+  }
+
+  void add(uint8_t metric, int32_t v) {
+    count++;
+    sum += v;
+    if (v < vmin) vmin = v;
+    if (v > vmax) vmax = v;
+    hist[tsHistBucket(metric, v)]++;
+    if (exactCount < QUERY_EXACT_VALUES) {
+      exact[exactCount++] = (int16_t)clamp(v, (int32_t)INT16_MIN, (int32_t)INT16_MAX);
+    } else {
+      exactOverflow = true;
+    }
+  }
+
+  void merge(const TsMetricAgg& m, uint16_t n) {
+    count += n;
+    sum += m.sum;
+    if (m.min < vmin) vmin = m.min;
+    if (m.max > vmax) vmax = m.max;
+    for (uint8_t b = 0; b < TS_HIST_BUCKETS; b++) hist[b] += m.hist[b];
+    exactOverflow = true;
+  }
+
+  /**
+   * @brief Percentile in scaled units
+   * @param metric Metric index (histogram edges)
+   * @param pct Percentile 0-100
+   */
+  float percentile(uint8_t metric, uint8_t pct) {
+    if (count == 0) return 0;
+    if (!exactOverflow) {
+      // Nearest-rank on the raw values
+      uint16_t rank = (uint16_t)ceilf(pct / 100.0f * exactCount);
+      if (rank > 0) rank--;
+      std::nth_element(exact, exact + rank, exact + exactCount);
+      return exact[rank];
+    }
+
+    uint32_t total = 0;
+    for (uint8_t b = 0; b < TS_HIST_BUCKETS; b++) total += hist[b];
+    float target = pct / 100.0f * total;
+    uint32_t seen = 0;
+    for (uint8_t b = 0; b < TS_HIST_BUCKETS; b++) {
+      if (hist[b] == 0 || seen + hist[b] < target) {
+        seen += hist[b];
+        continue;
+      }
+      // Interpolate inside the bucket, bounded by the observed range
+      float lo = b == 0 ? vmin : max(vmin, (int32_t)TS_HIST_EDGES[metric][b - 1]);
+      float hi = b == TS_HIST_BUCKETS - 1 ? vmax : min(vmax, (int32_t)TS_HIST_EDGES[metric][b]);
+      return lo + (hi - lo) * (target - seen) / hist[b];
+    }
+    return vmax;
+  }
+};
+
+extern TimeSeriesStore tsStore;
+
+#endif // KLIMERKO_TIMESERIES_H
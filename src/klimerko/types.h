@@ -11,6 +11,8 @@
 
 #include <Arduino.h>
 #include "config.h"
+#include "assets.h"
+#include "integrity.h"
 
 // ============================================================================
 // ENUMERATIONS
@@ -52,54 +54,48 @@ enum class DeviceMode : uint8_t {
 };
 
 /**
- * @brief MQTT Asset identifiers
+ * @brief Encoding of state publishes
  */
-enum class MqttAsset : uint8_t {
-  // Particle measurements
-  PM1,
-  PM2_5,
-  PM10,
-  PM1_CORRECTED,
-  PM2_5_CORRECTED,
-  PM10_CORRECTED,
-  
-  // Particle counts
-  COUNT_0_3,
-  COUNT_0_5,
-  COUNT_1_0,
-  COUNT_2_5,
-  COUNT_5_0,
-  COUNT_10_0,
-  
-  // Environmental
-  TEMPERATURE,
-  HUMIDITY,
-  PRESSURE,
-  DEWPOINT,
-  HUMIDITY_ABS,
-  PRESSURE_SEA,
-  HEAT_INDEX,
-  ALTITUDE,
-  
-  // Device status
-  AIR_QUALITY,
-  SENSOR_STATUS,
-  WIFI_SIGNAL,
-  FIRMWARE,
-  INTERVAL,
-  
-  // Configuration
-  TEMP_OFFSET,
-  ALTITUDE_SET,
-  WIFI_CONFIG,
-  RESTART_DEVICE,
-  FIRMWARE_UPDATE,
-  DEEP_SLEEP,
-  ALARM_ENABLE,
-  CALIBRATION,
-  MQTT_BROKER,
-  
-  UNKNOWN
+enum class PayloadFormat : uint8_t {
+  JSON = 0,       // AllThingsTalk {"asset":{"value":...}} text
+  MSGPACK = 1,    // Same document as MessagePack
+  CBOR = 2        // Same document as CBOR (RFC 8949)
+};
+
+/**
+ * @brief Prometheus push target
+ */
+enum class PromPushMode : uint8_t {
+  OFF = 0,
+  REMOTE_WRITE = 1,   // Snappy protobuf WriteRequest, batched snapshots
+  PUSHGATEWAY = 2     // Text exposition PUT to /metrics/job/...
+};
+
+/**
+ * @brief Journaled Settings fields (values are stored in the journal)
+ */
+enum class SettingKey : uint8_t {
+  DEVICE_ID = 0,
+  DEVICE_TOKEN = 1,
+  TEMP_OFFSET = 2,
+  ALTITUDE = 3,
+  DEEP_SLEEP = 4,
+  MQTT_BROKER = 5,
+  PAYLOAD_FORMAT = 6,
+  MQTT_PORT = 7,
+  ALARM_ENABLED = 8,
+  GMT_OFFSET = 9,
+  PM25_CAL = 10,
+  PM10_CAL = 11
+};
+
+/**
+ * @brief Progress of the asynchronous MQTT connect
+ */
+enum class MqttConnectPhase : uint8_t {
+  IDLE = 0,       // Connected, or waiting out the reconnect backoff
+  RESOLVING = 1,  // DNS lookup of the broker in flight
+  HANDSHAKE = 2   // TCP up, CONNECT sent, waiting for CONNACK
 };
 
 // ============================================================================
@@ -107,35 +103,39 @@ enum class MqttAsset : uint8_t {
 // ============================================================================
 
 /**
- * @brief Persistent device settings stored in EEPROM
- * @note CRC32 must be last field for validation
+ * @brief Persistent device settings stored in EEPROM (schema version 2)
+ * @note A frame (integrity.h): magic/version/length first, CRC32 last.
+ *       Older layouts are migrated by settings_schema.h
  */
 struct Settings {
-  char header[4];                         // "KLI" magic header
+  uint32_t magic;                         // SETTINGS_MAGIC
+  uint16_t version;                       // SETTINGS_VERSION
+  uint16_t length;                        // sizeof(Settings) when written
   char deviceId[DEVICE_ID_SIZE];          // AllThingsTalk Device ID
   char deviceToken[DEVICE_TOKEN_SIZE];    // AllThingsTalk Token
-  char tempOffset[8];                     // Temperature offset as string
-  char altitude[6];                       // Altitude in meters
-  bool deepSleepEnabled;                  // Deep sleep mode flag
-  char mqttBroker[MQTT_SERVER_SIZE];      // Custom MQTT broker
-  uint16_t mqttBrokerPort;                // Custom MQTT port
-  bool alarmEnabled;                      // Alarm system enabled
-  int8_t gmtOffset;                       // GMT offset in hours
+  char mqttBroker[MQTT_SERVER_SIZE];      // Custom MQTT broker (empty = default)
+  float tempOffset;                       // Temperature offset (°C)
   float pm25CalFactor;                    // PM2.5 calibration factor
   float pm10CalFactor;                    // PM10 calibration factor
+  int16_t altitude;                       // Altitude in meters
+  uint16_t mqttBrokerPort;                // Custom MQTT port (0 = default)
+  uint8_t payloadFormat;                  // PayloadFormat
+  int8_t gmtOffset;                       // GMT offset in hours
+  bool deepSleepEnabled;                  // Deep sleep mode flag
+  bool alarmEnabled;                      // Alarm system enabled
   uint32_t crc32;                         // CRC32 checksum (MUST be last)
 };
 
 /**
- * @brief Runtime statistics (persisted separately)
+ * @brief Runtime statistics (kept crash-safe by stats_store.h)
  */
 struct Statistics {
-  uint32_t bootCount;           // Number of device boots
-  uint32_t wifiReconnects;      // WiFi reconnection attempts
-  uint32_t mqttReconnects;      // MQTT reconnection attempts
-  uint32_t successfulPublishes; // Successful MQTT publishes
-  uint32_t failedPublishes;     // Failed MQTT publishes
-  uint32_t uptimeSeconds;       // Total uptime (saved periodically)
+  uint64_t bootCount;           // Number of device boots
+  uint64_t wifiReconnects;      // WiFi reconnection attempts
+  uint64_t mqttReconnects;      // MQTT reconnection attempts
+  uint64_t successfulPublishes; // Successful MQTT publishes
+  uint64_t failedPublishes;     // Failed MQTT publishes
+  uint64_t uptimeSeconds;       // Total uptime over all boots
 };
 
 /**
@@ -186,6 +186,36 @@ struct SensorData {
   SensorStatus bmeStatus;
 };
 
+/**
+ * @brief One fixed-width record of the binary history log
+ * 
+ * Values are stored as scaled integers so records stay 16 bytes.
+ */
+struct __attribute__((packed)) HistoryRecord {
+  uint32_t timestamp;     // Unix time if NTP synced, else uptime seconds
+  uint16_t pm1;           // µg/m³
+  uint16_t pm25;          // µg/m³
+  uint16_t pm10;          // µg/m³
+  int16_t temperature;    // °C × 10
+  uint16_t humidity;      // % × 10
+  uint16_t pressure;      // hPa × 10
+};
+
+/**
+ * @brief Header at the start of the history ring file (a frame, integrity.h)
+ */
+struct HistoryHeader {
+  FrameHeader frame;      // HISTORY_MAGIC, HISTORY_VERSION
+  uint16_t recordSize;    // sizeof(HistoryRecord) when written
+  uint16_t capacity;      // Number of record slots
+  uint32_t head;          // Next slot to write
+  uint32_t count;         // Valid records (<= capacity)
+  uint32_t crc32;         // Frame CRC (MUST be last)
+};
+
+#define HISTORY_MAGIC   0x3152484B  // "KHR1"
+#define HISTORY_VERSION 2
+
 /**
  * @brief Calibration factors
  */
@@ -220,6 +250,23 @@ struct MqttState {
   uint32_t reconnectCount;
   char server[MQTT_SERVER_SIZE];
   uint16_t port;
+  MqttConnectPhase phase;
+  unsigned long phaseStarted;
+  unsigned long reconnectInterval;  // Backoff until the next attempt (with jitter)
+  uint8_t reconnectFailCount;
+};
+
+/**
+ * @brief Last resolved address of the MQTT broker
+ */
+struct MqttDnsCache {
+  char host[MQTT_SERVER_SIZE];
+  uint32_t ip;                  // 0 = nothing cached
+  unsigned long resolvedAt;
+  char lookupHost[MQTT_SERVER_SIZE];  // Name the current lookup is for
+  uint8_t lookupId;             // Matches callbacks to the current lookup
+  volatile bool lookupDone;     // Set from the lwIP DNS callback
+  volatile uint32_t lookupIp;   // 0 = lookup failed
 };
 
 /**
@@ -243,7 +290,7 @@ struct AlarmState {
   unsigned long cooldownMs;
   int pm25Threshold;
   int pm10Threshold;
-  String reason;
+  char reason[ALARM_REASON_SIZE];  // Last triggered alarm
 };
 
 // ============================================================================
@@ -290,66 +337,44 @@ inline const char* sensorStatusToString(SensorStatus status) {
 }
 
 /**
- * @brief Get MQTT asset name string
+ * @brief Get payload format name
+ */
+inline const char* payloadFormatToString(PayloadFormat format) {
+  switch (format) {
+    case PayloadFormat::MSGPACK: return "msgpack";
+    case PayloadFormat::CBOR:    return "cbor";
+    default:                     return "json";
+  }
+}
+
+/**
+ * @brief Parse payload format name (unknown names map to JSON)
+ */
+inline PayloadFormat stringToPayloadFormat(const char* name) {
+  if (name == nullptr) return PayloadFormat::JSON;
+  if (strcmp(name, "msgpack") == 0) return PayloadFormat::MSGPACK;
+  if (strcmp(name, "cbor") == 0) return PayloadFormat::CBOR;
+  return PayloadFormat::JSON;
+}
+
+/**
+ * @brief Get Prometheus push mode name
  */
-inline const char* assetToString(MqttAsset asset) {
-  switch (asset) {
-    case MqttAsset::PM1:            return "pm1";
-    case MqttAsset::PM2_5:          return "pm2-5";
-    case MqttAsset::PM10:           return "pm10";
-    case MqttAsset::PM1_CORRECTED:  return "pm1-c";
-    case MqttAsset::PM2_5_CORRECTED: return "pm2-5-c";
-    case MqttAsset::PM10_CORRECTED: return "pm10-c";
-    case MqttAsset::COUNT_0_3:      return "count-0-3";
-    case MqttAsset::COUNT_0_5:      return "count-0-5";
-    case MqttAsset::COUNT_1_0:      return "count-1-0";
-    case MqttAsset::COUNT_2_5:      return "count-2-5";
-    case MqttAsset::COUNT_5_0:      return "count-5-0";
-    case MqttAsset::COUNT_10_0:     return "count-10-0";
-    case MqttAsset::TEMPERATURE:    return "temperature";
-    case MqttAsset::HUMIDITY:       return "humidity";
-    case MqttAsset::PRESSURE:       return "pressure";
-    case MqttAsset::DEWPOINT:       return "dewpoint";
-    case MqttAsset::HUMIDITY_ABS:   return "humidityAbs";
-    case MqttAsset::PRESSURE_SEA:   return "pressureSea";
-    case MqttAsset::HEAT_INDEX:     return "HeatIndex";
-    case MqttAsset::ALTITUDE:       return "altitude";
-    case MqttAsset::AIR_QUALITY:    return "air-quality";
-    case MqttAsset::SENSOR_STATUS:  return "sensor-status";
-    case MqttAsset::WIFI_SIGNAL:    return "wifi-signal";
-    case MqttAsset::FIRMWARE:       return "firmware";
-    case MqttAsset::INTERVAL:       return "interval";
-    case MqttAsset::TEMP_OFFSET:    return "temperature-offset";
-    case MqttAsset::ALTITUDE_SET:   return "altitude-set";
-    case MqttAsset::WIFI_CONFIG:    return "wifi-config";
-    case MqttAsset::RESTART_DEVICE: return "restart-device";
-    case MqttAsset::FIRMWARE_UPDATE: return "firmware-update";
-    case MqttAsset::DEEP_SLEEP:     return "deep-sleep";
-    case MqttAsset::ALARM_ENABLE:   return "alarm-enable";
-    case MqttAsset::CALIBRATION:    return "calibration";
-    case MqttAsset::MQTT_BROKER:    return "mqtt-broker";
-    default:                        return "unknown";
+inline const char* promPushModeToString(PromPushMode mode) {
+  switch (mode) {
+    case PromPushMode::REMOTE_WRITE: return "remote-write";
+    case PromPushMode::PUSHGATEWAY:  return "pushgateway";
+    default:                         return "off";
   }
 }
 
 /**
- * @brief Parse asset name to enum
+ * @brief Parse Prometheus push mode name (unknown names turn push off)
  */
-inline MqttAsset stringToAsset(const String& name) {
-  if (name == "pm1") return MqttAsset::PM1;
-  if (name == "pm2-5") return MqttAsset::PM2_5;
-  if (name == "pm10") return MqttAsset::PM10;
-  if (name == "interval") return MqttAsset::INTERVAL;
-  if (name == "temperature-offset") return MqttAsset::TEMP_OFFSET;
-  if (name == "altitude-set") return MqttAsset::ALTITUDE_SET;
-  if (name == "wifi-config") return MqttAsset::WIFI_CONFIG;
-  if (name == "restart-device") return MqttAsset::RESTART_DEVICE;
-  if (name == "firmware-update") return MqttAsset::FIRMWARE_UPDATE;
-  if (name == "deep-sleep") return MqttAsset::DEEP_SLEEP;
-  if (name == "alarm-enable") return MqttAsset::ALARM_ENABLE;
-  if (name == "calibration") return MqttAsset::CALIBRATION;
-  if (name == "mqtt-broker") return MqttAsset::MQTT_BROKER;
-  return MqttAsset::UNKNOWN;
+inline PromPushMode stringToPromPushMode(const char* name) {
+  if (strcmp(name, "remote-write") == 0) return PromPushMode::REMOTE_WRITE;
+  if (strcmp(name, "pushgateway") == 0) return PromPushMode::PUSHGATEWAY;
+  return PromPushMode::OFF;
 }
 
 #endif // KLIMERKO_TYPES_H
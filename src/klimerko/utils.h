@@ -12,6 +12,7 @@
 #include <Arduino.h>
 #include "config.h"
 #include "types.h"
+#include "integrity.h"
 
 // ============================================================================
 // CRC32 CALCULATION
@@ -21,22 +22,10 @@
  * @brief Calculate CRC32 checksum for data integrity
  * @param data Pointer to data buffer
  * @param length Length of data in bytes
- * @return CRC32 checksum value
+ * @return CRC32 checksum value (table-driven, see integrity.h)
  */
 inline uint32_t calculateCRC32(const uint8_t* data, size_t length) {
-  uint32_t crc = 0xFFFFFFFF;
-  while (length--) {
-    uint8_t c = *data++;
-    for (uint8_t i = 0; i < 8; i++) {
-      if ((crc ^ c) & 1) {
-        crc = (crc >> 1) ^ 0xEDB88320;
-      } else {
-        crc >>= 1;
-      }
-      c >>= 1;
-    }
-  }
-  return ~crc;
+  return crc32(data, length);
 }
 
 /**
@@ -109,10 +98,12 @@ inline T clamp(T value, T minVal, T maxVal) {
 
 /**
  * @brief Format seconds to human readable uptime string
+ * @param buffer Output buffer (UPTIME_TEXT_SIZE)
+ * @param bufferSize Size of buffer
  * @param seconds Total seconds
- * @return Formatted string like "5d 12:34:56"
+ * @return buffer, formatted like "5d 12:34:56"
  */
-inline String formatUptime(unsigned long seconds) {
+inline char* formatUptime(char* buffer, size_t bufferSize, unsigned long seconds) {
   unsigned long days = seconds / 86400;
   seconds %= 86400;
   unsigned long hours = seconds / 3600;
@@ -120,10 +111,8 @@ inline String formatUptime(unsigned long seconds) {
   unsigned long minutes = seconds / 60;
   seconds %= 60;
   
-  char buffer[24];
-  snprintf(buffer, sizeof(buffer), "%lud %02lu:%02lu:%02lu", 
-           days, hours, minutes, seconds);
-  return String(buffer);
+  snprintf(buffer, bufferSize, "%lud %02lu:%02lu:%02lu", days, hours, minutes, seconds);
+  return buffer;
 }
 
 /**
@@ -251,8 +240,10 @@ inline float calculateHeatIndex(float temperature, float humidity) {
  * @param maxLen Maximum length including null terminator
  */
 inline void safeStrCopy(char* dest, const char* src, size_t maxLen) {
-  strncpy(dest, src, maxLen - 1);
-  dest[maxLen - 1] = '\0';
+  size_t length = 0;
+  while (length < maxLen - 1 && src[length]) length++;
+  memmove(dest, src, length);
+  dest[length] = '\0';
 }
 
 /**
@@ -277,23 +268,6 @@ inline void buildMqttTopic(char* buffer, size_t bufferSize,
   snprintf(buffer, bufferSize, "device/%s/%s", deviceId, suffix);
 }
 
-/**
- * @brief Extract asset name from MQTT topic
- * @param topic Full topic string
- * @return Asset name or empty string
- * 
- * Topic format: device/{deviceId}/asset/{assetName}/command
- */
-inline String extractAssetFromTopic(const String& topic) {
-  int assetStart = topic.indexOf("/asset/") + 7;
-  int assetEnd = topic.lastIndexOf("/command");
-  
-  if (assetStart > 6 && assetEnd > assetStart) {
-    return topic.substring(assetStart, assetEnd);
-  }
-  return "";
-}
-
 // ============================================================================
 // MEDIAN FILTER CLASS
 // ============================================================================
@@ -4,7 +4,11 @@
  * @version 7.0 Ultimate
  * 
  * Provides local web dashboard with real-time data visualization,
- * Chart.js graphs, API endpoints, and Prometheus metrics export.
+ * self-hosted charts, API endpoints, and Prometheus metrics export.
+ * 
+ * Static assets are served pre-gzipped from LittleFS (WEB_ASSET_DIR) when
+ * present, with PROGMEM copies as fallback. Regenerate the LittleFS image
+ * with tools/build_web_assets.py after editing the assets below.
  */
 
 #ifndef KLIMERKO_WEB_DASHBOARD_H
@@ -12,9 +16,14 @@
 
 #include <Arduino.h>
 #include <ESP8266WebServer.h>
+#include <LittleFS.h>
 #include "config.h"
 #include "types.h"
 #include "utils.h"
+#include "storage.h"
+#include "timeseries.h"
+#include "metrics.h"
+#include "profiler.h"
 #include "../ArduinoJson-v6.18.5.h"
 
 // ============================================================================
@@ -30,6 +39,11 @@ extern char klimerkoID[32];
 extern bool ntpSynced;
 extern bool alarmTriggered;
 extern unsigned long bootTime;
+extern uint8_t dataPublishInterval;
+
+// Server-Sent Events subscribers
+extern WiFiClient sseClients[SSE_MAX_CLIENTS];
+extern unsigned long sseLastKeepAlive;
 
 // ============================================================================
 // DASHBOARD HTML (PROGMEM)
@@ -42,7 +56,7 @@ const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
   <meta charset="UTF-8">
   <meta name="viewport" content="width=device-width, initial-scale=1">
   <title>Klimerko Dashboard</title>
-  <script src="https://cdn.jsdelivr.net/npm/chart.js"></script>
+  <script src="/kchart.js?v=1"></script>
   <style>
     :root { --bg: #0f0f1a; --card: #1a1a2e; --card2: #16213e; --text: #eee; --accent: #0f3460; --good: #4ade80; --warn: #fbbf24; --bad: #f87171; --blue: #60a5fa; }
     * { box-sizing: border-box; margin: 0; padding: 0; }
@@ -133,7 +147,7 @@ const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
     <div id="charts" class="panel">
       <div class="grid">
         <div class="card full">
-          <h2>PM History (Last 20 readings)</h2>
+          <h2>PM History (24h)</h2>
           <div class="chart-container"><canvas id="pmChart"></canvas></div>
         </div>
         <div class="card full">
@@ -157,41 +171,32 @@ const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
       </div>
     </div>
     
-    <div class="footer">Klimerko 7.0 Ultimate • Auto-refresh 5s • <a href="/metrics" style="color:#666;">Prometheus</a></div>
+    <div class="footer">Klimerko 7.0 Ultimate • <span id="mode">Connecting...</span> • <a href="/metrics" style="color:#666;">Prometheus</a></div>
   </div>
   
   <script>
     let pmChart, envChart;
     const pmHistory = {labels:[], pm1:[], pm25:[], pm10:[]};
     const envHistory = {labels:[], temp:[], hum:[]};
-    const maxPoints = 20;
+    const maxPoints = 288;  // 24h at the default 5-minute log interval
+    let lastPointMs = 0;    // When a live sample last became a chart point
     
     function initCharts() {
-      const ctx1 = document.getElementById('pmChart').getContext('2d');
-      pmChart = new Chart(ctx1, {
-        type: 'line',
-        data: {
-          labels: pmHistory.labels,
-          datasets: [
-            {label: 'PM1', data: pmHistory.pm1, borderColor: '#60a5fa', tension: 0.3, fill: false},
-            {label: 'PM2.5', data: pmHistory.pm25, borderColor: '#fbbf24', tension: 0.3, fill: false},
-            {label: 'PM10', data: pmHistory.pm10, borderColor: '#f87171', tension: 0.3, fill: false}
-          ]
-        },
-        options: {responsive: true, maintainAspectRatio: false, plugins: {legend: {labels: {color: '#888'}}}, scales: {x: {ticks: {color: '#666'}}, y: {ticks: {color: '#666'}, beginAtZero: true}}}
+      pmChart = new KChart(document.getElementById('pmChart'), {
+        labels: pmHistory.labels, zeroBased: true,
+        datasets: [
+          {label: 'PM1', data: pmHistory.pm1, color: '#60a5fa'},
+          {label: 'PM2.5', data: pmHistory.pm25, color: '#fbbf24'},
+          {label: 'PM10', data: pmHistory.pm10, color: '#f87171'}
+        ]
       });
       
-      const ctx2 = document.getElementById('envChart').getContext('2d');
-      envChart = new Chart(ctx2, {
-        type: 'line',
-        data: {
-          labels: envHistory.labels,
-          datasets: [
-            {label: 'Temp °C', data: envHistory.temp, borderColor: '#f87171', tension: 0.3, yAxisID: 'y'},
-            {label: 'Humidity %', data: envHistory.hum, borderColor: '#60a5fa', tension: 0.3, yAxisID: 'y1'}
-          ]
-        },
-        options: {responsive: true, maintainAspectRatio: false, plugins: {legend: {labels: {color: '#888'}}}, scales: {x: {ticks: {color: '#666'}}, y: {type: 'linear', position: 'left', ticks: {color: '#f87171'}}, y1: {type: 'linear', position: 'right', ticks: {color: '#60a5fa'}, grid: {drawOnChartArea: false}}}}
+      envChart = new KChart(document.getElementById('envChart'), {
+        labels: envHistory.labels,
+        datasets: [
+          {label: 'Temp °C', data: envHistory.temp, color: '#f87171'},
+          {label: 'Humidity %', data: envHistory.hum, color: '#60a5fa', axis: 'y1'}
+        ]
       });
     }
     
@@ -200,6 +205,7 @@ const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
       document.querySelectorAll('.tab').forEach(t => t.classList.remove('active'));
       document.getElementById(id).classList.add('active');
       event.target.classList.add('active');
+      if (id === 'charts') { pmChart.update(); envChart.update(); }  // size canvases once visible
     }
     
     function getStatus(pm, type) {
@@ -213,74 +219,303 @@ const char DASHBOARD_HTML[] PROGMEM = R"rawliteral(
       document.getElementById('time').textContent = new Date().toLocaleTimeString();
     }
     
-    function fetchData() {
-      fetch('/api/data').then(r => r.json()).then(d => {
-        document.getElementById('pm1').textContent = d.pm1 ?? '--';
-        document.getElementById('pm25').textContent = d.pm25 ?? '--';
-        document.getElementById('pm10').textContent = d.pm10 ?? '--';
-        document.getElementById('temp').textContent = d.temp?.toFixed(1) ?? '--';
-        document.getElementById('hum').textContent = d.hum?.toFixed(1) ?? '--';
-        document.getElementById('pres').textContent = d.pres?.toFixed(1) ?? '--';
-        document.getElementById('aq').textContent = d.aq ?? '--';
-        document.getElementById('uptime').textContent = d.uptime ?? '--';
-        document.getElementById('boots').textContent = d.boots ?? '--';
-        document.getElementById('heap').textContent = ((d.heap||0)/1024).toFixed(0) + 'K';
-        document.getElementById('wifi').textContent = d.wifi ?? '--';
-        document.getElementById('publishes').textContent = d.publishes ?? '--';
-        document.getElementById('ntp').textContent = d.ntp ? 'Yes' : 'No';
-        
-        const pm25s = getStatus(d.pm25, 'pm25');
-        const pm10s = getStatus(d.pm10, 'pm10');
-        document.getElementById('pm25-status').className = 'status ' + pm25s.cls;
-        document.getElementById('pm25-status').textContent = pm25s.txt;
-        document.getElementById('pm10-status').className = 'status ' + pm10s.cls;
-        document.getElementById('pm10-status').textContent = pm10s.txt;
-        document.getElementById('aq-status').className = 'status ' + pm10s.cls;
-        document.getElementById('aq-status').textContent = d.aq;
-        
-        document.getElementById('alarm-badge').style.display = d.alarm ? 'block' : 'none';
-        
-        // Update charts
-        const now = new Date().toLocaleTimeString().slice(0,5);
-        pmHistory.labels.push(now); pmHistory.pm1.push(d.pm1); pmHistory.pm25.push(d.pm25); pmHistory.pm10.push(d.pm10);
-        envHistory.labels.push(now); envHistory.temp.push(d.temp); envHistory.hum.push(d.hum);
-        
-        if (pmHistory.labels.length > maxPoints) {
-          pmHistory.labels.shift(); pmHistory.pm1.shift(); pmHistory.pm25.shift(); pmHistory.pm10.shift();
-          envHistory.labels.shift(); envHistory.temp.shift(); envHistory.hum.shift();
-        }
-        
-        if (pmChart) pmChart.update();
-        if (envChart) envChart.update();
+    function render(d) {
+      document.getElementById('pm1').textContent = d.pm1 ?? '--';
+      document.getElementById('pm25').textContent = d.pm25 ?? '--';
+      document.getElementById('pm10').textContent = d.pm10 ?? '--';
+      document.getElementById('temp').textContent = d.temp?.toFixed(1) ?? '--';
+      document.getElementById('hum').textContent = d.hum?.toFixed(1) ?? '--';
+      document.getElementById('pres').textContent = d.pres?.toFixed(1) ?? '--';
+      document.getElementById('aq').textContent = d.aq ?? '--';
+      document.getElementById('uptime').textContent = d.uptime ?? '--';
+      document.getElementById('boots').textContent = d.boots ?? '--';
+      document.getElementById('heap').textContent = ((d.heap||0)/1024).toFixed(0) + 'K';
+      document.getElementById('wifi').textContent = d.wifi ?? '--';
+      document.getElementById('publishes').textContent = d.publishes ?? '--';
+      document.getElementById('ntp').textContent = d.ntp ? 'Yes' : 'No';
+      
+      const pm25s = getStatus(d.pm25, 'pm25');
+      const pm10s = getStatus(d.pm10, 'pm10');
+      document.getElementById('pm25-status').className = 'status ' + pm25s.cls;
+      document.getElementById('pm25-status').textContent = pm25s.txt;
+      document.getElementById('pm10-status').className = 'status ' + pm10s.cls;
+      document.getElementById('pm10-status').textContent = pm10s.txt;
+      document.getElementById('aq-status').className = 'status ' + pm10s.cls;
+      document.getElementById('aq-status').textContent = d.aq;
+      
+      document.getElementById('alarm-badge').style.display = d.alarm ? 'block' : 'none';
+      
+      // Update charts: one new point per log interval like the stored history,
+      // so live samples (every few seconds) cannot push the 24h window out;
+      // in between, the newest point follows the live value
+      const label = new Date().toLocaleTimeString().slice(0,5);
+      const now = Date.now();
+      if (!lastPointMs || now - lastPointMs >= (d.interval || 5) * 60000) {
+        addPoint(label, d);
+        lastPointMs = now;
+      } else {
+        setLastPoint(label, d);
+      }
+      if (pmChart) pmChart.update();
+      if (envChart) envChart.update();
+    }
+    
+    function addPoint(label, d) {
+      pmHistory.labels.push(label); pmHistory.pm1.push(d.pm1); pmHistory.pm25.push(d.pm25); pmHistory.pm10.push(d.pm10);
+      envHistory.labels.push(label); envHistory.temp.push(d.temp); envHistory.hum.push(d.hum);
+      
+      if (pmHistory.labels.length > maxPoints) {
+        pmHistory.labels.shift(); pmHistory.pm1.shift(); pmHistory.pm25.shift(); pmHistory.pm10.shift();
+        envHistory.labels.shift(); envHistory.temp.shift(); envHistory.hum.shift();
+      }
+    }
+    
+    function setLastPoint(label, d) {
+      const i = pmHistory.labels.length - 1;
+      pmHistory.labels[i] = label; pmHistory.pm1[i] = d.pm1; pmHistory.pm25[i] = d.pm25; pmHistory.pm10[i] = d.pm10;
+      envHistory.labels[i] = label; envHistory.temp[i] = d.temp; envHistory.hum[i] = d.hum;
+    }
+    
+    // Decode /api/history.bin (see handleApiHistoryBin) into {field: [values]}
+    function decodeHistory(buf) {
+      const v = new DataView(buf);
+      const str = (o, n) => String.fromCharCode(...new Uint8Array(buf, o, n));
+      if (str(0, 4) !== 'KHB1') throw new Error('bad history magic');
+      const nf = v.getUint8(5), count = v.getUint32(8, true);
+      let o = 12;
+      const fields = [];
+      for (let i = 0; i < nf; i++) {
+        const w = v.getUint8(o), dec = v.getUint8(o+1), nl = v.getUint8(o+2);
+        fields.push({name: str(o+3, nl), w, scale: Math.pow(10, dec)});
+        o += 3 + nl;
+      }
+      const read = {1: p => v.getInt8(p), 2: p => v.getInt16(p, true), 4: p => v.getInt32(p, true)};
+      const out = {}, cur = [];
+      fields.forEach(f => out[f.name] = []);
+      for (let r = 0; r < count; r++) {
+        fields.forEach((f, i) => {
+          const w = r ? f.w : 4;
+          cur[i] = (r ? cur[i] : 0) + read[w](o); o += w;
+          out[f.name].push(cur[i] / f.scale);
+        });
+      }
+      return out;
+    }
+    
+    function historyLabel(ts) {
+      if (ts > 1e9) return new Date(ts * 1000).toLocaleTimeString().slice(0,5);
+      return '+' + Math.floor(ts / 3600) + 'h' + String(Math.floor(ts / 60) % 60).padStart(2, '0');  // uptime
+    }
+    
+    function loadHistory() {
+      return fetch('/api/history.bin?n=' + maxPoints).then(r => r.arrayBuffer()).then(buf => {
+        const h = decodeHistory(buf);
+        h.ts.forEach((ts, i) => addPoint(historyLabel(ts),
+          {pm1: h.pm1[i], pm25: h.pm25[i], pm10: h.pm10[i], temp: h.temp[i], hum: h.hum[i]}));
+        pmChart.update(); envChart.update();
       }).catch(e => console.error(e));
     }
     
+    function fetchData() {
+      fetch('/api/data').then(r => r.json()).then(render).catch(e => console.error(e));
+    }
+    
+    // Live updates: server pushes each new sample over SSE; poll only as fallback
+    let pollTimer = null;
+    function setMode(txt) { document.getElementById('mode').textContent = txt; }
+    function startPolling() {
+      if (pollTimer) return;
+      setMode('Polling 5s');
+      fetchData();
+      pollTimer = setInterval(fetchData, 5000);
+    }
+    function stopPolling() {
+      if (pollTimer) { clearInterval(pollTimer); pollTimer = null; }
+      setMode('Live');
+    }
+    function connectEvents() {
+      if (!window.EventSource) { startPolling(); return; }
+      const es = new EventSource('/api/events');
+      es.addEventListener('sample', e => { stopPolling(); render(JSON.parse(e.data)); });
+      es.onopen = () => stopPolling();
+      es.onerror = () => startPolling();  // EventSource keeps retrying on its own
+    }
+    
     initCharts();
     updateTime();
-    fetchData();
     setInterval(updateTime, 1000);
-    setInterval(fetchData, 5000);
+    loadHistory().then(connectEvents);
   </script>
 </body>
 </html>
 )rawliteral";
 
+// Minimal canvas line chart (replaces Chart.js so the dashboard works offline)
+const char KCHART_JS[] PROGMEM = R"rawliteral(
+/* KChart - minimal line chart for the Klimerko dashboard (no dependencies) */
+class KChart {
+  constructor(canvas, cfg) {
+    this.c = canvas; this.cfg = cfg;
+    this.grid = cfg.grid || '#2a2a3e'; this.text = cfg.text || '#888';
+    window.addEventListener('resize', () => this.update());
+    this.update();
+  }
+  range(axis) {
+    let lo = Infinity, hi = -Infinity;
+    this.cfg.datasets.forEach(d => {
+      if ((d.axis || 'y') !== axis) return;
+      d.data.forEach(v => { if (v != null && isFinite(v)) { lo = Math.min(lo, v); hi = Math.max(hi, v); } });
+    });
+    if (lo === Infinity) return null;
+    if (axis === 'y' && this.cfg.zeroBased) lo = Math.min(0, lo);
+    if (hi - lo < 1e-6) { hi += 1; lo -= (axis === 'y' && this.cfg.zeroBased && lo >= 0) ? 0 : 1; }
+    const pad = (hi - lo) * 0.05;
+    return {lo: lo - (lo === 0 ? 0 : pad), hi: hi + pad};
+  }
+  update() {
+    const c = this.c, p = c.parentNode, dpr = window.devicePixelRatio || 1;
+    const w = p.clientWidth, h = p.clientHeight;
+    if (!w || !h) return;
+    c.width = w * dpr; c.height = h * dpr; c.style.width = w + 'px'; c.style.height = h + 'px';
+    const g = c.getContext('2d'); g.setTransform(dpr, 0, 0, dpr, 0, 0); g.clearRect(0, 0, w, h);
+    g.font = '11px sans-serif'; g.textBaseline = 'middle';
+    const ds = this.cfg.datasets, labels = this.cfg.labels;
+    const hasY1 = ds.some(d => d.axis === 'y1');
+    const L = 40, R = hasY1 ? 40 : 10, T = 24, B = 22, pw = w - L - R, ph = h - T - B;
+    // Legend
+    let lx = L;
+    ds.forEach(d => {
+      g.fillStyle = d.color; g.fillRect(lx, 6, 12, 4);
+      g.fillStyle = this.text; g.textAlign = 'left'; g.fillText(d.label, lx + 16, 8);
+      lx += g.measureText(d.label).width + 32;
+    });
+    const ranges = {y: this.range('y'), y1: hasY1 ? this.range('y1') : null};
+    // Grid and Y ticks
+    g.strokeStyle = this.grid; g.lineWidth = 1;
+    for (let i = 0; i <= 4; i++) {
+      const y = T + ph * i / 4;
+      g.beginPath(); g.moveTo(L, y); g.lineTo(L + pw, y); g.stroke();
+      ['y', 'y1'].forEach(a => {
+        const r = ranges[a]; if (!r) return;
+        const v = r.hi - (r.hi - r.lo) * i / 4;
+        g.fillStyle = a === 'y1' ? (ds.find(d => d.axis === 'y1').color) : (hasY1 ? ds.find(d => (d.axis || 'y') === 'y').color : this.text);
+        g.textAlign = a === 'y' ? 'right' : 'left';
+        g.fillText(Math.abs(v) >= 100 ? v.toFixed(0) : v.toFixed(1), a === 'y' ? L - 4 : L + pw + 4, y);
+      });
+    }
+    // X labels (at most 6)
+    const n = labels.length;
+    const xAt = i => L + (n > 1 ? pw * i / (n - 1) : pw / 2);
+    g.fillStyle = this.text; g.textAlign = 'center';
+    const step = Math.max(1, Math.ceil(n / 6));
+    for (let i = 0; i < n; i += step) g.fillText(labels[i], xAt(i), h - B / 2);
+    // Lines
+    ds.forEach(d => {
+      const r = ranges[d.axis || 'y']; if (!r) return;
+      g.strokeStyle = d.color; g.lineWidth = 2; g.beginPath();
+      let pen = false;
+      d.data.forEach((v, i) => {
+        if (v == null || !isFinite(v)) { pen = false; return; }
+        const x = xAt(i), y = T + ph * (r.hi - v) / (r.hi - r.lo);
+        pen ? g.lineTo(x, y) : g.moveTo(x, y); pen = true;
+      });
+      g.stroke();
+    });
+  }
+}
+)rawliteral";
+
 // ============================================================================
 // HTTP HANDLERS
 // ============================================================================
 
+/**
+ * @brief Get ETag for the PROGMEM asset copies
+ * @return Quoted ETag, stable for one firmware build
+ */
+inline const char* getBuiltinAssetETag() {
+  static char etag[12] = "";
+  if (etag[0] == '\0') {
+    const char stamp[] = FIRMWARE_VERSION __DATE__ __TIME__;
+    snprintf(etag, sizeof(etag), "\"%08x\"", 
+             calculateCRC32((const uint8_t*)stamp, sizeof(stamp) - 1));
+  }
+  return etag;
+}
+
+/**
+ * @brief Serve a static asset, preferring the pre-gzipped LittleFS copy
+ * @param gzPath Path of the gzipped asset on LittleFS
+ * @param contentType MIME type of the uncompressed asset
+ * @param fallback PROGMEM copy served when the file is missing
+ * @param cacheControl Cache-Control header value
+ * 
+ * Answers 304 when the browser already holds the current version.
+ * streamFile() adds Content-Encoding: gzip for *.gz files.
+ */
+inline void serveWebAsset(const char* gzPath, const char* contentType,
+                          PGM_P fallback, const char* cacheControl) {
+  File asset = LittleFS.open(gzPath, "r");
+  
+  char etag[24];
+  if (asset) {
+    snprintf(etag, sizeof(etag), "\"%x-%lx\"", 
+             (unsigned)asset.size(), (unsigned long)asset.getLastWrite());
+  } else {
+    safeStrCopy(etag, getBuiltinAssetETag(), sizeof(etag));
+  }
+  
+  webServer.sendHeader(F("Cache-Control"), cacheControl);
+  webServer.sendHeader(F("ETag"), etag);
+  
+  if (webServer.header(F("If-None-Match")) == etag) {
+    if (asset) asset.close();
+    webServer.send(304);
+    return;
+  }
+  
+  if (asset) {
+    webServer.streamFile(asset, contentType);
+    asset.close();
+    return;
+  }
+  
+  webServer.send_P(200, contentType, fallback);
+}
+
 /**
  * @brief Serve main dashboard page
+ * 
+ * Always revalidated (no-cache) so a firmware update shows up at once;
+ * unchanged pages cost a 304.
  */
 inline void handleRoot() {
-  webServer.send(200, "text/html", DASHBOARD_HTML);
+  serveWebAsset(WEB_ASSET_DIR "/index.html.gz", "text/html", DASHBOARD_HTML, "no-cache");
 }
 
 /**
- * @brief Serve current sensor data as JSON
+ * @brief Serve the chart library
+ * 
+ * Referenced with a version query (?v=N), so it can be cached long-term.
  */
-inline void handleApiData() {
-  StaticJsonDocument<512> doc;
+inline void handleChartJs() {
+  char cacheControl[40];
+  snprintf(cacheControl, sizeof(cacheControl), "public, max-age=%lu", 
+           (unsigned long)WEB_CACHE_MAX_AGE_SEC);
+  serveWebAsset(WEB_ASSET_DIR "/kchart.js.gz", "application/javascript", KCHART_JS, cacheControl);
+}
+
+/**
+ * @brief Serialize current sensor data as JSON
+ * @param buffer Output buffer
+ * @param bufferSize Buffer size
+ * @return Number of bytes written (excluding null terminator)
+ * 
+ * Shared by /api/data and the /api/events live stream.
+ */
+inline size_t buildLiveDataJson(char* buffer, size_t bufferSize) {
+  // Sized by member count: a fixed 512 dropped the last members on 64-bit
+  StaticJsonDocument<JSON_OBJECT_SIZE(20) + UPTIME_TEXT_SIZE> doc;
   
   doc["pm1"] = sensorData.pm1;
   doc["pm25"] = sensorData.pm25;
@@ -289,16 +524,27 @@ inline void handleApiData() {
   doc["hum"] = sensorData.humidity;
   doc["pres"] = sensorData.pressure;
   doc["aq"] = airQualityToString(sensorData.airQuality);
-  doc["uptime"] = formatUptime(getUptimeSeconds(bootTime));
+  char uptime[UPTIME_TEXT_SIZE];
+  doc["uptime"] = formatUptime(uptime, sizeof(uptime), getUptimeSeconds(bootTime));
   doc["heap"] = ESP.getFreeHeap();
+  doc["heapMaxBlock"] = memTelemetry.maxBlock();
+  doc["heapFrag"] = memTelemetry.fragmentation();
   doc["wifi"] = WiFi.isConnected() ? WiFi.RSSI() : 0;
   doc["publishes"] = stats.successfulPublishes;
   doc["boots"] = stats.bootCount;
   doc["ntp"] = ntpSynced;
   doc["alarm"] = alarmTriggered;
+  doc["interval"] = dataPublishInterval;  // Minutes between history records
   
-  String response;
-  serializeJson(doc, response);
+  return serializeJson(doc, buffer, bufferSize);
+}
+
+/**
+ * @brief Serve current sensor data as JSON
+ */
+inline void handleApiData() {
+  char response[JSON_BUFFER_MEDIUM];
+  buildLiveDataJson(response, sizeof(response));
   webServer.send(200, "application/json", response);
 }
 
@@ -306,7 +552,7 @@ inline void handleApiData() {
  * @brief Serve system statistics as JSON
  */
 inline void handleApiStats() {
-  StaticJsonDocument<384> doc;
+  StaticJsonDocument<1536> doc;
   
   doc["bootCount"] = stats.bootCount;
   doc["wifiReconnects"] = stats.wifiReconnects;
@@ -315,10 +561,26 @@ inline void handleApiStats() {
   doc["failedPublishes"] = stats.failedPublishes;
   doc["uptimeSeconds"] = getUptimeSeconds(bootTime);
   doc["freeHeap"] = ESP.getFreeHeap();
+  doc["freeHeapMin"] = memTelemetry.heapFreeMin();
+  doc["heapMaxBlock"] = memTelemetry.maxBlock();
+  doc["heapMaxBlockMin"] = memTelemetry.maxBlockMin();
+  doc["heapFragmentation"] = memTelemetry.fragmentation();
+  doc["heapFragmentationMax"] = memTelemetry.fragmentationMax();
+  doc["stackFreeMin"] = memTelemetry.stackFree();
   doc["chipId"] = ESP.getChipId();
   doc["flashSize"] = ESP.getFlashChipRealSize();
   doc["sketchSize"] = ESP.getSketchSize();
   doc["freeSketch"] = ESP.getFreeSketchSpace();
+  doc["resetReason"] = resetReasonToString(ESP.getResetInfoPtr()->reason);
+  
+  JsonObject loop = doc.createNestedObject("loop");
+  loop["p50Us"] = stallMonitor.loopQuantileUs(0.5f);
+  loop["p99Us"] = stallMonitor.loopQuantileUs(0.99f);
+  loop["maxUs"] = stallMonitor.loopMaxUs();
+  loop["stalls"] = stallMonitor.stalls();
+  if (stallMonitor.hasReport()) {
+    stallMonitor.reportToJson(doc.createNestedObject("lastReset"));
+  }
   
   String response;
   serializeJson(doc, response);
@@ -340,116 +602,542 @@ inline void handleApiLog() {
   webServer.send(200, "application/json", "[]");
 }
 
+// ============================================================================
+// BINARY HISTORY (/api/history.bin)
+// ============================================================================
+//
+// Little-endian layout:
+//   "KHB1" | u8 version | u8 fieldCount | u16 recordSize | u32 count
+//   fieldCount x { u8 width | u8 decimals | u8 nameLen | name }
+//   fieldCount x i32 base values (first record, only if count > 0)
+//   (count - 1) x record of signed deltas, each field `width` bytes
+//
+// Widths (1, 2 or 4) are the smallest that fit every delta in the
+// response, so a value = (base + sum of deltas) / 10^decimals.
+// Fields follow HISTORY_FIELD_NAMES (storage.h).
+
 /**
- * @brief Handle 404 not found
+ * @brief Smallest signed width (1, 2 or 4 bytes) holding a value
  */
-inline void handleNotFound() {
-  webServer.send(404, "text/plain", "Not Found");
+inline uint8_t historyDeltaWidth(int32_t v) {
+  if (v >= -128 && v <= 127) return 1;
+  if (v >= -32768 && v <= 32767) return 2;
+  return 4;
 }
 
-// ============================================================================
-// PROMETHEUS METRICS
-// ============================================================================
+/**
+ * @brief Append little-endian integer to buffer
+ */
+inline size_t putLE(uint8_t* buf, uint32_t v, uint8_t width) {
+  for (uint8_t i = 0; i < width; i++) {
+    buf[i] = (uint8_t)(v >> (8 * i));
+  }
+  return width;
+}
 
 /**
- * @brief Serve Prometheus metrics endpoint
+ * @brief Serve stored history as packed delta-encoded records
+ * 
+ * Optional ?n=<count> limits the response to the newest n records.
+ * Two passes over the ring file: one to size the delta fields, one to
+ * stream the records, so no per-request allocation beyond a small buffer.
+ * Content-Length comes from pass 1; if pass 2 reads fewer records or a
+ * delta no longer fits its width, the connection is dropped so the client
+ * sees a failed transfer instead of a short or garbled body.
  */
-inline void handlePrometheusMetrics() {
-  String metrics = "";
-  String device = String(klimerkoID);
+inline void handleApiHistoryBin() {
+  HistoryHeader header;
+  File f = openHistoryFile(header);
+  uint32_t count = f ? header.count : 0;
   
-  // Sensor metrics
-  metrics += "# HELP klimerko_pm1 PM1.0 concentration in µg/m³\n";
-  metrics += "# TYPE klimerko_pm1 gauge\n";
-  metrics += "klimerko_pm1{device=\"" + device + "\"} " + String(sensorData.pm1) + "\n";
+  if (webServer.hasArg("n")) {
+    long n = webServer.arg("n").toInt();
+    if (n >= 0 && (uint32_t)n < count) count = (uint32_t)n;
+  }
+  uint32_t first = f ? header.count - count : 0;
+  
+  // Pass 1: find the narrowest width per field
+  uint8_t widths[HISTORY_FIELD_COUNT];
+  memset(widths, 1, sizeof(widths));
+  if (count > 1) {
+    int32_t prev[HISTORY_FIELD_COUNT];
+    int32_t cur[HISTORY_FIELD_COUNT];
+    bool havePrev = false;
+    forEachHistoryRecord(f, header, first, count, [&](const HistoryRecord& rec) {
+      historyRecordFields(rec, cur);
+      if (havePrev) {
+        for (uint8_t i = 0; i < HISTORY_FIELD_COUNT; i++) {
+          widths[i] = max(widths[i], historyDeltaWidth(cur[i] - prev[i]));
+        }
+      }
+      memcpy(prev, cur, sizeof(prev));
+      havePrev = true;
+    });
+  }
+  
+  uint16_t recordSize = 0;
+  for (uint8_t i = 0; i < HISTORY_FIELD_COUNT; i++) recordSize += widths[i];
+  
+  // Header
+  uint8_t buf[256];
+  size_t len = 0;
+  memcpy(buf, "KHB1", 4); len = 4;
+  buf[len++] = 1;
+  buf[len++] = HISTORY_FIELD_COUNT;
+  len += putLE(buf + len, recordSize, 2);
+  len += putLE(buf + len, count, 4);
+  for (uint8_t i = 0; i < HISTORY_FIELD_COUNT; i++) {
+    uint8_t nameLen = strlen(HISTORY_FIELD_NAMES[i]);
+    buf[len++] = widths[i];
+    buf[len++] = HISTORY_FIELD_DECIMALS[i];
+    buf[len++] = nameLen;
+    memcpy(buf + len, HISTORY_FIELD_NAMES[i], nameLen);
+    len += nameLen;
+  }
+  
+  size_t total = len + (count > 0 ? 4 * HISTORY_FIELD_COUNT : 0) +
+                 (count > 1 ? (size_t)(count - 1) * recordSize : 0);
+  webServer.sendHeader(F("Cache-Control"), F("no-cache"));
+  webServer.setContentLength(total);
+  webServer.send(200, F("application/octet-stream"), "");
   
-  metrics += "# HELP klimerko_pm25 PM2.5 concentration in µg/m³\n";
-  metrics += "# TYPE klimerko_pm25 gauge\n";
-  metrics += "klimerko_pm25{device=\"" + device + "\"} " + String(sensorData.pm25) + "\n";
+  // Pass 2: base record then deltas
+  uint32_t streamed = 0;
+  bool consistent = true;
+  if (count > 0) {
+    int32_t prev[HISTORY_FIELD_COUNT];
+    int32_t cur[HISTORY_FIELD_COUNT];
+    forEachHistoryRecord(f, header, first, count, [&](const HistoryRecord& rec) {
+      if (!consistent) return;
+      historyRecordFields(rec, cur);
+      if (streamed > 0) {
+        for (uint8_t i = 0; i < HISTORY_FIELD_COUNT; i++) {
+          if (historyDeltaWidth(cur[i] - prev[i]) > widths[i]) consistent = false;
+        }
+        if (!consistent) return;
+      }
+      if (len + 4 * HISTORY_FIELD_COUNT > sizeof(buf)) {
+        webServer.sendContent((const char*)buf, len);
+        len = 0;
+      }
+      for (uint8_t i = 0; i < HISTORY_FIELD_COUNT; i++) {
+        if (streamed > 0) {
+          len += putLE(buf + len, (uint32_t)(cur[i] - prev[i]), widths[i]);
+        } else {
+          len += putLE(buf + len, (uint32_t)cur[i], 4);
+        }
+      }
+      memcpy(prev, cur, sizeof(prev));
+      streamed++;
+    });
+  }
+  if (f) f.close();
+  if (!consistent || streamed != count) {
+    DEBUG_PRINTF("[WEB] History changed while streaming (%lu of %lu records), aborting\n",
+                 (unsigned long)streamed, (unsigned long)count);
+    webServer.client().stop();
+    return;
+  }
+  if (len > 0) webServer.sendContent((const char*)buf, len);
+}
+
+// ============================================================================
+// AGGREGATION QUERIES (/api/query)
+// ============================================================================
+//
+// /api/query?metric=pm25&agg=avg,p95&from=<unix>&to=<unix>&step=<s>&limit=<n>
+//   metric  pm1, pm25, pm10, temp, hum, pres
+//   agg     comma list of avg, min, max, count, p1..p99 (default avg)
+//   from/to Unix seconds (default: last 24 h)
+//   step    point width in seconds (default: whole range)
+//   limit   max result points (default/cap QUERY_DEFAULT_LIMIT)
+//
+// Whole-hour steps are answered from hourly pre-aggregates, shorter ones by
+// decoding raw samples. Scanning stops after QUERY_TIME_BUDGET_MS and the
+// response is marked "truncated" so a large query cannot starve loop().
+//
+// {"metric":"pm25","from":..,"to":..,"step":..,"source":"raw",
+//  "columns":["t","avg","p95"],"points":[[t,avg,p95],...],"truncated":false}
+
+#define QUERY_MAX_AGGS 6
+#define QUERY_MIN_STEP 60
+
+enum class QueryAgg : uint8_t { AVG, MIN, MAX, COUNT, PERCENTILE };
+
+/**
+ * @brief Parsed /api/query parameters
+ */
+struct QuerySpec {
+  uint8_t metric;                  // Index into TS_AGG_METRICS
+  uint8_t aggCount;
+  QueryAgg agg[QUERY_MAX_AGGS];
+  uint8_t pct[QUERY_MAX_AGGS];     // For PERCENTILE
+  char aggNames[QUERY_MAX_AGGS][4];
+  uint32_t from;
+  uint32_t to;
+  uint32_t step;
+  uint32_t limit;
+};
+
+/**
+ * @brief Buffered writer for chunked responses
+ */
+struct ChunkedResponse {
+  char buf[512];
+  size_t len = 0;
   
-  metrics += "# HELP klimerko_pm10 PM10 concentration in µg/m³\n";
-  metrics += "# TYPE klimerko_pm10 gauge\n";
-  metrics += "klimerko_pm10{device=\"" + device + "\"} " + String(sensorData.pm10) + "\n";
+  void flush() {
+    if (len > 0) webServer.sendContent(buf, len);
+    len = 0;
+  }
   
-  metrics += "# HELP klimerko_pm25_corrected Humidity-corrected PM2.5 in µg/m³\n";
-  metrics += "# TYPE klimerko_pm25_corrected gauge\n";
-  metrics += "klimerko_pm25_corrected{device=\"" + device + "\"} " + String(sensorData.pm25_corrected) + "\n";
+  void printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    char tmp[160];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(tmp, sizeof(tmp), fmt, args);
+    va_end(args);
+    if (n <= 0) return;
+    n = min(n, (int)sizeof(tmp) - 1);
+    if (len + n > sizeof(buf)) flush();
+    memcpy(buf + len, tmp, n);
+    len += n;
+  }
+};
+
+/**
+ * @brief Parse query parameters
+ * @param q Output spec
+ * @return Error message, or nullptr if valid
+ */
+inline const char* parseQuerySpec(QuerySpec& q) {
+  String metric = webServer.arg("metric");
+  q.metric = TS_AGG_METRICS;
+  for (uint8_t i = 0; i < TS_AGG_METRICS; i++) {
+    if (metric == HISTORY_FIELD_NAMES[i + 1]) q.metric = i;
+  }
+  if (q.metric == TS_AGG_METRICS) return "unknown metric";
   
-  metrics += "# HELP klimerko_pm10_corrected Humidity-corrected PM10 in µg/m³\n";
-  metrics += "# TYPE klimerko_pm10_corrected gauge\n";
-  metrics += "klimerko_pm10_corrected{device=\"" + device + "\"} " + String(sensorData.pm10_corrected) + "\n";
+  String aggs = webServer.hasArg("agg") ? webServer.arg("agg") : String("avg");
+  q.aggCount = 0;
+  int start = 0;
+  while (start <= (int)aggs.length()) {
+    int end = aggs.indexOf(',', start);
+    if (end < 0) end = aggs.length();
+    String name = aggs.substring(start, end);
+    start = end + 1;
+    if (name.length() == 0) continue;
+    if (q.aggCount >= QUERY_MAX_AGGS) return "too many aggregates";
+    
+    uint8_t i = q.aggCount;
+    if (name == "avg") q.agg[i] = QueryAgg::AVG;
+    else if (name == "min") q.agg[i] = QueryAgg::MIN;
+    else if (name == "max") q.agg[i] = QueryAgg::MAX;
+    else if (name == "count") q.agg[i] = QueryAgg::COUNT;
+    else if (name.length() >= 2 && name.length() <= 3 && name[0] == 'p' && isdigit(name[1]) &&
+             (name.length() == 2 || isdigit(name[2])) && name.substring(1).toInt() >= 1) {
+      q.agg[i] = QueryAgg::PERCENTILE;
+      q.pct[i] = name.substring(1).toInt();
+    } else {
+      return "unknown aggregate";
+    }
+    safeStrCopy(q.aggNames[i], name.c_str(), sizeof(q.aggNames[i]));
+    q.aggCount++;
+  }
+  if (q.aggCount == 0) return "no aggregate";
   
-  metrics += "# HELP klimerko_temperature Temperature in Celsius\n";
-  metrics += "# TYPE klimerko_temperature gauge\n";
-  metrics += "klimerko_temperature{device=\"" + device + "\"} " + String(sensorData.temperature, 2) + "\n";
+  uint32_t now = ntpSynced ? (uint32_t)time(nullptr) : millis() / 1000;
+  q.to = webServer.hasArg("to") ? strtoul(webServer.arg("to").c_str(), nullptr, 10) : now;
+  q.from = webServer.hasArg("from") ? strtoul(webServer.arg("from").c_str(), nullptr, 10)
+                                    : (q.to > 86400 ? q.to - 86400 : 0);
+  if (q.from > q.to) return "from after to";
   
-  metrics += "# HELP klimerko_humidity Relative humidity in percent\n";
-  metrics += "# TYPE klimerko_humidity gauge\n";
-  metrics += "klimerko_humidity{device=\"" + device + "\"} " + String(sensorData.humidity, 2) + "\n";
+  q.step = webServer.hasArg("step") ? strtoul(webServer.arg("step").c_str(), nullptr, 10)
+                                    : q.to - q.from + 1;
+  if (q.step < QUERY_MIN_STEP) q.step = QUERY_MIN_STEP;
   
-  metrics += "# HELP klimerko_pressure Atmospheric pressure in hPa\n";
-  metrics += "# TYPE klimerko_pressure gauge\n";
-  metrics += "klimerko_pressure{device=\"" + device + "\"} " + String(sensorData.pressure, 2) + "\n";
+  q.limit = QUERY_DEFAULT_LIMIT;
+  if (webServer.hasArg("limit")) {
+    long limit = webServer.arg("limit").toInt();
+    if (limit > 0 && limit < QUERY_DEFAULT_LIMIT) q.limit = limit;
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Write one result point if it has samples
+ */
+inline void writeQueryPoint(ChunkedResponse& out, const QuerySpec& q, uint32_t t,
+                            TsQueryAcc& acc, bool& first) {
+  if (acc.count == 0) return;
   
-  metrics += "# HELP klimerko_heat_index Heat index in Celsius\n";
-  metrics += "# TYPE klimerko_heat_index gauge\n";
-  metrics += "klimerko_heat_index{device=\"" + device + "\"} " + String(sensorData.heatIndex, 2) + "\n";
+  uint8_t decimals = HISTORY_FIELD_DECIMALS[q.metric + 1];
+  float scale = decimals ? powf(10, decimals) : 1.0f;
+  out.printf("%s[%lu", first ? "" : ",", (unsigned long)t);
+  for (uint8_t i = 0; i < q.aggCount; i++) {
+    switch (q.agg[i]) {
+      case QueryAgg::AVG:
+        out.printf(",%.*f", decimals + 1, (double)acc.sum / acc.count / scale);
+        break;
+      case QueryAgg::MIN:
+        out.printf(",%.*f", decimals, acc.vmin / scale);
+        break;
+      case QueryAgg::MAX:
+        out.printf(",%.*f", decimals, acc.vmax / scale);
+        break;
+      case QueryAgg::COUNT:
+        out.printf(",%lu", (unsigned long)acc.count);
+        break;
+      case QueryAgg::PERCENTILE:
+        out.printf(",%.*f", decimals + 1, acc.percentile(q.metric, q.pct[i]) / scale);
+        break;
+    }
+  }
+  out.printf("]");
+  first = false;
+}
+
+/**
+ * @brief Aggregate stored history on the device
+ */
+inline void handleApiQuery() {
+  QuerySpec q;
+  const char* error = parseQuerySpec(q);
+  if (error) {
+    char body[64];
+    snprintf(body, sizeof(body), "{\"error\":\"%s\"}", error);
+    webServer.send(400, "application/json", body);
+    return;
+  }
   
-  metrics += "# HELP klimerko_dewpoint Dewpoint temperature in Celsius\n";
-  metrics += "# TYPE klimerko_dewpoint gauge\n";
-  metrics += "klimerko_dewpoint{device=\"" + device + "\"} " + String(sensorData.dewpoint, 2) + "\n";
+  bool hourly = q.step % 3600 == 0;
+  if (hourly) q.from -= q.from % 3600;
   
-  // System metrics
-  metrics += "# HELP klimerko_wifi_rssi WiFi signal strength in dBm\n";
-  metrics += "# TYPE klimerko_wifi_rssi gauge\n";
-  metrics += "klimerko_wifi_rssi{device=\"" + device + "\"} " + String(WiFi.isConnected() ? WiFi.RSSI() : 0) + "\n";
+  // Limit guard: clamp the range to at most q.limit points
+  bool truncated = false;
+  if ((q.to - q.from) / q.step >= q.limit) {
+    q.to = q.from + q.limit * q.step - 1;
+    truncated = true;
+  }
   
-  metrics += "# HELP klimerko_uptime_seconds Device uptime in seconds\n";
-  metrics += "# TYPE klimerko_uptime_seconds counter\n";
-  metrics += "klimerko_uptime_seconds{device=\"" + device + "\"} " + String(getUptimeSeconds(bootTime)) + "\n";
+  webServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  webServer.send(200, "application/json", "");
   
-  metrics += "# HELP klimerko_boot_count Number of device boots\n";
-  metrics += "# TYPE klimerko_boot_count counter\n";
-  metrics += "klimerko_boot_count{device=\"" + device + "\"} " + String(stats.bootCount) + "\n";
+  ChunkedResponse out;
+  out.printf("{\"metric\":\"%s\",\"from\":%lu,\"to\":%lu,\"step\":%lu,\"source\":\"%s\",\"columns\":[\"t\"",
+             HISTORY_FIELD_NAMES[q.metric + 1], (unsigned long)q.from, (unsigned long)q.to,
+             (unsigned long)q.step, hourly ? "hourly" : "raw");
+  for (uint8_t i = 0; i < q.aggCount; i++) {
+    out.printf(",\"%s\"", q.aggNames[i]);
+  }
+  out.printf("],\"points\":[");
   
-  metrics += "# HELP klimerko_heap_free Free heap memory in bytes\n";
-  metrics += "# TYPE klimerko_heap_free gauge\n";
-  metrics += "klimerko_heap_free{device=\"" + device + "\"} " + String(ESP.getFreeHeap()) + "\n";
+  TsQueryAcc acc;
+  acc.reset();
+  uint32_t bucketStart = q.from;
+  uint32_t scanned = 0;
+  bool first = true;
+  unsigned long started = millis();
   
-  metrics += "# HELP klimerko_publishes_total Total successful MQTT publishes\n";
-  metrics += "# TYPE klimerko_publishes_total counter\n";
-  metrics += "klimerko_publishes_total{device=\"" + device + "\"} " + String(stats.successfulPublishes) + "\n";
+  auto overBudget = [&]() {
+    if ((++scanned & 31) == 0) {
+      yield();
+      if (millis() - started > QUERY_TIME_BUDGET_MS) {
+        truncated = true;
+        return true;
+      }
+    }
+    return false;
+  };
   
-  metrics += "# HELP klimerko_publishes_failed Total failed MQTT publishes\n";
-  metrics += "# TYPE klimerko_publishes_failed counter\n";
-  metrics += "klimerko_publishes_failed{device=\"" + device + "\"} " + String(stats.failedPublishes) + "\n";
+  if (hourly) {
+    tsStore.hourly().forEachHour(q.from, q.to, [&](uint32_t hourTs, const TsHourAgg* agg) {
+      if (hourTs - bucketStart >= q.step) {
+        writeQueryPoint(out, q, bucketStart, acc, first);
+        acc.reset();
+        bucketStart = hourTs - (hourTs - q.from) % q.step;
+      }
+      if (agg) acc.merge(agg->m[q.metric], agg->count);
+      return !overBudget();
+    });
+  } else {
+    tsStore.forEach(q.from, q.to, [&](const HistoryRecord& rec) {
+      int32_t fields[HISTORY_FIELD_COUNT];
+      // Clock stepped back (NTP correction): the record belongs to a bucket already written
+      if (rec.timestamp < bucketStart) return !overBudget();
+      historyRecordFields(rec, fields);
+      if (rec.timestamp - bucketStart >= q.step) {
+        writeQueryPoint(out, q, bucketStart, acc, first);
+        acc.reset();
+        bucketStart = rec.timestamp - (rec.timestamp - q.from) % q.step;
+      }
+      acc.add(q.metric, fields[q.metric + 1]);
+      return !overBudget();
+    });
+  }
+  writeQueryPoint(out, q, bucketStart, acc, first);
   
-  metrics += "# HELP klimerko_wifi_reconnects Total WiFi reconnection attempts\n";
-  metrics += "# TYPE klimerko_wifi_reconnects counter\n";
-  metrics += "klimerko_wifi_reconnects{device=\"" + device + "\"} " + String(stats.wifiReconnects) + "\n";
+  out.printf("],\"truncated\":%s}", truncated ? "true" : "false");
+  out.flush();
+  webServer.sendContent("");  // Terminate chunked response
+}
+
+// ============================================================================
+// SERVER-SENT EVENTS (/api/events)
+// ============================================================================
+
+/**
+ * @brief Count connected SSE subscribers
+ * @return Number of open event streams
+ */
+inline uint8_t sseClientCount() {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < SSE_MAX_CLIENTS; i++) {
+    if (sseClients[i].connected()) count++;
+  }
+  return count;
+}
+
+/**
+ * @brief Write one SSE event to a subscriber
+ * @param client Subscriber connection
+ * @param event Event name
+ * @param data Event payload (single line)
+ * @return true if the whole event was written
+ */
+inline bool sseSend(WiFiClient& client, const char* event, const char* data) {
+  size_t expected = strlen(event) + strlen(data) + 16;
+  return client.printf("event: %s\ndata: %s\n\n", event, data) == expected;
+}
+
+/**
+ * @brief Push an event to every connected subscriber
+ * @param event Event name
+ * @param data Event payload (single line)
+ * 
+ * Subscribers whose socket can't take the write are dropped; the browser
+ * reconnects on its own.
+ */
+inline void sseBroadcast(const char* event, const char* data) {
+  for (uint8_t i = 0; i < SSE_MAX_CLIENTS; i++) {
+    if (!sseClients[i].connected()) continue;
+    if (!sseSend(sseClients[i], event, data)) {
+      DEBUG_PRINTF("[SSE] Client %u dropped\n", i);
+      sseClients[i].stop();
+    }
+  }
+}
+
+/**
+ * @brief Push the latest sample to all subscribers
+ * 
+ * Call once per new sensor reading. Serializes the sample a single time
+ * regardless of how many browsers are listening.
+ */
+inline void ssePublishSample() {
+  if (sseClientCount() == 0) return;
   
-  metrics += "# HELP klimerko_mqtt_reconnects Total MQTT reconnection attempts\n";
-  metrics += "# TYPE klimerko_mqtt_reconnects counter\n";
-  metrics += "klimerko_mqtt_reconnects{device=\"" + device + "\"} " + String(stats.mqttReconnects) + "\n";
+  char json[JSON_BUFFER_MEDIUM];
+  buildLiveDataJson(json, sizeof(json));
+  sseBroadcast("sample", json);
+}
+
+/**
+ * @brief Open an SSE stream for the requesting browser
+ * 
+ * Keeps a reference to the request's connection so it stays open after
+ * the handler returns. Replies 503 when all slots are taken, which makes
+ * the dashboard fall back to polling.
+ */
+inline void handleApiEvents() {
+  int8_t slot = -1;
+  for (uint8_t i = 0; i < SSE_MAX_CLIENTS; i++) {
+    if (!sseClients[i].connected()) {
+      slot = i;
+      break;
+    }
+  }
   
-  metrics += "# HELP klimerko_alarm_triggered Alarm currently triggered (1=yes, 0=no)\n";
-  metrics += "# TYPE klimerko_alarm_triggered gauge\n";
-  metrics += "klimerko_alarm_triggered{device=\"" + device + "\"} " + String(alarmTriggered ? 1 : 0) + "\n";
+  if (slot < 0) {
+    webServer.send(503, "text/plain", "Too many event streams");
+    return;
+  }
   
-  metrics += "# HELP klimerko_ntp_synced NTP time synchronized (1=yes, 0=no)\n";
-  metrics += "# TYPE klimerko_ntp_synced gauge\n";
-  metrics += "klimerko_ntp_synced{device=\"" + device + "\"} " + String(ntpSynced ? 1 : 0) + "\n";
+  sseClients[slot] = webServer.client();
+  sseClients[slot].setNoDelay(true);
+  sseClients[slot].printf("HTTP/1.1 200 OK\r\n"
+                          "Content-Type: text/event-stream\r\n"
+                          "Cache-Control: no-cache\r\n"
+                          "Connection: keep-alive\r\n"
+                          "Access-Control-Allow-Origin: *\r\n\r\n"
+                          "retry: %d\n\n", SSE_RETRY_MS);
   
-  // Particle counts
-  metrics += "# HELP klimerko_particle_count_0_3 Particle count >0.3µm per 0.1L\n";
-  metrics += "# TYPE klimerko_particle_count_0_3 gauge\n";
-  metrics += "klimerko_particle_count_0_3{device=\"" + device + "\"} " + String(sensorData.count_0_3) + "\n";
+  // Send current values right away so the page doesn't wait for the next read
+  char json[JSON_BUFFER_MEDIUM];
+  buildLiveDataJson(json, sizeof(json));
+  sseSend(sseClients[slot], "sample", json);
   
-  metrics += "# HELP klimerko_particle_count_2_5 Particle count >2.5µm per 0.1L\n";
-  metrics += "# TYPE klimerko_particle_count_2_5 gauge\n";
-  metrics += "klimerko_particle_count_2_5{device=\"" + device + "\"} " + String(sensorData.count_2_5) + "\n";
+  DEBUG_PRINTF("[SSE] Client %d subscribed (%u active)\n", slot, sseClientCount());
+}
+
+/**
+ * @brief Keep SSE streams alive and release closed ones (call in loop)
+ */
+inline void sseLoop() {
+  if (millis() - sseLastKeepAlive < SSE_KEEPALIVE_MS) return;
+  sseLastKeepAlive = millis();
   
-  webServer.send(200, "text/plain; version=0.0.4; charset=utf-8", metrics);
+  for (uint8_t i = 0; i < SSE_MAX_CLIENTS; i++) {
+    if (!sseClients[i].connected()) {
+      sseClients[i].stop();
+      continue;
+    }
+    if (sseClients[i].print(F(": ka\n\n")) == 0) {
+      sseClients[i].stop();
+    }
+  }
+}
+
+/**
+ * @brief Handle 404 not found
+ */
+inline void handleNotFound() {
+  webServer.send(404, "text/plain", "Not Found");
+}
+
+/**
+ * @brief Serve profiler timings (/api/perf, ?reset=1 clears them afterwards)
+ */
+inline void handleApiPerf() {
+  webServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  webServer.send(200, "application/json", "");
+  ChunkedResponse out;
+  writePerfJson(out);
+  out.flush();
+  webServer.sendContent("");
+#if PROFILER_ENABLED
+  if (webServer.arg("reset") == "1") profiler.reset();
+#endif
+}
+
+// ============================================================================
+// PROMETHEUS METRICS
+// ============================================================================
+
+/**
+ * @brief Serve Prometheus metrics endpoint
+ */
+inline void handlePrometheusMetrics() {
+  // Streamed in chunks from the shared metric table (metrics.h)
+  webServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  webServer.send(200, "text/plain; version=0.0.4; charset=utf-8", "");
+  ChunkedResponse out;
+  writePromExposition(out, true);
+  stallMonitor.writeExposition(out, klimerkoID);
+  memTelemetry.writeExposition(out, klimerkoID);
+  writePerfExposition(out, klimerkoID);  // Pull only: too many series for push
+  out.flush();
+  webServer.sendContent("");  // Terminate chunked response
 }
 
 // ============================================================================
@@ -460,26 +1148,41 @@ inline void handlePrometheusMetrics() {
  * @brief Initialize and start web server
  */
 inline void initWebServer() {
-  webServer.on("/", handleRoot);
-  webServer.on("/api/data", handleApiData);
-  webServer.on("/api/stats", handleApiStats);
-  webServer.on("/api/log", handleApiLog);
-  webServer.on("/metrics", handlePrometheusMetrics);
-  webServer.onNotFound(handleNotFound);
+  static const char* collectedHeaders[] = { "If-None-Match" };
+  webServer.collectHeaders(collectedHeaders, 1);
+  
+  // Each route timed as its own probe (profiler.h)
+  webServer.on("/", perfHandler<PerfProbe::WEB_ROOT, handleRoot>);
+  webServer.on("/kchart.js", perfHandler<PerfProbe::WEB_CHART_JS, handleChartJs>);
+  webServer.on("/api/data", perfHandler<PerfProbe::WEB_API_DATA, handleApiData>);
+  webServer.on("/api/events", perfHandler<PerfProbe::WEB_API_EVENTS, handleApiEvents>);
+  webServer.on("/api/stats", perfHandler<PerfProbe::WEB_API_STATS, handleApiStats>);
+  webServer.on("/api/log", perfHandler<PerfProbe::WEB_API_LOG, handleApiLog>);
+  webServer.on("/api/history.bin", perfHandler<PerfProbe::WEB_API_HISTORY, handleApiHistoryBin>);
+  webServer.on("/api/query", perfHandler<PerfProbe::WEB_API_QUERY, handleApiQuery>);
+  webServer.on("/api/perf", perfHandler<PerfProbe::WEB_API_PERF, handleApiPerf>);
+  webServer.on("/metrics", perfHandler<PerfProbe::WEB_METRICS, handlePrometheusMetrics>);
+  webServer.onNotFound(perfHandler<PerfProbe::WEB_NOT_FOUND, handleNotFound>);
   
   webServer.begin();
   
   DEBUG_PRINTLN(F("[WEB] Server started on port 80"));
   DEBUG_PRINTLN(F("[WEB] Dashboard: http://<ip>/"));
   DEBUG_PRINTLN(F("[WEB] API: http://<ip>/api/data"));
+  DEBUG_PRINTLN(F("[WEB] Live stream: http://<ip>/api/events"));
   DEBUG_PRINTLN(F("[WEB] Prometheus: http://<ip>/metrics"));
+  DEBUG_PRINTLN(F("[WEB] Profiler: http://<ip>/api/perf"));
 }
 
 /**
  * @brief Handle web server requests (call in loop)
  */
 inline void handleWebServer() {
-  webServer.handleClient();
+  {
+    PERF_SCOPE(WEB_CLIENT);
+    webServer.handleClient();
+  }
+  sseLoop();
 }
 
 #endif // KLIMERKO_WEB_DASHBOARD_H
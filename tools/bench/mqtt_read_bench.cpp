@@ -0,0 +1,142 @@
+/**
+ * @file mqtt_read_bench.cpp
+ * @brief Host benchmark - PubSubClient receive path (readPacket) per KB of commands
+ *
+ * Feeds a recorded-style stream of AllThingsTalk command publishes through
+ * PubSubClient::loop() from a mock Client that delivers data in TCP-segment
+ * sized pieces, and reports CPU time and Client calls per KB received.
+ * On the ESP8266 every available()/read() call walks lwIP pbufs, so the
+ * call count is the figure that carries over to the device; pass a per-call
+ * cost in ns to fold that into the timing.
+ *
+ * Built by the host build (tools/host), run by hand:
+ *   cmake --build build-host --target mqtt_read_bench
+ *   build-host/mqtt_read_bench [call-cost-ns]
+ */
+
+#include <chrono>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "PubSubClient.h"
+
+#define BENCH_TRAFFIC_BYTES  (1024UL * 1024UL)
+#define BENCH_SEGMENT_SIZE   1460
+#define BENCH_DEVICE_ID      "Kx1Yq3bV0sRz8dTn5mWc2fHg"
+
+/**
+ * @brief Client serving a prepared byte stream, one TCP segment at a time
+ */
+class MockClient : public Client {
+public:
+  std::vector<uint8_t> rx;
+  size_t pos = 0;
+  size_t segmentEnd = 0;
+  unsigned long calls = 0;
+  unsigned long callCostNs = 0;
+
+  int connect(IPAddress, uint16_t) override { return 1; }
+  int connect(const char*, uint16_t) override { return 1; }
+  size_t write(uint8_t) override { return 1; }
+  size_t write(const uint8_t*, size_t size) override { return size; }
+
+  int available() override {
+    charge();
+    if (pos == segmentEnd && pos < rx.size()) {
+      segmentEnd = pos + BENCH_SEGMENT_SIZE < rx.size() ? pos + BENCH_SEGMENT_SIZE : rx.size();
+    }
+    return (int)(segmentEnd - pos);
+  }
+
+  int read() override {
+    charge();
+    return pos < segmentEnd ? rx[pos++] : -1;
+  }
+
+  int read(uint8_t* buf, size_t size) override {
+    charge();
+    size_t n = segmentEnd - pos < size ? segmentEnd - pos : size;
+    memcpy(buf, rx.data() + pos, n);
+    pos += n;
+    return (int)n;
+  }
+
+  int peek() override { return pos < segmentEnd ? rx[pos] : -1; }
+  void flush() override {}
+  void stop() override {}
+  uint8_t connected() override { return 1; }
+  operator bool() override { return true; }
+
+private:
+  void charge() {
+    calls++;
+    if (callCostNs == 0) return;
+    auto until = std::chrono::steady_clock::now() + std::chrono::nanoseconds(callCostNs);
+    while (std::chrono::steady_clock::now() < until) {}
+  }
+};
+
+static void appendPublish(std::vector<uint8_t>& out, const std::string& topic, const std::string& payload) {
+  size_t remaining = 2 + topic.size() + payload.size();
+  out.push_back(0x30);
+  do {
+    uint8_t digit = remaining & 127;
+    remaining >>= 7;
+    out.push_back(remaining ? digit | 0x80 : digit);
+  } while (remaining);
+  out.push_back(topic.size() >> 8);
+  out.push_back(topic.size() & 0xFF);
+  out.insert(out.end(), topic.begin(), topic.end());
+  out.insert(out.end(), payload.begin(), payload.end());
+}
+
+static unsigned long messages = 0;
+
+static void onMessage(char*, uint8_t*, unsigned int) {
+  messages++;
+}
+
+int main(int argc, char** argv) {
+  MockClient client;
+  client.callCostNs = argc > 1 ? strtoul(argv[1], NULL, 10) : 0;
+
+  // CONNACK, then a mix of small asset commands and larger JSON settings
+  const uint8_t connack[] = {0x20, 0x02, 0x00, 0x00};
+  client.rx.assign(connack, connack + sizeof(connack));
+  const std::string prefix = "device/" BENCH_DEVICE_ID "/asset/";
+  std::string deadband = "{\"at\":\"2025-12-01T10:00:00Z\",\"value\":{\"rules\":[";
+  for (int i = 0; i < 12; i++) {
+    deadband += "{\"asset\":\"pm25\",\"abs\":1.0,\"rel\":0.05},";
+  }
+  deadband += "{}]}}";
+  size_t commandsStart = client.rx.size();
+  while (client.rx.size() - commandsStart < BENCH_TRAFFIC_BYTES) {
+    appendPublish(client.rx, prefix + "interval/command", "{\"at\":\"2025-12-01T10:00:00Z\",\"value\":15}");
+    appendPublish(client.rx, prefix + "alarm-enable/command", "{\"at\":\"2025-12-01T10:00:00Z\",\"value\":true}");
+    appendPublish(client.rx, prefix + "deadband/command", deadband);
+  }
+  size_t trafficBytes = client.rx.size() - commandsStart;
+
+  PubSubClient mqtt(client);
+  mqtt.setBufferSize(4096);
+  mqtt.setServer("localhost", 1883);
+  mqtt.setCallback(onMessage);
+  if (!mqtt.connect("bench")) {
+    fprintf(stderr, "connect failed\n");
+    return 1;
+  }
+
+  unsigned long callsBefore = client.calls;
+  auto start = std::chrono::steady_clock::now();
+  while (client.pos < client.rx.size()) {
+    mqtt.loop();
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  double kb = trafficBytes / 1024.0;
+  printf("traffic:        %.0f KB, %lu messages\n", kb, messages);
+  printf("call cost:      %lu ns\n", client.callCostNs);
+  printf("CPU per KB:     %.1f us\n", ns / kb / 1000.0);
+  printf("Client calls/KB: %.1f\n", (client.calls - callsBefore) / kb);
+  return 0;
+}
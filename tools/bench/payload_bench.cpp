@@ -0,0 +1,119 @@
+/**
+ * @file payload_bench.cpp
+ * @brief Host benchmark - state publish size and encode time per PayloadFormat
+ *
+ * Builds the documents publishSensorData() sends (every asset, and a
+ * deadband-filtered publish with a few assets) and encodes each with
+ * serializePayload() as JSON, MessagePack and CBOR. Reports bytes on the
+ * wire and ns (and TSC cycles on x86) per encode. Sizes carry over to the
+ * device unchanged; times only as a ratio between formats.
+ *
+ * Also checks that CborWriter::putFloat() keeps NaN, infinities and values
+ * beyond int32 as floats and shortens whole numbers to integers.
+ *
+ * Built by the host build (tools/host), run by hand:
+ *   cmake --build build-host --target payload_bench
+ *   build-host/payload_bench
+ */
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "payload.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#endif
+
+#define BENCH_ENCODES  200000UL
+
+static void fullState(JsonDocument& doc) {
+  doc.createNestedObject("air-quality")["value"] = "Good";
+  doc.createNestedObject("pm1")["value"] = 7;
+  doc.createNestedObject("pm2-5")["value"] = 11;
+  doc.createNestedObject("pm10")["value"] = 15;
+  doc.createNestedObject("count-0-3")["value"] = 1302;
+  doc.createNestedObject("count-0-5")["value"] = 388;
+  doc.createNestedObject("count-1-0")["value"] = 61;
+  doc.createNestedObject("count-2-5")["value"] = 6;
+  doc.createNestedObject("count-5-0")["value"] = 2;
+  doc.createNestedObject("count-10-0")["value"] = 0;
+  doc.createNestedObject("sensor-status")["value"] = "Running";
+  doc.createNestedObject("pm1-c")["value"] = 6;
+  doc.createNestedObject("pm2-5-c")["value"] = 9;
+  doc.createNestedObject("pm10-c")["value"] = 13;
+  doc.createNestedObject("temperature")["value"] = 21.37f;
+  doc.createNestedObject("humidity")["value"] = 47.81f;
+  doc.createNestedObject("pressure")["value"] = 1013.42f;
+  doc.createNestedObject("altitude")["value"] = 117.0f;
+  doc.createNestedObject("dewpoint")["value"] = 9.64f;
+  doc.createNestedObject("humidityAbs")["value"] = 8.93f;
+  doc.createNestedObject("pressureSea")["value"] = 1027.35f;
+  doc.createNestedObject("HeatIndex")["value"] = 20.98f;
+  doc.createNestedObject("firmware")["value"] = FIRMWARE_VERSION;
+  doc.createNestedObject("wifi-signal")["value"] = 3;
+}
+
+static void deadbandState(JsonDocument& doc) {
+  doc.createNestedObject("pm2-5")["value"] = 11;
+  doc.createNestedObject("temperature")["value"] = 21.37f;
+  doc.createNestedObject("humidity")["value"] = 47.81f;
+}
+
+static uint64_t cycles() {
+#ifdef BENCH_HAVE_TSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static void benchDocument(const char* name, const JsonDocument& doc, unsigned long& sink) {
+  const PayloadFormat formats[] = {PayloadFormat::JSON, PayloadFormat::MSGPACK, PayloadFormat::CBOR};
+  uint8_t buffer[2048];  // Same as payloadBuffer in publishStateDocument()
+  for (PayloadFormat format : formats) {
+    size_t length = serializePayload(doc, buffer, sizeof(buffer), format);
+    using namespace std::chrono;
+    steady_clock::time_point start = steady_clock::now();
+    uint64_t c0 = cycles();
+    for (unsigned long i = 0; i < BENCH_ENCODES; i++) {
+      sink += serializePayload(doc, buffer, sizeof(buffer), format);
+    }
+    uint64_t c1 = cycles();
+    double ns = duration_cast<nanoseconds>(steady_clock::now() - start).count() / (double)BENCH_ENCODES;
+    printf("%-10s %-8s %6zu %10.0f %10.0f\n", name, payloadFormatToString(format), length, ns,
+           (double)(c1 - c0) / BENCH_ENCODES);
+  }
+}
+
+/**
+ * @brief Encode one float and compare with the expected CBOR bytes
+ */
+static bool cborFloatIs(float f, const uint8_t* expected, size_t n) {
+  uint8_t out[8];
+  CborWriter writer(out, sizeof(out));
+  writer.putFloat(f);
+  return !writer.overflow && writer.len == n && memcmp(out, expected, n) == 0;
+}
+
+int main() {
+  unsigned long sink = 0;
+  StaticJsonDocument<2048> full;
+  fullState(full);
+  StaticJsonDocument<256> few;
+  deadbandState(few);
+
+  printf("%-10s %-8s %6s %10s %10s\n", "document", "format", "bytes", "ns/encode", "cyc/encode");
+  benchDocument("full", full, sink);
+  benchDocument("deadband", few, sink);
+
+  const uint8_t nan[] = {0xFA, 0x7F, 0xC0, 0x00, 0x00};
+  const uint8_t inf[] = {0xFA, 0x7F, 0x80, 0x00, 0x00};
+  const uint8_t big[] = {0xFA, 0x4F, 0x32, 0xD0, 0x5E};   // 3e9
+  const uint8_t whole[] = {0x38, 0x63};                    // -100
+  bool ok = cborFloatIs(NAN, nan, sizeof(nan)) && cborFloatIs(INFINITY, inf, sizeof(inf)) &&
+            cborFloatIs(3e9f, big, sizeof(big)) && cborFloatIs(-100.0f, whole, sizeof(whole));
+  printf("CBOR float edge cases: %s (sink %lu)\n", ok ? "ok" : "WRONG", sink);
+  return ok ? 0 : 1;
+}
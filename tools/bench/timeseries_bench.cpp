@@ -0,0 +1,182 @@
+/**
+ * @file timeseries_bench.cpp
+ * @brief Host benchmark - time-series store (timeseries.h) size and speed
+ *
+ * Appends a week of per-minute samples from three synthetic traces to a
+ * TimeSeriesStore on the host LittleFS and reports:
+ * - bytes per sample: bitstream + chunk header, and whole chunk slots
+ *   (what the ring on flash actually uses), against the 16-byte raw
+ *   HistoryRecord;
+ * - encode throughput of append(), including the chunk and hourly
+ *   aggregate writes the store makes every TS_FLUSH_SAMPLES samples;
+ * - decode throughput of tsDecodeChunk() over the sealed chunks in RAM.
+ * Every decoded sample is compared with the one appended.
+ *
+ * Built by the host build (tools/host), run by hand:
+ *   cmake --build build-host --target timeseries_bench
+ *   build-host/timeseries_bench
+ */
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include "timeseries.h"
+
+#define BENCH_SAMPLES        (7UL * 24UL * 60UL)
+#define BENCH_DECODE_ROUNDS  200
+#define BENCH_START_TS       1790000000UL
+
+/**
+ * @brief Deterministic noise so runs are comparable
+ */
+struct Lcg {
+  uint32_t state;
+  explicit Lcg(uint32_t seed) : state(seed) {}
+  uint32_t next() { return state = state * 1664525UL + 1013904223UL; }
+  int range(int lo, int hi) { return lo + (int)((next() >> 8) % (uint32_t)(hi - lo + 1)); }
+};
+
+enum class Trace { INDOOR, OUTDOOR, IRREGULAR };
+
+static const char* traceName(Trace t) {
+  switch (t) {
+    case Trace::INDOOR:  return "indoor";
+    case Trace::OUTDOOR: return "outdoor";
+    default:             return "irregular";
+  }
+}
+
+/**
+ * @brief Samples as the sensor loop would store them
+ *
+ * indoor:    slow PM random walk, small temperature swing, regular minutes
+ * outdoor:   noisy PM with spikes, day/night temperature and humidity
+ * irregular: outdoor values, 60-64 s spacing and occasional missed samples
+ */
+static std::vector<HistoryRecord> makeTrace(Trace trace) {
+  Lcg rng(12345);
+  std::vector<HistoryRecord> out;
+  uint32_t ts = BENCH_START_TS;
+  int pm = 12;
+  for (unsigned long i = 0; i < BENCH_SAMPLES; i++) {
+    double day = sin((ts % 86400UL) * 2.0 * M_PI / 86400.0);
+    HistoryRecord r;
+    r.timestamp = ts;
+    if (trace == Trace::INDOOR) {
+      pm = max(0, pm + rng.range(-1, 1));
+      r.temperature = (int16_t)(215 + 15 * day + rng.range(-1, 1));
+      r.humidity = (uint16_t)(450 - 30 * day + rng.range(-2, 2));
+    } else {
+      pm = max(0, pm + rng.range(-4, 4));
+      if (rng.range(0, 199) == 0) pm += rng.range(50, 150);  // Passing smoke
+      if (pm > 40) pm -= pm / 10;
+      r.temperature = (int16_t)(100 + 60 * day + rng.range(-3, 3));
+      r.humidity = (uint16_t)(650 - 200 * day + rng.range(-10, 10));
+    }
+    r.pm25 = (uint16_t)pm;
+    r.pm1 = (uint16_t)(pm * 2 / 3);
+    r.pm10 = (uint16_t)(pm * 3 / 2 + rng.range(0, 2));
+    r.pressure = (uint16_t)(10130 + 20 * sin(i * 2.0 * M_PI / (3.0 * 1440.0)) + rng.range(-1, 1));
+    out.push_back(r);
+
+    ts += 60;
+    if (trace == Trace::IRREGULAR) {
+      ts += rng.range(0, 4);
+      if (rng.range(0, 99) == 0) ts += 60 * rng.range(1, 10);
+    }
+  }
+  return out;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now() - start).count() / 1e9;
+}
+
+static bool sameRecord(const HistoryRecord& a, const HistoryRecord& b) {
+  return a.timestamp == b.timestamp && a.pm1 == b.pm1 && a.pm25 == b.pm25 && a.pm10 == b.pm10 &&
+         a.temperature == b.temperature && a.humidity == b.humidity && a.pressure == b.pressure;
+}
+
+/**
+ * @brief Run one trace through a fresh store
+ * @return Number of samples that did not decode to what was appended
+ */
+static unsigned long benchTrace(Trace trace, unsigned long& sink) {
+  LittleFS.remove(TS_FILE_PATH);
+  LittleFS.remove(TS_HOURLY_PATH);
+  std::vector<HistoryRecord> samples = makeTrace(trace);
+
+  TimeSeriesStore store;
+  store.begin();
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (const HistoryRecord& r : samples) store.append(r);
+  store.seal();
+  double encodeSec = secondsSince(start);
+
+  // Sealed chunks, in ring order (no wrap for one week)
+  std::vector<std::vector<uint8_t>> chunks;
+  size_t streamBytes = 0;
+  File f = LittleFS.open(TS_FILE_PATH, "r");
+  for (uint16_t slot = 0; slot < TS_MAX_CHUNKS; slot++) {
+    std::vector<uint8_t> chunk(TS_CHUNK_SIZE);
+    if (!f.seek((uint32_t)slot * TS_CHUNK_SIZE, SeekSet) ||
+        f.read(chunk.data(), TS_CHUNK_SIZE) != TS_CHUNK_SIZE || !tsChunkValid(chunk.data())) {
+      break;
+    }
+    const TsChunkHeader* h = (const TsChunkHeader*)chunk.data();
+    streamBytes += sizeof(TsChunkHeader) + (h->bitLen + 7) / 8;
+    chunks.push_back(chunk);
+  }
+  f.close();
+
+  unsigned long mismatches = 0;
+  size_t next = 0;
+  for (const std::vector<uint8_t>& chunk : chunks) {
+    tsDecodeChunk(chunk.data(), 0, UINT32_MAX, [&](const HistoryRecord& r) {
+      if (next >= samples.size() || !sameRecord(r, samples[next])) mismatches++;
+      next++;
+      return true;
+    });
+  }
+  if (next != samples.size()) mismatches += samples.size() > next ? samples.size() - next : next - samples.size();
+
+  start = std::chrono::steady_clock::now();
+  for (int round = 0; round < BENCH_DECODE_ROUNDS; round++) {
+    for (const std::vector<uint8_t>& chunk : chunks) {
+      tsDecodeChunk(chunk.data(), 0, UINT32_MAX, [&](const HistoryRecord& r) {
+        sink += r.pm25;  // Keeps the decode from being optimized out
+        return true;
+      });
+    }
+  }
+  double decodeSec = secondsSince(start) / BENCH_DECODE_ROUNDS;
+
+  double n = (double)samples.size();
+  printf("%-10s %8lu %7zu %9.2f %9.2f %7.1fx %12.0f %12.0f\n", traceName(trace),
+         (unsigned long)samples.size(), chunks.size(), streamBytes / n,
+         chunks.size() * (double)TS_CHUNK_SIZE / n, sizeof(HistoryRecord) * n / streamBytes,
+         n / encodeSec, n / decodeSec);
+  return mismatches;
+}
+
+int main() {
+  char dir[] = "/tmp/klimerko_ts_bench_XXXXXX";
+  if (!mkdtemp(dir)) return 2;
+  LittleFS.hostSetRoot(dir);
+  LittleFS.begin();
+  Serial.setQuiet(true);
+
+  printf("%-10s %8s %7s %9s %9s %8s %12s %12s\n", "trace", "samples", "chunks", "B/sample",
+         "slot B/s", "ratio", "enc samp/s", "dec samp/s");
+  unsigned long mismatches = 0;
+  unsigned long sink = 0;
+  for (Trace t : {Trace::INDOOR, Trace::OUTDOOR, Trace::IRREGULAR}) mismatches += benchTrace(t, sink);
+  printf("raw HistoryRecord: %u bytes/sample; %s (sink %lu)\n", (unsigned)sizeof(HistoryRecord),
+         mismatches ? "DECODE MISMATCH" : "every sample decodes to its input", sink);
+  return mismatches ? 1 : 0;
+}
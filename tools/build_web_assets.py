@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+"""
+Build the pre-gzipped dashboard assets for the Klimerko LittleFS image.
+
+The PROGMEM literals in src/klimerko/web_dashboard.h are the single source
+of truth. This script extracts them byte for byte, gzips them
+(deterministically, so an unchanged asset keeps its bytes) and writes them
+under data/www/, which the Arduino "LittleFS Data Upload" tool flashes to
+the device. ctest -R web_assets fails when the committed files drift from
+the literals.
+
+Usage: python3 tools/build_web_assets.py
+"""
+
+import gzip
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+HEADER = os.path.join(ROOT, "src", "klimerko", "web_dashboard.h")
+OUT_DIR = os.path.join(ROOT, "data", "www")
+
+# PROGMEM symbol -> output file name
+ASSETS = {
+    "DASHBOARD_HTML": "index.html.gz",
+    "KCHART_JS": "kchart.js.gz",
+}
+
+
+def extract_literal(source, symbol):
+    match = re.search(
+        r'const char %s\[\] PROGMEM = R"rawliteral\((.*?)\)rawliteral";' % symbol,
+        source, re.S)
+    if not match:
+        sys.exit("error: %s not found in %s" % (symbol, HEADER))
+    return match.group(1)
+
+
+def main():
+    with open(HEADER, encoding="utf-8") as f:
+        source = f.read()
+
+    os.makedirs(OUT_DIR, exist_ok=True)
+    for symbol, name in ASSETS.items():
+        raw = extract_literal(source, symbol).encode("utf-8")
+        packed = gzip.compress(raw, compresslevel=9, mtime=0)
+        with open(os.path.join(OUT_DIR, name), "wb") as f:
+            f.write(packed)
+        print("%-16s %6d -> %5d bytes (%s)" % (symbol, len(raw), len(packed), name))
+
+
+if __name__ == "__main__":
+    main()
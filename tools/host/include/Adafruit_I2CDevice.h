@@ -0,0 +1,42 @@
+/**
+ * @file Adafruit_I2CDevice.h
+ * @brief Host shim - Adafruit BusIO I2C device over the host TwoWire
+ */
+
+#ifndef KLIMERKO_HOST_ADAFRUIT_I2CDEVICE_H
+#define KLIMERKO_HOST_ADAFRUIT_I2CDEVICE_H
+
+#include <Wire.h>
+
+class Adafruit_I2CDevice {
+public:
+  Adafruit_I2CDevice(uint8_t addr, TwoWire* theWire = &Wire) : _addr(addr), _wire(theWire) {}
+  uint8_t address() const { return _addr; }
+  bool begin(bool addr_detect = true) { return !addr_detect || detected(); }
+  bool detected() {
+    _wire->beginTransmission(_addr);
+    return _wire->endTransmission() == 0;
+  }
+  bool read(uint8_t* buffer, size_t len, bool stop = true) {
+    if (_wire->requestFrom(_addr, len, stop) != len) return false;
+    for (size_t i = 0; i < len; i++) buffer[i] = (uint8_t)_wire->read();
+    return true;
+  }
+  bool write(const uint8_t* buffer, size_t len, bool stop = true,
+             const uint8_t* prefix_buffer = nullptr, size_t prefix_len = 0) {
+    _wire->beginTransmission(_addr);
+    if (prefix_len) _wire->write(prefix_buffer, prefix_len);
+    _wire->write(buffer, len);
+    return _wire->endTransmission(stop) == 0;
+  }
+  bool write_then_read(const uint8_t* write_buffer, size_t write_len,
+                       uint8_t* read_buffer, size_t read_len, bool stop = false) {
+    return write(write_buffer, write_len, stop) && read(read_buffer, read_len);
+  }
+
+private:
+  uint8_t _addr;
+  TwoWire* _wire;
+};
+
+#endif // KLIMERKO_HOST_ADAFRUIT_I2CDEVICE_H
@@ -0,0 +1,24 @@
+/**
+ * @file Adafruit_SPIDevice.h
+ * @brief Host shim - SPI transport is not emulated; begin() always fails
+ */
+
+#ifndef KLIMERKO_HOST_ADAFRUIT_SPIDEVICE_H
+#define KLIMERKO_HOST_ADAFRUIT_SPIDEVICE_H
+
+#include <SPI.h>
+
+#define SPI_BITORDER_MSBFIRST 1
+
+class Adafruit_SPIDevice {
+public:
+  Adafruit_SPIDevice(int8_t, uint32_t = 1000000, uint8_t = SPI_BITORDER_MSBFIRST,
+                     uint8_t = SPI_MODE0, SPIClass* = &SPI) {}
+  Adafruit_SPIDevice(int8_t, int8_t, int8_t, int8_t, uint32_t = 1000000,
+                     uint8_t = SPI_BITORDER_MSBFIRST, uint8_t = SPI_MODE0) {}
+  bool begin() { return false; }
+  bool write(const uint8_t*, size_t, const uint8_t* = nullptr, size_t = 0) { return false; }
+  bool write_then_read(const uint8_t*, size_t, uint8_t*, size_t, uint8_t = 0xFF) { return false; }
+};
+
+#endif // KLIMERKO_HOST_ADAFRUIT_SPIDEVICE_H
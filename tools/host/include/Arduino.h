@@ -0,0 +1,99 @@
+/**
+ * @file Arduino.h
+ * @brief Host shim - Arduino core API for Linux builds
+ *
+ * Time is virtual: millis()/micros() return the host clock, which only
+ * moves when delay()/yield() or hostAdvanceMillis() advance it. This makes
+ * every run deterministic and lets simulations run faster than real time.
+ */
+
+#ifndef KLIMERKO_HOST_ARDUINO_H
+#define KLIMERKO_HOST_ARDUINO_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+#include "pgmspace.h"
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "HardwareSerial.h"
+#include "Esp.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint16_t word;
+
+inline uint16_t makeWord(uint8_t high, uint8_t low) { return (uint16_t)((high << 8) | low); }
+
+using std::min;
+using std::max;
+using std::isnan;
+using std::isinf;
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT          0x00
+#define OUTPUT         0x01
+#define INPUT_PULLUP   0x02
+
+#define D0 16
+#define D1 5
+#define D2 4
+#define D3 0
+#define D4 2
+#define D5 14
+#define D6 12
+#define D7 13
+#define D8 15
+#define LED_BUILTIN 2
+
+#define PI 3.1415926535897932384626433832795
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+
+// NTP/time configuration (host time is the real wall clock)
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2 = nullptr, const char* server3 = nullptr);
+
+// Virtual clock
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+void hostAdvanceMillis(unsigned long ms);
+void hostAdvanceMicros(uint64_t us);
+void hostSetMillis(unsigned long ms);
+uint64_t hostMicros64();
+// Let delay() also sleep this many real microseconds (0 = off), so peers
+// on other threads (a localhost broker) can answer a firmware wait loop
+void hostSetDelayYield(unsigned long realUs);
+
+// Digital I/O (recorded, never touches hardware)
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+void hostSetDigitalInput(uint8_t pin, int value);
+int analogRead(uint8_t pin);
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+inline bool isDigit(int c) { return c >= '0' && c <= '9'; }
+inline bool isAlpha(int c) { return isalpha(c) != 0; }
+inline bool isAlphaNumeric(int c) { return isalnum(c) != 0; }
+inline bool isSpace(int c) { return isspace(c) != 0; }
+inline bool isHexadecimalDigit(int c) { return isxdigit(c) != 0; }
+
+#endif // KLIMERKO_HOST_ARDUINO_H
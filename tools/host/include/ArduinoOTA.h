@@ -0,0 +1,41 @@
+/**
+ * @file ArduinoOTA.h
+ * @brief Host shim - ArduinoOTA; callbacks are stored, no network update
+ */
+
+#ifndef KLIMERKO_HOST_ARDUINOOTA_H
+#define KLIMERKO_HOST_ARDUINOOTA_H
+
+#include <functional>
+#include "Arduino.h"
+
+typedef enum {
+  OTA_AUTH_ERROR,
+  OTA_BEGIN_ERROR,
+  OTA_CONNECT_ERROR,
+  OTA_RECEIVE_ERROR,
+  OTA_END_ERROR
+} ota_error_t;
+
+class ArduinoOTAClass {
+public:
+  void setHostname(const char*) {}
+  void setPassword(const char*) {}
+  void setPort(uint16_t) {}
+  void onStart(std::function<void()> fn) { _onStart = fn; }
+  void onEnd(std::function<void()> fn) { _onEnd = fn; }
+  void onProgress(std::function<void(unsigned int, unsigned int)> fn) { _onProgress = fn; }
+  void onError(std::function<void(ota_error_t)> fn) { _onError = fn; }
+  void begin(bool = true) {}
+  void handle() {}
+
+private:
+  std::function<void()> _onStart;
+  std::function<void()> _onEnd;
+  std::function<void(unsigned int, unsigned int)> _onProgress;
+  std::function<void(ota_error_t)> _onError;
+};
+
+extern ArduinoOTAClass ArduinoOTA;
+
+#endif // KLIMERKO_HOST_ARDUINOOTA_H
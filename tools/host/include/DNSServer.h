@@ -0,0 +1,22 @@
+/**
+ * @file DNSServer.h
+ * @brief Host shim - captive-portal DNS server (no-op)
+ */
+
+#ifndef KLIMERKO_HOST_DNSSERVER_H
+#define KLIMERKO_HOST_DNSSERVER_H
+
+#include "IPAddress.h"
+
+enum class DNSReplyCode { NoError = 0, ServerFailure = 2, NonExistentDomain = 3 };
+
+class DNSServer {
+public:
+  bool start(uint16_t, const String&, const IPAddress&) { return true; }
+  void stop() {}
+  void processNextRequest() {}
+  void setErrorReplyCode(const DNSReplyCode&) {}
+  void setTTL(uint32_t) {}
+};
+
+#endif // KLIMERKO_HOST_DNSSERVER_H
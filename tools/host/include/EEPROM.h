@@ -0,0 +1,62 @@
+/**
+ * @file EEPROM.h
+ * @brief Host shim - emulated EEPROM backed by a file
+ *
+ * Mirrors the ESP8266 semantics: begin() loads a RAM copy, commit() writes
+ * it back. Every commit counts as one flash sector erase.
+ */
+
+#ifndef KLIMERKO_HOST_EEPROM_H
+#define KLIMERKO_HOST_EEPROM_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+class EEPROMClass {
+public:
+  void begin(size_t size);
+  uint8_t read(int address) { return (address >= 0 && (size_t)address < _data.size()) ? _data[address] : 0; }
+  void write(int address, uint8_t val) {
+    if (address >= 0 && (size_t)address < _data.size() && _data[address] != val) {
+      _data[address] = val;
+      _dirty = true;
+    }
+  }
+  bool commit();
+  bool end();
+  size_t length() const { return _data.size(); }
+  uint8_t* getDataPtr() { _dirty = true; return _data.data(); }
+  const uint8_t* getConstDataPtr() const { return _data.data(); }
+
+  template<typename T>
+  T& get(int address, T& t) {
+    if (address >= 0 && address + sizeof(T) <= _data.size()) {
+      memcpy((uint8_t*)&t, _data.data() + address, sizeof(T));
+    }
+    return t;
+  }
+
+  template<typename T>
+  const T& put(int address, const T& t) {
+    if (address >= 0 && address + sizeof(T) <= _data.size()) {
+      if (memcmp(_data.data() + address, (const uint8_t*)&t, sizeof(T)) != 0) {
+        _dirty = true;
+        memcpy(_data.data() + address, (const uint8_t*)&t, sizeof(T));
+      }
+    }
+    return t;
+  }
+
+  /** Number of sector erases (commits that actually wrote) since start */
+  uint32_t hostEraseCount() const { return _eraseCount; }
+
+private:
+  std::vector<uint8_t> _data;
+  bool _dirty = false;
+  uint32_t _eraseCount = 0;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // KLIMERKO_HOST_EEPROM_H
@@ -0,0 +1,62 @@
+/**
+ * @file ESP8266HTTPClient.h
+ * @brief Host shim - minimal HTTP/1.1 client over WiFiClient
+ */
+
+#ifndef KLIMERKO_HOST_ESP8266HTTPCLIENT_H
+#define KLIMERKO_HOST_ESP8266HTTPCLIENT_H
+
+#include <vector>
+#include <utility>
+#include "Arduino.h"
+#include "WiFiClient.h"
+
+#define HTTPC_ERROR_CONNECTION_FAILED   (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED  (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED       (-4)
+#define HTTPC_ERROR_CONNECTION_LOST     (-5)
+#define HTTPC_ERROR_READ_TIMEOUT        (-11)
+
+#define HTTP_CODE_OK          200
+#define HTTP_CODE_NO_CONTENT  204
+
+class HTTPClient {
+public:
+  bool begin(WiFiClient& client, const String& url);
+  bool begin(WiFiClient& client, const String& host, uint16_t port, const String& uri = "/");
+  void end();
+  void setReuse(bool reuse) { _reuse = reuse; }
+  void setTimeout(uint16_t timeout) { _timeout = timeout; }
+  void setUserAgent(const String& ua) { _userAgent = ua; }
+  void setAuthorization(const char* auth) { _authorization = String("Basic ") + auth; }
+  void addHeader(const String& name, const String& value, bool = false, bool = true) {
+    _headers.push_back(std::make_pair(name, value));
+  }
+  bool connected() { return _client && _client->connected(); }
+
+  int GET() { return sendRequest("GET", nullptr, 0); }
+  int POST(const uint8_t* payload, size_t size) { return sendRequest("POST", payload, size); }
+  int POST(const String& payload) { return POST(reinterpret_cast<const uint8_t*>(payload.c_str()), payload.length()); }
+  int PUT(const uint8_t* payload, size_t size) { return sendRequest("PUT", payload, size); }
+  int PUT(const String& payload) { return PUT(reinterpret_cast<const uint8_t*>(payload.c_str()), payload.length()); }
+  int sendRequest(const char* method, const uint8_t* payload, size_t size);
+
+  String getString() { return _body; }
+  int getSize() { return (int)_body.length(); }
+  static String errorToString(int error);
+
+private:
+  WiFiClient* _client = nullptr;
+  String _host;
+  uint16_t _port = 80;
+  String _uri;
+  bool _reuse = true;
+  uint16_t _timeout = 5000;
+  String _userAgent = "ESP8266HTTPClient";
+  String _authorization;
+  std::vector<std::pair<String, String>> _headers;
+  String _body;
+};
+
+#endif // KLIMERKO_HOST_ESP8266HTTPCLIENT_H
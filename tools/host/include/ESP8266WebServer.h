@@ -0,0 +1,114 @@
+/**
+ * @file ESP8266WebServer.h
+ * @brief Host shim - single-threaded HTTP/1.1 server on localhost
+ *
+ * Implements the subset of the ESP8266WebServer API the firmware uses,
+ * with the same one-request-per-handleClient() processing model.
+ */
+
+#ifndef KLIMERKO_HOST_ESP8266WEBSERVER_H
+#define KLIMERKO_HOST_ESP8266WEBSERVER_H
+
+#include <functional>
+#include <utility>
+#include <vector>
+#include "Arduino.h"
+#include "WiFiServer.h"
+#include "FS.h"
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t) -1)
+#define CONTENT_LENGTH_NOT_SET ((size_t) -2)
+
+class ESP8266WebServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+
+  explicit ESP8266WebServer(int port = 80) : _server((uint16_t)port) {}
+
+  void begin() { _server.begin(); }
+  void begin(uint16_t port) { _server.begin(port); }
+  void close() { _server.close(); }
+  void stop() { close(); }
+  void handleClient();
+  uint16_t hostPort() const { return _server.hostPort(); }
+
+  void on(const String& uri, THandlerFunction fn) { on(uri, HTTP_ANY, fn); }
+  void on(const String& uri, HTTPMethod method, THandlerFunction fn) {
+    _handlers.push_back(Route{uri, method, fn});
+  }
+  void onNotFound(THandlerFunction fn) { _notFound = fn; }
+  void serveStatic(const char* uri, fs::FS& fs, const char* path, const char* cacheHeader = nullptr);
+
+  String uri() const { return _uri; }
+  HTTPMethod method() const { return _method; }
+  WiFiClient& client() { return _client; }
+
+  String arg(const String& name) const;
+  String arg(int i) const { return (size_t)i < _args.size() ? _args[i].second : String(); }
+  String argName(int i) const { return (size_t)i < _args.size() ? _args[i].first : String(); }
+  int args() const { return (int)_args.size(); }
+  bool hasArg(const String& name) const;
+  void collectHeaders(const char* headerKeys[], size_t count) { (void)headerKeys; (void)count; }
+  String header(const String& name) const;
+  bool hasHeader(const String& name) const;
+
+  void sendHeader(const String& name, const String& value, bool first = false);
+  void setContentLength(size_t len) { _contentLength = len; }
+  void send(int code, const char* contentType = nullptr, const String& content = String());
+  void send(int code, const String& contentType, const String& content) { send(code, contentType.c_str(), content); }
+  void send(int code, const char* contentType, const char* content) { send(code, contentType, String(content)); }
+  void send(int code, const char* contentType, const uint8_t* content, size_t len);
+  void send_P(int code, PGM_P contentType, PGM_P content) { send(code, contentType, content); }
+  void send_P(int code, PGM_P contentType, PGM_P content, size_t len) {
+    send(code, contentType, reinterpret_cast<const uint8_t*>(content), len);
+  }
+  void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+  void sendContent(const char* content, size_t len);
+  void sendContent_P(PGM_P content) { sendContent(content, strlen(content)); }
+  void sendContent_P(PGM_P content, size_t len) { sendContent(content, len); }
+
+  template<typename T>
+  size_t streamFile(T& file, const String& contentType, int code = 200) {
+    String name(file.name());
+    if (name.endsWith(".gz") && contentType != "application/x-gzip" && contentType != "application/octet-stream") {
+      sendHeader("Content-Encoding", "gzip");
+    }
+    setContentLength(file.size());
+    send(code, contentType.c_str(), String());
+    uint8_t buf[1024];
+    size_t total = 0;
+    int n;
+    while ((n = file.read(buf, sizeof(buf))) > 0) {
+      _client.write(buf, (size_t)n);
+      total += (size_t)n;
+    }
+    return total;
+  }
+
+private:
+  struct Route {
+    String uri;
+    HTTPMethod method;
+    THandlerFunction fn;
+  };
+
+  bool parseRequest();
+  void writeHead(int code, const char* contentType, size_t contentLength);
+  void finishRequest();
+
+  WiFiServer _server;
+  WiFiClient _client;
+  std::vector<Route> _handlers;
+  THandlerFunction _notFound;
+  String _uri;
+  HTTPMethod _method = HTTP_ANY;
+  std::vector<std::pair<String, String>> _args;
+  std::vector<std::pair<String, String>> _requestHeaders;
+  std::vector<std::pair<String, String>> _responseHeaders;
+  size_t _contentLength = CONTENT_LENGTH_NOT_SET;
+  bool _headSent = false;
+};
+
+#endif // KLIMERKO_HOST_ESP8266WEBSERVER_H
@@ -0,0 +1,76 @@
+/**
+ * @file ESP8266WiFi.h
+ * @brief Host shim - WiFi station that is always "connected" to the host
+ */
+
+#ifndef KLIMERKO_HOST_ESP8266WIFI_H
+#define KLIMERKO_HOST_ESP8266WIFI_H
+
+#include <string>
+#include "Arduino.h"
+#include "IPAddress.h"
+#include "WiFiClient.h"
+#include "WiFiServer.h"
+#include "WiFiClientSecure.h"
+#include "user_interface.h"
+
+typedef enum {
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_WRONG_PASSWORD = 6,
+  WL_DISCONNECTED = 7
+} wl_status_t;
+
+typedef enum WiFiMode { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } WiFiMode_t;
+typedef enum { WIFI_NONE_SLEEP = 0, WIFI_LIGHT_SLEEP = 1, WIFI_MODEM_SLEEP = 2 } WiFiSleepType_t;
+
+class ESP8266WiFiClass {
+public:
+  wl_status_t status() { return _status; }
+  bool isConnected() { return _status == WL_CONNECTED; }
+  int32_t RSSI() { return _rssi; }
+  IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+  IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+  String macAddress() { return String("DE:AD:BE:EF:00:01"); }
+  String SSID() const { return String("host"); }
+  String psk() const { return String(); }
+  const char* getHostname() { return "klimerko-host"; }
+  bool hostname(const char*) { return true; }
+  bool mode(WiFiMode_t m) { _mode = m; return true; }
+  WiFiMode_t getMode() { return _mode; }
+  bool begin() { return true; }
+  bool begin(const char*, const char* = nullptr) { return true; }
+  bool disconnect(bool = false) { return true; }
+  bool reconnect() { return true; }
+  bool setAutoReconnect(bool) { return true; }
+  bool persistent(bool) { return true; }
+  bool setSleepMode(WiFiSleepType_t) { return true; }
+  int hostByName(const char* host, IPAddress& result);
+  int hostByName(const char* host, IPAddress& result, uint32_t /*timeoutMs*/) { return hostByName(host, result); }
+
+  void hostSetStatus(wl_status_t s) { _status = s; }
+  void hostSetRSSI(int32_t rssi) { _rssi = rssi; }
+  // Connections by this name go to a stand-in server on 127.0.0.1:port
+  void hostRedirect(const char* host, uint16_t port) { _redirectHost = host; _redirectPort = port; }
+  bool hostRedirected(const char* host, uint16_t& port) const {
+    if (_redirectHost.empty() || _redirectHost != host) return false;
+    port = _redirectPort;
+    return true;
+  }
+
+private:
+  std::string _redirectHost;
+  uint16_t _redirectPort = 0;
+  wl_status_t _status = WL_CONNECTED;
+  int32_t _rssi = -55;
+  WiFiMode_t _mode = WIFI_STA;
+};
+
+extern ESP8266WiFiClass WiFi;
+
+#endif // KLIMERKO_HOST_ESP8266WIFI_H
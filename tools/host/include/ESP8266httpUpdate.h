@@ -0,0 +1,25 @@
+/**
+ * @file ESP8266httpUpdate.h
+ * @brief Host shim - HTTP firmware update; always fails (nothing to flash)
+ */
+
+#ifndef KLIMERKO_HOST_ESP8266HTTPUPDATE_H
+#define KLIMERKO_HOST_ESP8266HTTPUPDATE_H
+
+#include "Arduino.h"
+#include "WiFiClient.h"
+
+enum HTTPUpdateResult { HTTP_UPDATE_FAILED, HTTP_UPDATE_NO_UPDATES, HTTP_UPDATE_OK };
+typedef HTTPUpdateResult t_httpUpdate_return;
+
+class ESP8266HTTPUpdate {
+public:
+  t_httpUpdate_return update(WiFiClient&, const String&) { return HTTP_UPDATE_FAILED; }
+  int getLastError() { return -1; }
+  String getLastErrorString() { return String("not supported on host"); }
+  void rebootOnUpdate(bool) {}
+};
+
+extern ESP8266HTTPUpdate ESPhttpUpdate;
+
+#endif // KLIMERKO_HOST_ESP8266HTTPUPDATE_H
@@ -0,0 +1,22 @@
+/**
+ * @file ESP8266mDNS.h
+ * @brief Host shim - mDNS responder (no-op)
+ */
+
+#ifndef KLIMERKO_HOST_ESP8266MDNS_H
+#define KLIMERKO_HOST_ESP8266MDNS_H
+
+#include "Arduino.h"
+
+class MDNSResponder {
+public:
+  bool begin(const char* /*hostname*/) { return true; }
+  bool begin(const String& hostname) { return begin(hostname.c_str()); }
+  bool addService(const char*, const char*, uint16_t) { return true; }
+  bool update() { return true; }
+  void end() {}
+};
+
+extern MDNSResponder MDNS;
+
+#endif // KLIMERKO_HOST_ESP8266MDNS_H
@@ -0,0 +1,92 @@
+/**
+ * @file Esp.h
+ * @brief Host shim - ESP8266 system API (chip, heap, RTC memory, watchdog)
+ */
+
+#ifndef KLIMERKO_HOST_ESP_H
+#define KLIMERKO_HOST_ESP_H
+
+#include <cstdint>
+#include <cstddef>
+#include "WString.h"
+
+enum RFMode { RF_DEFAULT = 0, RF_CAL = 1, RF_NO_CAL = 2, RF_DISABLED = 4 };
+#define WAKE_RF_DEFAULT  RF_DEFAULT
+#define WAKE_RFCAL       RF_CAL
+#define WAKE_NO_RFCAL    RF_NO_CAL
+#define WAKE_RF_DISABLED RF_DISABLED
+
+enum rst_reason {
+  REASON_DEFAULT_RST = 0,
+  REASON_WDT_RST = 1,
+  REASON_EXCEPTION_RST = 2,
+  REASON_SOFT_WDT_RST = 3,
+  REASON_SOFT_RESTART = 4,
+  REASON_DEEP_SLEEP_AWAKE = 5,
+  REASON_EXT_SYS_RST = 6
+};
+
+struct rst_info {
+  uint32_t reason;
+  uint32_t exccause;
+  uint32_t epc1;
+  uint32_t epc2;
+  uint32_t epc3;
+  uint32_t excvaddr;
+  uint32_t depc;
+};
+
+/**
+ * @brief Thrown by ESP.restart()/deepSleep() so host drivers can unwind
+ */
+struct HostRestart {
+  bool deepSleep;
+  uint64_t sleepUs;
+};
+
+class EspClass {
+public:
+  uint32_t getChipId() { return 0x00C0FFEE; }
+  uint32_t getFlashChipId() { return 0x1640EF; }
+  uint32_t getFlashChipRealSize() { return 4 * 1024 * 1024; }
+  uint32_t getFlashChipSize() { return 4 * 1024 * 1024; }
+  uint32_t getSketchSize() { return 512 * 1024; }
+  uint32_t getFreeSketchSpace() { return 1024 * 1024; }
+  String getSketchMD5() { return String("00000000000000000000000000000000"); }
+  const char* getSdkVersion() { return "host"; }
+  String getCoreVersion() { return String("host"); }
+  String getFullVersion() { return String("host"); }
+  uint8_t getCpuFreqMHz() { return 80; }
+
+  uint32_t getFreeHeap();
+  uint32_t getMaxFreeBlockSize();
+  uint8_t getHeapFragmentation();
+  void getHeapStats(uint32_t* hfree, uint32_t* hmax, uint8_t* hfrag);
+  uint32_t getFreeContStack();
+  void resetFreeContStack() {}
+
+  uint32_t getCycleCount();
+
+  void wdtEnable(uint32_t /*timeout_ms*/ = 0) {}
+  void wdtDisable() {}
+  void wdtFeed() {}
+
+  [[noreturn]] void restart();
+  [[noreturn]] void reset() { restart(); }
+  [[noreturn]] void deepSleep(uint64_t timeUs, RFMode mode = RF_DEFAULT);
+  uint64_t deepSleepMax() { return 3 * 3600ULL * 1000000ULL; }
+  bool eraseConfig() { return true; }
+
+  bool rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size);
+  bool rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size);
+
+  rst_info* getResetInfoPtr();
+  String getResetReason();
+  String getResetInfo();
+
+  uint32_t random();
+};
+
+extern EspClass ESP;
+
+#endif // KLIMERKO_HOST_ESP_H
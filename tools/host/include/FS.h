@@ -0,0 +1,124 @@
+/**
+ * @file FS.h
+ * @brief Host shim - Arduino FS API on top of a host directory
+ */
+
+#ifndef KLIMERKO_HOST_FS_H
+#define KLIMERKO_HOST_FS_H
+
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+struct FSInfo {
+  size_t totalBytes;
+  size_t usedBytes;
+  size_t blockSize;
+  size_t pageSize;
+  size_t maxOpenFiles;
+  size_t maxPathLength;
+};
+
+class File : public Stream {
+public:
+  File() {}
+  File(FILE* fp, const std::string& name, const std::string& hostPath, bool isDir = false);
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buf, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int peek() override;
+  int read(uint8_t* buf, size_t size) override;
+  size_t readBytes(char* buffer, size_t length) override { return (size_t)read((uint8_t*)buffer, length); }
+  void flush() override;
+  bool seek(uint32_t pos, SeekMode mode = SeekSet);
+  size_t position() const;
+  size_t size() const;
+  bool truncate(uint32_t size);
+  void close();
+  operator bool() const { return (bool)_fp || _isDir; }
+  const char* name() const;
+  const char* fullName() const { return _name.c_str(); }
+  bool isFile() const { return (bool)_fp; }
+  bool isDirectory() const { return _isDir; }
+  time_t getLastWrite();
+  time_t getCreationTime() { return getLastWrite(); }
+
+private:
+  std::shared_ptr<FILE> _fp;
+  std::string _name;
+  std::string _hostPath;
+  bool _isDir = false;
+};
+
+class Dir {
+public:
+  Dir() {}
+  Dir(const std::string& hostPath, const std::string& fsPath);
+  bool next();
+  String fileName() const;
+  size_t fileSize() const;
+  bool isFile() const;
+  bool isDirectory() const;
+  File openFile(const char* mode);
+  bool rewind() { _index = -1; return true; }
+
+private:
+  std::string _hostPath;
+  std::string _fsPath;
+  std::vector<std::string> _entries;
+  int _index = -1;
+};
+
+class FS {
+public:
+  bool begin();
+  void end() {}
+  bool format();
+  bool info(FSInfo& info);
+  File open(const char* path, const char* mode);
+  File open(const String& path, const char* mode) { return open(path.c_str(), mode); }
+  bool exists(const char* path);
+  bool exists(const String& path) { return exists(path.c_str()); }
+  Dir openDir(const char* path);
+  Dir openDir(const String& path) { return openDir(path.c_str()); }
+  bool remove(const char* path);
+  bool remove(const String& path) { return remove(path.c_str()); }
+  bool rename(const char* from, const char* to);
+  bool mkdir(const char* path);
+  bool mkdir(const String& path) { return mkdir(path.c_str()); }
+  bool rmdir(const char* path);
+
+  /** Host directory that backs this filesystem */
+  void hostSetRoot(const std::string& dir) { _root = dir; }
+  const std::string& hostRoot() const { return _root; }
+  /** Files opened so far (each open allocates a handle on the device too) */
+  uint32_t hostOpens() const { return _opens; }
+
+private:
+  std::string hostPath(const char* path) const;
+  std::string _root = "klimerko_fs";
+  uint32_t _opens = 0;
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::Dir;
+using fs::FS;
+using fs::FSInfo;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+#endif // KLIMERKO_HOST_FS_H
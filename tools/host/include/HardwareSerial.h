@@ -0,0 +1,38 @@
+/**
+ * @file HardwareSerial.h
+ * @brief Host shim - Serial writes to stdout, reads nothing
+ */
+
+#ifndef KLIMERKO_HOST_HARDWARESERIAL_H
+#define KLIMERKO_HOST_HARDWARESERIAL_H
+
+#include "Stream.h"
+
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long /*baud*/) {}
+  void end() {}
+  void setDebugOutput(bool) {}
+  void setQuiet(bool quiet) { _quiet = quiet; }
+
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  size_t write(uint8_t c) override {
+    if (!_quiet) fputc(c, stdout);
+    return 1;
+  }
+  size_t write(const uint8_t* buffer, size_t size) override {
+    if (!_quiet) fwrite(buffer, 1, size, stdout);
+    return size;
+  }
+  using Print::write;
+  operator bool() const { return true; }
+
+private:
+  bool _quiet = false;
+};
+
+extern HardwareSerial Serial;
+
+#endif // KLIMERKO_HOST_HARDWARESERIAL_H
@@ -0,0 +1,144 @@
+/**
+ * @file HostBME280.h
+ * @brief Host emulation - BME280 register map on the host TwoWire
+ *
+ * Serves the chip ID, a fixed set of trimming coefficients and raw ADC
+ * words. setConditions() finds the raw words whose Bosch integer
+ * compensation (the driver's own formulas) lands on the requested values,
+ * so the real Adafruit driver reads them back within one LSB.
+ *
+ *   HostBME280 bme;
+ *   Wire.hostAttach(0x76, &bme);
+ *   bme.setConditions(21.5f, 1013.2f, 45.0f);
+ */
+
+#ifndef KLIMERKO_HOST_BME280_H
+#define KLIMERKO_HOST_BME280_H
+
+#include <cstdint>
+#include <cstring>
+#include "Wire.h"
+
+class HostBME280 : public HostI2CDevice {
+public:
+  HostBME280() {
+    memset(_regs, 0, sizeof(_regs));
+    _regs[0xD0] = 0x60;  // Chip ID
+    putLE(0x88, T1); putLE(0x8A, (uint16_t)T2); putLE(0x8C, (uint16_t)T3);
+    putLE(0x8E, P1); putLE(0x90, (uint16_t)P2); putLE(0x92, (uint16_t)P3);
+    putLE(0x94, (uint16_t)P4); putLE(0x96, (uint16_t)P5); putLE(0x98, (uint16_t)P6);
+    putLE(0x9A, (uint16_t)P7); putLE(0x9C, (uint16_t)P8); putLE(0x9E, (uint16_t)P9);
+    _regs[0xA1] = H1;
+    putLE(0xE1, (uint16_t)H2);
+    _regs[0xE3] = H3;
+    _regs[0xE4] = (uint8_t)(H4 >> 4);
+    _regs[0xE5] = (uint8_t)((H4 & 0x0F) | ((H5 & 0x0F) << 4));
+    _regs[0xE6] = (uint8_t)(H5 >> 4);
+    _regs[0xE7] = (uint8_t)H6;
+    setConditions(20.0f, 1013.25f, 50.0f);
+  }
+
+  /**
+   * @brief Next measurement: degrees C, hPa, % relative humidity
+   */
+  void setConditions(float temperatureC, float pressureHpa, float humidity) {
+    int32_t adcT = solve(0, 0xFFFFF, [](int32_t adc, int32_t) { return (int64_t)compensateT(adc) * 5 / 256; },
+                         (int64_t)(temperatureC * 100), 0);
+    int32_t tFine = compensateT(adcT);
+    int32_t adcP = solve(0, 0xFFFFF, [](int32_t adc, int32_t tf) { return (int64_t)compensateP(adc, tf); },
+                         (int64_t)(pressureHpa * 100 * 256), tFine);
+    int32_t adcH = solve(0, 0xFFFF, [](int32_t adc, int32_t tf) { return (int64_t)compensateH(adc, tf); },
+                         (int64_t)(humidity * 1024), tFine);
+    put20(0xF7, adcP);
+    put20(0xFA, adcT);
+    _regs[0xFD] = (uint8_t)(adcH >> 8);
+    _regs[0xFE] = (uint8_t)adcH;
+  }
+
+  /**
+   * @brief Simulate a sensor that stopped answering (reads 0xFF, like a floating bus)
+   */
+  void setFailed(bool failed) { _failed = failed; }
+
+  uint8_t readRegister(uint8_t reg) override { return _failed ? 0xFF : _regs[reg]; }
+  void writeRegister(uint8_t reg, uint8_t value) override {
+    if (reg == 0xE0) return;  // Soft reset: registers keep their values
+    if (reg >= 0xF2) _regs[reg] = value;
+  }
+
+private:
+  // Trimming coefficients (typical values from the Bosch datasheet)
+  static const uint16_t T1 = 27504;
+  static const int16_t T2 = 26435, T3 = -1000;
+  static const uint16_t P1 = 36477;
+  static const int16_t P2 = -10685, P3 = 3024, P4 = 2855, P5 = 140, P6 = -7, P7 = 15500, P8 = -14600, P9 = 6000;
+  static const uint8_t H1 = 75, H3 = 0;
+  static const int16_t H2 = 362, H4 = 313, H5 = 50;
+  static const int8_t H6 = 30;
+
+  static int32_t compensateT(int32_t adc) {
+    int32_t var1 = ((adc / 8) - ((int32_t)T1 * 2)) * T2 / 2048;
+    int32_t var2 = (adc / 16) - (int32_t)T1;
+    var2 = ((var2 * var2) / 4096) * T3 / 16384;
+    return var1 + var2;
+  }
+
+  // Pa * 256
+  static int64_t compensateP(int32_t adc, int32_t tFine) {
+    int64_t var1 = (int64_t)tFine - 128000;
+    int64_t var2 = var1 * var1 * P6;
+    var2 += (var1 * P5) * 131072;
+    var2 += (int64_t)P4 * 34359738368;
+    var1 = ((var1 * var1 * P3) / 256) + (var1 * P2 * 4096);
+    var1 = ((int64_t)140737488355328 + var1) * P1 / 8589934592;
+    if (var1 == 0) return 0;
+    int64_t p = 1048576 - adc;
+    p = (((p * 2147483648) - var2) * 3125) / var1;
+    var1 = ((int64_t)P9 * (p / 8192) * (p / 8192)) / 33554432;
+    var2 = ((int64_t)P8 * p) / 524288;
+    return ((p + var1 + var2) / 256) + ((int64_t)P7 * 16);
+  }
+
+  // %RH * 1024
+  static int32_t compensateH(int32_t adc, int32_t tFine) {
+    int32_t var1 = tFine - 76800;
+    int32_t var5 = ((adc * 16384 - (int32_t)H4 * 1048576 - H5 * var1) + 16384) / 32768;
+    int32_t var2 = (var1 * H6) / 1024;
+    int32_t var3 = (var1 * H3) / 2048;
+    int32_t var4 = ((var2 * (var3 + 32768)) / 1024) + 2097152;
+    var2 = ((var4 * H2) + 8192) / 16384;
+    var3 = var5 * var2;
+    var4 = ((var3 / 32768) * (var3 / 32768)) / 128;
+    var5 = var3 - ((var4 * H1) / 16);
+    var5 = var5 < 0 ? 0 : var5 > 419430400 ? 419430400 : var5;
+    return var5 / 4096;
+  }
+
+  // Bisection over a monotonic compensation (rising or falling)
+  template <typename F>
+  static int32_t solve(int32_t lo, int32_t hi, F f, int64_t target, int32_t tFine) {
+    bool rising = f(hi, tFine) > f(lo, tFine);
+    while (lo < hi) {
+      int32_t mid = lo + (hi - lo) / 2;
+      if ((f(mid, tFine) < target) == rising) lo = mid + 1;
+      else hi = mid;
+    }
+    return lo;
+  }
+
+  void putLE(uint8_t reg, uint16_t v) {
+    _regs[reg] = (uint8_t)v;
+    _regs[reg + 1] = (uint8_t)(v >> 8);
+  }
+
+  void put20(uint8_t reg, int32_t adc) {
+    _regs[reg] = (uint8_t)(adc >> 12);
+    _regs[reg + 1] = (uint8_t)(adc >> 4);
+    _regs[reg + 2] = (uint8_t)(adc << 4);
+  }
+
+  uint8_t _regs[256];
+  bool _failed = false;
+};
+
+#endif // KLIMERKO_HOST_BME280_H
@@ -0,0 +1,151 @@
+/**
+ * @file HostHttpServer.h
+ * @brief Host emulation - minimal HTTP/1.1 server on localhost
+ *
+ * Stand-in for the HTTP endpoints the sinks post to (InfluxDB,
+ * Sensor.Community). Reads keep-alive requests with a Content-Length body,
+ * records them and answers each with the status chosen by a callback
+ * (default 204). Listens on a kernel-chosen port; serves each connection on
+ * its own thread, so the object has to outlive the test.
+ *
+ *   HostHttpServer server;
+ *   uint16_t port = server.start();
+ *   server.setStatus([](const HostHttpServer::Request& r) { return 500; });
+ *   ... server.requests()
+ */
+
+#ifndef KLIMERKO_HOST_HTTP_SERVER_H
+#define KLIMERKO_HOST_HTTP_SERVER_H
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class HostHttpServer {
+public:
+  struct Request {
+    std::string method;
+    std::string path;
+    std::string headers;  // Raw header lines, names lower-cased
+    std::string body;
+
+    std::string header(const char* name) const {
+      std::string key = std::string("\r\n") + name + ":";
+      size_t at = ("\r\n" + headers).find(key);
+      if (at == std::string::npos) return std::string();
+      at += key.size() - 2;
+      size_t end = headers.find("\r\n", at);
+      std::string value = headers.substr(at, end == std::string::npos ? end : end - at);
+      size_t first = value.find_first_not_of(' ');
+      return first == std::string::npos ? std::string() : value.substr(first);
+    }
+  };
+
+  /**
+   * @brief Listen on 127.0.0.1
+   * @return Port number; exits the test if the socket cannot be opened
+   */
+  uint16_t start() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 4) < 0 ||
+        getsockname(fd, (sockaddr*)&addr, &len) < 0) {
+      perror("http");
+      exit(2);
+    }
+    std::thread([this, fd]() {
+      for (;;) {
+        int client = accept(fd, nullptr, nullptr);
+        if (client < 0) return;
+        std::thread([this, client]() { serve(client); }).detach();
+      }
+    }).detach();
+    return ntohs(addr.sin_port);
+  }
+
+  /**
+   * @brief Choose the response status per request (called on the server thread)
+   */
+  void setStatus(std::function<int(const Request&)> status) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _status = status;
+  }
+
+  std::vector<Request> requests() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _requests;
+  }
+
+private:
+  void serve(int fd) {
+    std::string buf;
+    char chunk[2048];
+    for (;;) {
+      size_t headerEnd;
+      while ((headerEnd = buf.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+          close(fd);
+          return;
+        }
+        buf.append(chunk, (size_t)n);
+      }
+      Request r;
+      size_t lineEnd = buf.find("\r\n");
+      std::string line = buf.substr(0, lineEnd);
+      size_t sp1 = line.find(' ');
+      size_t sp2 = line.find(' ', sp1 + 1);
+      r.method = line.substr(0, sp1);
+      r.path = line.substr(sp1 + 1, sp2 - sp1 - 1);
+      r.headers = buf.substr(lineEnd + 2, headerEnd - lineEnd - 2);
+      for (size_t i = 0; i < r.headers.size(); i++) {
+        if (r.headers[i] == ':') {
+          while (i < r.headers.size() && r.headers[i] != '\n') i++;
+        } else {
+          r.headers[i] = (char)tolower(r.headers[i]);
+        }
+      }
+      size_t length = (size_t)atol(r.header("content-length").c_str());
+      buf.erase(0, headerEnd + 4);
+      while (buf.size() < length) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+          close(fd);
+          return;
+        }
+        buf.append(chunk, (size_t)n);
+      }
+      r.body = buf.substr(0, length);
+      buf.erase(0, length);
+
+      int code;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        code = _status ? _status(r) : 204;
+        _requests.push_back(r);
+      }
+      char response[96];
+      int n = snprintf(response, sizeof(response), "HTTP/1.1 %d Status\r\nContent-Length: 0\r\n\r\n", code);
+      send(fd, response, (size_t)n, MSG_NOSIGNAL);
+    }
+  }
+
+  std::mutex _mutex;
+  std::function<int(const Request&)> _status;
+  std::vector<Request> _requests;
+};
+
+#endif // KLIMERKO_HOST_HTTP_SERVER_H
@@ -0,0 +1,160 @@
+/**
+ * @file HostMqttBroker.h
+ * @brief Host emulation - minimal MQTT 3.1.1 broker on localhost
+ *
+ * Enough of a broker for the firmware and its sinks: CONNACK, SUBACK
+ * (QoS 0 granted), PUBACK for QoS 1 publishes (can be withheld to test
+ * timeouts) and PINGRESP. Publishes are recorded, not routed. Listens on a
+ * kernel-chosen port; serves each connection on its own thread, so the
+ * object has to outlive the test (make it static or keep it in main()).
+ *
+ *   HostMqttBroker broker;
+ *   uint16_t port = broker.start();
+ *   ... broker.publishes(), broker.messages()
+ */
+
+#ifndef KLIMERKO_HOST_MQTT_BROKER_H
+#define KLIMERKO_HOST_MQTT_BROKER_H
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class HostMqttBroker {
+public:
+  struct Message {
+    std::string topic;
+    std::string payload;
+    uint8_t qos;
+  };
+
+  /**
+   * @brief Listen on 127.0.0.1
+   * @return Port number; exits the test if the socket cannot be opened
+   */
+  uint16_t start() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 4) < 0 ||
+        getsockname(fd, (sockaddr*)&addr, &len) < 0) {
+      perror("broker");
+      exit(2);
+    }
+    std::thread([this, fd]() {
+      for (;;) {
+        int client = accept(fd, nullptr, nullptr);
+        if (client < 0) return;
+        _connections++;
+        std::thread([this, client]() { serve(client); }).detach();
+      }
+    }).detach();
+    return ntohs(addr.sin_port);
+  }
+
+  /**
+   * @brief Withhold PUBACKs (QoS 1 publishes stay in flight)
+   */
+  void setAck(bool ack) { _ack = ack; }
+
+  unsigned long publishes() const { return _publishes; }
+  unsigned long connections() const { return _connections; }
+
+  std::vector<Message> messages() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _messages;
+  }
+
+private:
+  static bool readFully(int fd, uint8_t* buf, size_t len) {
+    while (len) {
+      ssize_t n = recv(fd, buf, len, 0);
+      if (n <= 0) return false;
+      buf += n;
+      len -= (size_t)n;
+    }
+    return true;
+  }
+
+  void serve(int fd) {
+    std::vector<uint8_t> packet;
+    for (;;) {
+      uint8_t type;
+      if (!readFully(fd, &type, 1)) break;
+      uint32_t length = 0;
+      bool ok = true;
+      for (int shift = 0; shift < 28; shift += 7) {
+        uint8_t b;
+        if (!(ok = readFully(fd, &b, 1))) break;
+        length |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) break;
+      }
+      packet.resize(length);
+      if (!ok || !readFully(fd, packet.data(), length)) break;
+
+      switch (type >> 4) {
+        case 1: {  // CONNECT
+          const uint8_t connack[] = {0x20, 0x02, 0x00, 0x00};
+          send(fd, connack, sizeof(connack), MSG_NOSIGNAL);
+          break;
+        }
+        case 3: {  // PUBLISH
+          uint8_t qos = (type >> 1) & 3;
+          uint16_t topicLength = (uint16_t)((packet[0] << 8) | packet[1]);
+          size_t payloadAt = 2 + topicLength + (qos ? 2 : 0);
+          if (payloadAt > length) break;
+          {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _messages.push_back({std::string((const char*)packet.data() + 2, topicLength),
+                                 std::string((const char*)packet.data() + payloadAt, length - payloadAt), qos});
+          }
+          _publishes++;
+          if (qos && _ack) {
+            const uint8_t puback[] = {0x40, 0x02, packet[2 + topicLength], packet[3 + topicLength]};
+            send(fd, puback, sizeof(puback), MSG_NOSIGNAL);
+          }
+          break;
+        }
+        case 8: {  // SUBSCRIBE: grant QoS 0 to every filter
+          uint8_t suback[64] = {0x90, 0, packet[0], packet[1]};
+          size_t n = 4;
+          for (uint32_t i = 2; i + 2 <= length && n < sizeof(suback);) {
+            i += 2 + ((packet[i] << 8) | packet[i + 1]) + 1;
+            suback[n++] = 0x00;
+          }
+          suback[1] = (uint8_t)(n - 2);
+          send(fd, suback, n, MSG_NOSIGNAL);
+          break;
+        }
+        case 12: {  // PINGREQ
+          const uint8_t pingresp[] = {0xD0, 0x00};
+          send(fd, pingresp, sizeof(pingresp), MSG_NOSIGNAL);
+          break;
+        }
+        case 14:  // DISCONNECT
+          close(fd);
+          return;
+      }
+    }
+    close(fd);
+  }
+
+  std::atomic<bool> _ack{true};
+  std::atomic<unsigned long> _publishes{0};
+  std::atomic<unsigned long> _connections{0};
+  std::mutex _mutex;
+  std::vector<Message> _messages;
+};
+
+#endif // KLIMERKO_HOST_MQTT_BROKER_H
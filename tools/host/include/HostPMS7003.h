@@ -0,0 +1,137 @@
+/**
+ * @file HostPMS7003.h
+ * @brief Host emulation - Plantower PMS7003 on a host SoftwareSerial
+ *
+ * Answers the 7-byte host commands like the sensor: sleep/wake, active or
+ * passive mode, and a 32-byte data frame per passive read request (or per
+ * tick() in active mode). Faults for simulations: silent (no reply),
+ * corrupt checksum and a stuck fan (frames keep coming, counts frozen).
+ * A recorded reply (any bytes, e.g. a truncated or noisy frame) can stand
+ * in for the next frame with queueRawReply().
+ *
+ *   HostPMS7003 pms(pmsSerial);
+ *   pms.setConcentrations(8, 12, 15);  // PM1.0, PM2.5, PM10 in ug/m3
+ */
+
+#ifndef KLIMERKO_HOST_PMS7003_H
+#define KLIMERKO_HOST_PMS7003_H
+
+#include <cstring>
+#include "SoftwareSerial.h"
+
+class HostPMS7003 {
+public:
+  explicit HostPMS7003(SoftwareSerial& serial) : _serial(serial) {
+    _serial.hostSetResponder([this](SoftwareSerial&, const uint8_t* data, size_t len) { receive(data, len); });
+  }
+
+  void setConcentrations(uint16_t pm1, uint16_t pm25, uint16_t pm10) {
+    if (_stuck) return;
+    _pm1 = pm1;
+    _pm25 = pm25;
+    _pm10 = pm10;
+  }
+
+  void setSilent(bool silent) { _silent = silent; }
+  void setCorrupt(bool corrupt) { _corrupt = corrupt; }
+  void setStuck(bool stuck) { _stuck = stuck; }
+
+  /**
+   * @brief Send these bytes verbatim instead of the next frame (up to RAW_REPLY_MAX)
+   */
+  void queueRawReply(const uint8_t* data, size_t len) {
+    _rawLen = len < RAW_REPLY_MAX ? len : RAW_REPLY_MAX;
+    memcpy(_raw, data, _rawLen);
+    _rawPending = true;
+  }
+
+  bool awake() const { return _awake; }
+  bool passive() const { return _passive; }
+  uint32_t framesSent() const { return _frames; }
+  uint32_t wakeUps() const { return _wakeUps; }
+
+  /**
+   * @brief Active mode: the sensor pushes a frame about once a second
+   */
+  void tick() {
+    if (_awake && !_passive) sendFrame();
+  }
+
+private:
+  void receive(const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+      _cmd[_cmdLen] = data[i];
+      if (_cmdLen == 0 && data[i] != 0x42) continue;
+      if (_cmdLen == 1 && data[i] != 0x4D) {
+        _cmdLen = 0;
+        continue;
+      }
+      if (++_cmdLen == sizeof(_cmd)) {
+        execute();
+        _cmdLen = 0;
+      }
+    }
+  }
+
+  void execute() {
+    uint16_t sum = 0;
+    for (int i = 0; i < 5; i++) sum += _cmd[i];
+    if (sum != (uint16_t)((_cmd[5] << 8) | _cmd[6])) return;
+    switch (_cmd[2]) {
+      case 0xE4:
+        if (_cmd[4] && !_awake) _wakeUps++;
+        _awake = _cmd[4] != 0;
+        break;
+      case 0xE1:
+        _passive = _cmd[4] == 0;
+        break;
+      case 0xE2:
+        if (_awake && _passive) sendFrame();
+        break;
+    }
+  }
+
+  void sendFrame() {
+    if (_rawPending) {
+      _rawPending = false;
+      _serial.hostInject(_raw, _rawLen);
+      _frames++;
+      return;
+    }
+    if (_silent) return;
+    uint8_t f[32] = {0x42, 0x4D, 0x00, 28};
+    const uint16_t values[13] = {_pm1, _pm25, _pm10, _pm1, _pm25, _pm10,
+                                 (uint16_t)(_pm25 * 60u), (uint16_t)(_pm25 * 18u), (uint16_t)(_pm25 * 4u),
+                                 (uint16_t)_pm25, (uint16_t)(_pm10 / 3u), (uint16_t)(_pm10 / 10u), 0x97};
+    for (int i = 0; i < 13; i++) {
+      f[4 + i * 2] = (uint8_t)(values[i] >> 8);
+      f[5 + i * 2] = (uint8_t)values[i];
+    }
+    uint16_t sum = 0;
+    for (int i = 0; i < 30; i++) sum += f[i];
+    if (_corrupt) sum ^= 0x5A5A;
+    f[30] = (uint8_t)(sum >> 8);
+    f[31] = (uint8_t)sum;
+    _serial.hostInject(f, sizeof(f));
+    _frames++;
+  }
+
+  static const size_t RAW_REPLY_MAX = 128;
+
+  SoftwareSerial& _serial;
+  uint8_t _cmd[7] = {0};
+  size_t _cmdLen = 0;
+  bool _awake = true;
+  bool _passive = false;
+  bool _silent = false;
+  bool _corrupt = false;
+  bool _stuck = false;
+  uint16_t _pm1 = 5, _pm25 = 8, _pm10 = 10;
+  uint8_t _raw[RAW_REPLY_MAX];
+  size_t _rawLen = 0;
+  bool _rawPending = false;
+  uint32_t _frames = 0;
+  uint32_t _wakeUps = 0;
+};
+
+#endif // KLIMERKO_HOST_PMS7003_H
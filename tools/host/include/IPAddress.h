@@ -0,0 +1,49 @@
+/**
+ * @file IPAddress.h
+ * @brief Host shim - IPv4 address
+ */
+
+#ifndef KLIMERKO_HOST_IPADDRESS_H
+#define KLIMERKO_HOST_IPADDRESS_H
+
+#include "Arduino.h"
+
+class IPAddress : public Printable {
+public:
+  IPAddress() : _addr(0) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    : _addr((uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24)) {}
+  IPAddress(uint32_t addr) : _addr(addr) {}
+  IPAddress(const uint8_t* addr) : IPAddress(addr[0], addr[1], addr[2], addr[3]) {}
+
+  operator uint32_t() const { return _addr; }
+  uint32_t v4() const { return _addr; }
+  bool isSet() const { return _addr != 0; }
+  bool operator==(const IPAddress& o) const { return _addr == o._addr; }
+  bool operator!=(const IPAddress& o) const { return _addr != o._addr; }
+  uint8_t operator[](int i) const { return (uint8_t)(_addr >> (8 * i)); }
+
+  bool fromString(const char* s) {
+    unsigned a, b, c, d;
+    if (sscanf(s, "%u.%u.%u.%u", &a, &b, &c, &d) != 4 || a > 255 || b > 255 || c > 255 || d > 255) return false;
+    *this = IPAddress((uint8_t)a, (uint8_t)b, (uint8_t)c, (uint8_t)d);
+    return true;
+  }
+  bool fromString(const String& s) { return fromString(s.c_str()); }
+  String toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(buf);
+  }
+  size_t printTo(Print& p) const override { return p.print(toString()); }
+  static bool isValid(const char* s) { IPAddress ip; return ip.fromString(s); }
+
+private:
+  uint32_t _addr;
+};
+
+// <netinet/in.h> defines INADDR_NONE as a macro; the Arduino name wins here
+#undef INADDR_NONE
+extern const IPAddress INADDR_NONE;
+
+#endif // KLIMERKO_HOST_IPADDRESS_H
@@ -0,0 +1,13 @@
+/**
+ * @file LittleFS.h
+ * @brief Host shim - LittleFS instance on a host directory (see FS.h)
+ */
+
+#ifndef KLIMERKO_HOST_LITTLEFS_H
+#define KLIMERKO_HOST_LITTLEFS_H
+
+#include "FS.h"
+
+extern fs::FS LittleFS;
+
+#endif // KLIMERKO_HOST_LITTLEFS_H
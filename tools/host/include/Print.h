@@ -0,0 +1,85 @@
+/**
+ * @file Print.h
+ * @brief Host shim - Arduino Print base class
+ */
+
+#ifndef KLIMERKO_HOST_PRINT_H
+#define KLIMERKO_HOST_PRINT_H
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include "WString.h"
+#include "Printable.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+      if (!write(*buffer++)) break;
+      n++;
+    }
+    return n;
+  }
+  size_t write(const char* s) { return s ? write(reinterpret_cast<const uint8_t*>(s), strlen(s)) : 0; }
+  size_t write(const char* buffer, size_t size) { return write(reinterpret_cast<const uint8_t*>(buffer), size); }
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (len < 0) return 0;
+    if ((size_t)len < sizeof(buf)) return write(buf, (size_t)len);
+    std::string big((size_t)len + 1, '\0');
+    va_start(args, format);
+    vsnprintf(&big[0], big.size(), format, args);
+    va_end(args);
+    return write(big.data(), (size_t)len);
+  }
+  size_t printf_P(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[512];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    return len > 0 ? write(buf, std::min((size_t)len, sizeof(buf) - 1)) : 0;
+  }
+
+  size_t print(const __FlashStringHelper* s) { return write(reinterpret_cast<const char*>(s)); }
+  size_t print(const String& s) { return write(s.c_str(), s.length()); }
+  size_t print(const char* s) { return write(s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(int v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned int v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(long v, int base = DEC) {
+    if (base == DEC) return printf("%ld", v);
+    return print(String(v, (unsigned char)base));
+  }
+  size_t print(unsigned long v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+  size_t print(long long v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+  size_t print(unsigned long long v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+  size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+  size_t print(const Printable& p) { return p.printTo(*this); }
+
+  template<typename T>
+  size_t println(const T& v) { size_t n = print(v); return n + println(); }
+  template<typename T>
+  size_t println(const T& v, int fmt) { size_t n = print(v, fmt); return n + println(); }
+  size_t println(void) { return write("\r\n"); }
+};
+
+#endif // KLIMERKO_HOST_PRINT_H
@@ -0,0 +1,19 @@
+/**
+ * @file Printable.h
+ * @brief Host shim - Arduino Printable interface
+ */
+
+#ifndef KLIMERKO_HOST_PRINTABLE_H
+#define KLIMERKO_HOST_PRINTABLE_H
+
+#include <cstddef>
+
+class Print;
+
+class Printable {
+public:
+  virtual ~Printable() {}
+  virtual size_t printTo(Print& p) const = 0;
+};
+
+#endif // KLIMERKO_HOST_PRINTABLE_H
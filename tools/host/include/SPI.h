@@ -0,0 +1,18 @@
+/**
+ * @file SPI.h
+ * @brief Host shim - SPI bus placeholder (no SPI devices are emulated)
+ */
+
+#ifndef KLIMERKO_HOST_SPI_H
+#define KLIMERKO_HOST_SPI_H
+
+#include "Arduino.h"
+
+#define SPI_MODE0 0x00
+class SPIClass {
+public:
+  void begin() {}
+};
+extern SPIClass SPI;
+
+#endif // KLIMERKO_HOST_SPI_H
@@ -0,0 +1,85 @@
+/**
+ * @file SoftwareSerial.h
+ * @brief Host shim - serial port fed from an injectable byte queue
+ *
+ * Bytes the device would receive are queued with hostInject() (or produced
+ * on demand by a responder installed with hostSetResponder(), which sees
+ * every write). Like the core, the receive side is a fixed ring buffer:
+ * bytes beyond SOFTWARESERIAL_RX_BUFFER are dropped and counted.
+ *
+ * Polling an empty port costs one byte time on the virtual clock, so a
+ * driver waiting for a reply (PMS::readUntil) times out as on hardware
+ * instead of spinning forever.
+ */
+
+#ifndef KLIMERKO_HOST_SOFTWARESERIAL_H
+#define KLIMERKO_HOST_SOFTWARESERIAL_H
+
+#include <functional>
+#include "Arduino.h"
+
+#define SOFTWARESERIAL_RX_BUFFER 256
+
+class SoftwareSerial : public Stream {
+public:
+  typedef std::function<void(SoftwareSerial&, const uint8_t*, size_t)> Responder;
+
+  SoftwareSerial(int8_t rxPin, int8_t txPin) : _rxPin(rxPin), _txPin(txPin) {}
+
+  void begin(unsigned long baud) { _baud = baud; }
+  void end() {}
+  bool isListening() const { return true; }
+  bool listen() { return true; }
+  bool overflow() {
+    bool o = _overflows != 0;
+    _overflows = 0;
+    return o;
+  }
+
+  int available() override {
+    if (_rxCount == 0) hostAdvanceMicros(_baud ? 10000000ULL / _baud : 1000);
+    return (int)_rxCount;
+  }
+  int read() override {
+    if (_rxCount == 0) return -1;
+    uint8_t c = _rx[_rxHead];
+    _rxHead = (_rxHead + 1) % SOFTWARESERIAL_RX_BUFFER;
+    _rxCount--;
+    return c;
+  }
+  int peek() override { return _rxCount ? _rx[_rxHead] : -1; }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t size) override {
+    _txBytes += size;
+    if (_responder) _responder(*this, buf, size);
+    return size;
+  }
+  using Print::write;
+  void flush() override {}
+
+  void hostInject(const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+      if (_rxCount == SOFTWARESERIAL_RX_BUFFER) {
+        _overflows++;
+        continue;
+      }
+      _rx[(_rxHead + _rxCount++) % SOFTWARESERIAL_RX_BUFFER] = data[i];
+    }
+  }
+  void hostSetResponder(Responder r) { _responder = r; }
+  void hostClearRx() { _rxHead = _rxCount = 0; }
+  uint32_t hostTxBytes() const { return _txBytes; }
+
+private:
+  int8_t _rxPin;
+  int8_t _txPin;
+  unsigned long _baud = 0;
+  uint8_t _rx[SOFTWARESERIAL_RX_BUFFER];
+  size_t _rxHead = 0;
+  size_t _rxCount = 0;
+  uint32_t _overflows = 0;
+  uint32_t _txBytes = 0;
+  Responder _responder;
+};
+
+#endif // KLIMERKO_HOST_SOFTWARESERIAL_H
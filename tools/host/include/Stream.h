@@ -0,0 +1,72 @@
+/**
+ * @file Stream.h
+ * @brief Host shim - Arduino Stream base class
+ */
+
+#ifndef KLIMERKO_HOST_STREAM_H
+#define KLIMERKO_HOST_STREAM_H
+
+#include "Print.h"
+
+unsigned long millis();
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeout) { _timeout = timeout; }
+  unsigned long getTimeout() const { return _timeout; }
+
+  virtual int read(uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (n < size && available() > 0) {
+      int c = read();
+      if (c < 0) break;
+      buffer[n++] = (uint8_t)c;
+    }
+    return (int)n;
+  }
+
+  virtual size_t readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+      int c = timedRead();
+      if (c < 0) break;
+      *buffer++ = (char)c;
+      count++;
+    }
+    return count;
+  }
+  size_t readBytes(uint8_t* buffer, size_t length) { return readBytes(reinterpret_cast<char*>(buffer), length); }
+
+  virtual String readString() {
+    String ret;
+    int c = timedRead();
+    while (c >= 0) {
+      ret += (char)c;
+      c = timedRead();
+    }
+    return ret;
+  }
+
+  String readStringUntil(char terminator) {
+    String ret;
+    int c = timedRead();
+    while (c >= 0 && c != terminator) {
+      ret += (char)c;
+      c = timedRead();
+    }
+    return ret;
+  }
+
+protected:
+  // Host streams are either fed synchronously or backed by files, so a
+  // missing byte will never arrive later - fail fast instead of spinning.
+  int timedRead() { return available() > 0 ? read() : -1; }
+
+  unsigned long _timeout = 1000;
+};
+
+#endif // KLIMERKO_HOST_STREAM_H
@@ -0,0 +1,6 @@
+/**
+ * @file WProgram.h
+ * @brief Host shim - pre-1.0 Arduino header some libraries still probe for
+ */
+
+#include "Arduino.h"
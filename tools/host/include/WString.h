@@ -0,0 +1,198 @@
+/**
+ * @file WString.h
+ * @brief Host shim - Arduino String backed by std::string
+ */
+
+#ifndef KLIMERKO_HOST_WSTRING_H
+#define KLIMERKO_HOST_WSTRING_H
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <strings.h>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+#define FPSTR(pstr_pointer) (reinterpret_cast<const __FlashStringHelper*>(pstr_pointer))
+
+class StringSumHelper;
+
+class String {
+public:
+  String() {}
+  String(const char* s) : _s(s ? s : "") {}
+  String(const char* s, size_t n) : _s(s, n) {}
+  String(const __FlashStringHelper* s) : _s(reinterpret_cast<const char*>(s)) {}
+  String(const String& other) = default;
+  String(String&& other) = default;
+  explicit String(char c) : _s(1, c) {}
+  explicit String(unsigned char v, unsigned char base = 10) { fromUnsigned(v, base); }
+  explicit String(int v, unsigned char base = 10) { fromSigned(v, base); }
+  explicit String(unsigned int v, unsigned char base = 10) { fromUnsigned(v, base); }
+  explicit String(long v, unsigned char base = 10) { fromSigned(v, base); }
+  explicit String(unsigned long v, unsigned char base = 10) { fromUnsigned(v, base); }
+  explicit String(long long v, unsigned char base = 10) { fromSigned(v, base); }
+  explicit String(unsigned long long v, unsigned char base = 10) { fromUnsigned(v, base); }
+  explicit String(float v, unsigned char decimals = 2) { fromDouble(v, decimals); }
+  explicit String(double v, unsigned char decimals = 2) { fromDouble(v, decimals); }
+
+  String& operator=(const String& other) = default;
+  String& operator=(String&& other) = default;
+  String& operator=(const char* s) { _s = s ? s : ""; return *this; }
+  String& operator=(const __FlashStringHelper* s) { _s = reinterpret_cast<const char*>(s); return *this; }
+
+  bool reserve(unsigned int size) { _s.reserve(size); return true; }
+  unsigned int length() const { return (unsigned int)_s.size(); }
+  bool isEmpty() const { return _s.empty(); }
+  const char* c_str() const { return _s.c_str(); }
+  char* begin() { return &_s[0]; }
+  char* end() { return &_s[0] + _s.size(); }
+
+  bool concat(const String& s) { _s += s._s; return true; }
+  bool concat(const char* s) { if (!s) return false; _s += s; return true; }
+  bool concat(const char* s, unsigned int n) { _s.append(s, n); return true; }
+  bool concat(const __FlashStringHelper* s) { return concat(reinterpret_cast<const char*>(s)); }
+  bool concat(char c) { _s += c; return true; }
+  bool concat(unsigned char v) { return concat(String(v)); }
+  bool concat(int v) { return concat(String(v)); }
+  bool concat(unsigned int v) { return concat(String(v)); }
+  bool concat(long v) { return concat(String(v)); }
+  bool concat(unsigned long v) { return concat(String(v)); }
+  bool concat(long long v) { return concat(String(v)); }
+  bool concat(unsigned long long v) { return concat(String(v)); }
+  bool concat(float v) { return concat(String(v)); }
+  bool concat(double v) { return concat(String(v)); }
+
+  template<typename T>
+  String& operator+=(const T& v) { concat(v); return *this; }
+
+  friend StringSumHelper operator+(const StringSumHelper& lhs, const String& rhs);
+  friend StringSumHelper operator+(const StringSumHelper& lhs, const char* rhs);
+  friend StringSumHelper operator+(const StringSumHelper& lhs, const __FlashStringHelper* rhs);
+  friend StringSumHelper operator+(const StringSumHelper& lhs, char rhs);
+  friend StringSumHelper operator+(const StringSumHelper& lhs, int rhs);
+  friend StringSumHelper operator+(const StringSumHelper& lhs, unsigned int rhs);
+  friend StringSumHelper operator+(const StringSumHelper& lhs, long rhs);
+  friend StringSumHelper operator+(const StringSumHelper& lhs, unsigned long rhs);
+  friend StringSumHelper operator+(const StringSumHelper& lhs, float rhs);
+  friend StringSumHelper operator+(const StringSumHelper& lhs, double rhs);
+
+  int compareTo(const String& s) const { return _s.compare(s._s); }
+  bool equals(const String& s) const { return _s == s._s; }
+  bool equals(const char* s) const { return _s == (s ? s : ""); }
+  bool equalsIgnoreCase(const String& s) const { return strcasecmp(_s.c_str(), s.c_str()) == 0; }
+  bool operator==(const String& s) const { return equals(s); }
+  bool operator==(const char* s) const { return equals(s); }
+  bool operator!=(const String& s) const { return !equals(s); }
+  bool operator!=(const char* s) const { return !equals(s); }
+  bool operator<(const String& s) const { return compareTo(s) < 0; }
+  bool startsWith(const String& s) const { return _s.compare(0, s._s.size(), s._s) == 0; }
+  bool endsWith(const String& s) const {
+    return _s.size() >= s._s.size() && _s.compare(_s.size() - s._s.size(), s._s.size(), s._s) == 0;
+  }
+
+  char charAt(unsigned int i) const { return i < _s.size() ? _s[i] : 0; }
+  void setCharAt(unsigned int i, char c) { if (i < _s.size()) _s[i] = c; }
+  char operator[](unsigned int i) const { return charAt(i); }
+  char& operator[](unsigned int i) { return _s[i]; }
+  void getBytes(unsigned char* buf, unsigned int size, unsigned int index = 0) const {
+    toCharArray(reinterpret_cast<char*>(buf), size, index);
+  }
+  void toCharArray(char* buf, unsigned int size, unsigned int index = 0) const {
+    if (!size || !buf) return;
+    if (index >= _s.size()) { buf[0] = 0; return; }
+    size_t n = std::min<size_t>(size - 1, _s.size() - index);
+    memcpy(buf, _s.data() + index, n);
+    buf[n] = 0;
+  }
+
+  int indexOf(char c, unsigned int from = 0) const { return pos(_s.find(c, from)); }
+  int indexOf(const String& s, unsigned int from = 0) const { return pos(_s.find(s._s, from)); }
+  int indexOf(const char* s, unsigned int from = 0) const { return pos(_s.find(s, from)); }
+  int lastIndexOf(char c) const { return pos(_s.rfind(c)); }
+  int lastIndexOf(const String& s) const { return pos(_s.rfind(s._s)); }
+  int lastIndexOf(const char* s) const { return pos(_s.rfind(s)); }
+  String substring(unsigned int from) const { return from >= _s.size() ? String() : String(_s.substr(from).c_str()); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= _s.size()) return String();
+    return String(_s.substr(from, to - from).c_str());
+  }
+
+  void replace(const String& find, const String& repl) {
+    if (find._s.empty()) return;
+    size_t p = 0;
+    while ((p = _s.find(find._s, p)) != std::string::npos) {
+      _s.replace(p, find._s.size(), repl._s);
+      p += repl._s.size();
+    }
+  }
+  void remove(unsigned int index) { if (index < _s.size()) _s.erase(index); }
+  void remove(unsigned int index, unsigned int count) { if (index < _s.size()) _s.erase(index, count); }
+  void toLowerCase() { for (auto& c : _s) c = (char)tolower((unsigned char)c); }
+  void toUpperCase() { for (auto& c : _s) c = (char)toupper((unsigned char)c); }
+  void trim() {
+    size_t b = _s.find_first_not_of(" \t\r\n");
+    size_t e = _s.find_last_not_of(" \t\r\n");
+    _s = (b == std::string::npos) ? std::string() : _s.substr(b, e - b + 1);
+  }
+
+  long toInt() const { return atol(_s.c_str()); }
+  float toFloat() const { return (float)atof(_s.c_str()); }
+  double toDouble() const { return atof(_s.c_str()); }
+
+private:
+  static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+  void fromSigned(long long v, unsigned char base) {
+    if (base == 10) { char b[24]; snprintf(b, sizeof(b), "%lld", v); _s = b; }
+    else if (v < 0) { fromUnsigned((unsigned long long)-v, base); _s.insert(_s.begin(), '-'); }
+    else fromUnsigned((unsigned long long)v, base);
+  }
+  void fromUnsigned(unsigned long long v, unsigned char base) {
+    if (base < 2 || base > 36) base = 10;
+    char b[72]; int i = sizeof(b) - 1; b[i] = 0;
+    do { int d = (int)(v % base); b[--i] = (char)(d < 10 ? '0' + d : 'a' + d - 10); v /= base; } while (v);
+    _s = &b[i];
+  }
+  void fromDouble(double v, unsigned char decimals) {
+    char b[48]; snprintf(b, sizeof(b), "%.*f", (int)decimals, v); _s = b;
+  }
+
+  std::string _s;
+};
+
+class StringSumHelper : public String {
+public:
+  StringSumHelper(const String& s) : String(s) {}
+  StringSumHelper(const char* s) : String(s) {}
+  StringSumHelper(char c) : String(c) {}
+  StringSumHelper(int v) : String(v) {}
+  StringSumHelper(unsigned int v) : String(v) {}
+  StringSumHelper(long v) : String(v) {}
+  StringSumHelper(unsigned long v) : String(v) {}
+  StringSumHelper(float v) : String(v) {}
+  StringSumHelper(double v) : String(v) {}
+};
+
+#define KLIMERKO_HOST_STRING_SUM(T) \
+  inline StringSumHelper operator+(const StringSumHelper& lhs, T rhs) { \
+    StringSumHelper& a = const_cast<StringSumHelper&>(lhs); a.concat(rhs); return a; }
+KLIMERKO_HOST_STRING_SUM(const String&)
+KLIMERKO_HOST_STRING_SUM(const char*)
+KLIMERKO_HOST_STRING_SUM(const __FlashStringHelper*)
+KLIMERKO_HOST_STRING_SUM(char)
+KLIMERKO_HOST_STRING_SUM(int)
+KLIMERKO_HOST_STRING_SUM(unsigned int)
+KLIMERKO_HOST_STRING_SUM(long)
+KLIMERKO_HOST_STRING_SUM(unsigned long)
+KLIMERKO_HOST_STRING_SUM(float)
+KLIMERKO_HOST_STRING_SUM(double)
+#undef KLIMERKO_HOST_STRING_SUM
+
+inline bool operator==(const char* lhs, const String& rhs) { return rhs == lhs; }
+inline bool operator!=(const char* lhs, const String& rhs) { return rhs != lhs; }
+
+#endif // KLIMERKO_HOST_WSTRING_H
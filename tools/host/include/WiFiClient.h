@@ -0,0 +1,59 @@
+/**
+ * @file WiFiClient.h
+ * @brief Host shim - TCP client over POSIX sockets
+ *
+ * Copies share one socket (reference counted), like the ESP8266 core.
+ */
+
+#ifndef KLIMERKO_HOST_WIFICLIENT_H
+#define KLIMERKO_HOST_WIFICLIENT_H
+
+#include <memory>
+#include "Client.h"
+
+struct HostSocket;
+
+class WiFiClient : public Client {
+public:
+  WiFiClient() {}
+  explicit WiFiClient(int fd);
+  ~WiFiClient() override {}
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(const char* host, uint16_t port) override;
+  int connect(const String& host, uint16_t port) { return connect(host.c_str(), port); }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t size) override;
+  using Print::write;
+  size_t write_P(const char* buf, size_t size) { return write(reinterpret_cast<const uint8_t*>(buf), size); }
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t size) override;
+  int read(char* buf, size_t size) { return read(reinterpret_cast<uint8_t*>(buf), size); }
+  int peek() override;
+  void flush() override {}
+  bool flush(unsigned int /*maxWaitMs*/) { return true; }
+  void stop() override;
+  bool stop(unsigned int /*maxWaitMs*/) { stop(); return true; }
+  uint8_t connected() override;
+  uint8_t status() { return connected() ? 4 : 0; }
+  operator bool() override { return connected(); }
+  bool operator==(const WiFiClient& o) const { return _sock == o._sock; }
+
+  IPAddress remoteIP();
+  uint16_t remotePort();
+  IPAddress localIP();
+  void setNoDelay(bool) {}
+  bool getNoDelay() const { return true; }
+  void setSync(bool) {}
+  void keepAlive(uint16_t = 7200, uint16_t = 75, uint8_t = 9) {}
+  void disableKeepAlive() {}
+  int availableForWrite() override { return 1460; }
+
+  static void setDefaultNoDelay(bool) {}
+
+protected:
+  std::shared_ptr<HostSocket> _sock;
+};
+
+#endif // KLIMERKO_HOST_WIFICLIENT_H
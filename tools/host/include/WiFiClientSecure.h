@@ -0,0 +1,77 @@
+/**
+ * @file WiFiClientSecure.h
+ * @brief Host shim - BearSSL client surface; the transport stays plain TCP
+ *
+ * Only the configuration API exists so TLS code paths compile and their
+ * bookkeeping can run; there is no TLS on the host wire.
+ */
+
+#ifndef KLIMERKO_HOST_WIFICLIENTSECURE_H
+#define KLIMERKO_HOST_WIFICLIENTSECURE_H
+
+#include <ctime>
+#include <cstring>
+#include "WiFiClient.h"
+
+namespace BearSSL {
+
+class X509List {
+public:
+  X509List() {}
+  explicit X509List(const char* /*pem*/) {}
+  X509List(const uint8_t* /*der*/, size_t /*len*/) {}
+  bool append(const char* /*pem*/) { return true; }
+  size_t getCount() const { return 1; }
+};
+
+class Session {
+  friend class WiFiClientSecure;
+public:
+  Session() { memset(_params, 0, sizeof(_params)); }
+private:
+  uint8_t _params[80];   // Stand-in for br_ssl_session_parameters
+};
+
+class WiFiClientSecure : public WiFiClient {
+public:
+  void setInsecure() { _insecure = true; }
+  bool setFingerprint(const uint8_t fingerprint[20]) { (void)fingerprint; return true; }
+  bool setFingerprint(const char* fpStr) { return fpStr != nullptr; }
+  void setTrustAnchors(const X509List* ta) { (void)ta; }
+  void setSession(Session* session) { _session = session; }
+  void setBufferSizes(int recv, int xmit) { _recv = recv; _xmit = xmit; }
+  static bool probeMaxFragmentLength(const char*, uint16_t, uint16_t len) { return len >= 512; }
+  static bool probeMaxFragmentLength(IPAddress, uint16_t, uint16_t len) { return len >= 512; }
+  void setX509Time(time_t) {}
+  int getLastSSLError(char* dest = nullptr, size_t len = 0) {
+    if (dest && len) dest[0] = '\0';
+    return 0;
+  }
+  void setTimeout(unsigned long ms) { Stream::setTimeout(ms); }
+
+  int connect(IPAddress ip, uint16_t port) override { return handshake(WiFiClient::connect(ip, port)); }
+  int connect(const char* host, uint16_t port) override { return handshake(WiFiClient::connect(host, port)); }
+
+private:
+  // Fake session parameters: kept when offered (resumed), new otherwise
+  int handshake(int connected) {
+    if (!connected || !_session) return connected;
+    bool empty = true;
+    for (uint8_t b : _session->_params) empty &= b == 0;
+    if (empty) {
+      for (uint8_t& b : _session->_params) b = (uint8_t)(::random(255) + 1);
+    }
+    return connected;
+  }
+
+  bool _insecure = false;
+  Session* _session = nullptr;
+  int _recv = 16384;
+  int _xmit = 512;
+};
+
+}  // namespace BearSSL
+
+using BearSSL::WiFiClientSecure;
+
+#endif // KLIMERKO_HOST_WIFICLIENTSECURE_H
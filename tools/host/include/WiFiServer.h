@@ -0,0 +1,37 @@
+/**
+ * @file WiFiServer.h
+ * @brief Host shim - TCP listener on localhost
+ *
+ * Privileged ports are moved up by 8000 (the dashboard's port 80 listens
+ * on 8080). With KLIMERKO_EPHEMERAL_PORTS set in the environment the
+ * kernel picks a free port instead, so tests can run in parallel; ask
+ * hostPort() where it ended up.
+ */
+
+#ifndef KLIMERKO_HOST_WIFISERVER_H
+#define KLIMERKO_HOST_WIFISERVER_H
+
+#include "WiFiClient.h"
+
+class WiFiServer {
+public:
+  explicit WiFiServer(uint16_t port) : _port(port) {}
+  ~WiFiServer() { close(); }
+  void begin();
+  void begin(uint16_t port) { _port = port; begin(); }
+  WiFiClient accept();
+  WiFiClient available() { return accept(); }
+  bool hasClient();
+  void close();
+  void stop() { close(); }
+  uint16_t port() const { return _port; }
+  uint16_t hostPort() const { return _hostPort; }
+  void setNoDelay(bool) {}
+
+private:
+  uint16_t _port;
+  uint16_t _hostPort = 0;
+  int _fd = -1;
+};
+
+#endif // KLIMERKO_HOST_WIFISERVER_H
@@ -0,0 +1,28 @@
+/**
+ * @file WiFiUdp.h
+ * @brief Host shim - UDP socket that sends nowhere and receives nothing
+ */
+
+#ifndef KLIMERKO_HOST_WIFIUDP_H
+#define KLIMERKO_HOST_WIFIUDP_H
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+class WiFiUDP : public Stream {
+public:
+  uint8_t begin(uint16_t) { return 1; }
+  void stop() {}
+  int beginPacket(IPAddress, uint16_t) { return 1; }
+  int beginPacket(const char*, uint16_t) { return 1; }
+  int endPacket() { return 1; }
+  int parsePacket() { return 0; }
+  size_t write(uint8_t) override { return 1; }
+  size_t write(const uint8_t*, size_t size) override { return size; }
+  using Print::write;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+};
+
+#endif // KLIMERKO_HOST_WIFIUDP_H
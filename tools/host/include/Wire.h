@@ -0,0 +1,52 @@
+/**
+ * @file Wire.h
+ * @brief Host shim - I2C bus with register-level device emulation
+ */
+
+#ifndef KLIMERKO_HOST_WIRE_H
+#define KLIMERKO_HOST_WIRE_H
+
+#include <map>
+#include <vector>
+#include "Arduino.h"
+
+/**
+ * @brief Emulated I2C slave with an auto-incrementing register pointer
+ */
+class HostI2CDevice {
+public:
+  virtual ~HostI2CDevice() {}
+  virtual uint8_t readRegister(uint8_t reg) = 0;
+  virtual void writeRegister(uint8_t reg, uint8_t value) = 0;
+};
+
+class TwoWire : public Stream {
+public:
+  void begin() {}
+  void begin(int /*sda*/, int /*scl*/) {}
+  void setClock(uint32_t) {}
+  void beginTransmission(uint8_t address);
+  uint8_t endTransmission(bool sendStop = true);
+  uint8_t requestFrom(uint8_t address, size_t quantity, bool sendStop = true);
+  size_t write(uint8_t data) override;
+  size_t write(const uint8_t* data, size_t quantity) override;
+  using Print::write;
+  int available() override { return (int)(_rx.size() - _rxIndex); }
+  int read() override { return _rxIndex < _rx.size() ? _rx[_rxIndex++] : -1; }
+  int peek() override { return _rxIndex < _rx.size() ? _rx[_rxIndex] : -1; }
+
+  void hostAttach(uint8_t address, HostI2CDevice* device) { _devices[address] = device; }
+  void hostDetach(uint8_t address) { _devices.erase(address); }
+
+private:
+  std::map<uint8_t, HostI2CDevice*> _devices;
+  std::map<uint8_t, uint8_t> _pointer;
+  uint8_t _txAddress = 0;
+  std::vector<uint8_t> _tx;
+  std::vector<uint8_t> _rx;
+  size_t _rxIndex = 0;
+};
+
+extern TwoWire Wire;
+
+#endif // KLIMERKO_HOST_WIRE_H
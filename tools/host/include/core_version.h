@@ -0,0 +1,12 @@
+/**
+ * @file core_version.h
+ * @brief Host shim - ESP8266 core version macros
+ */
+
+#ifndef KLIMERKO_HOST_CORE_VERSION_H
+#define KLIMERKO_HOST_CORE_VERSION_H
+#define ARDUINO_ESP8266_GIT_VER 0x00000000
+#define ARDUINO_ESP8266_GIT_DESC host
+#define ARDUINO_ESP8266_RELEASE_3_1_2
+#define ARDUINO_ESP8266_RELEASE "3_1_2"
+#endif
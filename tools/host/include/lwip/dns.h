@@ -0,0 +1,23 @@
+/**
+ * @file dns.h
+ * @brief Host shim - lwIP DNS client API (resolves synchronously)
+ */
+
+#ifndef KLIMERKO_HOST_LWIP_DNS_H
+#define KLIMERKO_HOST_LWIP_DNS_H
+
+#include <stdint.h>
+
+typedef int8_t err_t;
+#define ERR_OK          0
+#define ERR_INPROGRESS  -5
+#define ERR_ARG         -16
+
+typedef struct { uint32_t addr; } ip_addr_t;
+#define ip_addr_get_ip4_u32(ipaddr) ((ipaddr)->addr)
+
+typedef void (*dns_found_callback)(const char* name, const ip_addr_t* ipaddr, void* callback_arg);
+
+err_t dns_gethostbyname(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg);
+
+#endif // KLIMERKO_HOST_LWIP_DNS_H
@@ -0,0 +1,34 @@
+/**
+ * @file pgmspace.h
+ * @brief Host shim - PROGMEM accessors map to plain memory
+ */
+
+#ifndef KLIMERKO_HOST_PGMSPACE_H
+#define KLIMERKO_HOST_PGMSPACE_H
+
+#include <cstdint>
+#include <cstring>
+
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+#define pgm_read_byte(addr)  (*reinterpret_cast<const uint8_t*>(addr))
+#define pgm_read_byte_near(addr) pgm_read_byte(addr)
+#define pgm_read_word(addr)  (*reinterpret_cast<const uint16_t*>(addr))
+#define pgm_read_dword(addr) (*reinterpret_cast<const uint32_t*>(addr))
+#define pgm_read_float(addr) (*reinterpret_cast<const float*>(addr))
+#define pgm_read_ptr(addr)   (*reinterpret_cast<const void* const*>(addr))
+
+#define memcpy_P  memcpy
+#define memcmp_P  memcmp
+#define strlen_P  strlen
+#define strcpy_P  strcpy
+#define strncpy_P strncpy
+#define strcmp_P  strcmp
+#define strncmp_P strncmp
+#define strcasecmp_P strcasecmp
+#define strstr_P  strstr
+#define sprintf_P  sprintf
+#define snprintf_P snprintf
+
+#endif // KLIMERKO_HOST_PGMSPACE_H
@@ -0,0 +1,36 @@
+/**
+ * @file user_interface.h
+ * @brief Host shim - ESP8266 SDK calls the firmware and WiFiManager use
+ */
+
+#ifndef KLIMERKO_HOST_USER_INTERFACE_H
+#define KLIMERKO_HOST_USER_INTERFACE_H
+
+// WiFiManager includes this inside extern "C"; the shim itself is C++
+extern "C++" {
+
+#include <cstring>
+#include "Esp.h"
+
+typedef enum { WIFI_COUNTRY_POLICY_AUTO, WIFI_COUNTRY_POLICY_MANUAL } WIFI_COUNTRY_POLICY;
+
+typedef struct {
+  char cc[3];
+  uint8_t schan;
+  uint8_t nchan;
+  WIFI_COUNTRY_POLICY policy;
+} wifi_country_t;
+
+inline rst_info* system_get_rst_info() { return ESP.getResetInfoPtr(); }
+inline bool wifi_set_country(wifi_country_t*) { return true; }
+inline bool wifi_get_country(wifi_country_t* c) {
+  strcpy(c->cc, "RS");
+  c->schan = 1;
+  c->nchan = 13;
+  c->policy = WIFI_COUNTRY_POLICY_AUTO;
+  return true;
+}
+
+}  // extern "C++"
+
+#endif // KLIMERKO_HOST_USER_INTERFACE_H
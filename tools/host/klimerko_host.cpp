@@ -0,0 +1,72 @@
+/**
+ * @file klimerko_host.cpp
+ * @brief Host build - run the firmware on Linux with emulated sensors
+ *
+ * Boots the sketch with a PMS7003 and a BME280 emulated behind the host
+ * serial and I2C shims, then calls loop() forever (or for --minutes). By
+ * default the virtual clock follows the wall clock so the dashboard at
+ * http://localhost:8080/ behaves like the device; --fast runs loop() back
+ * to back, advancing the clock LOOP_STEP_MS per iteration.
+ *
+ * State lives in the working directory: klimerko_eeprom.bin (EEPROM) and
+ * klimerko_fs/ (LittleFS).
+ *
+ *   klimerko_host [--minutes N] [--fast] [--quiet]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include <Arduino.h>
+#include <SoftwareSerial.h>
+#include <Wire.h>
+#include "HostBME280.h"
+#include "HostPMS7003.h"
+
+void setup();
+void loop();
+extern SoftwareSerial pmsSerial;
+
+static const unsigned long LOOP_STEP_MS = 10;
+
+int main(int argc, char** argv) {
+  unsigned long minutes = 0;
+  bool fast = false;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--minutes") && i + 1 < argc) minutes = strtoul(argv[++i], nullptr, 10);
+    else if (!strcmp(argv[i], "--fast")) fast = true;
+    else if (!strcmp(argv[i], "--quiet")) Serial.setQuiet(true);
+    else {
+      fprintf(stderr, "usage: %s [--minutes N] [--fast] [--quiet]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  HostBME280 bme;
+  bme.setConditions(21.5f, 1013.0f, 45.0f);
+  Wire.hostAttach(0x76, &bme);  // BME280_ADDR_PRIMARY
+  HostPMS7003 pms(pmsSerial);
+  pms.setConcentrations(6, 11, 14);
+
+  try {
+    setup();
+    auto start = std::chrono::steady_clock::now();
+    unsigned long startMs = millis();
+    while (!minutes || millis() - startMs < minutes * 60000UL) {
+      loop();
+      if (fast) {
+        hostAdvanceMillis(LOOP_STEP_MS);
+      } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(LOOP_STEP_MS));
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        unsigned long target = startMs + (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+        if ((long)(target - millis()) > 0) hostSetMillis(target);
+      }
+    }
+  } catch (const HostRestart& restart) {
+    printf("\n[HOST] %s requested\n", restart.deepSleep ? "Deep sleep" : "Restart");
+  }
+  return 0;
+}
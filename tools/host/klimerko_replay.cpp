@@ -0,0 +1,429 @@
+/**
+ * @file klimerko_replay.cpp
+ * @brief Host build - deterministic sensor trace replay on the virtual clock
+ *
+ * Replays a scenario (a .scn file in tools/host/scenarios) through the
+ * firmware's own sensorLoop(), readPMSSensor(), readBMESensor(),
+ * checkFanStatus() and checkAlarms(). The emulated PMS7003 answers each read request with a
+ * frame built from the scenario (or a recorded reply), and the emulated
+ * BME280 serves the raw register words for the scenario's conditions. The
+ * virtual clock moves STEP_MS per iteration plus whatever the firmware
+ * spends in delay() and serial timeouts, so weeks replay in seconds and
+ * every run is bit-for-bit the same.
+ *
+ * The run is summarized as key/value lines (filter error against the
+ * scenario truth, offline and fan-stuck detections, alarms) and compared
+ * with the scenario's .baseline file next to it; --update rewrites it.
+ *
+ *   klimerko_replay [--update] [--trace FILE.csv] [--verbose] SCENARIO.scn
+ *
+ * Scenario format, one directive or keyframe per line, '#' comments:
+ *
+ *   duration 14d          simulated time (s, m, h or d suffix)
+ *   period 1d             optional: keyframe times repeat with this period
+ *   interval 5            publish interval in minutes (reads every interval/10)
+ *   noise 8               optional: +-8% deterministic noise on PM values
+ *   seed 1                optional: noise generator seed
+ *   # time  pm1 pm25 pm10  temp  pressure humidity  [flags]
+ *   0h      5   9    12    21.0  1013.0   45
+ *   6h      30  60   80    18.5  1015.0   70        silent
+ *
+ * Values are interpolated linearly between keyframes; flags hold from their
+ * keyframe to the next one: silent (PMS7003 does not answer), corrupt (bad
+ * checksum), stuck (fan stuck: frames keep coming with frozen counts),
+ * bme_fail (BME280 reads 0xFF) and frame=HEX (answer the first read request
+ * after the keyframe with these bytes, e.g. a captured truncated frame).
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Arduino.h>
+#include <SoftwareSerial.h>
+#include <Wire.h>
+#include "HostBME280.h"
+#include "HostPMS7003.h"
+#include "../../src/klimerko/sensors.h"
+#include "../../src/klimerko/alarms.h"
+
+extern unsigned long sensorReadTime;
+extern uint8_t dataPublishInterval;
+
+static const unsigned long STEP_MS = 1000;
+
+// ============================================================================
+// SCENARIO
+// ============================================================================
+
+struct Keyframe {
+  unsigned long second;
+  float pm1, pm25, pm10;
+  float temperature, pressure, humidity;
+  bool silent, corrupt, stuck, bmeFail;
+  std::vector<uint8_t> rawReply;
+};
+
+struct Conditions {
+  float pm1, pm25, pm10;
+  float temperature, pressure, humidity;
+  const Keyframe* keyframe;
+};
+
+struct Scenario {
+  unsigned long durationSec = 0;
+  unsigned long periodSec = 0;
+  uint8_t interval = 5;
+  float noisePercent = 0;
+  uint32_t seed = 1;
+  std::vector<Keyframe> keyframes;
+
+  /**
+   * @brief Scenario truth at a point in simulated time
+   */
+  Conditions at(unsigned long second) const {
+    if (periodSec) second %= periodSec;
+    size_t i = 0;
+    while (i + 1 < keyframes.size() && keyframes[i + 1].second <= second) i++;
+    const Keyframe& a = keyframes[i];
+    const Keyframe& b = i + 1 < keyframes.size() ? keyframes[i + 1] : a;
+    float f = b.second > a.second ? (float)(second - a.second) / (float)(b.second - a.second) : 0.0f;
+    if (f > 1.0f) f = 1.0f;
+    auto lerp = [f](float x, float y) { return x + (y - x) * f; };
+    return {lerp(a.pm1, b.pm1), lerp(a.pm25, b.pm25), lerp(a.pm10, b.pm10),
+            lerp(a.temperature, b.temperature), lerp(a.pressure, b.pressure), lerp(a.humidity, b.humidity), &a};
+  }
+};
+
+static bool parseDuration(const std::string& token, unsigned long* seconds) {
+  char* end;
+  double value = strtod(token.c_str(), &end);
+  if (end == token.c_str() || value < 0) return false;
+  double unit = 1;
+  if (!strcmp(end, "m")) unit = 60;
+  else if (!strcmp(end, "h")) unit = 3600;
+  else if (!strcmp(end, "d")) unit = 86400;
+  else if (strcmp(end, "s") && *end) return false;
+  *seconds = (unsigned long)llround(value * unit);
+  return true;
+}
+
+static bool parseHex(const std::string& hex, std::vector<uint8_t>* bytes) {
+  if (hex.size() % 2) return false;
+  for (size_t i = 0; i < hex.size(); i += 2) {
+    char* end;
+    std::string pair = hex.substr(i, 2);
+    long b = strtol(pair.c_str(), &end, 16);
+    if (*end) return false;
+    bytes->push_back((uint8_t)b);
+  }
+  return true;
+}
+
+static bool loadScenario(const char* path, Scenario* scenario) {
+  std::ifstream in(path);
+  if (!in) {
+    fprintf(stderr, "%s: cannot open\n", path);
+    return false;
+  }
+  std::string line;
+  for (int lineNo = 1; std::getline(in, line); lineNo++) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream words(line);
+    std::string first;
+    if (!(words >> first)) continue;
+
+    bool ok = true;
+    std::string value;
+    if (first == "duration") {
+      ok = (words >> value) && parseDuration(value, &scenario->durationSec);
+    } else if (first == "period") {
+      ok = (words >> value) && parseDuration(value, &scenario->periodSec);
+    } else if (first == "interval") {
+      int minutes = 0;
+      ok = (words >> minutes) && minutes >= 1 && minutes <= 60;
+      scenario->interval = (uint8_t)minutes;
+    } else if (first == "noise") {
+      ok = (bool)(words >> scenario->noisePercent);
+    } else if (first == "seed") {
+      ok = (words >> scenario->seed) && scenario->seed != 0;
+    } else {
+      Keyframe k = {};
+      ok = parseDuration(first, &k.second) &&
+           (bool)(words >> k.pm1 >> k.pm25 >> k.pm10 >> k.temperature >> k.pressure >> k.humidity);
+      std::string flag;
+      while (ok && words >> flag) {
+        if (flag == "silent") k.silent = true;
+        else if (flag == "corrupt") k.corrupt = true;
+        else if (flag == "stuck") k.stuck = true;
+        else if (flag == "bme_fail") k.bmeFail = true;
+        else if (flag.compare(0, 6, "frame=") == 0) ok = parseHex(flag.substr(6), &k.rawReply);
+        else ok = false;
+      }
+      if (ok && !scenario->keyframes.empty() && k.second < scenario->keyframes.back().second) ok = false;
+      if (ok) scenario->keyframes.push_back(k);
+    }
+    if (!ok) {
+      fprintf(stderr, "%s:%d: cannot parse '%s'\n", path, lineNo, line.c_str());
+      return false;
+    }
+  }
+  if (scenario->keyframes.empty() || !scenario->durationSec) {
+    fprintf(stderr, "%s: needs a duration and at least one keyframe\n", path);
+    return false;
+  }
+  return true;
+}
+
+// ============================================================================
+// SUMMARY
+// ============================================================================
+
+struct Summary {
+  unsigned long reads = 0;
+  unsigned long pmsFailedReads = 0, pmsOfflineEvents = 0;
+  unsigned long bmeFailedReads = 0, bmeOfflineEvents = 0;
+  unsigned long fanStuckReads = 0, zeroDataReads = 0;
+  long firstFanStuckMinute = -1;
+  unsigned long alarms = 0;
+  long firstAlarmMinute = -1;
+  // Filter output against the scenario truth at read time (valid reads only)
+  unsigned long pmSamples = 0, envSamples = 0;
+  double pm25AbsError = 0, pm25MaxError = 0, pm10AbsError = 0;
+  int pm25Peak = 0, pm10Peak = 0;
+  double temperatureAbsError = 0, humidityAbsError = 0;
+};
+
+typedef std::vector<std::pair<std::string, std::string>> Report;
+
+static void add(Report& report, const char* key, unsigned long value) {
+  report.emplace_back(key, std::to_string(value));
+}
+static void add(Report& report, const char* key, long value) {
+  report.emplace_back(key, std::to_string(value));
+}
+static void add(Report& report, const char* key, double value) {
+  char text[32];
+  snprintf(text, sizeof(text), "%.2f", value);
+  report.emplace_back(key, text);
+}
+
+static Report makeReport(const Scenario& scenario, const Summary& s, const HostPMS7003& pms) {
+  Report r;
+  add(r, "simulated_minutes", scenario.durationSec / 60);
+  add(r, "reads", s.reads);
+  add(r, "pms_frames", (unsigned long)pms.framesSent());
+  add(r, "pms_wakeups", (unsigned long)pms.wakeUps());
+  add(r, "pms_failed_reads", s.pmsFailedReads);
+  add(r, "pms_offline_events", s.pmsOfflineEvents);
+  add(r, "bme_failed_reads", s.bmeFailedReads);
+  add(r, "bme_offline_events", s.bmeOfflineEvents);
+  add(r, "fan_stuck_reads", s.fanStuckReads);
+  add(r, "first_fan_stuck_minute", s.firstFanStuckMinute);
+  add(r, "zero_data_reads", s.zeroDataReads);
+  add(r, "alarms", s.alarms);
+  add(r, "first_alarm_minute", s.firstAlarmMinute);
+  add(r, "pm25_mae", s.pmSamples ? s.pm25AbsError / s.pmSamples : 0.0);
+  add(r, "pm25_max_error", s.pm25MaxError);
+  add(r, "pm10_mae", s.pmSamples ? s.pm10AbsError / s.pmSamples : 0.0);
+  add(r, "pm25_peak", (long)s.pm25Peak);
+  add(r, "pm10_peak", (long)s.pm10Peak);
+  add(r, "temperature_mae", s.envSamples ? s.temperatureAbsError / s.envSamples : 0.0);
+  add(r, "humidity_mae", s.envSamples ? s.humidityAbsError / s.envSamples : 0.0);
+  return r;
+}
+
+static bool readBaseline(const std::string& path, Report* baseline) {
+  std::ifstream in(path);
+  if (!in) return false;
+  std::string key, value;
+  while (in >> key >> value) baseline->emplace_back(key, value);
+  return true;
+}
+
+/**
+ * @brief Compare with the baseline: integers exactly, decimals to 0.01
+ *
+ * The tolerance only absorbs libm rounding differences between hosts; any
+ * change in firmware behavior moves a count or a mean by more than that.
+ */
+static int compareReport(const Report& report, const Report& baseline) {
+  int differences = 0;
+  for (size_t i = 0; i < report.size() || i < baseline.size(); i++) {
+    const char* key = i < report.size() ? report[i].first.c_str() : baseline[i].first.c_str();
+    const char* got = i < report.size() ? report[i].second.c_str() : "(missing)";
+    const char* want = i < baseline.size() ? baseline[i].second.c_str() : "(missing)";
+    bool same = i < report.size() && i < baseline.size() && report[i].first == baseline[i].first;
+    if (same && strcmp(got, want)) {
+      same = strchr(want, '.') && fabs(atof(got) - atof(want)) <= 0.0101;
+    }
+    if (!same) {
+      printf("DIFF %-24s baseline %-10s now %s\n", key, want, got);
+      differences++;
+    }
+  }
+  return differences;
+}
+
+// ============================================================================
+// REPLAY
+// ============================================================================
+
+int main(int argc, char** argv) {
+  bool update = false;
+  const char* scenarioPath = nullptr;
+  const char* tracePath = nullptr;
+  Serial.setQuiet(true);
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--update")) update = true;
+    else if (!strcmp(argv[i], "--trace") && i + 1 < argc) tracePath = argv[++i];
+    else if (!strcmp(argv[i], "--verbose")) Serial.setQuiet(false);
+    else if (argv[i][0] != '-' && !scenarioPath) scenarioPath = argv[i];
+    else scenarioPath = nullptr, i = argc;
+  }
+  if (!scenarioPath) {
+    fprintf(stderr, "usage: %s [--update] [--trace FILE.csv] [--verbose] SCENARIO.scn\n", argv[0]);
+    return 2;
+  }
+
+  Scenario scenario;
+  if (!loadScenario(scenarioPath, &scenario)) return 2;
+  std::string baselinePath = scenarioPath;
+  baselinePath = baselinePath.substr(0, baselinePath.rfind('.')) + ".baseline";
+
+  FILE* trace = nullptr;
+  if (tracePath) {
+    trace = fopen(tracePath, "w");
+    if (!trace) {
+      perror(tracePath);
+      return 2;
+    }
+    fprintf(trace, "minute,true_pm25,true_pm10,true_temp,pm1,pm25,pm10,temp,hum,pres,"
+                   "pms_online,bme_online,pms_status,alarm\n");
+  }
+
+  HostBME280 bmeDevice;
+  Wire.hostAttach(BME_I2C_ADDR_PRIMARY, &bmeDevice);
+  HostPMS7003 pmsDevice(pmsSerial);
+
+  // The sensor half of the firmware: no network, storage or sinks
+  dataPublishInterval = scenario.interval;
+  initSensors();
+  initAlarms();
+
+  Summary s;
+  uint32_t noiseState = scenario.seed;
+  auto noise = [&]() {
+    noiseState ^= noiseState << 13;
+    noiseState ^= noiseState >> 17;
+    noiseState ^= noiseState << 5;
+    return ((float)(noiseState % 20001) / 10000.0f - 1.0f) * scenario.noisePercent / 100.0f;
+  };
+  const Keyframe* active = nullptr;
+  bool alarmFired = false;
+
+  auto wallStart = std::chrono::steady_clock::now();
+  unsigned long start = millis();
+  for (;;) {
+    unsigned long elapsedMs = millis() - start;
+    if (elapsedMs >= scenario.durationSec * 1000UL) break;
+    unsigned long minute = elapsedMs / 60000;
+
+    // Present the scenario to the emulated sensors
+    Conditions c = scenario.at(elapsedMs / 1000);
+    if (c.keyframe != active) {
+      active = c.keyframe;
+      if (!active->rawReply.empty()) pmsDevice.queueRawReply(active->rawReply.data(), active->rawReply.size());
+    }
+    float n = noise();
+    auto pm = [n](float value) { return (uint16_t)lroundf(fmaxf(0.0f, value * (1.0f + n))); };
+    pmsDevice.setSilent(active->silent);
+    pmsDevice.setCorrupt(active->corrupt);
+    pmsDevice.setStuck(active->stuck);
+    pmsDevice.setConcentrations(pm(c.pm1), pm(c.pm25), pm(c.pm10));
+    bmeDevice.setFailed(active->bmeFail);
+    bmeDevice.setConditions(c.temperature, c.pressure, c.humidity);
+
+    bool pmsWasOnline = pmsSensorOnline;
+    bool bmeWasOnline = bmeSensorOnline;
+    unsigned long readBefore = sensorReadTime;
+    sensorLoop(sensorReadTime, dataPublishInterval);
+
+    if (sensorReadTime != readBefore) {
+      s.reads++;
+      bool pmsValid = pmsSensorOnline && pmsSensorRetry == 0;
+      bool bmeValid = bmeSensorOnline && bmeSensorRetry == 0;
+      if (!pmsValid) s.pmsFailedReads++;
+      if (!bmeValid) s.bmeFailedReads++;
+      if (pmsWasOnline && !pmsSensorOnline) s.pmsOfflineEvents++;
+      if (bmeWasOnline && !bmeSensorOnline) s.bmeOfflineEvents++;
+      if (pmsStatus == SensorStatus::FAN_STUCK) {
+        if (s.firstFanStuckMinute < 0) s.firstFanStuckMinute = (long)minute;
+        s.fanStuckReads++;
+      }
+      if (pmsStatus == SensorStatus::ZERO_DATA) s.zeroDataReads++;
+      if (pmsValid) {
+        double error = fabs(sensorData.pm25 - c.pm25);
+        s.pmSamples++;
+        s.pm25AbsError += error;
+        if (error > s.pm25MaxError) s.pm25MaxError = error;
+        s.pm10AbsError += fabs(sensorData.pm10 - c.pm10);
+        if (sensorData.pm25 > s.pm25Peak) s.pm25Peak = sensorData.pm25;
+        if (sensorData.pm10 > s.pm10Peak) s.pm10Peak = sensorData.pm10;
+      }
+      if (bmeValid) {
+        s.envSamples++;
+        s.temperatureAbsError += fabs(sensorData.temperature - c.temperature);
+        s.humidityAbsError += fabs(sensorData.humidity - c.humidity);
+      }
+      if (trace) {
+        fprintf(trace, "%lu,%.1f,%.1f,%.2f,%d,%d,%d,%.2f,%.2f,%.2f,%d,%d,%d,%d\n", minute, c.pm25, c.pm10,
+                c.temperature, sensorData.pm1, sensorData.pm25, sensorData.pm10, sensorData.temperature,
+                sensorData.humidity, sensorData.pressure, pmsSensorOnline, bmeSensorOnline, (int)pmsStatus,
+                alarmTriggered);
+      }
+    }
+
+    alarmFired = false;
+    checkAlarms([&](const char*) { alarmFired = true; });
+    if (alarmFired) {
+      if (s.firstAlarmMinute < 0) s.firstAlarmMinute = (long)minute;
+      s.alarms++;
+    }
+
+    hostAdvanceMillis(STEP_MS);
+  }
+  double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  if (trace) fclose(trace);
+
+  Report report = makeReport(scenario, s, pmsDevice);
+  printf("%s: %.1f simulated days in %.2f s (%.0fx real time)\n", scenarioPath,
+         scenario.durationSec / 86400.0, wallSec, scenario.durationSec / (wallSec > 0 ? wallSec : 1e-9));
+  for (const auto& line : report) printf("  %-24s %s\n", line.first.c_str(), line.second.c_str());
+
+  if (update) {
+    FILE* out = fopen(baselinePath.c_str(), "w");
+    if (!out) {
+      perror(baselinePath.c_str());
+      return 2;
+    }
+    for (const auto& line : report) fprintf(out, "%s %s\n", line.first.c_str(), line.second.c_str());
+    fclose(out);
+    printf("Baseline written to %s\n", baselinePath.c_str());
+    return 0;
+  }
+
+  Report baseline;
+  if (!readBaseline(baselinePath, &baseline)) {
+    printf("FAIL no baseline %s (run with --update)\n", baselinePath.c_str());
+    return 1;
+  }
+  int differences = compareReport(report, baseline);
+  printf(differences ? "FAILED\n" : "OK\n");
+  return differences ? 1 : 0;
+}
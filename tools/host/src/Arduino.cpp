@@ -0,0 +1,51 @@
+/**
+ * @file Arduino.cpp
+ * @brief Host shim - virtual clock, GPIO recording and Serial
+ */
+
+#include "Arduino.h"
+#include <unistd.h>
+#include <map>
+#include <random>
+
+HardwareSerial Serial;
+
+static uint64_t hostClockUs = 0;
+static unsigned long hostDelayYieldUs = 0;
+static std::map<uint8_t, int> hostPins;
+static std::mt19937 hostRng(1);
+
+unsigned long millis() { return (unsigned long)(hostClockUs / 1000); }
+unsigned long micros() { return (unsigned long)hostClockUs; }
+uint64_t hostMicros64() { return hostClockUs; }
+void delay(unsigned long ms) {
+  hostClockUs += (uint64_t)ms * 1000;
+  if (hostDelayYieldUs) usleep(hostDelayYieldUs);
+}
+void delayMicroseconds(unsigned int us) { hostClockUs += us; }
+void yield() {}
+void hostAdvanceMillis(unsigned long ms) { hostClockUs += (uint64_t)ms * 1000; }
+void hostAdvanceMicros(uint64_t us) { hostClockUs += us; }
+void hostSetMillis(unsigned long ms) { hostClockUs = (uint64_t)ms * 1000; }
+void hostSetDelayYield(unsigned long realUs) { hostDelayYieldUs = realUs; }
+
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t pin, uint8_t val) { hostPins[pin] = val; }
+int digitalRead(uint8_t pin) {
+  auto it = hostPins.find(pin);
+  return it == hostPins.end() ? HIGH : it->second;
+}
+void hostSetDigitalInput(uint8_t pin, int value) { hostPins[pin] = value; }
+int analogRead(uint8_t) { return 0; }
+
+long random(long howbig) {
+  if (howbig <= 0) return 0;
+  return (long)(hostRng() % (unsigned long)howbig);
+}
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) return howsmall;
+  return howsmall + random(howbig - howsmall);
+}
+void randomSeed(unsigned long seed) { hostRng.seed(seed); }
+
+void configTime(long, int, const char*, const char*, const char*) {}
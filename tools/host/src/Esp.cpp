@@ -0,0 +1,108 @@
+/**
+ * @file Esp.cpp
+ * @brief Host shim - EspClass (heap figures, restart, RTC user memory)
+ */
+
+#include <cstring>
+#include "Arduino.h"
+#include "Esp.h"
+
+EspClass ESP;
+
+static uint32_t hostRtcMemory[128];   // 512 bytes of RTC user memory
+static rst_info hostResetInfo = {REASON_DEFAULT_RST, 0, 0, 0, 0, 0, 0};
+static uint32_t hostFreeHeap = 40000;
+
+void hostSetFreeHeap(uint32_t bytes) { hostFreeHeap = bytes; }
+void hostSetResetReason(uint32_t reason) { hostResetInfo.reason = reason; }
+
+uint32_t EspClass::getFreeHeap() { return hostFreeHeap; }
+uint32_t EspClass::getMaxFreeBlockSize() { return hostFreeHeap * 3 / 4; }
+uint8_t EspClass::getHeapFragmentation() { return 25; }
+void EspClass::getHeapStats(uint32_t* hfree, uint32_t* hmax, uint8_t* hfrag) {
+  if (hfree) *hfree = getFreeHeap();
+  if (hmax) *hmax = getMaxFreeBlockSize();
+  if (hfrag) *hfrag = getHeapFragmentation();
+}
+uint32_t EspClass::getFreeContStack() { return 2048; }
+uint32_t EspClass::getCycleCount() { return (uint32_t)(micros() * 80UL); }
+
+void EspClass::restart() { throw HostRestart{false, 0}; }
+void EspClass::deepSleep(uint64_t timeUs, RFMode) { throw HostRestart{true, timeUs}; }
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size) {
+  if (offset >= 128 || offset * 4 + size > sizeof(hostRtcMemory)) return false;
+  memcpy(data, (uint8_t*)hostRtcMemory + offset * 4, size);
+  return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size) {
+  if (offset >= 128 || offset * 4 + size > sizeof(hostRtcMemory)) return false;
+  memcpy((uint8_t*)hostRtcMemory + offset * 4, data, size);
+  return true;
+}
+
+rst_info* EspClass::getResetInfoPtr() { return &hostResetInfo; }
+
+String EspClass::getResetReason() {
+  static const char* const names[] = {"Power On", "Hardware Watchdog", "Exception", "Software Watchdog",
+                                      "Software/System restart", "Deep-Sleep Wake", "External System"};
+  return String(hostResetInfo.reason < 7 ? names[hostResetInfo.reason] : "Unknown");
+}
+
+String EspClass::getResetInfo() { return String("Fatal exception:0"); }
+
+uint32_t EspClass::random() { return (uint32_t)::random(0x7FFFFFFF); }
+
+// ============================================================================
+// EEPROM (file backed, one file = one flash sector)
+// ============================================================================
+
+#include "EEPROM.h"
+#include <cstdio>
+#include <algorithm>
+
+EEPROMClass EEPROM;
+
+static const char* hostEepromPath() {
+  const char* p = getenv("KLIMERKO_EEPROM");
+  return p ? p : "klimerko_eeprom.bin";
+}
+
+void EEPROMClass::begin(size_t size) {
+  _data.assign(size, 0xFF);
+  _dirty = false;
+  FILE* f = fopen(hostEepromPath(), "rb");
+  if (f) {
+    size_t n = fread(_data.data(), 1, size, f);
+    (void)n;
+    fclose(f);
+  }
+}
+
+bool EEPROMClass::commit() {
+  if (!_dirty) return true;
+  std::vector<uint8_t> sector(4096, 0xFF);
+  FILE* f = fopen(hostEepromPath(), "rb");
+  if (f) {
+    size_t n = fread(sector.data(), 1, sector.size(), f);
+    (void)n;
+    fclose(f);
+  }
+  // Like the core: the sector is erased and only the begin() size written back
+  std::fill(sector.begin(), sector.end(), 0xFF);
+  memcpy(sector.data(), _data.data(), std::min(_data.size(), sector.size()));
+  f = fopen(hostEepromPath(), "wb");
+  if (!f) return false;
+  fwrite(sector.data(), 1, sector.size(), f);
+  fclose(f);
+  _dirty = false;
+  _eraseCount++;
+  return true;
+}
+
+bool EEPROMClass::end() {
+  bool ok = commit();
+  _data.clear();
+  return ok;
+}
@@ -0,0 +1,162 @@
+/**
+ * @file FS.cpp
+ * @brief Host shim - LittleFS backed by a host directory
+ */
+
+#include "FS.h"
+#include "LittleFS.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+
+fs::FS LittleFS;
+
+namespace fs {
+
+File::File(FILE* fp, const std::string& name, const std::string& hostPath, bool isDir)
+    : _name(name), _hostPath(hostPath), _isDir(isDir) {
+  if (fp) _fp = std::shared_ptr<FILE>(fp, fclose);
+}
+
+size_t File::write(uint8_t c) { return write(&c, 1); }
+size_t File::write(const uint8_t* buf, size_t size) {
+  return _fp ? fwrite(buf, 1, size, _fp.get()) : 0;
+}
+int File::available() {
+  if (!_fp) return 0;
+  return (int)(size() - position());
+}
+int File::read() {
+  if (!_fp) return -1;
+  int c = fgetc(_fp.get());
+  return c == EOF ? -1 : c;
+}
+int File::peek() {
+  if (!_fp) return -1;
+  int c = fgetc(_fp.get());
+  if (c != EOF) ungetc(c, _fp.get());
+  return c == EOF ? -1 : c;
+}
+int File::read(uint8_t* buf, size_t size) {
+  return _fp ? (int)fread(buf, 1, size, _fp.get()) : -1;
+}
+void File::flush() { if (_fp) fflush(_fp.get()); }
+bool File::seek(uint32_t pos, SeekMode mode) {
+  if (!_fp) return false;
+  int whence = mode == SeekSet ? SEEK_SET : mode == SeekCur ? SEEK_CUR : SEEK_END;
+  return fseek(_fp.get(), (long)pos, whence) == 0;
+}
+size_t File::position() const { return _fp ? (size_t)ftell(_fp.get()) : 0; }
+size_t File::size() const {
+  if (!_fp) return 0;
+  fflush(_fp.get());
+  struct stat st;
+  return fstat(fileno(_fp.get()), &st) == 0 ? (size_t)st.st_size : 0;
+}
+bool File::truncate(uint32_t size) {
+  return _fp && ftruncate(fileno(_fp.get()), size) == 0;
+}
+void File::close() { _fp.reset(); _isDir = false; }
+const char* File::name() const {
+  size_t slash = _name.rfind('/');
+  return slash == std::string::npos ? _name.c_str() : _name.c_str() + slash + 1;
+}
+time_t File::getLastWrite() {
+  struct stat st;
+  return stat(_hostPath.c_str(), &st) == 0 ? st.st_mtime : 0;
+}
+
+Dir::Dir(const std::string& hostPath, const std::string& fsPath)
+    : _hostPath(hostPath), _fsPath(fsPath) {
+  DIR* d = opendir(hostPath.c_str());
+  if (!d) return;
+  while (struct dirent* e = readdir(d)) {
+    std::string n = e->d_name;
+    if (n != "." && n != "..") _entries.push_back(n);
+  }
+  closedir(d);
+  std::sort(_entries.begin(), _entries.end());
+}
+bool Dir::next() { return ++_index < (int)_entries.size(); }
+String Dir::fileName() const { return String(_entries[_index].c_str()); }
+size_t Dir::fileSize() const {
+  struct stat st;
+  std::string p = _hostPath + "/" + _entries[_index];
+  return stat(p.c_str(), &st) == 0 ? (size_t)st.st_size : 0;
+}
+bool Dir::isFile() const {
+  struct stat st;
+  std::string p = _hostPath + "/" + _entries[_index];
+  return stat(p.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+bool Dir::isDirectory() const { return !isFile(); }
+File Dir::openFile(const char* mode) {
+  std::string p = _hostPath + "/" + _entries[_index];
+  std::string fsPath = _fsPath + (_fsPath.size() && _fsPath.back() == '/' ? "" : "/") + _entries[_index];
+  FILE* fp = fopen(p.c_str(), mode[0] == 'r' && mode[1] == '\0' ? "rb" : mode);
+  return File(fp, fsPath, p);
+}
+
+std::string FS::hostPath(const char* path) const {
+  std::string p = path ? path : "";
+  if (p.empty() || p[0] != '/') p = "/" + p;
+  return _root + p;
+}
+
+static bool mkdirs(const std::string& dir) {
+  size_t pos = 0;
+  while ((pos = dir.find('/', pos + 1)) != std::string::npos) {
+    ::mkdir(dir.substr(0, pos).c_str(), 0755);
+  }
+  return ::mkdir(dir.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool FS::begin() { return mkdirs(_root); }
+
+bool FS::format() {
+  std::string cmd = "rm -rf '" + _root + "'";
+  if (system(cmd.c_str()) != 0) return false;
+  return begin();
+}
+
+bool FS::info(FSInfo& info) {
+  info.totalBytes = 2 * 1024 * 1024;
+  info.usedBytes = 0;
+  info.blockSize = 8192;
+  info.pageSize = 256;
+  info.maxOpenFiles = 5;
+  info.maxPathLength = 32;
+  return true;
+}
+
+File FS::open(const char* path, const char* mode) {
+  _opens++;
+  std::string hp = hostPath(path);
+  struct stat st;
+  if (stat(hp.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+    return File(nullptr, path, hp, true);
+  }
+  std::string m = mode;
+  if (m != "r" && m != "r+") {
+    size_t slash = hp.rfind('/');
+    if (slash != std::string::npos) mkdirs(hp.substr(0, slash));
+  }
+  m += "b";
+  FILE* fp = fopen(hp.c_str(), m.c_str());
+  return fp ? File(fp, path, hp) : File();
+}
+
+bool FS::exists(const char* path) {
+  struct stat st;
+  return stat(hostPath(path).c_str(), &st) == 0;
+}
+Dir FS::openDir(const char* path) { return Dir(hostPath(path), path); }
+bool FS::remove(const char* path) { return ::unlink(hostPath(path).c_str()) == 0; }
+bool FS::rename(const char* from, const char* to) {
+  return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+bool FS::mkdir(const char* path) { return mkdirs(hostPath(path)); }
+bool FS::rmdir(const char* path) { return ::rmdir(hostPath(path).c_str()) == 0; }
+
+}  // namespace fs
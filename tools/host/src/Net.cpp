@@ -0,0 +1,304 @@
+/**
+ * @file Net.cpp
+ * @brief Host shim - WiFi, TCP client/server over POSIX sockets, HTTPClient
+ */
+
+#include "ESP8266WiFi.h"
+#include "ESP8266HTTPClient.h"
+#include "lwip/dns.h"
+
+ESP8266WiFiClass WiFi;
+const IPAddress INADDR_NONE(0u);
+
+// After the shim globals: <netinet/in.h> defines INADDR_NONE as a macro
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string>
+
+int ESP8266WiFiClass::hostByName(const char* host, IPAddress& result) {
+  if (result.fromString(host)) return 1;
+  addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  addrinfo* res = nullptr;
+  if (getaddrinfo(host, nullptr, &hints, &res) != 0 || !res) return 0;
+  result = IPAddress((uint32_t)((sockaddr_in*)res->ai_addr)->sin_addr.s_addr);
+  freeaddrinfo(res);
+  return 1;
+}
+
+err_t dns_gethostbyname(const char* hostname, ip_addr_t* addr, dns_found_callback, void*) {
+  IPAddress ip;
+  if (!WiFi.hostByName(hostname, ip)) return ERR_ARG;
+  addr->addr = (uint32_t)ip;
+  return ERR_OK;
+}
+
+// ============================================================================
+// SOCKETS
+// ============================================================================
+
+struct HostSocket {
+  int fd;
+  std::string rx;
+  bool eof = false;
+  explicit HostSocket(int f) : fd(f) {}
+  ~HostSocket() { if (fd >= 0) ::close(fd); }
+
+  void pump(int waitMs) {
+    if (fd < 0 || eof) return;
+    pollfd p = {fd, POLLIN, 0};
+    if (poll(&p, 1, waitMs) <= 0) return;
+    char buf[2048];
+    ssize_t n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (n > 0) rx.append(buf, n);
+    else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) eof = true;
+  }
+};
+
+WiFiClient::WiFiClient(int fd) : _sock(std::make_shared<HostSocket>(fd)) {}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  stop();
+  if (WiFi.status() != WL_CONNECTED) return 0;
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return 0;
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = (uint32_t)ip;
+
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+  int rc = ::connect(fd, (sockaddr*)&addr, sizeof(addr));
+  if (rc < 0 && errno == EINPROGRESS) {
+    pollfd p = {fd, POLLOUT, 0};
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (poll(&p, 1, (int)_timeout) <= 0 ||
+        getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) {
+      ::close(fd);
+      return 0;
+    }
+  } else if (rc < 0) {
+    ::close(fd);
+    return 0;
+  }
+  fcntl(fd, F_SETFL, 0);
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  _sock = std::make_shared<HostSocket>(fd);
+  return 1;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+  IPAddress ip;
+  if (WiFi.hostRedirected(host, port)) return connect(IPAddress(127, 0, 0, 1), port);
+  if (!WiFi.hostByName(host, ip)) return 0;
+  return connect(ip, port);
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size) {
+  if (!_sock || _sock->fd < 0) return 0;
+  size_t sent = 0;
+  while (sent < size) {
+    ssize_t n = send(_sock->fd, buf + sent, size - sent, MSG_NOSIGNAL);
+    if (n <= 0) {
+      _sock->eof = true;
+      break;
+    }
+    sent += n;
+  }
+  return sent;
+}
+
+int WiFiClient::available() {
+  if (!_sock) return 0;
+  if (_sock->rx.empty()) _sock->pump(0);
+  return (int)_sock->rx.size();
+}
+
+int WiFiClient::read() {
+  if (!available()) return -1;
+  uint8_t c = _sock->rx[0];
+  _sock->rx.erase(0, 1);
+  return c;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t size) {
+  size_t n = std::min(size, (size_t)available());
+  if (n == 0) return 0;
+  memcpy(buf, _sock->rx.data(), n);
+  _sock->rx.erase(0, n);
+  return (int)n;
+}
+
+int WiFiClient::peek() {
+  if (!available()) return -1;
+  return (uint8_t)_sock->rx[0];
+}
+
+void WiFiClient::stop() {
+  _sock.reset();
+}
+
+uint8_t WiFiClient::connected() {
+  if (!_sock || _sock->fd < 0) return 0;
+  if (!_sock->rx.empty()) return 1;
+  _sock->pump(0);
+  return (!_sock->eof || !_sock->rx.empty()) ? 1 : 0;
+}
+
+IPAddress WiFiClient::remoteIP() { return IPAddress(127, 0, 0, 1); }
+uint16_t WiFiClient::remotePort() { return 0; }
+IPAddress WiFiClient::localIP() { return IPAddress(127, 0, 0, 1); }
+
+void WiFiServer::begin() {
+  close();
+  _fd = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  uint16_t port = getenv("KLIMERKO_EPHEMERAL_PORTS") ? 0 : _port < 1024 ? _port + 8000 : _port;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  if (bind(_fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(_fd, 8) < 0 ||
+      getsockname(_fd, (sockaddr*)&addr, &len) < 0) {
+    ::close(_fd);
+    _fd = -1;
+    return;
+  }
+  _hostPort = ntohs(addr.sin_port);
+  fcntl(_fd, F_SETFL, O_NONBLOCK);
+}
+
+bool WiFiServer::hasClient() {
+  if (_fd < 0) return false;
+  pollfd p = {_fd, POLLIN, 0};
+  return poll(&p, 1, 0) > 0;
+}
+
+WiFiClient WiFiServer::accept() {
+  if (_fd < 0) return WiFiClient();
+  int fd = ::accept(_fd, nullptr, nullptr);
+  if (fd < 0) return WiFiClient();
+  fcntl(fd, F_SETFL, 0);
+  return WiFiClient(fd);
+}
+
+void WiFiServer::close() {
+  if (_fd >= 0) ::close(_fd);
+  _fd = -1;
+}
+
+// ============================================================================
+// HTTP CLIENT
+// ============================================================================
+
+bool HTTPClient::begin(WiFiClient& client, const String& url) {
+  std::string u = url.c_str();
+  size_t scheme = u.find("://");
+  if (scheme == std::string::npos || u.compare(0, scheme, "http") != 0) return false;
+  u = u.substr(scheme + 3);
+  size_t slash = u.find('/');
+  std::string hostPort = u.substr(0, slash);
+  std::string uri = slash == std::string::npos ? "/" : u.substr(slash);
+  size_t colon = hostPort.find(':');
+  uint16_t port = 80;
+  if (colon != std::string::npos) {
+    port = (uint16_t)atoi(hostPort.c_str() + colon + 1);
+    hostPort = hostPort.substr(0, colon);
+  }
+  return begin(client, String(hostPort.c_str()), port, String(uri.c_str()));
+}
+
+bool HTTPClient::begin(WiFiClient& client, const String& host, uint16_t port, const String& uri) {
+  if (_client != &client || _host != host || _port != port) {
+    if (_client) _client->stop();
+  }
+  _client = &client;
+  _host = host;
+  _port = port;
+  _uri = uri;
+  _headers.clear();
+  _body = "";
+  return true;
+}
+
+void HTTPClient::end() {
+  if (_client && !_reuse) _client->stop();
+  _headers.clear();
+}
+
+int HTTPClient::sendRequest(const char* method, const uint8_t* payload, size_t size) {
+  if (!_client) return HTTPC_ERROR_NOT_CONNECTED;
+  _client->setTimeout(_timeout);
+  bool reused = _client->connected();
+  if (!reused && !_client->connect(_host.c_str(), _port)) return HTTPC_ERROR_CONNECTION_FAILED;
+
+  String head = String(method) + " " + _uri + " HTTP/1.1\r\nHost: " + _host;
+  if (_port != 80) head += ":" + String(_port);
+  head += "\r\nUser-Agent: " + _userAgent + "\r\nConnection: " + (_reuse ? "keep-alive" : "close") + "\r\n";
+  if (_authorization.length()) head += "Authorization: " + _authorization + "\r\n";
+  for (auto& h : _headers) head += h.first + ": " + h.second + "\r\n";
+  head += "Content-Length: " + String((unsigned)size) + "\r\n\r\n";
+  if (_client->write((const uint8_t*)head.c_str(), head.length()) != head.length()) return HTTPC_ERROR_SEND_HEADER_FAILED;
+  if (size && _client->write(payload, size) != size) return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+
+  // Read status line and headers (real time - talks to real sockets)
+  std::string buf;
+  int code = 0;
+  long contentLength = -1;
+  bool close = !_reuse;
+  size_t headerEnd;
+  unsigned waited = 0;
+  while ((headerEnd = buf.find("\r\n\r\n")) == std::string::npos) {
+    uint8_t tmp[512];
+    int n = _client->read(tmp, sizeof(tmp));
+    if (n > 0) { buf.append((char*)tmp, n); continue; }
+    if (!_client->connected()) return HTTPC_ERROR_CONNECTION_LOST;
+    if (waited >= _timeout) return HTTPC_ERROR_READ_TIMEOUT;
+    usleep(1000);
+    waited++;
+  }
+  sscanf(buf.c_str(), "HTTP/%*s %d", &code);
+  std::string headers = buf.substr(0, headerEnd);
+  for (char& c : headers) c = tolower(c);
+  size_t cl = headers.find("content-length:");
+  if (cl != std::string::npos) contentLength = atol(headers.c_str() + cl + 15);
+  if (headers.find("connection: close") != std::string::npos) close = true;
+  buf.erase(0, headerEnd + 4);
+
+  if (contentLength < 0) contentLength = 0;
+  waited = 0;
+  while ((long)buf.size() < contentLength && waited < _timeout) {
+    uint8_t tmp[512];
+    int n = _client->read(tmp, sizeof(tmp));
+    if (n > 0) { buf.append((char*)tmp, n); continue; }
+    if (!_client->connected()) break;
+    usleep(1000);
+    waited++;
+  }
+  _body = String(buf.substr(0, contentLength).c_str());
+  if (close) _client->stop();
+  return code;
+}
+
+String HTTPClient::errorToString(int error) {
+  switch (error) {
+    case HTTPC_ERROR_CONNECTION_FAILED: return "connection failed";
+    case HTTPC_ERROR_SEND_HEADER_FAILED: return "send header failed";
+    case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return "send payload failed";
+    case HTTPC_ERROR_NOT_CONNECTED: return "not connected";
+    case HTTPC_ERROR_CONNECTION_LOST: return "connection lost";
+    case HTTPC_ERROR_READ_TIMEOUT: return "read timeout";
+    default: return String();
+  }
+}
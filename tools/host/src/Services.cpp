@@ -0,0 +1,14 @@
+/**
+ * @file Services.cpp
+ * @brief Host shim - globals of the network services that are no-ops on host
+ */
+
+#include "ArduinoOTA.h"
+#include "ESP8266httpUpdate.h"
+#include "ESP8266mDNS.h"
+#include "SPI.h"
+
+ArduinoOTAClass ArduinoOTA;
+ESP8266HTTPUpdate ESPhttpUpdate;
+MDNSResponder MDNS;
+SPIClass SPI;
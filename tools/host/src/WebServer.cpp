@@ -0,0 +1,227 @@
+/**
+ * @file WebServer.cpp
+ * @brief Host shim - ESP8266WebServer on localhost
+ *
+ * One request per handleClient(), answered with "Connection: close". A
+ * response of CONTENT_LENGTH_UNKNOWN is close-delimited rather than
+ * chunked; clients see the same bytes either way.
+ */
+
+#include "ESP8266WebServer.h"
+#include <strings.h>
+#include <unistd.h>
+
+static const char* hostStatusText(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "";
+  }
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+static String urlDecode(const std::string& in) {
+  std::string out;
+  for (size_t i = 0; i < in.size(); i++) {
+    if (in[i] == '+') {
+      out += ' ';
+    } else if (in[i] == '%' && i + 2 < in.size() && hexValue(in[i + 1]) >= 0 && hexValue(in[i + 2]) >= 0) {
+      out += (char)(hexValue(in[i + 1]) * 16 + hexValue(in[i + 2]));
+      i += 2;
+    } else {
+      out += in[i];
+    }
+  }
+  return String(out.c_str(), out.size());
+}
+
+void ESP8266WebServer::handleClient() {
+  if (!_server.hasClient()) return;
+  _client = _server.accept();
+  if (!_client) return;
+
+  if (parseRequest()) {
+    bool handled = false;
+    for (const Route& r : _handlers) {
+      if (r.uri == _uri && (r.method == HTTP_ANY || r.method == _method)) {
+        r.fn();
+        handled = true;
+        break;
+      }
+    }
+    if (!handled) {
+      if (_notFound) _notFound();
+      else send(404, "text/plain", "Not found");
+    }
+    if (!_headSent) send(500, "text/plain", "No response");
+  }
+  finishRequest();
+}
+
+bool ESP8266WebServer::parseRequest() {
+  // Sockets are real, so this waits on the wall clock (bounded)
+  std::string head;
+  for (int waited = 0; head.find("\r\n\r\n") == std::string::npos; ) {
+    uint8_t buf[512];
+    int n = _client.read(buf, sizeof(buf));
+    if (n > 0) {
+      head.append((const char*)buf, n);
+      continue;
+    }
+    if (!_client.connected() || waited >= 2000 || head.size() > 8192) return false;
+    usleep(1000);
+    waited++;
+  }
+  head.resize(head.find("\r\n\r\n"));
+
+  size_t lineEnd = head.find("\r\n");
+  std::string line = head.substr(0, lineEnd);
+  size_t sp1 = line.find(' ');
+  size_t sp2 = line.find(' ', sp1 + 1);
+  if (sp1 == std::string::npos || sp2 == std::string::npos) return false;
+  std::string method = line.substr(0, sp1);
+  std::string target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+
+  static const char* const METHODS[] = {"GET", "HEAD", "POST", "PUT", "PATCH", "DELETE", "OPTIONS"};
+  _method = HTTP_ANY;
+  for (int i = 0; i < 7; i++) {
+    if (method == METHODS[i]) _method = (HTTPMethod)(HTTP_GET + i);
+  }
+
+  _args.clear();
+  size_t q = target.find('?');
+  _uri = urlDecode(target.substr(0, q));
+  if (q != std::string::npos) {
+    std::string query = target.substr(q + 1);
+    size_t start = 0;
+    while (start <= query.size()) {
+      size_t amp = query.find('&', start);
+      std::string pair = query.substr(start, amp == std::string::npos ? std::string::npos : amp - start);
+      if (!pair.empty()) {
+        size_t eq = pair.find('=');
+        _args.emplace_back(urlDecode(pair.substr(0, eq)),
+                           eq == std::string::npos ? String() : urlDecode(pair.substr(eq + 1)));
+      }
+      if (amp == std::string::npos) break;
+      start = amp + 1;
+    }
+  }
+
+  _requestHeaders.clear();
+  while (lineEnd != std::string::npos) {
+    size_t next = head.find("\r\n", lineEnd + 2);
+    std::string h = head.substr(lineEnd + 2, next == std::string::npos ? std::string::npos : next - lineEnd - 2);
+    size_t colon = h.find(':');
+    if (colon != std::string::npos) {
+      size_t v = h.find_first_not_of(' ', colon + 1);
+      _requestHeaders.emplace_back(String(h.substr(0, colon).c_str()),
+                                   String(v == std::string::npos ? "" : h.substr(v).c_str()));
+    }
+    lineEnd = next;
+  }
+  return true;
+}
+
+String ESP8266WebServer::arg(const String& name) const {
+  for (const auto& a : _args) {
+    if (a.first == name) return a.second;
+  }
+  return String();
+}
+
+bool ESP8266WebServer::hasArg(const String& name) const {
+  for (const auto& a : _args) {
+    if (a.first == name) return true;
+  }
+  return false;
+}
+
+String ESP8266WebServer::header(const String& name) const {
+  for (const auto& h : _requestHeaders) {
+    if (h.first.equalsIgnoreCase(name)) return h.second;
+  }
+  return String();
+}
+
+bool ESP8266WebServer::hasHeader(const String& name) const {
+  for (const auto& h : _requestHeaders) {
+    if (h.first.equalsIgnoreCase(name)) return true;
+  }
+  return false;
+}
+
+void ESP8266WebServer::sendHeader(const String& name, const String& value, bool first) {
+  if (first) _responseHeaders.insert(_responseHeaders.begin(), std::make_pair(name, value));
+  else _responseHeaders.emplace_back(name, value);
+}
+
+void ESP8266WebServer::writeHead(int code, const char* contentType, size_t contentLength) {
+  String head = String("HTTP/1.1 ") + code + " " + hostStatusText(code) + "\r\n";
+  head += String("Content-Type: ") + (contentType ? contentType : "text/html") + "\r\n";
+  if (contentLength != CONTENT_LENGTH_UNKNOWN) head += String("Content-Length: ") + (unsigned long)contentLength + "\r\n";
+  for (const auto& h : _responseHeaders) head += h.first + ": " + h.second + "\r\n";
+  head += "Connection: close\r\n\r\n";
+  _client.write(head.c_str(), head.length());
+  _responseHeaders.clear();
+  _headSent = true;
+}
+
+void ESP8266WebServer::send(int code, const char* contentType, const String& content) {
+  size_t length = _contentLength == CONTENT_LENGTH_NOT_SET ? content.length() : _contentLength;
+  writeHead(code, contentType, length);
+  if (content.length() && _method != HTTP_HEAD) _client.write(content.c_str(), content.length());
+}
+
+void ESP8266WebServer::send(int code, const char* contentType, const uint8_t* content, size_t len) {
+  writeHead(code, contentType, _contentLength == CONTENT_LENGTH_NOT_SET ? len : _contentLength);
+  if (len && _method != HTTP_HEAD) _client.write(content, len);
+}
+
+void ESP8266WebServer::sendContent(const char* content, size_t len) {
+  if (len && _method != HTTP_HEAD) _client.write(reinterpret_cast<const uint8_t*>(content), len);
+}
+
+void ESP8266WebServer::serveStatic(const char* uri, fs::FS& fs, const char* path, const char* cacheHeader) {
+  String filePath(path);
+  String cache(cacheHeader ? cacheHeader : "");
+  fs::FS* files = &fs;
+  on(String(uri), HTTP_GET, [this, files, filePath, cache]() {
+    String gz = filePath + ".gz";
+    fs::File f = files->open(gz.c_str(), "r");
+    if (!f) f = files->open(filePath.c_str(), "r");
+    if (!f) {
+      send(404, "text/plain", "Not found");
+      return;
+    }
+    if (cache.length()) sendHeader("Cache-Control", cache);
+    const char* type = filePath.endsWith(".js") ? "application/javascript"
+                     : filePath.endsWith(".css") ? "text/css"
+                     : filePath.endsWith(".json") ? "application/json" : "text/html";
+    streamFile(f, type);
+  });
+}
+
+void ESP8266WebServer::finishRequest() {
+  _client.stop();
+  _client = WiFiClient();
+  _args.clear();
+  _requestHeaders.clear();
+  _responseHeaders.clear();
+  _contentLength = CONTENT_LENGTH_NOT_SET;
+  _headSent = false;
+}
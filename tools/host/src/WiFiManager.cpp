@@ -0,0 +1,147 @@
+/**
+ * @file WiFiManager.cpp
+ * @brief Host shim - WiFiManager stand-in built against the vendored header
+ *
+ * The host WiFi station is "connected" from the start (ESP8266WiFi.h), so
+ * autoConnect() succeeds immediately. The config portal only tracks its
+ * active flag and callbacks; there is no captive portal or scan on host.
+ * Parameters behave like the library's (value buffer of the given length).
+ */
+
+#include "../../../src/WiFiManager/WiFiManager.h"
+
+// ============================================================================
+// PARAMETERS
+// ============================================================================
+
+WiFiManagerParameter::WiFiManagerParameter() : WiFiManagerParameter("") {}
+
+WiFiManagerParameter::WiFiManagerParameter(const char* custom) {
+  _id = nullptr;
+  _label = nullptr;
+  _length = 0;
+  _value = nullptr;
+  _labelPlacement = WFM_LABEL_DEFAULT;
+  _customHTML = custom;
+}
+
+WiFiManagerParameter::WiFiManagerParameter(const char* id, const char* label) {
+  init(id, label, "", 0, "", WFM_LABEL_DEFAULT);
+}
+
+WiFiManagerParameter::WiFiManagerParameter(const char* id, const char* label, const char* defaultValue, int length) {
+  init(id, label, defaultValue, length, "", WFM_LABEL_DEFAULT);
+}
+
+WiFiManagerParameter::WiFiManagerParameter(const char* id, const char* label, const char* defaultValue, int length,
+                                           const char* custom) {
+  init(id, label, defaultValue, length, custom, WFM_LABEL_DEFAULT);
+}
+
+WiFiManagerParameter::WiFiManagerParameter(const char* id, const char* label, const char* defaultValue, int length,
+                                           const char* custom, int labelPlacement) {
+  init(id, label, defaultValue, length, custom, labelPlacement);
+}
+
+void WiFiManagerParameter::init(const char* id, const char* label, const char* defaultValue, int length,
+                                const char* custom, int labelPlacement) {
+  _id = id;
+  _label = label;
+  _labelPlacement = labelPlacement;
+  _customHTML = custom;
+  _length = 0;
+  _value = nullptr;
+  setValue(defaultValue, length);
+}
+
+WiFiManagerParameter::~WiFiManagerParameter() {
+  delete[] _value;
+  _length = 0;
+}
+
+void WiFiManagerParameter::setValue(const char* defaultValue, int length) {
+  if (!_id) return;
+  if (_length != length || _value == nullptr) {
+    _length = length;
+    delete[] _value;
+    _value = new char[_length + 1];
+  }
+  memset(_value, 0, _length + 1);
+  if (defaultValue) strncpy(_value, defaultValue, _length);
+}
+
+const char* WiFiManagerParameter::getValue() const { return _value; }
+const char* WiFiManagerParameter::getID() const { return _id; }
+const char* WiFiManagerParameter::getPlaceholder() const { return _label; }
+const char* WiFiManagerParameter::getLabel() const { return _label; }
+int WiFiManagerParameter::getValueLength() const { return _length; }
+int WiFiManagerParameter::getLabelPlacement() const { return _labelPlacement; }
+const char* WiFiManagerParameter::getCustomHTML() const { return _customHTML; }
+
+// ============================================================================
+// MANAGER
+// ============================================================================
+
+WiFiManager::WiFiManager() { _max_params = WIFI_MANAGER_MAX_PARAMS; }
+
+WiFiManager::~WiFiManager() { free(_params); }
+
+bool WiFiManager::addParameter(WiFiManagerParameter* p) {
+  if (_paramsCount == _max_params) return false;
+  if (!_params) _params = (WiFiManagerParameter**)malloc(_max_params * sizeof(WiFiManagerParameter*));
+  _params[_paramsCount++] = p;
+  return true;
+}
+
+boolean WiFiManager::autoConnect(const char* apName, const char* apPassword) {
+  if (WiFi.isConnected()) return true;
+  if (_enableConfigPortal) startConfigPortal(apName, apPassword);
+  return false;
+}
+
+boolean WiFiManager::startConfigPortal(const char* /*apName*/, const char* /*apPassword*/) {
+  configPortalActive = true;
+  _configPortalStart = millis();
+  if (_apcallback) _apcallback(this);
+  if (_webservercallback) _webservercallback();
+  return false;  // Non-blocking: nothing was saved yet
+}
+
+bool WiFiManager::stopConfigPortal() {
+  configPortalActive = false;
+  return true;
+}
+
+boolean WiFiManager::process() {
+  if (configPortalActive && _configPortalTimeout && millis() - _configPortalStart > _configPortalTimeout) {
+    stopConfigPortal();
+    if (_configportaltimeoutcallback) _configportaltimeoutcallback();
+  }
+  return false;
+}
+
+bool WiFiManager::getConfigPortalActive() { return configPortalActive; }
+void WiFiManager::resetSettings() { WiFi.disconnect(true); }
+
+void WiFiManager::setAPCallback(std::function<void(WiFiManager*)> func) { _apcallback = func; }
+void WiFiManager::setWebServerCallback(std::function<void()> func) { _webservercallback = func; }
+void WiFiManager::setSaveConfigCallback(std::function<void()> func) { _savewificallback = func; }
+void WiFiManager::setSaveParamsCallback(std::function<void()> func) { _saveparamscallback = func; }
+
+void WiFiManager::setConfigPortalTimeout(unsigned long seconds) { _configPortalTimeout = seconds * 1000; }
+void WiFiManager::setConnectTimeout(unsigned long seconds) { _connectTimeout = seconds * 1000; }
+void WiFiManager::setConnectRetries(uint8_t numRetries) { _connectRetries = numRetries; }
+void WiFiManager::setConfigPortalBlocking(boolean shouldBlock) { _configPortalIsBlocking = shouldBlock; }
+void WiFiManager::setBreakAfterConfig(boolean shouldBreak) { _shouldBreakAfterConfig = shouldBreak; }
+void WiFiManager::setEnableConfigPortal(boolean enable) { _enableConfigPortal = enable; }
+void WiFiManager::setSaveConnect(bool connect) { _connectonsave = connect; }
+void WiFiManager::setWiFiAutoReconnect(boolean enabled) { _wifiAutoReconnect = enabled; }
+void WiFiManager::setParamsPage(bool enable) { _paramsInWifi = !enable; }
+void WiFiManager::setDarkMode(bool enable) { _bodyClass = enable ? "invert" : ""; }
+void WiFiManager::setDebugOutput(boolean debug) { _debug = debug; }
+void WiFiManager::setTitle(String title) { _title = title; }
+void WiFiManager::setCountry(String cc) { _wificountry = cc; }
+bool WiFiManager::setHostname(const char* hostname) {
+  _hostname = String(hostname);
+  return true;
+}
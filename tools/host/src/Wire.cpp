@@ -0,0 +1,49 @@
+/**
+ * @file Wire.cpp
+ * @brief Host shim - TwoWire dispatching to emulated register devices
+ *
+ * Like a real register-mapped I2C slave: the first byte of a write sets the
+ * register pointer, further bytes are written from there on, and reads
+ * continue from the pointer, incrementing it per byte.
+ */
+
+#include "Wire.h"
+
+TwoWire Wire;
+
+void TwoWire::beginTransmission(uint8_t address) {
+  _txAddress = address;
+  _tx.clear();
+}
+
+size_t TwoWire::write(uint8_t data) {
+  _tx.push_back(data);
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t quantity) {
+  _tx.insert(_tx.end(), data, data + quantity);
+  return quantity;
+}
+
+uint8_t TwoWire::endTransmission(bool /*sendStop*/) {
+  auto it = _devices.find(_txAddress);
+  if (it == _devices.end()) return 2;  // Address NACK
+  if (!_tx.empty()) {
+    uint8_t reg = _tx[0];
+    for (size_t i = 1; i < _tx.size(); i++) it->second->writeRegister(reg++, _tx[i]);
+    _pointer[_txAddress] = _tx[0];
+  }
+  _tx.clear();
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, size_t quantity, bool /*sendStop*/) {
+  _rx.clear();
+  _rxIndex = 0;
+  auto it = _devices.find(address);
+  if (it == _devices.end()) return 0;
+  uint8_t& reg = _pointer[address];
+  for (size_t i = 0; i < quantity; i++) _rx.push_back(it->second->readRegister(reg++));
+  return (uint8_t)_rx.size();
+}
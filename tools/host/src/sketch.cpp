@@ -0,0 +1,9 @@
+/**
+ * @file sketch.cpp
+ * @brief Host build - the firmware sketch as one translation unit
+ *
+ * The Arduino IDE compiles the .ino as C++ with the prototypes it needs
+ * already declared in the headers; the host build does the same.
+ */
+
+#include "../../../Klimerko_7.0_Modular.ino"
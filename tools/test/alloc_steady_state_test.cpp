@@ -0,0 +1,150 @@
+/**
+ * @file alloc_steady_state_test.cpp
+ * @brief Host test - no heap allocation in steady-state loop() iterations
+ *
+ * Runs the whole sketch against the host shims with an emulated PMS7003 and
+ * BME280 and a minimal MQTT broker on localhost. After a warm-up (first
+ * connect, first reads and publishes, buffers grown to size) every call to
+ * malloc/calloc/realloc made by the firmware thread is counted per loop()
+ * iteration. Iterations are classified as publish (dataPublishTime moved),
+ * storage (a LittleFS file was opened: the device allocates a handle per
+ * open), sensor read (sensorReadTime moved) or idle. Idle and sensor
+ * iterations must not allocate; the other two are reported for information.
+ *
+ * Built and run by the host build (tools/host): ctest -R alloc_steady_state
+ */
+
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <SoftwareSerial.h>
+#include <Wire.h>
+#include "HostBME280.h"
+#include "HostMqttBroker.h"
+#include "HostPMS7003.h"
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t n, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void __libc_free(void* ptr);
+
+// Counted on the firmware thread only; the broker thread allocates freely
+static thread_local bool counting = false;
+static unsigned long allocations = 0;
+
+extern "C" void* malloc(size_t size) {
+  if (counting) allocations++;
+  return __libc_malloc(size);
+}
+extern "C" void* calloc(size_t n, size_t size) {
+  if (counting) allocations++;
+  return __libc_calloc(n, size);
+}
+extern "C" void* realloc(void* ptr, size_t size) {
+  if (counting) allocations++;
+  return __libc_realloc(ptr, size);
+}
+extern "C" void free(void* ptr) { __libc_free(ptr); }
+
+// Sketch
+void setup();
+void loop();
+extern SoftwareSerial pmsSerial;
+extern char mqttServer[64];
+extern uint16_t mqttPort;
+extern unsigned long sensorReadTime;
+extern unsigned long dataPublishTime;
+
+// ============================================================================
+// TEST
+// ============================================================================
+
+static const unsigned long LOOP_STEP_MS = 10;
+
+struct Tally {
+  const char* name;
+  unsigned long iterations;
+  unsigned long allocating;
+  unsigned long allocations;
+};
+
+struct Tallies {
+  Tally idle = {"idle", 0, 0, 0};
+  Tally sensor = {"sensor read", 0, 0, 0};
+  Tally storage = {"storage", 0, 0, 0};
+  Tally publish = {"publish", 0, 0, 0};
+};
+
+static void runFor(unsigned long ms, Tallies* tallies, HostBME280& bme, HostPMS7003& pms) {
+  for (unsigned long t = 0; t < ms; t += LOOP_STEP_MS) {
+    // Slow drift so readings change and deadbands/alarms see real input
+    unsigned long minute = millis() / 60000;
+    bme.setConditions(20.0f + (minute % 7) * 0.3f, 1012.0f + (minute % 5) * 0.2f, 40.0f + (minute % 9));
+    pms.setConcentrations((uint16_t)(4 + minute % 6), (uint16_t)(9 + minute % 11), (uint16_t)(12 + minute % 13));
+
+    unsigned long readBefore = sensorReadTime;
+    unsigned long publishBefore = dataPublishTime;
+    uint32_t opensBefore = LittleFS.hostOpens();
+    allocations = 0;
+    counting = tallies != nullptr;
+    loop();
+    counting = false;
+
+    if (tallies) {
+      Tally* tally = dataPublishTime != publishBefore ? &tallies->publish
+                   : LittleFS.hostOpens() != opensBefore ? &tallies->storage
+                   : sensorReadTime != readBefore ? &tallies->sensor : &tallies->idle;
+      tally->iterations++;
+      if (allocations) tally->allocating++;
+      tally->allocations += allocations;
+    }
+    hostAdvanceMillis(LOOP_STEP_MS);
+  }
+}
+
+int main() {
+  char dir[] = "/tmp/klimerko_alloc_XXXXXX";
+  if (!mkdtemp(dir)) return 2;
+  if (chdir(dir) != 0) return 2;
+  Serial.setQuiet(true);
+
+  HostBME280 bme;
+  Wire.hostAttach(0x76, &bme);
+  HostPMS7003 pms(pmsSerial);
+  static HostMqttBroker broker;
+  uint16_t port = broker.start();
+
+  setup();
+  strcpy(mqttServer, "127.0.0.1");
+  mqttPort = port;
+
+  // Warm-up: connect, two publish intervals of reads and publishes
+  runFor(12 * 60 * 1000UL, nullptr, bme, pms);
+
+  Tallies t;
+  runFor(30 * 60 * 1000UL, &t, bme, pms);
+
+  printf("broker received %lu publishes\n", broker.publishes());
+  int failures = 0;
+  for (const Tally* tally : {&t.idle, &t.sensor, &t.storage, &t.publish}) {
+    printf("%-12s %7lu iterations, %5lu allocating, %6lu allocations\n", tally->name, tally->iterations,
+           tally->allocating, tally->allocations);
+  }
+  if (broker.publishes() == 0) {
+    printf("FAIL nothing was published\n");
+    failures++;
+  }
+  if (t.sensor.iterations == 0 || t.publish.iterations == 0) {
+    printf("FAIL steady state did not read and publish\n");
+    failures++;
+  }
+  if (t.idle.allocations || t.sensor.allocations) {
+    printf("FAIL steady-state iterations allocate\n");
+    failures++;
+  }
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures ? 1 : 0;
+}
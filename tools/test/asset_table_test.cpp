@@ -0,0 +1,69 @@
+/**
+ * @file asset_table_test.cpp
+ * @brief Host test - perfect-hash asset lookup in src/klimerko/assets.h
+ *
+ * Checks that every MqttAsset round-trips through its name and through a
+ * command topic, and that near misses and malformed topics map to UNKNOWN.
+ *
+ * Built and run by the host build (tools/host): ctest -R asset_table
+ *   /tmp/asset_table_test
+ */
+
+#include <stdio.h>
+#include <string>
+#include "assets.h"
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what, const std::string& input) {
+  if (!ok) {
+    printf("FAIL %s: \"%s\"\n", what, input.c_str());
+    failures++;
+  }
+}
+
+static MqttAsset lookup(const std::string& name) {
+  // Deliberately not NUL-terminated at name.size()
+  std::string padded = name + "/command";
+  return assetFromName(padded.data(), name.size());
+}
+
+int main() {
+  const std::string prefix = "device/Kx1Yq3bV0sRz8dTn5mWc2fHg/asset/";
+
+  for (uint8_t i = 0; i < ASSET_COUNT; i++) {
+    MqttAsset asset = (MqttAsset)i;
+    std::string name = assetToString(asset);
+
+    expect(name != "unknown", "asset has a name", name);
+    for (uint8_t j = 0; j < i; j++) {
+      expect(name != assetToString((MqttAsset)j), "name is unique", name);
+    }
+    expect(lookup(name) == asset, "name lookup", name);
+    expect(assetFromTopic((prefix + name + "/command").c_str()) == asset, "topic lookup", name);
+
+    // Near misses must not match (a prefix may be another asset, e.g. pm1 of pm10)
+    expect(lookup(name.substr(0, name.size() - 1)) != asset, "shorter name", name);
+    expect(lookup(name + "x") == MqttAsset::UNKNOWN, "longer name", name);
+    std::string flipped = name;
+    flipped[0] ^= 0x20;
+    expect(lookup(flipped) == MqttAsset::UNKNOWN, "case changed", flipped);
+    expect(assetFromTopic((prefix + name).c_str()) == MqttAsset::UNKNOWN, "no /command", name);
+    expect(assetFromTopic((prefix + name + "/command/x").c_str()) == MqttAsset::UNKNOWN, "trailing level", name);
+    expect(assetFromTopic((prefix + name + "/feed").c_str()) == MqttAsset::UNKNOWN, "other suffix", name);
+  }
+
+  const char* malformed[] = {
+    "", "device", "device/id/state", "device/id/asset//command",
+    "device/id/asset/command", "device/id/asset/", "/asset/unknown-asset/command"
+  };
+  for (const char* topic : malformed) {
+    expect(assetFromTopic(topic) == MqttAsset::UNKNOWN, "malformed topic", topic);
+  }
+  expect(assetFromName("", 0) == MqttAsset::UNKNOWN, "empty name", "");
+  expect(std::string(assetToString(MqttAsset::UNKNOWN)) == "unknown", "unknown name", "unknown");
+
+  printf("%u assets, table %u slots, seed %u: %s\n", ASSET_COUNT, ASSET_TABLE_SIZE,
+         (unsigned)ASSET_TABLE.seed, failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file deep_sleep_publish_test.cpp
+ * @brief Host test - a deep-sleep wake publishes and counts its QoS 1 delivery
+ *
+ * Connects the sketch to a localhost broker, then lets the deep-sleep
+ * branch of loop() take one measurement. The publish goes out at
+ * MQTT_STATE_QOS; its PUBACK has to be read (and counted as a successful
+ * publish) before ESP.deepSleep(), because the in-flight window does not
+ * survive sleep. With the PUBACK withheld the publish counts as failed
+ * after MQTT_DRAIN_TIMEOUT_MS.
+ *
+ *   deep_sleep_publish_test          PUBACK sent
+ *   deep_sleep_publish_test --no-ack PUBACK withheld
+ *
+ * Built and run by the host build (tools/host): ctest -R deep_sleep_publish
+ */
+
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include <SoftwareSerial.h>
+#include <Wire.h>
+#include "HostBME280.h"
+#include "HostMqttBroker.h"
+#include "HostPMS7003.h"
+#include "types.h"
+
+void setup();
+void loop();
+extern SoftwareSerial pmsSerial;
+extern PubSubClient mqtt;
+extern char mqttServer[64];
+extern uint16_t mqttPort;
+extern bool deepSleepEnabled;
+extern Statistics stats;
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+int main(int argc, char** argv) {
+  bool ack = !(argc > 1 && !strcmp(argv[1], "--no-ack"));
+  char dir[] = "/tmp/klimerko_sleep_XXXXXX";
+  if (!mkdtemp(dir) || chdir(dir) != 0) return 2;
+  setenv("KLIMERKO_EPHEMERAL_PORTS", "1", 1);
+  Serial.setQuiet(true);
+
+  HostBME280 bme;
+  Wire.hostAttach(0x76, &bme);
+  HostPMS7003 pms(pmsSerial);
+  static HostMqttBroker broker;
+  uint16_t port = broker.start();
+  broker.setAck(ack);
+
+  setup();
+  strcpy(mqttServer, "127.0.0.1");
+  mqttPort = port;
+  for (int i = 0; i < 3000 && !mqtt.connected(); i++) {
+    loop();
+    hostAdvanceMillis(10);
+    usleep(1000);
+  }
+  expect(mqtt.connected(), "connected to the broker");
+
+  uint32_t successfulBefore = stats.successfulPublishes;
+  uint32_t failedBefore = stats.failedPublishes;
+  bool slept = false;
+  unsigned long publishStart = 0;
+  deepSleepEnabled = true;
+  hostSetDelayYield(1000);  // The broker thread answers in real time
+  try {
+    publishStart = millis();
+    loop();
+  } catch (const HostRestart& restart) {
+    slept = restart.deepSleep;
+  }
+  unsigned long elapsed = millis() - publishStart;
+
+  expect(slept, "loop() ended in deep sleep");
+  expect(broker.publishes() > 0, "measurement published before sleeping");
+  if (ack) {
+    expect(stats.successfulPublishes == successfulBefore + 1, "PUBACK counted as a successful publish");
+    expect(stats.failedPublishes == failedBefore, "no failed publish");
+  } else {
+    expect(stats.successfulPublishes == successfulBefore, "no PUBACK, nothing counted as delivered");
+    expect(stats.failedPublishes == failedBefore + 1, "unacknowledged publish counted as failed");
+    expect(elapsed >= 30000 + MQTT_DRAIN_TIMEOUT_MS, "waited for the PUBACK before sleeping");
+  }
+
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures ? 1 : 0;
+}
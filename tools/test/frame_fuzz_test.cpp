@@ -0,0 +1,155 @@
+/**
+ * @file frame_fuzz_test.cpp
+ * @brief Host fuzz test - frame decoder in src/klimerko/integrity.h
+ *
+ * Encodes frames with random payloads, then damages them (bit flips,
+ * truncation, rewritten length/magic fields, random bytes) and decodes.
+ * Every buffer is a heap block of exactly the bytes handed to the decoder,
+ * so with -fsanitize=address any read past the end aborts the test.
+ * A damaged frame must never decode as OK unless its bytes are unchanged,
+ * and the streaming CRC must match the one-shot CRC at any split.
+ *
+ * Built and run by the host build (tools/host): ctest -R frame_fuzz. For
+ * the sanitizer run, configure a separate tree:
+ *   cmake -S . -B build-asan -DCMAKE_CXX_FLAGS="-fsanitize=address,undefined"
+ *   cmake --build build-asan --target frame_fuzz_test
+ *   build-asan/frame_fuzz_test [iterations] [seed]
+ */
+
+#include <stdio.h>
+#include <random>
+#include <vector>
+#include "integrity.h"
+
+#define FUZZ_MAGIC    0x5A5A534BUL  // "KSZZ"
+#define FUZZ_VERSION  3
+
+static int failures = 0;
+static std::mt19937 rng;
+
+static uint32_t rnd(uint32_t n) {
+  return n ? rng() % n : 0;
+}
+
+static void expect(bool ok, const char* what, unsigned long iteration) {
+  if (!ok) {
+    if (failures < 20) printf("FAIL %s (iteration %lu)\n", what, iteration);
+    failures++;
+  }
+}
+
+/**
+ * @brief Decode a copy that ends exactly at len bytes
+ */
+static FrameStatus decodeExact(const std::vector<uint8_t>& bytes, size_t len, FrameView& view,
+                               std::vector<uint8_t>& copy) {
+  copy.assign(bytes.begin(), bytes.begin() + len);
+  copy.shrink_to_fit();
+  uint8_t* exact = new uint8_t[len ? len : 1];
+  if (len) memcpy(exact, copy.data(), len);
+  FrameStatus status = frameDecode(exact, len, FUZZ_MAGIC, view);
+  if (status == FrameStatus::OK) {
+    // Re-point the view at the vector before the block goes away
+    view.payload = copy.data() + (view.payload - exact);
+  }
+  delete[] exact;
+  return status;
+}
+
+int main(int argc, char** argv) {
+  unsigned long iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+  rng.seed(argc > 2 ? strtoul(argv[2], nullptr, 10) : 1);
+
+  std::vector<uint8_t> payload, frame, damaged, copy;
+  unsigned long accepted = 0;
+  unsigned long rejected[6] = {0};
+
+  for (unsigned long it = 0; it < iterations; it++) {
+    payload.resize(rnd(300));
+    for (uint8_t& b : payload) b = (uint8_t)rng();
+
+    // Round trip, with slack bytes after the frame
+    size_t slack = rnd(8);
+    frame.assign(payload.size() + FRAME_OVERHEAD + slack, 0xEE);
+    size_t len = frameEncode(frame.data(), frame.size(), FUZZ_MAGIC, FUZZ_VERSION,
+                             payload.data(), payload.size());
+    expect(len == payload.size() + FRAME_OVERHEAD, "encoded length", it);
+    expect(frameEncode(frame.data(), len - 1, FUZZ_MAGIC, FUZZ_VERSION,
+                       payload.data(), payload.size()) == 0, "encode into short buffer", it);
+
+    FrameView view;
+    FrameStatus status = decodeExact(frame, frame.size(), view, copy);
+    expect(status == FrameStatus::OK, "round trip", it);
+    expect(status != FrameStatus::OK ||
+           (view.version == FUZZ_VERSION && view.payloadLength == payload.size() &&
+            memcmp(view.payload, payload.data(), payload.size()) == 0), "round trip payload", it);
+
+    // Damage it
+    damaged = frame;
+    size_t decodeLen = frame.size();
+    switch (rnd(6)) {
+      case 0: {  // Bit flips
+        uint32_t flips = 1 + rnd(4);
+        for (uint32_t i = 0; i < flips; i++) damaged[rnd(len)] ^= 1 << rnd(8);
+        break;
+      }
+      case 1:    // Truncation
+        decodeLen = rnd(len);
+        break;
+      case 2: {  // Length field rewritten
+        uint16_t bogus = (uint16_t)rng();
+        memcpy(damaged.data() + 6, &bogus, 2);
+        break;
+      }
+      case 3:    // Random bytes after a valid magic
+        for (size_t i = 4; i < damaged.size(); i++) damaged[i] = (uint8_t)rng();
+        break;
+      case 4:    // Other record type
+        damaged[rnd(4)] ^= 1 + rnd(255);
+        break;
+      default:   // Byte shifted window (a record read at the wrong offset)
+        damaged.erase(damaged.begin(), damaged.begin() + 1 + rnd(4));
+        decodeLen = damaged.size();
+        break;
+    }
+
+    status = decodeExact(damaged, decodeLen, view, copy);
+    bool unchanged = decodeLen >= len && memcmp(damaged.data(), frame.data(), len) == 0;
+    if (status == FrameStatus::OK) {
+      accepted++;
+      expect(unchanged, "damaged frame accepted", it);
+      expect(view.payload + view.payloadLength <= copy.data() + decodeLen, "view inside buffer", it);
+    } else {
+      rejected[(uint8_t)status]++;
+    }
+
+    // Streaming CRC equals one-shot at any split
+    size_t split = rnd(payload.size() + 1);
+    Crc32 stream;
+    stream.update(payload.data(), split).update(payload.data() + split, payload.size() - split);
+    expect(stream.value() == crc32(payload.data(), payload.size()), "streaming crc", it);
+  }
+
+  // Known answer: CRC-32/ISO-HDLC check value
+  expect(crc32("123456789", 9) == 0xCBF43926UL, "check value", 0);
+
+  // Struct helpers
+  struct Record {
+    FrameHeader frame;
+    uint32_t value;
+    uint32_t crc32;
+  } record = {};
+  record.value = 42;
+  frameSeal(&record, sizeof(record), FUZZ_MAGIC, FUZZ_VERSION);
+  expect(frameCheck(&record, sizeof(record), FUZZ_MAGIC, FUZZ_VERSION) == FrameStatus::OK, "seal/check", 0);
+  expect(frameCheck(&record, sizeof(record), FUZZ_MAGIC, FUZZ_VERSION + 1) == FrameStatus::VERSION, "version", 0);
+  record.value++;
+  expect(frameCheck(&record, sizeof(record), FUZZ_MAGIC, FUZZ_VERSION) == FrameStatus::CRC, "changed", 0);
+
+  printf("%lu iterations: %lu damaged accepted (unchanged bytes), rejected short %lu magic %lu "
+         "length %lu crc %lu: %s\n", iterations, accepted,
+         rejected[(uint8_t)FrameStatus::SHORT], rejected[(uint8_t)FrameStatus::MAGIC],
+         rejected[(uint8_t)FrameStatus::LENGTH], rejected[(uint8_t)FrameStatus::CRC],
+         failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+/**
+ * @file host_smoke_test.cpp
+ * @brief Host test - the firmware boots, measures and serves on the host build
+ *
+ * End to end through every shim: emulated PMS7003 frames over the serial
+ * shim and BME280 registers over Wire reach sensorData, LittleFS gets
+ * written, and /api/data answers over a real localhost socket with the
+ * emulated values; /api/history.bin sends exactly its Content-Length and
+ * /api/query rejects malformed aggregate names.
+ *
+ * Built and run by the host build (tools/host): ctest -R host_smoke
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+#include <LittleFS.h>
+#include <SoftwareSerial.h>
+#include <Wire.h>
+#include "HostBME280.h"
+#include "HostPMS7003.h"
+
+void setup();
+void loop();
+extern SoftwareSerial pmsSerial;
+extern ESP8266WebServer webServer;
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+static std::string httpGet(uint16_t port, const char* path) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  std::string response;
+  if (connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0) {
+    std::string request = std::string("GET ") + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+    char buf[1024];
+    ssize_t n;
+    while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) response.append(buf, (size_t)n);
+  }
+  close(fd);
+  return response;
+}
+
+/**
+ * @brief GET from the sketch's web server while loop() keeps running
+ */
+static std::string fetch(const char* path) {
+  std::atomic<bool> done(false);
+  std::string response;
+  std::thread client([&]() {
+    response = httpGet(webServer.hostPort(), path);
+    done = true;
+  });
+  for (int i = 0; i < 5000 && !done; i++) {
+    loop();
+    hostAdvanceMillis(10);
+    usleep(1000);
+  }
+  client.join();
+  return response;
+}
+
+static double jsonNumber(const std::string& json, const char* key) {
+  size_t at = json.find(std::string("\"") + key + "\":");
+  return at == std::string::npos ? NAN : atof(json.c_str() + at + strlen(key) + 3);
+}
+
+static bool fileExists(const std::string& path) {
+  struct stat st;
+  return stat(path.c_str(), &st) == 0;
+}
+
+int main() {
+  char dir[] = "/tmp/klimerko_smoke_XXXXXX";
+  if (!mkdtemp(dir) || chdir(dir) != 0) return 2;
+  setenv("KLIMERKO_EPHEMERAL_PORTS", "1", 1);
+  Serial.setQuiet(true);
+
+  HostBME280 bme;
+  bme.setConditions(24.0f, 1008.5f, 55.0f);
+  Wire.hostAttach(0x76, &bme);
+  HostPMS7003 pms(pmsSerial);
+  pms.setConcentrations(7, 23, 31);
+
+  setup();
+  expect(webServer.hostPort() != 0, "web server listening");
+  for (unsigned long t = 0; t < 10 * 60 * 1000UL; t += 10) {
+    loop();
+    hostAdvanceMillis(10);
+  }
+  expect(pms.framesSent() > 0, "PMS7003 frames requested");
+  expect(pms.wakeUps() > 0, "PMS7003 put to sleep and woken");
+
+  std::string response = fetch("/api/data");
+  expect(response.compare(0, 15, "HTTP/1.1 200 OK") == 0, "/api/data status");
+  size_t body = response.find("\r\n\r\n");
+  std::string json = body == std::string::npos ? "" : response.substr(body + 4);
+  expect(jsonNumber(json, "pm25") == 23, "pm25 from the PMS7003 frame");
+  expect(jsonNumber(json, "pm10") == 31, "pm10 from the PMS7003 frame");
+  expect(fabs(jsonNumber(json, "pres") - 1008.5) < 0.1, "pressure from BME280 registers");
+  expect(fabs(jsonNumber(json, "hum") - 55.0) < 0.5, "humidity from BME280 registers");
+  expect(fabs(jsonNumber(json, "temp") - 24.0) < 0.1, "temperature from BME280 registers");
+
+  expect(jsonNumber(json, "interval") == 5, "history interval for the live chart");
+
+  std::string history = fetch("/api/history.bin?n=288");
+  size_t historyBody = history.find("\r\n\r\n");
+  size_t declared = (size_t)atol(history.c_str() + history.find("Content-Length:") + 15);
+  expect(history.compare(0, 15, "HTTP/1.1 200 OK") == 0, "/api/history.bin status");
+  expect(historyBody != std::string::npos && history.size() - historyBody - 4 == declared &&
+             history.compare(historyBody + 4, 4, "KHB1") == 0,
+         "history body matches its Content-Length");
+
+  expect(fetch("/api/query?metric=pm25&agg=avg,p95").compare(0, 15, "HTTP/1.1 200 OK") == 0,
+         "/api/query accepts avg,p95");
+  expect(fetch("/api/query?metric=pm25&agg=p5x").compare(0, 12, "HTTP/1.1 400") == 0,
+         "/api/query rejects p5x");
+  expect(fetch("/api/query?metric=pm25&agg=p0").compare(0, 12, "HTTP/1.1 400") == 0,
+         "/api/query rejects p0");
+
+  expect(fetch("/no-such-page").compare(0, 12, "HTTP/1.1 404") == 0, "unknown path is 404");
+  expect(LittleFS.hostOpens() > 0 && fileExists(LittleFS.hostRoot()), "LittleFS directory used");
+
+  if (failures) printf("--- /api/data ---\n%s\n", response.c_str());
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures ? 1 : 0;
+}
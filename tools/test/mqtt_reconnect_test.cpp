@@ -0,0 +1,110 @@
+/**
+ * @file mqtt_reconnect_test.cpp
+ * @brief Host test - a broker change abandons the connect attempt in progress
+ *
+ * updateMqttBroker() during HANDSHAKE (old broker accepted TCP but never
+ * sends CONNACK) must not count a failure or wait out a backoff. During
+ * RESOLVING, the late answer for the old name must neither be used nor
+ * cached under the new one.
+ *
+ * Built and run by the host build (tools/host): ctest -R mqtt_reconnect
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <Arduino.h>
+#include "HostMqttBroker.h"
+// Same order as the sketch: metrics.h uses the MQTT link from network.h
+#include "network.h"
+#include "sinks.h"
+#include "metrics.h"
+#include "storage.h"
+#include "timeseries.h"
+#include "web_dashboard.h"
+
+void setup();
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+// Accepts TCP (in the backlog) but never answers
+static uint16_t silentListener() {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 4) < 0 ||
+      getsockname(fd, (sockaddr*)&addr, &len) < 0) {
+    perror("listener");
+    exit(2);
+  }
+  return ntohs(addr.sin_port);
+}
+
+// Step the connection without advancing time: no backoff can expire
+static void stepUntilConnected() {
+  for (int i = 0; i < 500 && !mqtt.connected(); i++) {
+    maintainMQTT();
+    usleep(1000);
+  }
+}
+
+int main() {
+  char dir[] = "/tmp/klimerko_reconnect_XXXXXX";
+  if (!mkdtemp(dir) || chdir(dir) != 0) return 2;
+  setenv("KLIMERKO_EPHEMERAL_PORTS", "1", 1);
+  Serial.setQuiet(true);
+
+  static HostMqttBroker broker;
+  uint16_t brokerPort = broker.start();
+  uint16_t silentPort = silentListener();
+
+  setup();
+
+  // HANDSHAKE: the old broker holds the CONNACK
+  strcpy(mqttServer, "127.0.0.1");
+  mqttPort = silentPort;
+  mqtt.disconnect();
+  mqttStartConnect();
+  mqttConnectStep();
+  expect(mqttState.phase == MqttConnectPhase::HANDSHAKE, "waiting for CONNACK from the old broker");
+
+  updateMqttBroker("127.0.0.1", brokerPort);
+  expect(mqttState.reconnectFailCount == 0, "abandoned handshake not counted as a failure");
+  stepUntilConnected();
+  expect(mqtt.connected(), "connected to the new broker without a backoff");
+  expect(mqttState.reconnectFailCount == 0, "no failure recorded");
+
+  // RESOLVING: the lookup for the old name answers after the change
+  mqtt.disconnect();
+  strcpy(mqttServer, "old-broker.example");
+  mqttStartConnect();
+  mqttDns.lookupDone = false;  // Lookup still running
+  uint8_t oldLookup = mqttDns.lookupId;
+  IPAddress oldIp(192, 0, 2, 1);
+
+  updateMqttBroker("127.0.0.1", brokerPort);
+  ip_addr_t answer;
+  answer.addr = (uint32_t)oldIp;
+  mqttDnsFound("old-broker.example", &answer, (void*)(uintptr_t)oldLookup);
+  stepUntilConnected();
+  expect(mqtt.connected(), "connected to the new broker after the late answer");
+  expect(mqttDns.ip != (uint32_t)oldIp, "late answer for the old name not used");
+  expect(strcmp(mqttDns.host, "127.0.0.1") == 0, "cache entry under the looked-up name");
+
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file prom_write_size_test.cpp
+ * @brief Host test - remote-write and Pushgateway bodies fit their buffers
+ *
+ * Takes PROM_PUSH_BATCH snapshots with the longest device ID and encodes
+ * them: the WriteRequest must fit PROM_WRITE_REQUEST_MAX (the bound the
+ * push buffer is sized from) and snappy must fit one snapshot into
+ * PROM_PUSH_PACKED. The Pushgateway text must fit PROM_PUSH_BUFFER.
+ * Counters past float precision (2^24) must still be sent exactly.
+ *
+ * Built and run by the host build (tools/host): ctest -R prom_write_size
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <Arduino.h>
+// Same order as the sketch: metrics.h uses the MQTT link from network.h
+#include "network.h"
+#include "sinks.h"
+#include "metrics.h"
+#include "storage.h"
+#include "timeseries.h"
+#include "web_dashboard.h"
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+int main() {
+  memset(klimerkoID, 'K', sizeof(klimerkoID) - 1);
+  klimerkoID[sizeof(klimerkoID) - 1] = '\0';
+
+  PromSnapshots snaps = {};
+  for (uint8_t i = 0; i < PROM_PUSH_BATCH; i++) snaps.take(1790000000UL + i * PROM_PUSH_INTERVAL_SEC);
+  expect(snaps.count == PROM_PUSH_BATCH, "batch of snapshots taken");
+  expect(snaps.series == promSeriesCount(), "every series in the snapshot");
+
+  std::vector<uint8_t> body(PROM_WRITE_REQUEST_MAX);
+  std::vector<uint8_t> packed(PROM_PUSH_PACKED);
+  for (uint8_t n = 1; n <= PROM_PUSH_BATCH; n++) {
+    size_t length = encodePromWriteRequest(snaps, n, body.data(), body.size());
+    printf("%u snapshots: %u bytes (bound %u)\n", n, (unsigned)length, (unsigned)promWriteRequestBound(n));
+    expect(length > 0 && length <= promWriteRequestBound(n), "WriteRequest within its bound");
+  }
+  size_t one = encodePromWriteRequest(snaps, 1, body.data(), body.size());
+  size_t packedLength = snappyCompress(body.data(), one, packed.data(), packed.size());
+  printf("1 snapshot snappy: %u bytes\n", (unsigned)packedLength);
+  expect(packedLength > 0, "one snapshot fits PROM_PUSH_PACKED");
+
+  // Counters above 2^24 must reach the receiver exact, as /metrics shows them
+  stats.successfulPublishes = (1UL << 24) + 1;
+  snaps.take(1790000000UL + PROM_PUSH_BATCH * PROM_PUSH_INTERVAL_SEC);
+  size_t latest = encodePromWriteRequest(snaps, PROM_PUSH_BATCH, body.data(), body.size());
+  uint8_t sample[9] = {(1 << 3) | 1};
+  double exact = (double)stats.successfulPublishes;
+  memcpy(sample + 1, &exact, sizeof(exact));  // Little-endian host, as on the device
+  expect(std::search(body.begin(), body.begin() + latest, sample, sample + sizeof(sample)) !=
+             body.begin() + latest,
+         "counter above 2^24 encoded exactly");
+
+  std::vector<char> text(PROM_PUSH_BUFFER);
+  PromTextBuffer out(text.data(), text.size());
+  writePromExposition(out, false);
+  printf("Pushgateway text: %u bytes\n", (unsigned)out.len);
+  expect(!out.overflow, "Pushgateway text fits PROM_PUSH_BUFFER");
+
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file settings_journal_test.cpp
+ * @brief Host test - settings journal replay, torn tail and compaction
+ *
+ * Uses the sketch's klimerkoSettings and settingsJournal on the file-backed
+ * EEPROM and LittleFS, restarting by clearing RAM and loading again:
+ * - updates settle for SETTINGS_COMMIT_QUIET_MS and are coalesced into one
+ *   append; no EEPROM erase on the way;
+ * - after a restart the journal is replayed over the EEPROM base;
+ * - a record cut short by power loss is ignored, the records before it are
+ *   kept and folded into a new base (journal removed);
+ * - a journal written against another base is discarded;
+ * - past SETTINGS_JOURNAL_MAX_BYTES the journal is compacted into EEPROM.
+ *
+ * Built and run by the host build (tools/host): ctest -R settings_journal
+ */
+
+#include <unistd.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <Arduino.h>
+// Same order as the sketch
+#include "network.h"
+#include "sinks.h"
+#include "metrics.h"
+#include "storage.h"
+#include "timeseries.h"
+#include "web_dashboard.h"
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+/**
+ * @brief Lose RAM and boot: EEPROM base, then the journal over it
+ * @return Records replayed
+ */
+static uint16_t reboot() {
+  memset(&klimerkoSettings, 0, sizeof(klimerkoSettings));
+  if (loadSettingsBase(klimerkoSettings) != SettingsLoad::CURRENT) return 0xFFFF;
+  return settingsJournal.replay();
+}
+
+static size_t journalSize() {
+  File f = LittleFS.open(SETTINGS_JOURNAL_PATH, "r");
+  if (!f) return 0;
+  size_t size = f.size();
+  f.close();
+  return size;
+}
+
+/**
+ * @brief Cut the journal short, as a power loss during an append would
+ */
+static void truncateJournal(size_t cut) {
+  File f = LittleFS.open(SETTINGS_JOURNAL_PATH, "r");
+  std::vector<uint8_t> bytes(f.size());
+  f.read(bytes.data(), bytes.size());
+  f.close();
+  f = LittleFS.open(SETTINGS_JOURNAL_PATH, "w");
+  f.write(bytes.data(), bytes.size() - cut);
+  f.close();
+}
+
+int main() {
+  char dir[] = "/tmp/klimerko_journal_XXXXXX";
+  if (!mkdtemp(dir) || chdir(dir) != 0) return 2;
+  Serial.setQuiet(true);
+  LittleFS.begin();
+
+  defaultSettings(klimerkoSettings);
+  strcpy(klimerkoSettings.deviceId, "journal");
+  expect(settingsJournal.compact(), "base written");
+  uint32_t erases = EEPROM.hostEraseCount();
+
+  // Quiet period and coalescing
+  updateTempOffsetSetting(-1.0f);
+  hostAdvanceMillis(SETTINGS_COMMIT_QUIET_MS / 2);
+  updateTempOffsetSetting(-1.25f);
+  updateAltitudeSetting(230);
+  hostAdvanceMillis(SETTINGS_COMMIT_QUIET_MS / 2);
+  settingsJournal.loop();
+  expect(settingsJournal.pending() && settingsJournal.appends() == 0, "no commit while changes continue");
+  hostAdvanceMillis(SETTINGS_COMMIT_QUIET_MS);
+  settingsJournal.loop();
+  expect(!settingsJournal.pending() && settingsJournal.appends() == 1, "one append after the quiet period");
+  expect(settingsJournal.coalesced() == 1, "repeated update coalesced");
+  expect(EEPROM.hostEraseCount() == erases, "no EEPROM erase for an update");
+
+  updateBoolSetting("alarmEnabled", false);
+  expect(settingsJournal.commit(), "second append");
+  size_t twoAppends = journalSize();
+
+  // Replay after a restart
+  expect(reboot() == 3, "three records replayed");
+  expect(fabsf(klimerkoSettings.tempOffset + 1.25f) < 0.001f, "latest temperature offset");
+  expect(klimerkoSettings.altitude == 230 && !klimerkoSettings.alarmEnabled, "altitude and alarm replayed");
+  expect(!strcmp(klimerkoSettings.deviceId, "journal"), "base fields untouched");
+  expect(journalSize() == twoAppends, "clean journal kept as is");
+
+  // Torn tail: the last record (alarm) loses its CRC bytes
+  truncateJournal(2);
+  erases = EEPROM.hostEraseCount();
+  expect(reboot() == 2, "records before the torn one replayed");
+  expect(klimerkoSettings.altitude == 230 && klimerkoSettings.alarmEnabled, "torn record ignored");
+  expect(!LittleFS.exists(SETTINGS_JOURNAL_PATH), "torn journal folded into the base");
+  expect(EEPROM.hostEraseCount() == erases + 1, "one erase for the fold");
+  expect(reboot() == 0 && klimerkoSettings.altitude == 230, "folded values survive the next restart");
+
+  // Journal left by an interrupted compaction: written against another base
+  updateAltitudeSetting(999);
+  settingsJournal.commit();
+  File f = LittleFS.open(SETTINGS_JOURNAL_PATH, "r+");
+  SettingsJournalHeader header;
+  f.read((uint8_t*)&header, sizeof(header));
+  header.baseCrc ^= 1;
+  f.seek(0, SeekSet);
+  f.write((const uint8_t*)&header, sizeof(header));
+  f.close();
+  expect(reboot() == 0, "stale journal not applied");
+  expect(klimerkoSettings.altitude == 230, "base value kept");
+  expect(!LittleFS.exists(SETTINGS_JOURNAL_PATH), "stale journal removed");
+
+  // Compaction once the journal is full
+  uint32_t compactions = settingsJournal.compactions();
+  int altitude = 0;
+  while (settingsJournal.compactions() == compactions && altitude < 2000) {
+    updateAltitudeSetting(++altitude);
+    settingsJournal.commit();
+    expect(journalSize() <= SETTINGS_JOURNAL_MAX_BYTES, "journal within its limit");
+  }
+  expect(settingsJournal.compactions() == compactions + 1, "full journal compacted");
+  expect(!LittleFS.exists(SETTINGS_JOURNAL_PATH), "journal removed by compaction");
+  expect(reboot() == 0 && klimerkoSettings.altitude == altitude, "compacted value in the base");
+
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,206 @@
+/**
+ * @file settings_migration_test.cpp
+ * @brief Host test - EEPROM settings from older firmware are migrated
+ *
+ * Writes settings images the way earlier firmware left them in the
+ * file-backed EEPROM and restores them with restoreSettings():
+ * - version 0 (Klimerko 6.7 strings, no CRC) -> current, 7.0 defaults;
+ * - version 1 (Klimerko 7.0, CRC) with a 7.0 journal record on top and its
+ *   statistics moved to STATS_EEPROM_OFFSET; out-of-range values defaulted;
+ * - the migrated base is written back once and then loads as current;
+ * - a damaged current base falls back to defaults;
+ * - an altitude outside MIN_ALTITUDE..MAX_ALTITUDE is clamped on restore.
+ *
+ * Built and run by the host build (tools/host): ctest -R settings_migration
+ */
+
+#include <unistd.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <Arduino.h>
+// Same order as the sketch
+#include "network.h"
+#include "sinks.h"
+#include "metrics.h"
+#include "storage.h"
+#include "timeseries.h"
+#include "web_dashboard.h"
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+/**
+ * @brief Sketch-side copies of the settings, as restoreSettings() fills them
+ */
+struct Restored {
+  char deviceId[32];
+  char deviceToken[64];
+  char tempOffsetChar[8];
+  float tempOffset;
+  char altitudeChar[6];
+  int altitude;
+  bool deepSleep;
+  bool alarm;
+  char broker[64];
+  uint16_t port;
+  Calibration cal;
+  bool valid;
+
+  Restored() {
+    memset(this, 0, sizeof(*this));
+    strcpy(broker, MQTT_DEFAULT_SERVER);
+    port = MQTT_DEFAULT_PORT;
+    cal.pm25Factor = DEFAULT_PM_CAL_FACTOR;
+    cal.pm10Factor = DEFAULT_PM_CAL_FACTOR;
+    valid = restoreSettings(deviceId, deviceToken, tempOffsetChar, tempOffset,
+                            altitudeChar, altitude, deepSleep, alarm, broker, port, cal);
+  }
+};
+
+/**
+ * @brief Replace the EEPROM area and the journal with an old image
+ */
+template <typename T>
+static void writeImage(const T& image) {
+  EEPROM.begin(EEPROM_USED_SIZE);
+  for (size_t i = 0; i < EEPROM_USED_SIZE; i++) EEPROM.write(i, 0);
+  EEPROM.put(0, image);
+  EEPROM.commit();
+  EEPROM.end();
+  LittleFS.remove(SETTINGS_JOURNAL_PATH);
+}
+
+static void appendV1Record(uint32_t baseCrc, SettingKey key, const void* value, uint8_t len) {
+  File f = LittleFS.open(SETTINGS_JOURNAL_PATH, "a");
+  if (f.size() == 0) {
+    SettingsJournalHeader header = {SETTINGS_JOURNAL_MAGIC, baseCrc};
+    f.write((const uint8_t*)&header, sizeof(header));
+  }
+  uint8_t record[2 + 255 + 4];
+  record[0] = (uint8_t)key;
+  record[1] = len;
+  memcpy(record + 2, value, len);
+  uint32_t crc = calculateCRC32(record, 2 + len);
+  memcpy(record + 2 + len, &crc, sizeof(crc));
+  f.write(record, 2 + len + 4);
+  f.close();
+}
+
+static void testV0() {
+  SettingsV0 v0;
+  memset(&v0, 0, sizeof(v0));
+  memcpy(v0.header, "KLI", 4);
+  strcpy(v0.deviceId, "device67");
+  strcpy(v0.deviceToken, "maker:token67");
+  strcpy(v0.tempOffset, "-1.50");
+  strcpy(v0.altitude, "117");
+  writeImage(v0);
+
+  Restored r;
+  expect(r.valid, "v0: restored");
+  expect(!strcmp(r.deviceId, "device67") && !strcmp(r.deviceToken, "maker:token67"), "v0: credentials kept");
+  expect(fabsf(r.tempOffset + 1.5f) < 0.001f && !strcmp(r.tempOffsetChar, "-1.50"), "v0: temperature offset parsed");
+  expect(r.altitude == 117 && !strcmp(r.altitudeChar, "117"), "v0: altitude parsed");
+  expect(r.alarm && !r.deepSleep, "v0: 7.0 defaults for new flags");
+  expect(!strcmp(r.broker, MQTT_DEFAULT_SERVER) && r.port == MQTT_DEFAULT_PORT, "v0: default broker");
+  expect(getStoredPayloadFormat() == PayloadFormat::JSON, "v0: JSON payload format");
+
+  Settings again;
+  expect(loadSettingsBase(again) == SettingsLoad::CURRENT, "v0: written back in the current layout");
+  expect(again.version == SETTINGS_VERSION && !strcmp(again.deviceId, "device67"), "v0: written back intact");
+}
+
+static void testV1() {
+  SettingsV1 v1;
+  memset(&v1, 0, sizeof(v1));
+  memcpy(v1.header, "KLI", 4);
+  strcpy(v1.deviceId, "device70");
+  strcpy(v1.deviceToken, "maker:token70");
+  strcpy(v1.tempOffset, "0.75");
+  strcpy(v1.altitude, "99999");  // Out of range: clamped
+  v1.deepSleepEnabled = true;
+  strcpy(v1.mqttBroker, "broker.local");
+  v1.payloadFormat = 0xFF;       // Former padding on early 7.0 devices
+  v1.mqttBrokerPort = 8883;
+  v1.alarmEnabled = false;
+  v1.gmtOffset = 2;
+  v1.pm25CalFactor = 1.25f;
+  v1.pm10CalFactor = 50.0f;      // Invalid: default
+  v1.crc32 = crc32(&v1, sizeof(v1) - sizeof(uint32_t));
+  writeImage(v1);
+
+  StatisticsV1 oldStats = {42, 3, 5, 1000, 7, 3600};
+  EEPROM.begin(EEPROM_USED_SIZE);
+  EEPROM.put(STATS_V1_EEPROM_OFFSET, oldStats);
+  EEPROM.commit();
+  EEPROM.end();
+
+  // Update journaled by 7.0 after its last full save
+  char token[sizeof(SettingsV1::deviceToken)] = "maker:journaled";
+  appendV1Record(v1.crc32, SettingKey::DEVICE_TOKEN, token, sizeof(token));
+
+  Restored r;
+  expect(r.valid, "v1: restored");
+  expect(!strcmp(r.deviceId, "device70"), "v1: device ID kept");
+  expect(!strcmp(r.deviceToken, "maker:journaled"), "v1: 7.0 journal applied before migrating");
+  expect(fabsf(r.tempOffset - 0.75f) < 0.001f, "v1: temperature offset parsed");
+  expect(r.altitude == MAX_ALTITUDE && !strcmp(r.altitudeChar, "9000"), "v1: altitude clamped");
+  expect(r.deepSleep && !r.alarm, "v1: flags kept");
+  expect(!strcmp(r.broker, "broker.local") && r.port == 8883, "v1: broker kept");
+  expect(fabsf(r.cal.pm25Factor - 1.25f) < 0.001f, "v1: valid calibration kept");
+  expect(r.cal.pm10Factor == DEFAULT_PM_CAL_FACTOR, "v1: invalid calibration defaulted");
+  expect(getStoredPayloadFormat() == PayloadFormat::JSON, "v1: padding byte read as JSON");
+  expect(klimerkoSettings.gmtOffset == 2, "v1: GMT offset kept");
+  expect(!LittleFS.exists(SETTINGS_JOURNAL_PATH), "v1: old journal dropped after write-back");
+
+  StatisticsV1 moved = {};
+  EEPROM.begin(EEPROM_USED_SIZE);
+  expect(getStatisticsRecord(moved) == FrameStatus::OK, "v1: statistics record sealed");
+  EEPROM.end();
+  expect(moved.bootCount == 42 && moved.successfulPublishes == 1000, "v1: statistics moved");
+
+  Settings again;
+  expect(loadSettingsBase(again) == SettingsLoad::CURRENT, "v1: written back in the current layout");
+}
+
+static void testDamagedAndClamped() {
+  Settings s;
+  defaultSettings(s);
+  strcpy(s.deviceId, "device72");
+  s.altitude = -32768;  // Written by a build without the range check
+  s.crc32 = calculateSettingsCRC(s);
+  writeImage(s);
+
+  Restored clamped;
+  expect(clamped.valid, "v2: restored");
+  expect(clamped.altitude == MIN_ALTITUDE && !strcmp(clamped.altitudeChar, "-500"), "v2: altitude clamped to fit");
+
+  s.deviceId[0] ^= 0x01;  // CRC no longer matches
+  writeImage(s);
+  Restored damaged;
+  expect(!damaged.valid, "damaged base rejected");
+  expect(damaged.deviceId[0] == '\0' && !strcmp(damaged.altitudeChar, "0"), "damaged base: defaults");
+}
+
+int main() {
+  char dir[] = "/tmp/klimerko_settings_XXXXXX";
+  if (!mkdtemp(dir) || chdir(dir) != 0) return 2;
+  Serial.setQuiet(true);
+  LittleFS.begin();
+
+  testV0();
+  testV1();
+  testDamagedAndClamped();
+
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file sinks_test.cpp
+ * @brief Host test - sink delivery against stand-in MQTT and HTTP servers
+ *
+ * Drives sinkPublishSample()/sinkLoop() directly:
+ * - with every sink off the payload pool is not allocated;
+ * - the local MQTT sink publishes flat JSON to klimerko/<id>/sample;
+ * - InfluxDB lines are batched into one POST;
+ * - Sensor.Community gets one POST per pin, and when the BME280 POST fails
+ *   after the PM POST succeeded only the BME280 pin is retried;
+ * - turning every sink off again returns the pool.
+ *
+ * Built and run by the host build (tools/host): ctest -R sinks
+ */
+
+#include <unistd.h>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <Arduino.h>
+#include "HostHttpServer.h"
+#include "HostMqttBroker.h"
+// Same order as the sketch
+#include "network.h"
+#include "sinks.h"
+#include "metrics.h"
+#include "storage.h"
+#include "timeseries.h"
+#include "web_dashboard.h"
+
+extern MqttSink localMqttSink;
+extern InfluxSink influxSink;
+extern SensorCommunitySink communitySink;
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+/**
+ * @brief Run sinkLoop() until done() or about two seconds of real time
+ */
+template <typename Done>
+static bool serviceUntil(Done done) {
+  for (int i = 0; i < 2000 && !done(); i++) {
+    sinkLoop();
+    hostAdvanceMillis(10);
+    usleep(1000);
+  }
+  return done();
+}
+
+static size_t countPin(const std::vector<HostHttpServer::Request>& requests, const char* pin) {
+  size_t n = 0;
+  for (const auto& r : requests) {
+    if (r.header("x-pin") == pin) n++;
+  }
+  return n;
+}
+
+int main() {
+  Serial.setQuiet(true);
+  strcpy(klimerkoID, "sinktest");
+  memset(&sinkConfig, 0, sizeof(sinkConfig));
+  sinkConfig.mqttPort = MQTT_DEFAULT_PORT;
+  sinkConfig.influxBatch = 2;
+  sinkConfig.influxFlushSec = INFLUX_BATCH_MAX_SEC;
+
+  SensorData data = {};
+  data.pm1 = 4;
+  data.pm25 = 7;
+  data.pm10 = 11;
+  data.temperature = 21.5f;
+  data.humidity = 48.25f;
+  data.pressure = 1013.2f;
+  SinkSample sample = {&data, 1790000000UL, true, true};
+
+  // Everything off: no pool, nothing queued
+  sinkLoop();
+  sinkPublishSample(sample);
+  expect(!sinkPool.reserved(), "no payload pool while every sink is off");
+
+  static HostMqttBroker broker;
+  static HostHttpServer influx;
+  static HostHttpServer community;
+  uint16_t brokerPort = broker.start();
+  uint16_t influxPort = influx.start();
+  uint16_t communityPort = community.start();
+  WiFi.hostRedirect("api.sensor.community", communityPort);
+
+  // The BME280 pin fails once; everything else is accepted
+  static std::atomic<int> envFailures{1};
+  community.setStatus([](const HostHttpServer::Request& r) {
+    if (r.header("x-pin") == SENSOR_COMMUNITY_PIN_ENV && envFailures > 0) {
+      envFailures--;
+      return 500;
+    }
+    return 201;
+  });
+
+  strcpy(sinkConfig.mqttHost, "127.0.0.1");
+  sinkConfig.mqttPort = brokerPort;
+  snprintf(sinkConfig.influxUrl, sizeof(sinkConfig.influxUrl),
+           "http://127.0.0.1:%u/write?db=klimerko&precision=s", influxPort);
+  sinkConfig.communityEnabled = true;
+  sinkLoop();
+  expect(sinkPool.reserved(), "payload pool allocated once a sink is on");
+
+  sinkPublishSample(sample);
+  sample.timestamp += 60;
+  sinkPublishSample(sample);
+
+  // MQTT: one message per sample
+  expect(serviceUntil([&]() { return broker.publishes() == 2; }), "both samples published over MQTT");
+  std::vector<HostMqttBroker::Message> messages = broker.messages();
+  expect(messages.size() == 2 && messages[0].topic == "klimerko/sinktest/sample", "sample topic");
+  expect(!messages.empty() && messages[0].payload.find("\"pm25\":7") != std::string::npos &&
+             messages[0].payload.find("\"temp\":21.50") != std::string::npos,
+         "flat JSON sample");
+
+  // InfluxDB: both lines in a single POST
+  expect(serviceUntil([&]() { return influx.requests().size() >= 1 && influxSink.queued() == 0; }),
+         "influx batch delivered");
+  std::vector<HostHttpServer::Request> writes = influx.requests();
+  expect(writes.size() == 1, "two lines, one POST");
+  expect(!writes.empty() && writes[0].path == "/write?db=klimerko&precision=s", "influx write path");
+
+  // Sensor.Community: PM accepted, BME280 refused, retried alone after backoff
+  expect(serviceUntil([&]() { return communitySink.backingOff(); }), "failed BME280 POST backs off");
+  expect(countPin(community.requests(), SENSOR_COMMUNITY_PIN_PM) == 1, "PM posted for the first sample");
+  hostAdvanceMillis(2 * SINK_BACKOFF_MIN_MS);
+  expect(serviceUntil([&]() { return communitySink.queued() == 0; }), "community backlog delivered");
+  std::vector<HostHttpServer::Request> pushes = community.requests();
+  expect(countPin(pushes, SENSOR_COMMUNITY_PIN_PM) == 2, "PM posted once per sample, not again on retry");
+  expect(countPin(pushes, SENSOR_COMMUNITY_PIN_ENV) == 3, "BME280 retried, then posted for the second sample");
+  expect(communitySink.sent() == 2 && communitySink.failed() == 1, "community counters");
+
+  // Everything off again: the pool goes once the queues are empty
+  sinkConfig.mqttHost[0] = '\0';
+  sinkConfig.influxUrl[0] = '\0';
+  sinkConfig.communityEnabled = false;
+  sinkLoop();
+  expect(sinkPool.inUse() == 0, "no payload referenced");
+  expect(!sinkPool.reserved(), "payload pool freed when every sink is off");
+
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file stats_store_test.cpp
+ * @brief Host test - statistics survive resets and power loss
+ *
+ * Uses the sketch's stats and statsStore on the emulated RTC memory and
+ * LittleFS. A reset keeps RTC memory; a power loss clears it:
+ * - a reset restores every counter from RTC memory;
+ * - a power loss falls back to the last flash checkpoint;
+ * - with both present each counter is max(RTC, flash);
+ * - a record cut short at the end of /stats.log is skipped in favour of
+ *   the one before it;
+ * - the log is rewritten with the newest record beyond STATS_LOG_MAX_BYTES;
+ * - without a log the 7.0 EEPROM record is imported once.
+ *
+ * Built and run by the host build (tools/host): ctest -R stats_store
+ */
+
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <Arduino.h>
+// Same order as the sketch
+#include "network.h"
+#include "sinks.h"
+#include "metrics.h"
+#include "storage.h"
+#include "timeseries.h"
+#include "web_dashboard.h"
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+static void powerLoss() {
+  uint32_t words[STATS_RTC_WORDS] = {};
+  ESP.rtcUserMemoryWrite(STATS_RTC_BLOCK, words, sizeof(words));
+}
+
+static void appendLog(const void* bytes, size_t length) {
+  File f = LittleFS.open(STATS_LOG_PATH, "a");
+  f.write((const uint8_t*)bytes, length);
+  f.close();
+}
+
+static size_t logSize() {
+  File f = LittleFS.open(STATS_LOG_PATH, "r");
+  if (!f) return 0;
+  size_t size = f.size();
+  f.close();
+  return size;
+}
+
+int main() {
+  char dir[] = "/tmp/klimerko_stats_XXXXXX";
+  if (!mkdtemp(dir) || chdir(dir) != 0) return 2;
+  Serial.setQuiet(true);
+  LittleFS.begin();
+  powerLoss();
+
+  // 7.0 counters in EEPROM, no log yet
+  StatisticsV1 legacy = {10, 1, 2, 300, 4, 7200};
+  EEPROM.begin(EEPROM_USED_SIZE);
+  putStatisticsRecord(legacy);
+  EEPROM.commit();
+  EEPROM.end();
+  statsStore.begin();
+  expect(stats.bootCount == 11 && stats.successfulPublishes == 300, "7.0 EEPROM statistics imported");
+  expect(stats.uptimeSeconds == 7200, "7.0 uptime imported");
+
+  // Reset: RTC memory keeps what was never checkpointed
+  for (int i = 0; i < 5; i++) recordSuccessfulPublish();
+  incrementMqttReconnects();
+  statsStore.begin();
+  expect(stats.bootCount == 12, "reset counted as a boot");
+  expect(stats.successfulPublishes == 305 && stats.mqttReconnects == 3, "reset: counters from RTC memory");
+
+  // Power loss: back to the last checkpoint
+  hostAdvanceMillis(STATS_CHECKPOINT_SEC * 1000UL);
+  statsStore.loop();
+  expect(statsStore.checkpoints() == 1, "checkpoint after STATS_CHECKPOINT_SEC awake");
+  expect(logSize() == STATS_LOG_RECORD_SIZE, "one record in the log");
+  for (int i = 0; i < 3; i++) recordFailedPublish();
+  powerLoss();
+  statsStore.begin();
+  expect(stats.bootCount == 13, "power loss counted as a boot");
+  expect(stats.successfulPublishes == 305 && stats.failedPublishes == 4, "power loss: checkpointed counters");
+  expect(stats.uptimeSeconds == 7200 + STATS_CHECKPOINT_SEC, "power loss: checkpointed uptime");
+
+  // Both present: each counter is the larger of the two
+  for (int i = 0; i < 2; i++) recordSuccessfulPublish();   // RTC ahead
+  Statistics flash = stats;
+  flash.successfulPublishes = 1;
+  flash.wifiReconnects = 50;                                 // Flash ahead
+  uint8_t record[STATS_LOG_RECORD_SIZE];
+  frameEncode(record, sizeof(record), STATS_LOG_MAGIC, STATS_LOG_VERSION, &flash, sizeof(flash));
+  appendLog(record, sizeof(record));
+  statsStore.begin();
+  expect(stats.successfulPublishes == 307, "max: RTC counter kept");
+  expect(stats.wifiReconnects == 50, "max: flash counter kept");
+
+  // Torn tail: a half-written newer record does not hide the one before
+  Statistics newer = flash;
+  newer.wifiReconnects = 90;
+  frameEncode(record, sizeof(record), STATS_LOG_MAGIC, STATS_LOG_VERSION, &newer, sizeof(newer));
+  appendLog(record, sizeof(record) / 2);
+  powerLoss();
+  statsStore.begin();
+  expect(stats.wifiReconnects == 50 && stats.successfulPublishes == 1, "torn record skipped, previous one used");
+
+  // Damaged newest record (full length, bad CRC): same
+  File f = LittleFS.open(STATS_LOG_PATH, "w");
+  frameEncode(record, sizeof(record), STATS_LOG_MAGIC, STATS_LOG_VERSION, &flash, sizeof(flash));
+  f.write(record, sizeof(record));
+  frameEncode(record, sizeof(record), STATS_LOG_MAGIC, STATS_LOG_VERSION, &newer, sizeof(newer));
+  record[sizeof(record) - 1] ^= 0xFF;
+  f.write(record, sizeof(record));
+  f.close();
+  powerLoss();
+  statsStore.begin();
+  expect(stats.wifiReconnects == 50, "record with a bad CRC skipped");
+
+  // Log rewritten with the newest record once full
+  uint32_t before = statsStore.checkpoints();
+  for (int i = 0; i < (int)(STATS_LOG_MAX_BYTES / STATS_LOG_RECORD_SIZE) + 2; i++) {
+    recordSuccessfulPublish();
+    statsStore.checkpoint();
+    expect(logSize() <= STATS_LOG_MAX_BYTES, "log within its limit");
+  }
+  expect(statsStore.checkpoints() > before, "checkpoints written");
+  uint64_t successful = stats.successfulPublishes;
+  powerLoss();
+  statsStore.begin();
+  expect(stats.successfulPublishes == successful, "newest checkpoint survives the rewrite");
+  expect(!LittleFS.exists(STATS_LOG_TMP_PATH), "rewrite left no temporary file");
+
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file web_assets_test.cpp
+ * @brief Host test - the data/www gzip files match the PROGMEM dashboard assets
+ *
+ * serveWebAsset() prefers the LittleFS copy, so a stale data/www file
+ * hides every dashboard change from devices with an uploaded data image.
+ * Each .gz file in data/www must decompress to exactly its PROGMEM literal;
+ * rerun tools/build_web_assets.py when this fails.
+ *
+ * Built and run by the host build (tools/host): ctest -R web_assets
+ */
+
+#include <dirent.h>
+#include <zlib.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <Arduino.h>
+// Same order as the sketch: metrics.h uses the MQTT link from network.h
+#include "network.h"
+#include "sinks.h"
+#include "metrics.h"
+#include "storage.h"
+#include "timeseries.h"
+#include "web_dashboard.h"
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+// Must list every asset tools/build_web_assets.py writes
+static const struct {
+  const char* file;
+  const char* literal;
+} ASSETS[] = {
+  {"index.html.gz", DASHBOARD_HTML},
+  {"kchart.js.gz", KCHART_JS},
+};
+
+static bool gunzip(const std::string& path, std::string& out) {
+  gzFile gz = gzopen(path.c_str(), "rb");
+  if (!gz) return false;
+  char buf[4096];
+  int n;
+  out.clear();
+  while ((n = gzread(gz, buf, sizeof(buf))) > 0) out.append(buf, n);
+  bool ok = n == 0 && !gzdirect(gz);
+  gzclose(gz);
+  return ok;
+}
+
+int main() {
+  const std::string dir = WEB_ASSET_SOURCE_DIR;
+
+  for (const auto& asset : ASSETS) {
+    std::string text;
+    char what[96];
+    snprintf(what, sizeof(what), "%s is a readable gzip file", asset.file);
+    expect(gunzip(dir + "/" + asset.file, text), what);
+    snprintf(what, sizeof(what), "%s matches its PROGMEM literal", asset.file);
+    expect(text == asset.literal, what);
+  }
+
+  // A .gz without a literal would be served but never checked
+  DIR* d = opendir(dir.c_str());
+  expect(d != nullptr, "data/www readable");
+  while (dirent* entry = d ? readdir(d) : nullptr) {
+    size_t len = strlen(entry->d_name);
+    if (len < 3 || strcmp(entry->d_name + len - 3, ".gz") != 0) continue;
+    bool known = false;
+    for (const auto& asset : ASSETS) known |= !strcmp(entry->d_name, asset.file);
+    char what[96];
+    snprintf(what, sizeof(what), "%s has a PROGMEM literal", entry->d_name);
+    expect(known, what);
+  }
+  if (d) closedir(d);
+
+  printf(failures ? "FAILED\n" : "OK\n");
+  return failures ? 1 : 0;
+}